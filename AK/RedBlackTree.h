@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace AK {
+
+// An augmenter gets a chance to recompute per-node summary data (stored in the node's value)
+// whenever the shape of the subtree below that node changes. The default one does nothing.
+struct RedBlackTreeNoAugmentation {
+    template<typename Node>
+    static void update(Node&) {}
+};
+
+template<typename TreeType, typename ElementType>
+class RedBlackTreeIterator {
+public:
+    RedBlackTreeIterator() {}
+    bool operator!=(const RedBlackTreeIterator& other) const { return m_node != other.m_node; }
+    bool operator==(const RedBlackTreeIterator& other) const { return m_node == other.m_node; }
+    RedBlackTreeIterator& operator++()
+    {
+        m_node = TreeType::successor(m_node);
+        return *this;
+    }
+    ElementType& operator*() { return m_node->value; }
+    ElementType* operator->() { return &m_node->value; }
+    const auto& key() const { return m_node->key; }
+    bool is_end() const { return !m_node; }
+
+private:
+    friend TreeType;
+    explicit RedBlackTreeIterator(typename TreeType::Node* node)
+        : m_node(node)
+    {
+    }
+    typename TreeType::Node* m_node { nullptr };
+};
+
+template<typename K, typename V, typename Augmenter = RedBlackTreeNoAugmentation>
+class RedBlackTree {
+public:
+    struct Node {
+        Node(const K& k, V&& v)
+            : key(k)
+            , value(move(v))
+        {
+        }
+        Node(const K& k, const V& v)
+            : key(k)
+            , value(v)
+        {
+        }
+
+        K key;
+        V value;
+        Node* parent { nullptr };
+        Node* left { nullptr };
+        Node* right { nullptr };
+        bool is_red { true };
+    };
+
+    RedBlackTree() {}
+    ~RedBlackTree() { clear(); }
+
+    RedBlackTree(const RedBlackTree& other)
+    {
+        m_root = clone_subtree(other.m_root, nullptr);
+        m_size = other.m_size;
+    }
+
+    RedBlackTree(RedBlackTree&& other)
+        : m_root(other.m_root)
+        , m_size(other.m_size)
+    {
+        other.m_root = nullptr;
+        other.m_size = 0;
+    }
+
+    RedBlackTree& operator=(const RedBlackTree& other)
+    {
+        if (this != &other) {
+            clear();
+            m_root = clone_subtree(other.m_root, nullptr);
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    RedBlackTree& operator=(RedBlackTree&& other)
+    {
+        if (this != &other) {
+            clear();
+            m_root = other.m_root;
+            m_size = other.m_size;
+            other.m_root = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    bool is_empty() const { return !m_root; }
+    size_t size() const { return m_size; }
+
+    void clear()
+    {
+        delete_subtree(m_root);
+        m_root = nullptr;
+        m_size = 0;
+    }
+
+    // The root is exposed so that augmented trees can implement their own guided descents.
+    const Node* root() const { return m_root; }
+
+    V& insert(const K& key, V&& value)
+    {
+        Node* parent = nullptr;
+        Node** link = &m_root;
+        while (*link) {
+            parent = *link;
+            if (key < parent->key)
+                link = &parent->left;
+            else if (parent->key < key)
+                link = &parent->right;
+            else
+                ASSERT_NOT_REACHED();
+        }
+        auto* node = new Node(key, move(value));
+        node->parent = parent;
+        *link = node;
+        ++m_size;
+        update_path_to_root(node);
+        insert_fixup(node);
+        return node->value;
+    }
+
+    V& insert(const K& key, const V& value)
+    {
+        return insert(key, V(value));
+    }
+
+    bool remove(const K& key)
+    {
+        auto* node = find_node(key);
+        if (!node)
+            return false;
+        remove_node(node);
+        return true;
+    }
+
+    V* find(const K& key)
+    {
+        auto* node = find_node(key);
+        return node ? &node->value : nullptr;
+    }
+
+    const V* find(const K& key) const
+    {
+        return const_cast<RedBlackTree*>(this)->find(key);
+    }
+
+    bool contains(const K& key) const { return find_node(key); }
+
+    // Returns the value with the largest key that is <= the given key.
+    V* find_largest_not_above(const K& key)
+    {
+        Node* candidate = nullptr;
+        for (auto* node = m_root; node;) {
+            if (key < node->key) {
+                node = node->left;
+                continue;
+            }
+            candidate = node;
+            if (!(node->key < key))
+                break;
+            node = node->right;
+        }
+        return candidate ? &candidate->value : nullptr;
+    }
+
+    const V* find_largest_not_above(const K& key) const
+    {
+        return const_cast<RedBlackTree*>(this)->find_largest_not_above(key);
+    }
+
+    // Returns the value with the smallest key that is >= the given key.
+    V* find_smallest_not_below(const K& key)
+    {
+        Node* candidate = nullptr;
+        for (auto* node = m_root; node;) {
+            if (node->key < key) {
+                node = node->right;
+                continue;
+            }
+            candidate = node;
+            if (!(key < node->key))
+                break;
+            node = node->left;
+        }
+        return candidate ? &candidate->value : nullptr;
+    }
+
+    const V* find_smallest_not_below(const K& key) const
+    {
+        return const_cast<RedBlackTree*>(this)->find_smallest_not_below(key);
+    }
+
+    using Iterator = RedBlackTreeIterator<RedBlackTree, V>;
+    friend Iterator;
+    Iterator begin() { return Iterator(minimum(m_root)); }
+    Iterator end() { return {}; }
+
+    using ConstIterator = RedBlackTreeIterator<const RedBlackTree, const V>;
+    friend ConstIterator;
+    ConstIterator begin() const { return ConstIterator(minimum(m_root)); }
+    ConstIterator end() const { return {}; }
+
+private:
+    static Node* minimum(Node* node)
+    {
+        if (!node)
+            return nullptr;
+        while (node->left)
+            node = node->left;
+        return node;
+    }
+
+    static Node* successor(Node* node)
+    {
+        if (node->right)
+            return minimum(node->right);
+        while (node->parent && node == node->parent->right)
+            node = node->parent;
+        return node->parent;
+    }
+
+    static bool is_black(const Node* node) { return !node || !node->is_red; }
+
+    static void delete_subtree(Node* node)
+    {
+        if (!node)
+            return;
+        delete_subtree(node->left);
+        delete_subtree(node->right);
+        delete node;
+    }
+
+    static Node* clone_subtree(const Node* node, Node* parent)
+    {
+        if (!node)
+            return nullptr;
+        auto* clone = new Node(node->key, node->value);
+        clone->is_red = node->is_red;
+        clone->parent = parent;
+        clone->left = clone_subtree(node->left, clone);
+        clone->right = clone_subtree(node->right, clone);
+        return clone;
+    }
+
+    Node* find_node(const K& key) const
+    {
+        for (auto* node = m_root; node;) {
+            if (key < node->key)
+                node = node->left;
+            else if (node->key < key)
+                node = node->right;
+            else
+                return node;
+        }
+        return nullptr;
+    }
+
+    static void update_path_to_root(Node* node)
+    {
+        for (; node; node = node->parent)
+            Augmenter::update(*node);
+    }
+
+    void replace_child(Node* parent, Node* old_child, Node* new_child)
+    {
+        if (!parent)
+            m_root = new_child;
+        else if (parent->left == old_child)
+            parent->left = new_child;
+        else
+            parent->right = new_child;
+        if (new_child)
+            new_child->parent = parent;
+    }
+
+    void rotate_left(Node* node)
+    {
+        auto* pivot = node->right;
+        node->right = pivot->left;
+        if (pivot->left)
+            pivot->left->parent = node;
+        replace_child(node->parent, node, pivot);
+        pivot->left = node;
+        node->parent = pivot;
+        Augmenter::update(*node);
+        Augmenter::update(*pivot);
+    }
+
+    void rotate_right(Node* node)
+    {
+        auto* pivot = node->left;
+        node->left = pivot->right;
+        if (pivot->right)
+            pivot->right->parent = node;
+        replace_child(node->parent, node, pivot);
+        pivot->right = node;
+        node->parent = pivot;
+        Augmenter::update(*node);
+        Augmenter::update(*pivot);
+    }
+
+    void insert_fixup(Node* node)
+    {
+        while (node->parent && node->parent->is_red) {
+            auto* parent = node->parent;
+            auto* grandparent = parent->parent;
+            if (parent == grandparent->left) {
+                auto* uncle = grandparent->right;
+                if (uncle && uncle->is_red) {
+                    parent->is_red = false;
+                    uncle->is_red = false;
+                    grandparent->is_red = true;
+                    node = grandparent;
+                    continue;
+                }
+                if (node == parent->right) {
+                    node = parent;
+                    rotate_left(node);
+                    parent = node->parent;
+                }
+                parent->is_red = false;
+                grandparent->is_red = true;
+                rotate_right(grandparent);
+            } else {
+                auto* uncle = grandparent->left;
+                if (uncle && uncle->is_red) {
+                    parent->is_red = false;
+                    uncle->is_red = false;
+                    grandparent->is_red = true;
+                    node = grandparent;
+                    continue;
+                }
+                if (node == parent->left) {
+                    node = parent;
+                    rotate_right(node);
+                    parent = node->parent;
+                }
+                parent->is_red = false;
+                grandparent->is_red = true;
+                rotate_left(grandparent);
+            }
+        }
+        m_root->is_red = false;
+    }
+
+    void remove_node(Node* node)
+    {
+        Node* child = nullptr;
+        Node* child_parent = nullptr;
+        bool removed_black = !node->is_red;
+
+        if (!node->left || !node->right) {
+            child = node->left ? node->left : node->right;
+            child_parent = node->parent;
+            replace_child(node->parent, node, child);
+        } else {
+            // Splice out the in-order successor and move it into this node's position.
+            auto* next = minimum(node->right);
+            removed_black = !next->is_red;
+            child = next->right;
+            if (next->parent == node) {
+                child_parent = next;
+            } else {
+                child_parent = next->parent;
+                replace_child(next->parent, next, next->right);
+                next->right = node->right;
+                next->right->parent = next;
+            }
+            replace_child(node->parent, node, next);
+            next->left = node->left;
+            next->left->parent = next;
+            next->is_red = node->is_red;
+        }
+
+        delete node;
+        --m_size;
+        update_path_to_root(child_parent);
+        if (removed_black)
+            remove_fixup(child, child_parent);
+    }
+
+    void remove_fixup(Node* node, Node* parent)
+    {
+        while (node != m_root && is_black(node)) {
+            if (node == parent->left) {
+                auto* sibling = parent->right;
+                if (sibling->is_red) {
+                    sibling->is_red = false;
+                    parent->is_red = true;
+                    rotate_left(parent);
+                    sibling = parent->right;
+                }
+                if (is_black(sibling->left) && is_black(sibling->right)) {
+                    sibling->is_red = true;
+                    node = parent;
+                    parent = node->parent;
+                    continue;
+                }
+                if (is_black(sibling->right)) {
+                    sibling->left->is_red = false;
+                    sibling->is_red = true;
+                    rotate_right(sibling);
+                    sibling = parent->right;
+                }
+                sibling->is_red = parent->is_red;
+                parent->is_red = false;
+                sibling->right->is_red = false;
+                rotate_left(parent);
+            } else {
+                auto* sibling = parent->left;
+                if (sibling->is_red) {
+                    sibling->is_red = false;
+                    parent->is_red = true;
+                    rotate_right(parent);
+                    sibling = parent->left;
+                }
+                if (is_black(sibling->left) && is_black(sibling->right)) {
+                    sibling->is_red = true;
+                    node = parent;
+                    parent = node->parent;
+                    continue;
+                }
+                if (is_black(sibling->left)) {
+                    sibling->right->is_red = false;
+                    sibling->is_red = true;
+                    rotate_left(sibling);
+                    sibling = parent->left;
+                }
+                sibling->is_red = parent->is_red;
+                parent->is_red = false;
+                sibling->left->is_red = false;
+                rotate_right(parent);
+            }
+            node = m_root;
+            break;
+        }
+        if (node)
+            node->is_red = false;
+    }
+
+    Node* m_root { nullptr };
+    size_t m_size { 0 };
+};
+
+}
+
+using AK::RedBlackTree;
+using AK::RedBlackTreeNoAugmentation;
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/RedBlackTree.h>
+#include <AK/Vector.h>
+
+TEST_CASE(construct)
+{
+    RedBlackTree<int, int> empty;
+    EXPECT(empty.is_empty());
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT(empty.begin() == empty.end());
+}
+
+TEST_CASE(insert_and_find)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 0; i < 1000; ++i)
+        tree.insert((i * 7919) % 1000, i);
+    EXPECT_EQ(tree.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        auto* value = tree.find((i * 7919) % 1000);
+        EXPECT(value != nullptr);
+        EXPECT_EQ(*value, i);
+    }
+    EXPECT(!tree.find(1000));
+    EXPECT(!tree.find(-1));
+}
+
+TEST_CASE(iterates_in_order)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 0; i < 500; ++i)
+        tree.insert((i * 31) % 500, 0);
+    int expected = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        EXPECT_EQ(it.key(), expected);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 500);
+}
+
+TEST_CASE(insert_and_remove)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 0; i < 1000; ++i)
+        tree.insert(i, i);
+    for (int i = 0; i < 1000; i += 2)
+        EXPECT(tree.remove(i));
+    EXPECT(!tree.remove(0));
+    EXPECT_EQ(tree.size(), 500u);
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(tree.contains(i), i % 2 == 1);
+
+    int previous = -1;
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        EXPECT(it.key() > previous);
+        previous = it.key();
+    }
+
+    for (int i = 1; i < 1000; i += 2)
+        EXPECT(tree.remove(i));
+    EXPECT(tree.is_empty());
+}
+
+TEST_CASE(nearest_key_lookups)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 10; i <= 100; i += 10)
+        tree.insert(i, i);
+
+    EXPECT(!tree.find_largest_not_above(9));
+    EXPECT_EQ(*tree.find_largest_not_above(10), 10);
+    EXPECT_EQ(*tree.find_largest_not_above(55), 50);
+    EXPECT_EQ(*tree.find_largest_not_above(1000), 100);
+
+    EXPECT_EQ(*tree.find_smallest_not_below(0), 10);
+    EXPECT_EQ(*tree.find_smallest_not_below(55), 60);
+    EXPECT_EQ(*tree.find_smallest_not_below(100), 100);
+    EXPECT(!tree.find_smallest_not_below(101));
+}
+
+TEST_CASE(copy_and_move)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 0; i < 100; ++i)
+        tree.insert(i, i * 2);
+
+    auto copy = tree;
+    EXPECT_EQ(copy.size(), 100u);
+    copy.remove(50);
+    EXPECT(tree.contains(50));
+    EXPECT(!copy.contains(50));
+
+    auto moved = move(copy);
+    EXPECT(copy.is_empty());
+    EXPECT_EQ(moved.size(), 99u);
+    EXPECT_EQ(*moved.find(99), 198);
+}
+
+struct SubtreeCount {
+    int value { 0 };
+    size_t count { 1 };
+};
+
+struct SubtreeCountAugmenter {
+    template<typename Node>
+    static void update(Node& node)
+    {
+        node.value.count = 1;
+        if (node.left)
+            node.value.count += node.left->value.count;
+        if (node.right)
+            node.value.count += node.right->value.count;
+    }
+};
+
+TEST_CASE(augmentation)
+{
+    RedBlackTree<int, SubtreeCount, SubtreeCountAugmenter> tree;
+    for (int i = 0; i < 300; ++i)
+        tree.insert((i * 101) % 300, { i, 1 });
+    EXPECT_EQ(tree.root()->value.count, 300u);
+
+    for (int i = 0; i < 300; i += 3)
+        tree.remove(i);
+    EXPECT_EQ(tree.root()->value.count, 200u);
+    EXPECT_EQ(tree.root()->value.count, tree.size());
+}
+
+TEST_MAIN(RedBlackTree)
@@ -96,11 +96,11 @@ void MonitorWidget::paint_event(GUI::PaintEvent& event)
         if (m_desktop_wallpaper_mode == "simple") {
             painter.blit({ 8, 9 }, *m_desktop_wallpaper_bitmap, { 88, 51, 200, 150 });
         } else if (m_desktop_wallpaper_mode == "center") {
-            painter.draw_scaled_bitmap({ 88, 51, 160, 90 }, *m_desktop_wallpaper_bitmap, m_desktop_wallpaper_bitmap->rect());
+            painter.draw_scaled_bitmap({ 88, 51, 160, 90 }, *m_desktop_wallpaper_bitmap, m_desktop_wallpaper_bitmap->rect(), Gfx::Painter::ScalingMode::Bilinear);
         } else if (m_desktop_wallpaper_mode == "tile") {
             painter.draw_tiled_bitmap(m_monitor_rect, *m_desktop_wallpaper_bitmap);
         } else if (m_desktop_wallpaper_mode == "scaled") {
-            painter.draw_scaled_bitmap(m_monitor_rect, *m_desktop_wallpaper_bitmap, m_desktop_wallpaper_bitmap->rect());
+            painter.draw_scaled_bitmap(m_monitor_rect, *m_desktop_wallpaper_bitmap, m_desktop_wallpaper_bitmap->rect(), Gfx::Painter::ScalingMode::Bilinear);
         } else {
             ASSERT_NOT_REACHED();
         }
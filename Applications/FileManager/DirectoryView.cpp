@@ -28,7 +28,9 @@
 #include <AK/FileSystemPath.h>
 #include <AK/StringBuilder.h>
 #include <LibGUI/SortingProxyModel.h>
+#include <spawn.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 // FIXME: Remove this hackery once printf() supports floats.
@@ -49,6 +51,15 @@ static String human_readable_size(size_t size)
     return number_string_with_one_decimal((float)size / (float)GB, "GB");
 }
 
+static void launch(const char* executable, const char* argument = nullptr)
+{
+    const char* argv[] = { executable, argument, nullptr };
+    pid_t pid;
+    int rc = posix_spawn(&pid, executable, nullptr, nullptr, const_cast<char* const*>(argv), environ);
+    if (rc != 0)
+        fprintf(stderr, "posix_spawn(%s): %s\n", executable, strerror(rc));
+}
+
 void DirectoryView::handle_activation(const GUI::ModelIndex& index)
 {
     if (!index.is_valid())
@@ -71,51 +82,26 @@ void DirectoryView::handle_activation(const GUI::ModelIndex& index)
     ASSERT(!S_ISLNK(st.st_mode));
 
     if (st.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) {
-        if (fork() == 0) {
-            int rc = execl(path.characters(), path.characters(), nullptr);
-            if (rc < 0)
-                perror("exec");
-            ASSERT_NOT_REACHED();
-        }
+        launch(path.characters());
         return;
     }
 
     if (path.to_lowercase().ends_with(".png")) {
-        if (fork() == 0) {
-            int rc = execl("/bin/qs", "/bin/qs", path.characters(), nullptr);
-            if (rc < 0)
-                perror("exec");
-            ASSERT_NOT_REACHED();
-        }
+        launch("/bin/qs", path.characters());
         return;
     }
 
     if (path.to_lowercase().ends_with(".html")) {
-        if (fork() == 0) {
-            int rc = execl("/bin/Browser", "/bin/Browser", path.characters(), nullptr);
-            if (rc < 0)
-                perror("exec");
-            ASSERT_NOT_REACHED();
-        }
+        launch("/bin/Browser", path.characters());
         return;
     }
 
     if (path.to_lowercase().ends_with(".wav")) {
-        if (fork() == 0) {
-            int rc = execl("/bin/SoundPlayer", "/bin/SoundPlayer", path.characters(), nullptr);
-            if (rc < 0)
-                perror("exec");
-            ASSERT_NOT_REACHED();
-        }
+        launch("/bin/SoundPlayer", path.characters());
         return;
     }
 
-    if (fork() == 0) {
-        int rc = execl("/bin/TextEditor", "/bin/TextEditor", path.characters(), nullptr);
-        if (rc < 0)
-            perror("exec");
-        ASSERT_NOT_REACHED();
-    }
+    launch("/bin/TextEditor", path.characters());
 };
 
 DirectoryView::DirectoryView()
@@ -25,11 +25,14 @@
  */
 
 #include "QSWidget.h"
+#include <LibCore/Timer.h>
 #include <LibGUI/MessageBox.h>
 #include <LibGUI/Painter.h>
 #include <LibGUI/Window.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/DisplayList.h>
 #include <LibGfx/Palette.h>
+#include <LibGfx/TiledPainter.h>
 
 QSWidget::QSWidget()
 {
@@ -71,10 +74,12 @@ void QSWidget::paint_event(GUI::PaintEvent& event)
     GUI::Painter painter(*this);
     painter.add_clip_rect(event.rect());
 
-    painter.fill_rect_with_checkerboard(rect(), { 8, 8 }, palette().base().darkened(0.9), palette().base());
-
+    // Scaling a big image dominates the repaint, so spread it across all processors.
+    Gfx::DisplayList display_list;
+    display_list.fill_rect_with_checkerboard(rect(), { 8, 8 }, palette().base().darkened(0.9), palette().base());
     if (!m_bitmap.is_null())
-        painter.draw_scaled_bitmap(m_bitmap_rect, *m_bitmap, m_bitmap->rect());
+        display_list.draw_scaled_bitmap(m_bitmap_rect, *m_bitmap, m_bitmap->rect());
+    Gfx::TiledPainter(painter).paint(display_list);
 }
 
 void QSWidget::mousedown_event(GUI::MouseEvent& event)
@@ -133,18 +138,67 @@ void QSWidget::mousewheel_event(GUI::MouseEvent& event)
     }
 }
 
+void QSWidget::animate()
+{
+    m_current_frame_index = (m_current_frame_index + 1) % m_image_decoder->frame_count();
+    auto current_frame = m_image_decoder->frame(m_current_frame_index);
+    if (!current_frame.image)
+        return;
+    m_bitmap = current_frame.image;
+
+    if (current_frame.duration != m_animation_timer->interval())
+        m_animation_timer->restart(current_frame.duration);
+
+    if (m_current_frame_index == m_image_decoder->frame_count() - 1) {
+        ++m_loops_completed;
+        if (m_loops_completed == m_image_decoder->loop_count())
+            m_animation_timer->stop();
+    }
+
+    update();
+}
+
 void QSWidget::load_from_file(const String& path)
 {
-    auto bitmap = Gfx::Bitmap::load_from_file(path);
-    if (!bitmap) {
+    auto show_error = [&] {
         GUI::MessageBox::show(String::format("Failed to open %s", path.characters()), "Cannot open image", GUI::MessageBox::Type::Error, GUI::MessageBox::InputType::OK, window());
+    };
+
+    MappedFile mapped_file(path);
+    if (!mapped_file.is_valid()) {
+        show_error();
+        return;
+    }
+
+    auto image_decoder = Gfx::ImageDecoder::create((const u8*)mapped_file.data(), mapped_file.size());
+    auto first_frame = image_decoder->frame(0);
+    if (!first_frame.image) {
+        show_error();
         return;
     }
 
-    window()->resize(bitmap->size());
+    window()->resize(first_frame.image->size());
+
+    if (m_animation_timer)
+        m_animation_timer->stop();
+
+    // The decoder reads straight from the mapping, so it has to go before the file does.
+    m_image_decoder = move(image_decoder);
+    m_mapped_file = move(mapped_file);
 
     m_path = path;
-    m_bitmap = bitmap;
+    m_bitmap = first_frame.image;
+    m_current_frame_index = 0;
+    m_loops_completed = 0;
+
+    if (m_image_decoder->is_animated() && m_image_decoder->frame_count() > 1) {
+        if (!m_animation_timer) {
+            m_animation_timer = add<Core::Timer>();
+            m_animation_timer->on_timeout = [this] { animate(); };
+        }
+        m_animation_timer->start(first_frame.duration);
+    }
+
     m_scale = 100;
     m_pan_origin = { 0, 0 };
     if (on_scale_change)
@@ -26,8 +26,11 @@
 
 #pragma once
 
+#include <AK/MappedFile.h>
+#include <LibCore/Forward.h>
 #include <LibGUI/Frame.h>
 #include <LibGfx/FloatPoint.h>
+#include <LibGfx/ImageDecoder.h>
 
 class QSLabel;
 
@@ -55,10 +58,17 @@ private:
     virtual void drop_event(GUI::DropEvent&) override;
 
     void relayout();
+    void animate();
 
     String m_path;
+    MappedFile m_mapped_file;
+    RefPtr<Gfx::ImageDecoder> m_image_decoder;
     RefPtr<Gfx::Bitmap> m_bitmap;
 
+    RefPtr<Core::Timer> m_animation_timer;
+    size_t m_current_frame_index { 0 };
+    size_t m_loops_completed { 0 };
+
     Gfx::Rect m_bitmap_rect;
     int m_scale { 100 };
     Gfx::FloatPoint m_pan_origin;
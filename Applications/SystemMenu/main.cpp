@@ -37,7 +37,9 @@
 #include <LibGUI/MessageBox.h>
 #include <LibGUI/WindowServerConnection.h>
 #include <LibGfx/Bitmap.h>
+#include <spawn.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/utsname.h>
 #include <unistd.h>
 
@@ -67,6 +69,14 @@ RefPtr<GUI::Menu> g_themes_menu;
 
 static NonnullRefPtr<GUI::Menu> build_system_menu();
 
+static void spawn(const char* const argv[])
+{
+    pid_t pid;
+    int rc = posix_spawn(&pid, argv[0], nullptr, nullptr, const_cast<char* const*>(argv), environ);
+    if (rc != 0)
+        fprintf(stderr, "posix_spawn(%s): %s\n", argv[0], strerror(rc));
+}
+
 int main(int argc, char** argv)
 {
     GUI::Application app(argc, argv);
@@ -155,12 +165,9 @@ NonnullRefPtr<GUI::Menu> build_system_menu()
         auto parent_menu = g_app_category_menus.get(app.category).value_or(*system_menu);
         parent_menu->add_action(GUI::Action::create(app.name, icon.ptr(), [app_identifier](auto&) {
             dbg() << "Activated app with ID " << app_identifier;
-            if (fork() == 0) {
-                const auto& bin = g_apps[app_identifier].executable;
-                if (execl(bin.characters(), bin.characters(), nullptr) < 0)
-                    perror("execl");
-                ASSERT_NOT_REACHED();
-            }
+            const auto& bin = g_apps[app_identifier].executable;
+            const char* argv[] = { bin.characters(), nullptr };
+            spawn(argv);
         }));
         ++app_identifier;
     }
@@ -196,10 +203,8 @@ NonnullRefPtr<GUI::Menu> build_system_menu()
 
     system_menu->add_separator();
     system_menu->add_action(GUI::Action::create("About...", Gfx::Bitmap::load_from_file("/res/icons/16x16/ladybug.png"), [](auto&) {
-        if (fork() == 0) {
-            execl("/bin/About", "/bin/About", nullptr);
-            ASSERT_NOT_REACHED();
-        }
+        const char* argv[] = { "/bin/About", nullptr };
+        spawn(argv);
     }));
     system_menu->add_separator();
     system_menu->add_action(GUI::Action::create("Exit...", [](auto&) {
@@ -208,10 +213,7 @@ NonnullRefPtr<GUI::Menu> build_system_menu()
         if (command.size() == 0)
             return;
 
-        if (fork() == 0) {
-            execv(command[0], const_cast<char* const*>(command.data()));
-            ASSERT_NOT_REACHED();
-        }
+        spawn(command.data());
     }));
 
     return system_menu;
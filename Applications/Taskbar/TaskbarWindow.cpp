@@ -34,7 +34,10 @@
 #include <LibGUI/Desktop.h>
 #include <LibGUI/Frame.h>
 #include <LibGUI/Window.h>
+#include <spawn.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 //#define EVENT_DEBUG
 
@@ -103,18 +106,15 @@ void TaskbarWindow::create_quick_launch_bar()
         button.set_icon(Gfx::Bitmap::load_from_file(app_icon_path));
         button.set_tooltip(name);
         button.on_click = [app_executable] {
-            pid_t pid = fork();
-            if (pid < 0) {
-                perror("fork");
-            } else if (pid == 0) {
-                if (chdir(get_current_user_home_path().characters()) < 0) {
-                    perror("chdir");
-                    exit(1);
-                }
-                execl(app_executable.characters(), app_executable.characters(), nullptr);
-                perror("execl");
-                ASSERT_NOT_REACHED();
-            }
+            posix_spawn_file_actions_t file_actions;
+            posix_spawn_file_actions_init(&file_actions);
+            posix_spawn_file_actions_addchdir(&file_actions, get_current_user_home_path().characters());
+            const char* argv[] = { app_executable.characters(), nullptr };
+            pid_t pid;
+            int rc = posix_spawn(&pid, app_executable.characters(), &file_actions, nullptr, const_cast<char* const*>(argv), environ);
+            if (rc != 0)
+                fprintf(stderr, "posix_spawn(%s): %s\n", app_executable.characters(), strerror(rc));
+            posix_spawn_file_actions_destroy(&file_actions);
         };
 
         if (!first)
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "IPCBenchmarkClientEndpoint.h"
+#include "IPCBenchmarkServerEndpoint.h"
+#include <AK/HashMap.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/LocalServer.h>
+#include <LibIPC/ClientConnection.h>
+#include <LibIPC/ServerConnection.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+class BenchmarkServerConnection final : public IPC::ClientConnection<IPCBenchmarkServerEndpoint>
+    , public IPCBenchmarkServerEndpoint {
+    C_OBJECT(BenchmarkServerConnection)
+public:
+    virtual void die() override { s_connections.remove(client_id()); }
+
+private:
+    BenchmarkServerConnection(Core::LocalSocket& socket, int client_id)
+        : IPC::ClientConnection<IPCBenchmarkServerEndpoint>(*this, socket, client_id)
+    {
+        s_connections.set(client_id, *this);
+    }
+
+    virtual OwnPtr<Messages::IPCBenchmarkServer::GreetResponse> handle(const Messages::IPCBenchmarkServer::Greet&) override
+    {
+        return make<Messages::IPCBenchmarkServer::GreetResponse>(client_id());
+    }
+
+    virtual void handle(const Messages::IPCBenchmarkServer::Ping&) override
+    {
+        ++m_pings_received;
+    }
+
+    virtual OwnPtr<Messages::IPCBenchmarkServer::FlushResponse> handle(const Messages::IPCBenchmarkServer::Flush&) override
+    {
+        return make<Messages::IPCBenchmarkServer::FlushResponse>(m_pings_received);
+    }
+
+    virtual OwnPtr<Messages::IPCBenchmarkServer::EchoResponse> handle(const Messages::IPCBenchmarkServer::Echo& message) override
+    {
+        return make<Messages::IPCBenchmarkServer::EchoResponse>(message.payload());
+    }
+
+    static HashMap<int, RefPtr<BenchmarkServerConnection>> s_connections;
+    int m_pings_received { 0 };
+};
+
+HashMap<int, RefPtr<BenchmarkServerConnection>> BenchmarkServerConnection::s_connections;
+
+class BenchmarkClientConnection final : public IPC::ServerConnection<IPCBenchmarkClientEndpoint, IPCBenchmarkServerEndpoint>
+    , public IPCBenchmarkClientEndpoint {
+    C_OBJECT(BenchmarkClientConnection)
+public:
+    virtual void handshake() override
+    {
+        auto response = send_sync<Messages::IPCBenchmarkServer::Greet>();
+        set_my_client_id(response->client_id());
+    }
+
+private:
+    explicit BenchmarkClientConnection(const String& address)
+        : IPC::ServerConnection<IPCBenchmarkClientEndpoint, IPCBenchmarkServerEndpoint>(*this, address)
+    {
+    }
+
+    virtual void handle(const Messages::IPCBenchmarkClient::Dummy&) override { }
+};
+
+static int run_server(const String& address)
+{
+    Core::EventLoop loop;
+    auto server = Core::LocalServer::construct();
+    if (!server->listen(address)) {
+        fprintf(stderr, "IPCBenchmark: Couldn't listen on %s\n", address.characters());
+        return 1;
+    }
+    server->on_ready_to_accept = [&] {
+        auto client_socket = server->accept();
+        if (!client_socket)
+            return;
+        static int s_next_client_id = 0;
+        IPC::new_client_connection<BenchmarkServerConnection>(*client_socket, ++s_next_client_id);
+    };
+    return loop.exec();
+}
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: IPCBenchmark [-h] [-n messages] [-r round-trips] [-s payload-size]\n");
+    exit(rc);
+}
+
+int main(int argc, char** argv)
+{
+    int messages = 100000;
+    int round_trips = 10000;
+    int payload_size = 64;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:r:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            messages = atoi(optarg);
+            break;
+        case 'r':
+            round_trips = atoi(optarg);
+            break;
+        case 's':
+            payload_size = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (messages <= 0 || round_trips <= 0 || payload_size < 0)
+        exit_with_usage(1);
+
+    auto address = String::format("/tmp/ipc-benchmark-%d", getpid());
+    pid_t server_pid = fork();
+    if (server_pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (server_pid == 0)
+        return run_server(address);
+
+    Core::EventLoop loop;
+    auto payload = String::repeated('x', payload_size);
+
+    for (bool use_shared_rings : { false, true }) {
+        auto client = BenchmarkClientConnection::construct(address);
+        client->handshake();
+        const char* transport = "socket";
+        if (use_shared_rings) {
+            if (!client->enable_shared_rings()) {
+                fprintf(stderr, "IPCBenchmark: Server refused shared rings\n");
+                break;
+            }
+            transport = "shared rings";
+        }
+
+        // Async messages are what mouse events and invalidations look like, so measure raw throughput first.
+        Core::ElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < messages; ++i)
+            client->post_message(Messages::IPCBenchmarkServer::Ping(i));
+        auto flush_response = client->send_sync<Messages::IPCBenchmarkServer::Flush>();
+        auto elapsed_ms = max(timer.elapsed(), 1);
+        if (flush_response->pings_received() != messages)
+            fprintf(stderr, "IPCBenchmark: Server only got %d of %d messages\n", flush_response->pings_received(), messages);
+        printf("%s: %d async messages in %d ms (%llu messages/s)\n", transport, messages, elapsed_ms, (u64)messages * 1000 / elapsed_ms);
+
+        timer.start();
+        for (int i = 0; i < round_trips; ++i)
+            client->send_sync<Messages::IPCBenchmarkServer::Echo>(payload);
+        elapsed_ms = max(timer.elapsed(), 1);
+        printf("%s: %d round trips with %d byte payloads in %d ms (%llu ns/round trip)\n", transport, round_trips, payload_size, elapsed_ms, (u64)elapsed_ms * 1000000 / round_trips);
+    }
+
+    kill(server_pid, SIGTERM);
+    waitpid(server_pid, nullptr, 0);
+    unlink(address.characters());
+    return 0;
+}
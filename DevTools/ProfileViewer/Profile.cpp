@@ -26,6 +26,7 @@
 
 #include "Profile.h"
 #include "ProfileModel.h"
+#include <AK/HashMap.h>
 #include <AK/HashTable.h>
 #include <AK/MappedFile.h>
 #include <AK/QuickSort.h>
@@ -43,8 +44,10 @@ static void sort_profile_nodes(Vector<NonnullRefPtr<ProfileNode>>& nodes)
         child->sort_children();
 }
 
-Profile::Profile(Vector<Event> events)
+Profile::Profile(Vector<Event> events, Vector<Process> processes, u32 lost_sample_count)
     : m_events(move(events))
+    , m_processes(move(processes))
+    , m_lost_sample_count(lost_sample_count)
 {
     m_first_timestamp = m_events.first().timestamp;
     m_last_timestamp = m_events.last().timestamp;
@@ -67,6 +70,19 @@ GUI::Model& Profile::model()
     return *m_model;
 }
 
+bool Profile::is_event_filtered_out(const Event& event) const
+{
+    if (has_timestamp_filter_range()) {
+        if (event.timestamp < m_timestamp_filter_range_start || event.timestamp > m_timestamp_filter_range_end)
+            return true;
+    }
+    if (has_process_filter() && event.pid != m_process_filter)
+        return true;
+    if (has_thread_filter() && event.tid != m_thread_filter)
+        return true;
+    return false;
+}
+
 void Profile::rebuild_tree()
 {
     u32 filtered_event_count = 0;
@@ -87,11 +103,8 @@ void Profile::rebuild_tree()
     HashTable<FlatPtr> live_allocations;
 
     for (auto& event : m_events) {
-        if (has_timestamp_filter_range()) {
-            auto timestamp = event.timestamp;
-            if (timestamp < m_timestamp_filter_range_start || timestamp > m_timestamp_filter_range_end)
-                continue;
-        }
+        if (is_event_filtered_out(event))
+            continue;
 
         if (event.type == "malloc")
             live_allocations.set(event.ptr);
@@ -100,11 +113,8 @@ void Profile::rebuild_tree()
     }
 
     for (auto& event : m_events) {
-        if (has_timestamp_filter_range()) {
-            auto timestamp = event.timestamp;
-            if (timestamp < m_timestamp_filter_range_start || timestamp > m_timestamp_filter_range_end)
-                continue;
-        }
+        if (is_event_filtered_out(event))
+            continue;
 
         if (event.type == "malloc" && !live_allocations.contains(event.ptr))
             continue;
@@ -173,15 +183,59 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
     }
 
     auto& object = json.as_object();
-    auto executable_path = object.get("executable").to_string();
 
-    MappedFile elf_file(executable_path);
-    if (!elf_file.is_valid()) {
-        fprintf(stderr, "Unable to open executable '%s' for symbolication.\n", executable_path.characters());
-        return nullptr;
+    // Profiles may span several processes, and a process may exec() while being profiled,
+    // so we pick the executable to symbolicate against per sample.
+    struct ExecutableMapping {
+        pid_t pid { 0 };
+        u64 timestamp { 0 };
+        String path;
+    };
+    Vector<ExecutableMapping> mappings;
+    auto processes_value = object.get("processes");
+    if (processes_value.is_array()) {
+        processes_value.as_array().for_each([&](auto& value) {
+            auto& process = value.as_object();
+            mappings.append({ process.get("pid").to_i32(), process.get("timestamp").template to_number<u64>(), process.get("executable").to_string() });
+        });
     }
+    if (mappings.is_empty())
+        mappings.append({ object.get("pid").to_i32(), 0, object.get("executable").to_string() });
 
-    auto elf_loader = make<ELFLoader>(static_cast<const u8*>(elf_file.data()), elf_file.size());
+    struct LoadedExecutable {
+        MappedFile file;
+        OwnPtr<ELFLoader> loader;
+    };
+    HashMap<String, OwnPtr<LoadedExecutable>> loaded_executables;
+    auto loader_for_path = [&](const String& path) -> const ELFLoader* {
+        if (path.is_empty())
+            return nullptr;
+        auto it = loaded_executables.find(path);
+        if (it != loaded_executables.end())
+            return (*it).value ? (*it).value->loader.ptr() : nullptr;
+        auto executable = make<LoadedExecutable>();
+        executable->file = MappedFile(path);
+        if (!executable->file.is_valid()) {
+            fprintf(stderr, "Unable to open executable '%s' for symbolication.\n", path.characters());
+            loaded_executables.set(path, nullptr);
+            return nullptr;
+        }
+        executable->loader = make<ELFLoader>(static_cast<const u8*>(executable->file.data()), executable->file.size());
+        auto* loader = executable->loader.ptr();
+        loaded_executables.set(path, move(executable));
+        return loader;
+    };
+
+    auto executable_path_for = [&](pid_t pid, u64 timestamp) -> String {
+        const ExecutableMapping* best = nullptr;
+        for (auto& mapping : mappings) {
+            if (mapping.pid != pid)
+                continue;
+            if (!best || (mapping.timestamp <= timestamp && mapping.timestamp >= best->timestamp))
+                best = &mapping;
+        }
+        return best ? best->path : String();
+    };
 
     MappedFile kernel_elf_file("/boot/kernel");
     OwnPtr<ELFLoader> kernel_elf_loader;
@@ -197,6 +251,20 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
         return nullptr;
 
     Vector<Event> events;
+    Vector<Process> processes;
+
+    auto register_thread = [&](pid_t pid, int tid, const String& executable) {
+        for (auto& process : processes) {
+            if (process.pid != pid)
+                continue;
+            if (!process.tids.contains_slow(tid))
+                process.tids.append(tid);
+            return;
+        }
+        processes.append({ pid, executable, { tid } });
+    };
+
+    pid_t default_pid = object.get("pid").to_i32();
 
     for (auto& perf_event_value : perf_events.values()) {
         auto& perf_event = perf_event_value.as_object();
@@ -205,6 +273,8 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
 
         event.timestamp = perf_event.get("timestamp").to_number<u64>();
         event.type = perf_event.get("type").to_string();
+        event.pid = perf_event.has("pid") ? perf_event.get("pid").to_i32() : default_pid;
+        event.tid = perf_event.get("tid").to_i32();
 
         if (event.type == "malloc") {
             event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
@@ -213,6 +283,9 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
             event.ptr = perf_event.get("ptr").to_number<FlatPtr>();
         }
 
+        auto executable_path = executable_path_for(event.pid, event.timestamp);
+        auto* elf_loader = loader_for_path(executable_path);
+
         auto stack_array = perf_event.get("stack").as_array();
         for (ssize_t i = stack_array.values().size() - 1; i >= 1; --i) {
             auto& frame = stack_array.at(i);
@@ -226,8 +299,10 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
                 } else {
                     symbol = "??";
                 }
-            } else {
+            } else if (elf_loader) {
                 symbol = elf_loader->symbolicate(ptr, &offset);
+            } else {
+                symbol = "??";
             }
 
             if (symbol == "??")
@@ -242,10 +317,18 @@ OwnPtr<Profile> Profile::load_from_perfcore_file(const StringView& path)
         FlatPtr innermost_frame_address = event.frames.at(1).address;
         event.in_kernel = innermost_frame_address >= 0xc0000000;
 
+        register_thread(event.pid, event.tid, executable_path);
         events.append(move(event));
     }
 
-    return NonnullOwnPtr<Profile>(NonnullOwnPtr<Profile>::Adopt, *new Profile(move(events)));
+    if (events.is_empty())
+        return nullptr;
+
+    quick_sort(processes.begin(), processes.end(), [](auto& a, auto& b) { return a.pid < b.pid; });
+    for (auto& process : processes)
+        quick_sort(process.tids.begin(), process.tids.end(), [](auto& a, auto& b) { return a < b; });
+
+    return NonnullOwnPtr<Profile>(NonnullOwnPtr<Profile>::Adopt, *new Profile(move(events), move(processes), object.get("lost_samples").to_u32()));
 }
 
 void ProfileNode::sort_children()
@@ -287,3 +370,37 @@ void Profile::set_show_percentages(bool show_percentages)
         return;
     m_show_percentages = show_percentages;
 }
+
+void Profile::set_process_filter(pid_t pid)
+{
+    if (m_has_process_filter && m_process_filter == pid)
+        return;
+    m_has_process_filter = true;
+    m_process_filter = pid;
+    rebuild_tree();
+}
+
+void Profile::clear_process_filter()
+{
+    if (!m_has_process_filter)
+        return;
+    m_has_process_filter = false;
+    rebuild_tree();
+}
+
+void Profile::set_thread_filter(int tid)
+{
+    if (m_has_thread_filter && m_thread_filter == tid)
+        return;
+    m_has_thread_filter = true;
+    m_thread_filter = tid;
+    rebuild_tree();
+}
+
+void Profile::clear_thread_filter()
+{
+    if (!m_has_thread_filter)
+        return;
+    m_has_thread_filter = false;
+    rebuild_tree();
+}
@@ -119,6 +119,8 @@ public:
 
     struct Event {
         u64 timestamp { 0 };
+        pid_t pid { 0 };
+        int tid { 0 };
         String type;
         FlatPtr ptr { 0 };
         size_t size { 0 };
@@ -126,7 +128,16 @@ public:
         Vector<Frame> frames;
     };
 
+    struct Process {
+        pid_t pid { 0 };
+        String executable;
+        Vector<int> tids;
+    };
+
     u32 filtered_event_count() const { return m_filtered_event_count; }
+    u32 lost_sample_count() const { return m_lost_sample_count; }
+
+    const Vector<Process>& processes() const { return m_processes; }
 
     const Vector<Event>& events() const { return m_events; }
 
@@ -139,6 +150,14 @@ public:
     void clear_timestamp_filter_range();
     bool has_timestamp_filter_range() const { return m_has_timestamp_filter_range; }
 
+    void set_process_filter(pid_t);
+    void clear_process_filter();
+    bool has_process_filter() const { return m_has_process_filter; }
+
+    void set_thread_filter(int tid);
+    void clear_thread_filter();
+    bool has_thread_filter() const { return m_has_thread_filter; }
+
     bool is_inverted() const { return m_inverted; }
     void set_inverted(bool);
 
@@ -146,9 +165,10 @@ public:
     void set_show_percentages(bool);
 
 private:
-    explicit Profile(Vector<Event>);
+    Profile(Vector<Event>, Vector<Process>, u32 lost_sample_count);
 
     void rebuild_tree();
+    bool is_event_filtered_out(const Event&) const;
 
     RefPtr<ProfileModel> m_model;
     Vector<NonnullRefPtr<ProfileNode>> m_roots;
@@ -157,11 +177,19 @@ private:
     u64 m_last_timestamp { 0 };
 
     Vector<Event> m_events;
+    Vector<Process> m_processes;
+    u32 m_lost_sample_count { 0 };
 
     bool m_has_timestamp_filter_range { false };
     u64 m_timestamp_filter_range_start { 0 };
     u64 m_timestamp_filter_range_end { 0 };
 
+    bool m_has_process_filter { false };
+    pid_t m_process_filter { 0 };
+
+    bool m_has_thread_filter { false };
+    int m_thread_filter { 0 };
+
     u32 m_deepest_stack_depth { 0 };
     bool m_inverted { false };
     bool m_show_percentages { false };
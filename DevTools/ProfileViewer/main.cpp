@@ -26,7 +26,9 @@
 
 #include "Profile.h"
 #include "ProfileTimelineWidget.h"
+#include <AK/FileSystemPath.h>
 #include <LibGUI/Action.h>
+#include <LibGUI/ActionGroup.h>
 #include <LibGUI/Application.h>
 #include <LibGUI/BoxLayout.h>
 #include <LibGUI/Menu.h>
@@ -51,6 +53,9 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (profile->lost_sample_count())
+        fprintf(stderr, "Warning: the profile is missing %u samples that the kernel had to drop.\n", profile->lost_sample_count());
+
     GUI::Application app(argc, argv);
 
     auto window = GUI::Window::construct();
@@ -89,6 +94,50 @@ int main(int argc, char** argv)
     percent_action->set_checked(false);
     view_menu.add_action(percent_action);
 
+    auto& process_menu = menubar->add_menu("Process");
+    GUI::ActionGroup process_action_group;
+    process_action_group.set_exclusive(true);
+
+    auto make_process_action = [&](const String& title, Function<void()> callback, bool checked = false) {
+        auto action = GUI::Action::create(title, [callback = move(callback)](auto& action) {
+            action.set_checked(true);
+            callback();
+        });
+        action->set_checkable(true);
+        action->set_checked(checked);
+        process_action_group.add_action(*action);
+        process_menu.add_action(*action);
+    };
+
+    auto& thread_menu = menubar->add_menu("Thread");
+    GUI::ActionGroup thread_action_group;
+    thread_action_group.set_exclusive(true);
+
+    auto make_thread_action = [&](const String& title, Function<void()> callback, bool checked = false) {
+        auto action = GUI::Action::create(title, [callback = move(callback)](auto& action) {
+            action.set_checked(true);
+            callback();
+        });
+        action->set_checkable(true);
+        action->set_checked(checked);
+        thread_action_group.add_action(*action);
+        thread_menu.add_action(*action);
+    };
+
+    make_process_action("All processes", [&] { profile->clear_process_filter(); }, true);
+    make_thread_action("All threads", [&] { profile->clear_thread_filter(); }, true);
+    for (auto& process : profile->processes()) {
+        pid_t pid = process.pid;
+        make_process_action(String::format("%s (%d)", FileSystemPath(process.executable).basename().characters(), pid), [&, pid] {
+            profile->set_process_filter(pid);
+        });
+        for (int tid : process.tids) {
+            make_thread_action(String::format("%d (pid %d)", tid, pid), [&, tid] {
+                profile->set_thread_filter(tid);
+            });
+        }
+    }
+
     app.set_menubar(move(menubar));
 
     window->show();
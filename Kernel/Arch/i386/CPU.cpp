@@ -38,6 +38,8 @@
 #include <Kernel/Interrupts/UnhandledInterruptHandler.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/Tracing.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <LibBareMetal/IO.h>
 #include <LibC/mallocdefs.h>
@@ -46,33 +48,34 @@
 
 namespace Kernel {
 
-struct [[gnu::packed]] DescriptorTablePointer
-{
-    u16 limit;
-    void* address;
-};
-
 static DescriptorTablePointer s_idtr;
-static DescriptorTablePointer s_gdtr;
 static Descriptor s_idt[256];
-static Descriptor s_gdt[256];
 
 static GenericInterruptHandler* s_interrupt_handler[GENERIC_INTERRUPT_HANDLERS_COUNT];
 
-static Vector<u16>* s_gdt_freelist;
+static Processor s_processors[Processor::max_processor_count];
+static Atomic<u32> s_processor_count;
 
-static u16 s_gdt_length;
+// GDT selectors are shared by all processors, but every processor has its own GDT.
+// Descriptors for dynamically allocated selectors are written into the GDT of whichever
+// processor is about to use them.
+static constexpr u16 gdt_reserved_entry_count = 7;
+static u16 s_gdt_freelist[256];
+static size_t s_gdt_freelist_size;
+static SpinLock s_gdt_freelist_lock;
 
 u16 gdt_alloc_entry()
 {
-    ASSERT(s_gdt_freelist);
-    ASSERT(!s_gdt_freelist->is_empty());
-    return s_gdt_freelist->take_last();
+    ScopedSpinLock locker(s_gdt_freelist_lock);
+    ASSERT(s_gdt_freelist_size);
+    return s_gdt_freelist[--s_gdt_freelist_size];
 }
 
 void gdt_free_entry(u16 entry)
 {
-    s_gdt_freelist->append(entry);
+    ScopedSpinLock locker(s_gdt_freelist_lock);
+    ASSERT(s_gdt_freelist_size < 256);
+    s_gdt_freelist[s_gdt_freelist_size++] = entry;
 }
 
 extern "C" void handle_interrupt(RegisterState);
@@ -92,6 +95,8 @@ extern "C" void handle_interrupt(RegisterState);
         "    mov $0x10, %ax\n"                      \
         "    mov %ax, %ds\n"                        \
         "    mov %ax, %es\n"                        \
+        "    mov $0x30, %ax\n"                      \
+        "    mov %ax, %fs\n"                        \
         "    cld\n"                                 \
         "    call " #title "_handler\n"             \
         "    add $0x4, %esp \n"                     \
@@ -119,6 +124,8 @@ extern "C" void handle_interrupt(RegisterState);
         "    mov $0x10, %ax\n"                      \
         "    mov %ax, %ds\n"                        \
         "    mov %ax, %es\n"                        \
+        "    mov $0x30, %ax\n"                      \
+        "    mov %ax, %fs\n"                        \
         "    cld\n"                                 \
         "    call " #title "_handler\n"             \
         "    add $0x4, %esp\n"                      \
@@ -134,7 +141,7 @@ static void dump(const RegisterState& regs)
 {
     u16 ss;
     u32 esp;
-    if (!Process::current || Process::current->is_ring0()) {
+    if (!Process::current() || Process::current()->is_ring0()) {
         ss = regs.ss;
         esp = regs.esp;
     } else {
@@ -160,7 +167,7 @@ static void dump(const RegisterState& regs)
         : "=a"(cr4));
     klog() << "cr0=" << String::format("%08x", cr0) << " cr2=" << String::format("%08x", cr2) << " cr3=" << String::format("%08x", cr3) << " cr4=" << String::format("%08x", cr4);
 
-    if (Process::current && Process::current->validate_read((void*)regs.eip, 8)) {
+    if (Process::current() && Process::current()->validate_read((void*)regs.eip, 8)) {
         SmapDisabler disabler;
         u8* codeptr = (u8*)regs.eip;
         klog() << "code: " << String::format("%02x", codeptr[0]) << " " << String::format("%02x", codeptr[1]) << " " << String::format("%02x", codeptr[2]) << " " << String::format("%02x", codeptr[3]) << " " << String::format("%02x", codeptr[4]) << " " << String::format("%02x", codeptr[5]) << " " << String::format("%02x", codeptr[6]) << " " << String::format("%02x", codeptr[7]);
@@ -169,26 +176,26 @@ static void dump(const RegisterState& regs)
 
 void handle_crash(RegisterState& regs, const char* description, int signal)
 {
-    if (!Process::current) {
+    if (!Process::current()) {
         klog() << description << " with !current";
         hang();
     }
 
     // If a process crashed while inspecting another process,
     // make sure we switch back to the right page tables.
-    MM.enter_process_paging_scope(*Process::current);
+    MM.enter_process_paging_scope(*Process::current());
 
-    klog() << "CRASH: " << description << ". Ring " << (Process::current->is_ring0() ? 0 : 3) << ".";
+    klog() << "CRASH: " << description << ". Ring " << (Process::current()->is_ring0() ? 0 : 3) << ".";
     dump(regs);
 
-    if (Process::current->is_ring0()) {
+    if (Process::current()->is_ring0()) {
         klog() << "Oh shit, we've crashed in ring 0 :(";
         dump_backtrace();
         hang();
     }
 
     cli();
-    Process::current->crash(signal, regs.eip);
+    Process::current()->crash(signal, regs.eip);
 }
 
 EH_ENTRY_NO_CODE(6, illegal_instruction);
@@ -246,17 +253,21 @@ void page_fault_handler(RegisterState regs)
 #endif
 
     bool faulted_in_userspace = (regs.cs & 3) == 3;
-    if (faulted_in_userspace && !MM.validate_user_stack(*Process::current, VirtualAddress(regs.userspace_esp))) {
+    if (faulted_in_userspace && !MM.validate_user_stack(*Process::current(), VirtualAddress(regs.userspace_esp))) {
         dbg() << "Invalid stack pointer: " << VirtualAddress(regs.userspace_esp);
         handle_crash(regs, "Bad stack on page fault", SIGSTKFLT);
         ASSERT_NOT_REACHED();
     }
 
-    auto response = MM.handle_page_fault(PageFault(regs.exception_code, VirtualAddress(fault_address)));
+    PageFaultResponse response;
+    {
+        Tracing::ScopedTracepoint tracepoint(Tracing::Tracepoint::PageFault);
+        response = MM.handle_page_fault(PageFault(regs.exception_code, VirtualAddress(fault_address)));
+    }
 
     if (response == PageFaultResponse::ShouldCrash) {
-        if (Thread::current->has_signal_handler(SIGSEGV)) {
-            Thread::current->send_urgent_signal_to_self(SIGSEGV);
+        if (Thread::current()->has_signal_handler(SIGSEGV)) {
+            Thread::current()->send_urgent_signal_to_self(SIGSEGV);
             return;
         }
 
@@ -327,68 +338,116 @@ EH(12, "Stack exception")
 EH(15, "Unknown error")
 EH(16, "Coprocessor error")
 
-static void write_raw_gdt_entry(u16 selector, u32 low, u32 high)
+void write_gdt_entry(u16 selector, Descriptor& descriptor)
 {
-    u16 i = (selector & 0xfffc) >> 3;
-    s_gdt[i].low = low;
-    s_gdt[i].high = high;
+    auto& entry = get_gdt_entry(selector);
+    entry.low = descriptor.low;
+    entry.high = descriptor.high;
+}
 
-    if (i > s_gdt_length)
-        s_gdtr.limit = (s_gdt_length + 1) * 8 - 1;
+Descriptor& get_gdt_entry(u16 selector)
+{
+    return Processor::current().get_gdt_entry(selector);
 }
 
-void write_gdt_entry(u16 selector, Descriptor& descriptor)
+void flush_gdt()
 {
-    write_raw_gdt_entry(selector, descriptor.low, descriptor.high);
+    Processor::current().flush_gdt();
 }
 
-Descriptor& get_gdt_entry(u16 selector)
+void Processor::initialize(u32 cpu)
 {
-    u16 i = (selector & 0xfffc) >> 3;
-    return *(Descriptor*)(&s_gdt[i]);
+    ASSERT(cpu < max_processor_count);
+    auto& processor = s_processors[cpu];
+    processor.m_self = &processor;
+    processor.m_cpu = cpu;
+
+    if (cpu == 0) {
+        for (u16 i = 255; i >= gdt_reserved_entry_count; --i)
+            s_gdt_freelist[s_gdt_freelist_size++] = i * 8;
+    }
+
+    processor.gdt_init();
+    s_processor_count.fetch_add(1, AK::memory_order_acq_rel);
 }
 
-void flush_gdt()
+Processor& Processor::by_id(u32 cpu)
 {
-    s_gdtr.address = s_gdt;
-    s_gdtr.limit = (s_gdt_length * 8) - 1;
-    asm("lgdt %0" ::"m"(s_gdtr)
-        : "memory");
+    ASSERT(cpu < count());
+    return s_processors[cpu];
 }
 
-void gdt_init()
+u32 Processor::count()
 {
-    s_gdt_length = 5;
+    return s_processor_count.load(AK::memory_order_acquire);
+}
 
-    s_gdt_freelist = new Vector<u16>();
-    s_gdt_freelist->ensure_capacity(256);
-    for (size_t i = s_gdt_length; i < 256; ++i)
-        s_gdt_freelist->append(i * 8);
+void Processor::write_raw_gdt_entry(u16 selector, u32 low, u32 high)
+{
+    u16 i = (selector & 0xfffc) >> 3;
+    m_gdt[i].low = low;
+    m_gdt[i].high = high;
+}
 
-    s_gdt_length = 256;
-    s_gdtr.address = s_gdt;
-    s_gdtr.limit = (s_gdt_length * 8) - 1;
+Descriptor& Processor::get_gdt_entry(u16 selector)
+{
+    u16 i = (selector & 0xfffc) >> 3;
+    return m_gdt[i];
+}
+
+void Processor::flush_gdt()
+{
+    m_gdtr.address = m_gdt;
+    m_gdtr.limit = sizeof(m_gdt) - 1;
+    asm("lgdt %0" ::"m"(m_gdtr)
+        : "memory");
+}
 
+void Processor::gdt_init()
+{
     write_raw_gdt_entry(0x0000, 0x00000000, 0x00000000);
-    write_raw_gdt_entry(0x0008, 0x0000ffff, 0x00cf9a00);
-    write_raw_gdt_entry(0x0010, 0x0000ffff, 0x00cf9200);
-    write_raw_gdt_entry(0x0018, 0x0000ffff, 0x00cffa00);
-    write_raw_gdt_entry(0x0020, 0x0000ffff, 0x00cff200);
+    write_raw_gdt_entry(GDT_SELECTOR_CODE0, 0x0000ffff, 0x00cf9a00);
+    write_raw_gdt_entry(GDT_SELECTOR_DATA0, 0x0000ffff, 0x00cf9200);
+    write_raw_gdt_entry(GDT_SELECTOR_CODE3, 0x0000ffff, 0x00cffa00);
+    write_raw_gdt_entry(GDT_SELECTOR_DATA3, 0x0000ffff, 0x00cff200);
+
+    // The scheduler points this at the thread-specific data of whichever thread runs here.
+    auto& tls_descriptor = get_gdt_entry(GDT_SELECTOR_TLS);
+    tls_descriptor.dpl = 3;
+    tls_descriptor.segment_present = 1;
+    tls_descriptor.granularity = 0;
+    tls_descriptor.zero = 0;
+    tls_descriptor.operation_size = 1;
+    tls_descriptor.descriptor_type = 1;
+    tls_descriptor.type = 2;
+
+    auto& processor_descriptor = get_gdt_entry(GDT_SELECTOR_PROC);
+    processor_descriptor.set_base(this);
+    processor_descriptor.set_limit(sizeof(Processor));
+    processor_descriptor.dpl = 0;
+    processor_descriptor.segment_present = 1;
+    processor_descriptor.granularity = 0;
+    processor_descriptor.zero = 0;
+    processor_descriptor.operation_size = 1;
+    processor_descriptor.descriptor_type = 1;
+    processor_descriptor.type = 2;
 
     flush_gdt();
 
     asm volatile(
         "mov %%ax, %%ds\n"
         "mov %%ax, %%es\n"
-        "mov %%ax, %%fs\n"
         "mov %%ax, %%gs\n"
-        "mov %%ax, %%ss\n" ::"a"(0x10)
+        "mov %%ax, %%ss\n" ::"a"(GDT_SELECTOR_DATA0)
+        : "memory");
+    asm volatile(
+        "mov %%ax, %%fs\n" ::"a"(GDT_SELECTOR_PROC)
         : "memory");
 
     // Make sure CS points to the kernel code descriptor.
     asm volatile(
-        "ljmpl $0x8, $sanity\n"
-        "sanity:\n");
+        "ljmpl $0x8, $1f\n"
+        "1:\n");
 }
 
 static void unimp_trap()
@@ -644,18 +703,17 @@ void load_task_register(u16 selector)
     asm("ltr %0" ::"r"(selector));
 }
 
-u32 g_in_irq;
-
 void handle_interrupt(RegisterState regs)
 {
     clac();
-    ++g_in_irq;
+    auto& in_irq = Processor::current().in_irq();
+    ++in_irq;
     ASSERT(regs.isr_number >= IRQ_VECTOR_BASE && regs.isr_number <= (IRQ_VECTOR_BASE + GENERIC_INTERRUPT_HANDLERS_COUNT));
     u8 irq = (u8)(regs.isr_number - 0x50);
     ASSERT(s_interrupt_handler[irq]);
     s_interrupt_handler[irq]->handle_interrupt(regs);
     s_interrupt_handler[irq]->increment_invoking_counter();
-    --g_in_irq;
+    --in_irq;
     s_interrupt_handler[irq]->eoi();
 }
 
@@ -679,7 +737,9 @@ bool g_cpu_supports_smap;
 bool g_cpu_supports_smep;
 bool g_cpu_supports_sse;
 bool g_cpu_supports_tsc;
+bool g_cpu_supports_invariant_tsc;
 bool g_cpu_supports_umip;
+bool g_user_tsc_allowed;
 
 void cpu_detect()
 {
@@ -693,6 +753,12 @@ void cpu_detect()
     CPUID extended_processor_info(0x80000001);
     g_cpu_supports_nx = (extended_processor_info.edx() & (1 << 20));
 
+    CPUID max_extended_leaf(0x80000000);
+    if (max_extended_leaf.eax() >= 0x80000007) {
+        CPUID advanced_power_management(0x80000007);
+        g_cpu_supports_invariant_tsc = (advanced_power_management.edx() & (1 << 8));
+    }
+
     CPUID extended_features(0x7);
     g_cpu_supports_smap = (extended_features.ebx() & (1 << 20));
     g_cpu_supports_smep = (extended_features.ebx() & (1 << 7));
@@ -717,11 +783,19 @@ void clac()
 
 void cpu_setup()
 {
-    cpu_detect();
+    // Application processors go through the same setup, but the bootstrap processor has
+    // already detected and announced everything.
+    bool is_bootstrap_processor = Processor::current().is_bootstrap_processor();
+    if (is_bootstrap_processor)
+        cpu_detect();
+    auto log = [&](const char* message) {
+        if (is_bootstrap_processor)
+            klog() << message;
+    };
 
     if (g_cpu_supports_sse) {
         sse_init();
-        klog() << "x86: SSE support enabled";
+        log("x86: SSE support enabled");
     }
 
     asm volatile(
@@ -729,7 +803,7 @@ void cpu_setup()
         "orl $0x00010000, %%eax\n"
         "movl %%eax, %%cr0\n" ::
             : "%eax", "memory");
-    klog() << "x86: WP support enabled";
+    log("x86: WP support enabled");
 
     if (g_cpu_supports_pge) {
         // Turn on CR4.PGE so the CPU will respect the G bit in page tables.
@@ -737,9 +811,9 @@ void cpu_setup()
             "mov %cr4, %eax\n"
             "orl $0x80, %eax\n"
             "mov %eax, %cr4\n");
-        klog() << "x86: PGE support enabled";
+        log("x86: PGE support enabled");
     } else {
-        klog() << "x86: PGE support not detected";
+        log("x86: PGE support not detected");
     }
 
     if (g_cpu_supports_nx) {
@@ -749,9 +823,9 @@ void cpu_setup()
             "rdmsr\n"
             "orl $0x800, %eax\n"
             "wrmsr\n");
-        klog() << "x86: NX support enabled";
+        log("x86: NX support enabled");
     } else {
-        klog() << "x86: NX support not detected";
+        log("x86: NX support not detected");
     }
 
     if (g_cpu_supports_smep) {
@@ -760,21 +834,21 @@ void cpu_setup()
             "mov %cr4, %eax\n"
             "orl $0x100000, %eax\n"
             "mov %eax, %cr4\n");
-        klog() << "x86: SMEP support enabled";
+        log("x86: SMEP support enabled");
     } else {
-        klog() << "x86: SMEP support not detected";
+        log("x86: SMEP support not detected");
     }
 
     if (g_cpu_supports_smap) {
         // Turn on CR4.SMAP
-        klog() << "x86: Enabling SMAP";
+        log("x86: Enabling SMAP");
         asm volatile(
             "mov %cr4, %eax\n"
             "orl $0x200000, %eax\n"
             "mov %eax, %cr4\n");
-        klog() << "x86: SMAP support enabled";
+        log("x86: SMAP support enabled");
     } else {
-        klog() << "x86: SMAP support not detected";
+        log("x86: SMAP support not detected");
     }
 
     if (g_cpu_supports_umip) {
@@ -782,21 +856,21 @@ void cpu_setup()
             "mov %cr4, %eax\n"
             "orl $0x800, %eax\n"
             "mov %eax, %cr4\n");
-        klog() << "x86: UMIP support enabled";
+        log("x86: UMIP support enabled");
     }
 
-    if (g_cpu_supports_tsc) {
+    if (g_cpu_supports_tsc && !g_user_tsc_allowed) {
         asm volatile(
             "mov %cr4, %eax\n"
             "orl $0x4, %eax\n"
             "mov %eax, %cr4\n");
-        klog() << "x86: RDTSC support restricted";
+        log("x86: RDTSC support restricted");
     }
 
     if (g_cpu_supports_rdrand) {
-        klog() << "x86: Using RDRAND for good randomness";
+        log("x86: Using RDRAND for good randomness");
     } else {
-        klog() << "x86: No RDRAND support detected. Randomness will be shitty";
+        log("x86: No RDRAND support detected. Randomness will be shitty");
     }
 }
 
@@ -814,6 +888,18 @@ void write_cr3(u32 cr3)
                  : "memory");
 }
 
+void allow_user_tsc()
+{
+    ASSERT(g_cpu_supports_tsc);
+    g_user_tsc_allowed = true;
+    // Turn off CR4.TSD. Processors that come up after this won't turn it back on.
+    asm volatile(
+        "mov %cr4, %eax\n"
+        "andl $0xfffffffb, %eax\n"
+        "mov %eax, %cr4\n");
+    klog() << "x86: RDTSC support unrestricted";
+}
+
 }
 
 #ifdef DEBUG
@@ -825,8 +911,8 @@ void __assertion_failed(const char* msg, const char* file, unsigned line, const
 
     // Switch back to the current process's page tables if there are any.
     // Otherwise stack walking will be a disaster.
-    if (Process::current)
-        MM.enter_process_paging_scope(*Process::current);
+    if (Process::current())
+        MM.enter_process_paging_scope(*Process::current());
 
     Kernel::dump_backtrace();
     asm volatile("hlt");
@@ -35,11 +35,25 @@
 #define GENERIC_INTERRUPT_HANDLERS_COUNT 128
 #define PAGE_MASK ((FlatPtr)0xfffff000u)
 
+#define GDT_SELECTOR_CODE0 0x08
+#define GDT_SELECTOR_DATA0 0x10
+#define GDT_SELECTOR_CODE3 0x18
+#define GDT_SELECTOR_DATA3 0x20
+#define GDT_SELECTOR_TLS 0x28
+#define GDT_SELECTOR_PROC 0x30
+
 namespace Kernel {
 
 class MemoryManager;
 class PageDirectory;
 class PageTableEntry;
+class Thread;
+
+struct [[gnu::packed]] DescriptorTablePointer
+{
+    u16 limit;
+    void* address;
+};
 
 struct [[gnu::packed]] TSS32
 {
@@ -248,7 +262,6 @@ public:
 class GenericInterruptHandler;
 struct RegisterState;
 
-void gdt_init();
 void idt_init();
 void sse_init();
 void register_interrupt_handler(u8 number, void (*f)());
@@ -479,6 +492,7 @@ inline FlatPtr offset_in_page(const void* address)
 
 u32 read_cr3();
 void write_cr3(u32);
+void allow_user_tsc();
 
 class CPUID {
 public:
@@ -580,7 +594,9 @@ extern bool g_cpu_supports_smap;
 extern bool g_cpu_supports_smep;
 extern bool g_cpu_supports_sse;
 extern bool g_cpu_supports_tsc;
+extern bool g_cpu_supports_invariant_tsc;
 extern bool g_cpu_supports_umip;
+extern bool g_user_tsc_allowed;
 
 void stac();
 void clac();
@@ -603,6 +619,56 @@ private:
     u32 m_flags;
 };
 
-extern u32 g_in_irq;
+class Processor {
+    AK_MAKE_NONCOPYABLE(Processor);
+
+public:
+    static constexpr u32 max_processor_count = 8;
+
+    Processor() {}
+
+    // Sets up this processor's GDT and points %fs at it. Must run on the processor itself.
+    static void initialize(u32 cpu);
+
+    static Processor& current()
+    {
+        // The kernel keeps %fs pointing at the current processor's Processor.
+        return *(Processor*)read_fs_u32(0);
+    }
+
+    static Processor& by_id(u32 cpu);
+    static u32 count();
+
+    template<typename Callback>
+    static void for_each(Callback callback)
+    {
+        for (u32 cpu = 0; cpu < count(); ++cpu)
+            callback(by_id(cpu));
+    }
+
+    u32 id() const { return m_cpu; }
+    bool is_bootstrap_processor() const { return m_cpu == 0; }
+
+    Thread* current_thread() const { return m_current_thread; }
+    void set_current_thread(Thread* thread) { m_current_thread = thread; }
+
+    u32& in_irq() { return m_in_irq; }
+
+    Descriptor& get_gdt_entry(u16 selector);
+    void flush_gdt();
+
+private:
+    void gdt_init();
+    void write_raw_gdt_entry(u16 selector, u32 low, u32 high);
+
+    // Must be the first member, see current().
+    Processor* m_self { nullptr };
+    u32 m_cpu { 0 };
+    u32 m_in_irq { 0 };
+    Thread* m_current_thread { nullptr };
+
+    DescriptorTablePointer m_gdtr;
+    Descriptor m_gdt[256];
+};
 
 }
@@ -31,6 +31,7 @@
 #include <Kernel/Devices/PATAChannel.h>
 #include <Kernel/Devices/PATADiskDevice.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Tracing.h>
 
 namespace Kernel {
 
@@ -57,6 +58,7 @@ const char* PATADiskDevice::class_name() const
 
 bool PATADiskDevice::read_blocks(unsigned index, u16 count, u8* out)
 {
+    Tracing::ScopedTracepoint tracepoint(Tracing::Tracepoint::BlockRequest);
     if (!m_channel.m_bus_master_base.is_null() && m_channel.m_dma_enabled.resource())
         return read_sectors_with_dma(index, count, out);
     return read_sectors(index, count, out);
@@ -64,6 +66,7 @@ bool PATADiskDevice::read_blocks(unsigned index, u16 count, u8* out)
 
 bool PATADiskDevice::write_blocks(unsigned index, u16 count, const u8* data)
 {
+    Tracing::ScopedTracepoint tracepoint(Tracing::Tracepoint::BlockRequest);
     if (!m_channel.m_bus_master_base.is_null() && m_channel.m_dma_enabled.resource())
         return write_sectors_with_dma(index, count, data);
     for (unsigned i = 0; i < count; ++i) {
@@ -554,12 +554,15 @@ void Ext2FS::flush_writes()
     //        The problem is that they are quite heavy objects, and use a lot of heap memory
     //        for their (child name lookup) and (block list) caches.
     Vector<InodeIndex> unused_inodes;
-    for (auto& it : m_inode_cache) {
-        if (it.value->ref_count() != 1)
-            continue;
-        if (it.value->has_watchers())
-            continue;
-        unused_inodes.append(it.key);
+    {
+        ReadLocker cache_locker(m_inode_cache_lock);
+        for (auto& it : m_inode_cache) {
+            if (it.value->ref_count() != 1)
+                continue;
+            if (it.value->has_watchers())
+                continue;
+            unused_inodes.append(it.key);
+        }
     }
     for (auto index : unused_inodes)
         uncache_inode(index);
@@ -622,16 +625,30 @@ void Ext2FSInode::flush_metadata()
 
 RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 {
-    LOCKER(m_lock);
     ASSERT(inode.fsid() == fsid());
 
-    {
+    // Cache hits are by far the common case, so we don't serialize them behind the FS lock.
+    auto find_in_cache = [&](RefPtr<Inode>& cached_inode) {
+        ReadLocker cache_locker(m_inode_cache_lock);
         auto it = m_inode_cache.find(inode.index());
-        if (it != m_inode_cache.end())
-            return (*it).value;
-    }
+        if (it == m_inode_cache.end())
+            return false;
+        cached_inode = (*it).value;
+        return true;
+    };
+
+    RefPtr<Inode> cached_inode;
+    if (find_in_cache(cached_inode))
+        return cached_inode;
+
+    LOCKER(m_lock);
+
+    // Someone else may have brought the inode in while we were waiting for the FS lock.
+    if (find_in_cache(cached_inode))
+        return cached_inode;
 
     if (!get_inode_allocation_state(inode.index())) {
+        WriteLocker cache_locker(m_inode_cache_lock);
         m_inode_cache.set(inode.index(), nullptr);
         return nullptr;
     }
@@ -644,7 +661,10 @@ RefPtr<Inode> Ext2FS::get_inode(InodeIdentifier inode) const
 
     auto new_inode = adopt(*new Ext2FSInode(const_cast<Ext2FS&>(*this), inode.index()));
     memcpy(&new_inode->m_raw_inode, reinterpret_cast<ext2_inode*>(block + offset), sizeof(ext2_inode));
-    m_inode_cache.set(inode.index(), new_inode);
+    {
+        WriteLocker cache_locker(m_inode_cache_lock);
+        m_inode_cache.set(inode.index(), new_inode);
+    }
     return new_inode;
 }
 
@@ -1465,7 +1485,10 @@ KResultOr<NonnullRefPtr<Inode>> Ext2FS::create_inode(InodeIdentifier parent_id,
     ASSERT(success);
 
     // We might have cached the fact that this inode didn't exist. Wipe the slate.
-    m_inode_cache.remove(inode_id);
+    {
+        WriteLocker cache_locker(m_inode_cache_lock);
+        m_inode_cache.remove(inode_id);
+    }
 
     auto inode = get_inode({ fsid(), inode_id });
     // If we've already computed a block list, no sense in throwing it away.
@@ -1564,7 +1587,13 @@ KResult Ext2FSInode::decrement_link_count()
 void Ext2FS::uncache_inode(InodeIndex index)
 {
     LOCKER(m_lock);
-    m_inode_cache.remove(index);
+    RefPtr<Ext2FSInode> inode;
+    {
+        WriteLocker cache_locker(m_inode_cache_lock);
+        // Keep the inode alive until we've dropped the cache lock, since destroying it may need the FS.
+        inode = m_inode_cache.get(index).value_or(nullptr);
+        m_inode_cache.remove(index);
+    }
 }
 
 size_t Ext2FSInode::directory_entry_count() const
@@ -1635,6 +1664,7 @@ unsigned Ext2FS::free_inode_count() const
 KResult Ext2FS::prepare_to_unmount() const
 {
     LOCKER(m_lock);
+    WriteLocker cache_locker(m_inode_cache_lock);
 
     for (auto& it : m_inode_cache) {
         if (it.value->ref_count() > 1)
@@ -166,6 +166,8 @@ private:
     mutable ext2_super_block m_super_block;
     mutable Optional<KBuffer> m_cached_group_descriptor_table;
 
+    // Lookups only need m_inode_cache_lock for reading. Modifications need m_lock as well.
+    mutable RWLock m_inode_cache_lock { "Ext2FS inode cache" };
     mutable HashMap<InodeIndex, RefPtr<Ext2FSInode>> m_inode_cache;
 
     bool m_super_block_dirty { false };
@@ -48,7 +48,7 @@ ssize_t InodeFile::read(FileDescription& description, u8* buffer, ssize_t count)
 {
     ssize_t nread = m_inode->read_bytes(description.offset(), count, buffer, &description);
     if (nread > 0)
-        Thread::current->did_file_read(nread);
+        Thread::current()->did_file_read(nread);
     return nread;
 }
 
@@ -57,17 +57,19 @@ ssize_t InodeFile::write(FileDescription& description, const u8* data, ssize_t c
     ssize_t nwritten = m_inode->write_bytes(description.offset(), count, data, &description);
     if (nwritten > 0) {
         m_inode->set_mtime(kgettimeofday().tv_sec);
-        Thread::current->did_file_write(nwritten);
+        Thread::current()->did_file_write(nwritten);
     }
     return nwritten;
 }
 
 KResultOr<Region*> InodeFile::mmap(Process& process, FileDescription& description, VirtualAddress preferred_vaddr, size_t offset, size_t size, int prot, bool shared)
 {
-    ASSERT(offset == 0);
     // FIXME: If PROT_EXEC, check that the underlying file system isn't mounted noexec.
     RefPtr<InodeVMObject> vmobject;
-    if (shared)
+    // A private mapping that can't be written to (e.g the text of a shared library) is indistinguishable
+    // from a shared one, so let it use the inode's page cache instead of reading in its own copy.
+    // If it's later mprotect()'ed writable, it gets detached onto a PrivateInodeVMObject.
+    if (shared || !(prot & PROT_WRITE))
         vmobject = SharedInodeVMObject::create_with_inode(inode());
     else
         vmobject = PrivateInodeVMObject::create_with_inode(inode());
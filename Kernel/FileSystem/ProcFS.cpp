@@ -50,8 +50,10 @@
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/PCI/Access.h>
+#include <Kernel/ProcessSnapshot.h>
 #include <Kernel/Profiling.h>
 #include <Kernel/TTY/TTY.h>
+#include <Kernel/Tracing.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PurgeableVMObject.h>
 #include <LibBareMetal/Output/Console.h>
@@ -79,6 +81,7 @@ enum ProcFileType {
     FI_Root_mounts,
     FI_Root_df,
     FI_Root_all,
+    FI_Root_all_snapshot,
     FI_Root_memstat,
     FI_Root_cpuinfo,
     FI_Root_inodes,
@@ -90,6 +93,8 @@ enum ProcFileType {
     FI_Root_cmdline,
     FI_Root_modules,
     FI_Root_profile,
+    FI_Root_trace,
+    FI_Root_locks,
     FI_Root_self, // symlink
     FI_Root_sys,  // directory
     FI_Root_net,  // directory
@@ -295,7 +300,7 @@ Optional<KBuffer> procfs$pid_vm(InodeIdentifier identifier)
     KBufferBuilder builder;
     JsonArraySerializer array { builder };
     for (auto& region : process.regions()) {
-        if (!region.is_user_accessible() && !Process::current->is_superuser())
+        if (!region.is_user_accessible() && !Process::current()->is_superuser())
             continue;
         auto region_object = array.add_object();
         region_object.add("readable", region.is_readable());
@@ -428,20 +433,83 @@ Optional<KBuffer> procfs$modules(InodeIdentifier)
     return builder.build();
 }
 
+// The most a sample can take up in /proc/profile: the fixed fields with the longest numbers they can hold,
+// and a full stack of 10-digit addresses.
+static const size_t max_serialized_sample_size = 128 + Profiling::max_stack_frame_count * 11;
+
+// Samples are copied out of the profiling buffer with interrupts disabled, so hand out a bounded batch per read.
+// "pending_samples" tells the reader how many are left for the next one.
+static const size_t max_samples_per_profile_read = 1024;
+
 Optional<KBuffer> procfs$profile(InodeIdentifier)
 {
-    InterruptDisabler disabler;
-    KBufferBuilder builder;
+    auto samples_buffer = KBufferImpl::create_with_size(max_samples_per_profile_read * sizeof(Profiling::Sample), Region::Access::Read | Region::Access::Write, "Profile samples");
+    samples_buffer->region().commit();
+    auto* samples = (Profiling::Sample*)samples_buffer->data();
+
+    auto& current_process = *Process::current();
+    pid_t pid;
+    size_t lost_sample_count;
+    size_t lost_executable_mapping_count;
+    Vector<Profiling::ExecutableMapping> mappings;
+    size_t sample_count;
+    size_t pending_sample_count;
+    {
+        InterruptDisabler disabler;
+
+        // The samples of other users' processes are nobody else's business.
+        if (!current_process.is_superuser()) {
+            if (Profiling::pid() == Profiling::all_processes || Profiling::uid() != current_process.uid())
+                return {};
+        }
+
+        pid = Profiling::pid();
+        lost_sample_count = Profiling::lost_sample_count();
+        lost_executable_mapping_count = Profiling::lost_executable_mapping_count();
+        Profiling::for_each_executable_mapping([&](auto& mapping) {
+            mappings.append(mapping);
+        });
+        // Reading the profile drains the samples it returns, so a profiler can keep
+        // streaming samples out of here for as long as it likes.
+        sample_count = Profiling::take_samples(samples, max_samples_per_profile_read);
+        pending_sample_count = Profiling::sample_count();
+    }
+
+    // Make room for everything up front, so reading never cuts the JSON off.
+    size_t capacity = 256 + sample_count * max_serialized_sample_size;
+    for (auto& mapping : mappings) {
+        // Escaping a character takes up to six, and the profiled executable's path appears twice.
+        size_t path_size = mapping.path.length() * 6;
+        capacity += 96 + (mapping.pid == pid ? path_size * 2 : path_size);
+    }
+    KBufferBuilder builder(capacity);
 
     JsonObjectSerializer object(builder);
-    object.add("pid", Profiling::pid());
-    object.add("executable", Profiling::executable_path());
+    object.add("pid", pid);
+    object.add("lost_samples", lost_sample_count);
+    object.add("lost_processes", lost_executable_mapping_count);
+    object.add("pending_samples", pending_sample_count);
+
+    String executable;
+    auto processes_array = object.add_array("processes");
+    for (auto& mapping : mappings) {
+        if (mapping.pid == pid)
+            executable = mapping.path;
+        auto mapping_object = processes_array.add_object();
+        mapping_object.add("pid", mapping.pid);
+        mapping_object.add("timestamp", mapping.timestamp);
+        mapping_object.add("executable", mapping.path);
+    }
+    processes_array.finish();
+    object.add("executable", executable);
 
     auto array = object.add_array("events");
-    bool mask_kernel_addresses = !Process::current->is_superuser();
-    Profiling::for_each_sample([&](auto& sample) {
+    bool mask_kernel_addresses = !current_process.is_superuser();
+    for (size_t sample_index = 0; sample_index < sample_count; ++sample_index) {
+        auto& sample = samples[sample_index];
         auto object = array.add_object();
         object.add("type", "sample");
+        object.add("pid", sample.pid);
         object.add("tid", sample.tid);
         object.add("timestamp", sample.timestamp);
         auto frames_array = object.add_array("stack");
@@ -454,12 +522,75 @@ Optional<KBuffer> procfs$profile(InodeIdentifier)
             frames_array.add(address);
         }
         frames_array.finish();
-    });
+    }
     array.finish();
     object.finish();
     return builder.build();
 }
 
+Optional<KBuffer> procfs$trace(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    JsonObjectSerializer object(builder);
+
+    for (size_t i = 0; i < (size_t)Tracing::Tracepoint::__Count; ++i) {
+        Tracing::TracepointData data;
+        {
+            InterruptDisabler disabler;
+            data = Tracing::g_tracepoints[i];
+        }
+        auto tracepoint_object = object.add_object(Tracing::to_string((Tracing::Tracepoint)i));
+        tracepoint_object.add("enabled", data.enabled);
+        tracepoint_object.add("count", data.event_count);
+        tracepoint_object.add("total_cycles", data.total_cycles);
+        tracepoint_object.add("max_cycles", data.max_cycles);
+        auto histogram_array = tracepoint_object.add_array("histogram");
+        for (auto bucket : data.histogram)
+            histogram_array.add(bucket);
+        histogram_array.finish();
+        tracepoint_object.finish();
+    }
+
+    auto reasons_object = object.add_object("context_switch_reasons");
+    for (size_t i = 0; i < (size_t)Tracing::ContextSwitchReason::__Count; ++i) {
+        auto reason = (Tracing::ContextSwitchReason)i;
+        reasons_object.add(Tracing::to_string(reason), Tracing::context_switch_count(reason));
+    }
+    reasons_object.finish();
+
+    auto syscalls_object = object.add_object("syscalls");
+    for (u32 function = 0; function < Syscall::Function::__Count; ++function) {
+        auto count = Tracing::syscall_count(function);
+        if (!count)
+            continue;
+        auto syscall_object = syscalls_object.add_object(Syscall::to_string((Syscall::Function)function));
+        syscall_object.add("count", count);
+        syscall_object.add("total_cycles", Tracing::syscall_cycles(function));
+        syscall_object.finish();
+    }
+    syscalls_object.finish();
+
+    object.finish();
+    return builder.build();
+}
+
+Optional<KBuffer> procfs$locks(InodeIdentifier)
+{
+    KBufferBuilder builder;
+    JsonArraySerializer array { builder };
+    LockStatistics::for_each([&](auto& statistics) {
+        auto obj = array.add_object();
+        obj.add("name", statistics.name);
+        obj.add("acquisitions", statistics.acquisitions.load(AK::memory_order_relaxed));
+        obj.add("contentions", statistics.contentions);
+        obj.add("spin_acquisitions", statistics.spin_acquisitions);
+        obj.add("wait_cycles", statistics.wait_cycles);
+        obj.add("max_wait_cycles", statistics.max_wait_cycles);
+    });
+    array.finish();
+    return builder.build();
+}
+
 Optional<KBuffer> procfs$net_adapters(InodeIdentifier)
 {
     KBufferBuilder builder;
@@ -490,7 +621,7 @@ Optional<KBuffer> procfs$net_arp(InodeIdentifier)
 {
     KBufferBuilder builder;
     JsonArraySerializer array { builder };
-    LOCKER(arp_table().lock());
+    ReadLocker locker(arp_table().lock());
     for (auto& it : arp_table().resource()) {
         auto obj = array.add_object();
         obj.add("mac_address", it.value.to_string());
@@ -676,7 +807,7 @@ Optional<KBuffer> procfs$pid_root(InodeIdentifier identifier)
 Optional<KBuffer> procfs$self(InodeIdentifier)
 {
     char buffer[16];
-    sprintf(buffer, "%u", Process::current->pid());
+    sprintf(buffer, "%u", Process::current()->pid());
     return KBuffer::copy((const u8*)buffer, strlen(buffer));
 }
 
@@ -758,6 +889,7 @@ Optional<KBuffer> procfs$df(InodeIdentifier)
 Optional<KBuffer> procfs$cpuinfo(InodeIdentifier)
 {
     KBufferBuilder builder;
+    builder.appendf("processors: %u\n", Processor::count());
     {
         CPUID cpuid(0);
         builder.appendf("cpuid:     ");
@@ -922,6 +1054,143 @@ Optional<KBuffer> procfs$all(InodeIdentifier)
     return builder.build();
 }
 
+template<size_t N>
+static void copy_to_snapshot_string(char (&buffer)[N], const StringView& string)
+{
+    size_t length = min(string.length(), N - 1);
+    memcpy(buffer, string.characters_without_null_termination(), length);
+    buffer[length] = '\0';
+}
+
+static void build_thread_snapshot(const Thread& thread, ThreadSnapshot& snapshot)
+{
+    snapshot.tid = thread.tid();
+    snapshot.times_scheduled = thread.times_scheduled();
+    snapshot.ticks = thread.ticks();
+    snapshot.priority = thread.priority();
+    snapshot.effective_priority = thread.effective_priority();
+    snapshot.syscall_count = thread.syscall_count();
+    snapshot.inode_faults = thread.inode_faults();
+    snapshot.zero_faults = thread.zero_faults();
+    snapshot.cow_faults = thread.cow_faults();
+    snapshot.unix_socket_read_bytes = thread.unix_socket_read_bytes();
+    snapshot.unix_socket_write_bytes = thread.unix_socket_write_bytes();
+    snapshot.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes();
+    snapshot.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes();
+    snapshot.file_read_bytes = thread.file_read_bytes();
+    snapshot.file_write_bytes = thread.file_write_bytes();
+    copy_to_snapshot_string(snapshot.state, thread.state_string());
+    copy_to_snapshot_string(snapshot.name, thread.name());
+}
+
+static void build_process_snapshot(const Process& process, ProcessSnapshot& snapshot, Vector<ThreadSnapshot, 16>& threads)
+{
+    snapshot.pid = process.pid();
+    snapshot.pgid = process.tty() ? process.tty()->pgid() : 0;
+    snapshot.pgp = process.pgid();
+    snapshot.sid = process.sid();
+    snapshot.uid = process.uid();
+    snapshot.gid = process.gid();
+    snapshot.ppid = process.ppid();
+    snapshot.nfds = process.number_of_open_file_descriptors();
+    snapshot.amount_virtual = process.amount_virtual();
+    snapshot.amount_resident = process.amount_resident();
+    snapshot.amount_dirty_private = process.amount_dirty_private();
+    snapshot.amount_clean_inode = process.amount_clean_inode();
+    snapshot.amount_shared = process.amount_shared();
+    snapshot.amount_purgeable_volatile = process.amount_purgeable_volatile();
+    snapshot.amount_purgeable_nonvolatile = process.amount_purgeable_nonvolatile();
+    snapshot.icon_id = process.icon_id();
+
+    switch (process.veil_state()) {
+    case VeilState::None:
+        snapshot.veil = ProcessSnapshotVeilState::None;
+        break;
+    case VeilState::Dropped:
+        snapshot.veil = ProcessSnapshotVeilState::Dropped;
+        break;
+    case VeilState::Locked:
+        snapshot.veil = ProcessSnapshotVeilState::Locked;
+        break;
+    }
+
+    copy_to_snapshot_string(snapshot.name, process.name());
+    copy_to_snapshot_string(snapshot.tty, process.tty() ? process.tty()->tty_name() : "notty");
+
+    size_t pledge_length = 0;
+    auto append_promise = [&](const StringView& promise) {
+        if (pledge_length + promise.length() + 1 >= sizeof(snapshot.pledge))
+            return;
+        memcpy(snapshot.pledge + pledge_length, promise.characters_without_null_termination(), promise.length());
+        pledge_length += promise.length();
+        snapshot.pledge[pledge_length++] = ' ';
+    };
+#define __ENUMERATE_PLEDGE_PROMISE(promise)      \
+    if (process.has_promised(Pledge::promise)) { \
+        append_promise(#promise);                \
+    }
+    ENUMERATE_PLEDGE_PROMISES
+#undef __ENUMERATE_PLEDGE_PROMISE
+    snapshot.pledge[pledge_length] = '\0';
+
+    process.for_each_thread([&](const Thread& thread) {
+        ThreadSnapshot thread_snapshot {};
+        build_thread_snapshot(thread, thread_snapshot);
+        threads.append(thread_snapshot);
+        return IterationDecision::Continue;
+    });
+    snapshot.thread_count = threads.size();
+}
+
+Optional<KBuffer> procfs$all_snapshot(InodeIdentifier)
+{
+    // Unlike procfs$all, we only keep interrupts disabled while copying the counters
+    // of a single process, so a large process table doesn't stall the whole system.
+    auto pids = Process::all_pids();
+
+    KBufferBuilder builder;
+    ProcessSnapshotHeader header {};
+    header.version = PROCESS_SNAPSHOT_VERSION;
+    header.header_size = sizeof(ProcessSnapshotHeader);
+    header.process_size = sizeof(ProcessSnapshot);
+    header.thread_size = sizeof(ThreadSnapshot);
+
+    // We patch in the final process count once the walk is complete.
+    builder.append((const char*)&header, sizeof(header));
+
+    ProcessSnapshot snapshot;
+    Vector<ThreadSnapshot, 16> threads;
+    auto append_process = [&] {
+        builder.append((const char*)&snapshot, sizeof(snapshot));
+        builder.append((const char*)threads.data(), threads.size() * sizeof(ThreadSnapshot));
+        ++header.process_count;
+    };
+
+    {
+        snapshot = {};
+        InterruptDisabler disabler;
+        build_process_snapshot(*Scheduler::colonel(), snapshot, threads);
+    }
+    append_process();
+
+    for (auto pid : pids) {
+        snapshot = {};
+        threads.clear_with_capacity();
+        {
+            InterruptDisabler disabler;
+            auto* process = Process::from_pid(pid);
+            if (!process)
+                continue;
+            build_process_snapshot(*process, snapshot, threads);
+        }
+        append_process();
+    }
+
+    auto buffer = builder.build();
+    memcpy(buffer.data(), &header, sizeof(header));
+    return buffer;
+}
+
 Optional<KBuffer> procfs$inodes(InodeIdentifier)
 {
     extern InlineLinkedList<Inode>& all_inodes();
@@ -1622,6 +1891,7 @@ ProcFS::ProcFS()
     m_entries[FI_Root_mounts] = { "mounts", FI_Root_mounts, false, procfs$mounts };
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
+    m_entries[FI_Root_all_snapshot] = { "all_snapshot", FI_Root_all_snapshot, false, procfs$all_snapshot };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_inodes] = { "inodes", FI_Root_inodes, true, procfs$inodes };
@@ -1634,6 +1904,8 @@ ProcFS::ProcFS()
     m_entries[FI_Root_cmdline] = { "cmdline", FI_Root_cmdline, true, procfs$cmdline };
     m_entries[FI_Root_modules] = { "modules", FI_Root_modules, true, procfs$modules };
     m_entries[FI_Root_profile] = { "profile", FI_Root_profile, false, procfs$profile };
+    m_entries[FI_Root_trace] = { "trace", FI_Root_trace, false, procfs$trace };
+    m_entries[FI_Root_locks] = { "locks", FI_Root_locks, false, procfs$locks };
     m_entries[FI_Root_sys] = { "sys", FI_Root_sys, true };
     m_entries[FI_Root_net] = { "net", FI_Root_net, false };
 
@@ -29,14 +29,17 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <LibBareMetal/IO.h>
+#include <LibBareMetal/StdLib.h>
 
 #define IRQ_APIC_SPURIOUS 0x7f
 
 #define APIC_BASE_MSR 0x1b
 
+#define APIC_REG_ID 0x20
 #define APIC_REG_EOI 0xb0
 #define APIC_REG_LD 0xd0
 #define APIC_REG_DF 0xe0
@@ -95,7 +98,7 @@ public:
     u32 high() const { return 0; }
 };
 
-static volatile u8* g_apic_base = nullptr;
+static volatile u8* s_apic_registers;
 
 static PhysicalAddress get_base()
 {
@@ -113,18 +116,15 @@ static void set_base(const PhysicalAddress& base)
     msr.set(lo, hi);
 }
 
+// Every processor sees its own local APIC at the same address, so one mapping serves them all.
 static void write_register(u32 offset, u32 value)
 {
-    auto lapic_region = MM.allocate_kernel_region(PhysicalAddress(page_base_of((u32)g_apic_base)), PAGE_SIZE, "LAPIC Write Access", Region::Access::Read | Region::Access::Write, false, true);
-    auto* lapic = (volatile u32*)lapic_region->vaddr().offset(offset_in_page((u32)g_apic_base)).offset(offset).as_ptr();
-    *lapic = value;
+    *reinterpret_cast<volatile u32*>(s_apic_registers + offset) = value;
 }
 
 static u32 read_register(u32 offset)
 {
-    auto lapic_region = MM.allocate_kernel_region(PhysicalAddress(page_base_of((u32)g_apic_base)), PAGE_SIZE, "LAPIC Read Access", Region::Access::Read, false, true);
-    auto* lapic = (volatile u32*)lapic_region->vaddr().offset(offset_in_page((u32)g_apic_base)).offset(offset).as_ptr();
-    return *lapic;
+    return *reinterpret_cast<volatile u32*>(s_apic_registers + offset);
 }
 
 static void write_icr(const ICRReg& icr)
@@ -137,12 +137,91 @@ static void write_icr(const ICRReg& icr)
 #define APIC_LVT_TRIGGER_LEVEL (1 << 14)
 #define APIC_LVT(iv, dm) ((iv & 0xff) | ((dm & 0x7) << 8))
 
+// The application processor trampoline. It gets copied to ap_start_paddr, where the
+// processors start executing in real mode after the STARTUP IPI. It switches to protected
+// mode, turns on paging with the page tables prepared by boot_aps() and calls init_ap()
+// on a stack of its own.
 asm(
+    ".p2align 5 \n"
     ".globl apic_ap_start \n"
     ".type apic_ap_start, @function \n"
     "apic_ap_start: \n"
     ".set begin_apic_ap_start, . \n"
-    "    jmp apic_ap_start\n" // TODO: implement
+    ".code16 \n"
+    "    cli \n"
+    "    mov %cs, %ax \n"
+    "    mov %ax, %ds \n"
+    "    lgdtl (apic_ap_start_gdtr - begin_apic_ap_start) \n"
+    "    mov %cr0, %eax \n"
+    "    orl $0x1, %eax \n"
+    "    mov %eax, %cr0 \n"
+    "    ljmpl $0x8, $(0x8000 + apic_ap_start32 - begin_apic_ap_start) \n"
+    ".code32 \n"
+    "apic_ap_start32: \n"
+    "    mov $0x10, %ax \n"
+    "    mov %ax, %ds \n"
+    "    mov %ax, %es \n"
+    "    mov %ax, %fs \n"
+    "    mov %ax, %gs \n"
+    "    mov %ax, %ss \n"
+    "    movl $1, %eax \n"
+    "    lock xaddl %eax, (0x8000 + apic_ap_start_next_index - begin_apic_ap_start) \n"
+    "    cmpl (0x8000 + apic_ap_start_ap_count - begin_apic_ap_start), %eax \n"
+    "    jae 2f \n"
+    "    movl %eax, %esi \n"
+    /* enable PAE + PSE, just like boot.S does */
+    "    movl %cr4, %eax \n"
+    "    orl $0x60, %eax \n"
+    "    movl %eax, %cr4 \n"
+    /* the kernel's page tables use the NX bit, which is reserved unless EFER.NXE is set */
+    "    cmpl $0, (0x8000 + apic_ap_start_nx - begin_apic_ap_start) \n"
+    "    je 1f \n"
+    "    movl $0xc0000080, %ecx \n"
+    "    rdmsr \n"
+    "    orl $0x800, %eax \n"
+    "    wrmsr \n"
+    "1: \n"
+    "    movl $(0x8000 + apic_ap_start_pdpt - begin_apic_ap_start), %eax \n"
+    "    movl %eax, %cr3 \n"
+    "    movl %cr0, %eax \n"
+    "    orl $0x80000000, %eax \n"
+    "    movl %eax, %cr0 \n"
+    "    movl (0x8000 + apic_ap_start_stack_tops - begin_apic_ap_start), %ebx \n"
+    "    movl (%ebx, %esi, 4), %esp \n"
+    "    pushl (0x8000 + apic_ap_start_kernel_cr3 - begin_apic_ap_start) \n"
+    "    leal 1(%esi), %eax \n"
+    "    pushl %eax \n"
+    "    movl (0x8000 + apic_ap_start_entry - begin_apic_ap_start), %eax \n"
+    "    call *%eax \n"
+    "2: \n"
+    "    cli \n"
+    "    hlt \n"
+    "    jmp 2b \n"
+    ".p2align 3 \n"
+    "apic_ap_start_gdt: \n"
+    "    .quad 0x0000000000000000 \n"
+    "    .quad 0x00cf9a000000ffff \n"
+    "    .quad 0x00cf92000000ffff \n"
+    "apic_ap_start_gdtr: \n"
+    "    .word 23 \n"
+    "    .long 0x8000 + apic_ap_start_gdt - begin_apic_ap_start \n"
+    ".p2align 5 \n"
+    ".globl apic_ap_start_data \n"
+    "apic_ap_start_data: \n"
+    "apic_ap_start_pdpt: \n"
+    "    .skip 32 \n"
+    "apic_ap_start_next_index: \n"
+    "    .long 0 \n"
+    "apic_ap_start_ap_count: \n"
+    "    .long 0 \n"
+    "apic_ap_start_nx: \n"
+    "    .long 0 \n"
+    "apic_ap_start_stack_tops: \n"
+    "    .long 0 \n"
+    "apic_ap_start_entry: \n"
+    "    .long 0 \n"
+    "apic_ap_start_kernel_cr3: \n"
+    "    .long 0 \n"
     ".set end_apic_ap_start, . \n"
     "\n"
     ".globl apic_ap_start_size \n"
@@ -150,7 +229,33 @@ asm(
     ".word end_apic_ap_start - begin_apic_ap_start \n");
 
 extern "C" void apic_ap_start(void);
+extern "C" u8 apic_ap_start_data[];
 extern "C" u16 apic_ap_start_size;
+extern "C" [[noreturn]] void init_ap(u32 cpu, u32 kernel_cr3);
+
+// Must match the data block at the end of apic_ap_start.
+struct [[gnu::packed]] APStartData
+{
+    u64 pdpt[4];
+    u32 next_index;
+    u32 ap_count;
+    u32 nx;
+    u32 stack_tops;
+    u32 entry;
+    u32 kernel_cr3;
+};
+
+// The STARTUP IPI vector is the page number of the trampoline.
+static constexpr FlatPtr ap_start_paddr = 0x8000;
+static constexpr FlatPtr ap_page_directory_paddr = 0x9000;
+static constexpr size_t ap_stack_size = 16 * KB;
+
+static void delay_microseconds(u32 microseconds)
+{
+    // IO::delay() takes roughly 3 microseconds.
+    for (u32 i = 0; i < microseconds / 3 + 1; ++i)
+        IO::delay();
+}
 
 void eoi()
 {
@@ -177,20 +282,29 @@ bool init()
     klog() << "Initializing APIC, base: " << apic_base;
     set_base(apic_base);
 
-    g_apic_base = apic_base.as_ptr();
+    auto region = MM.allocate_kernel_region(apic_base.page_base(), PAGE_SIZE, "Local APIC", Region::Access::Read | Region::Access::Write, false, false);
+    s_apic_registers = region->vaddr().offset(apic_base.offset_in_page()).as_ptr();
+    // The mapping stays around for as long as the kernel runs.
+    (void)region.leak_ptr();
 
     return true;
 }
 
 void enable_bsp()
 {
-    // FIXME: Ensure this method can only be executed by the BSP.
+    ASSERT(Processor::current().is_bootstrap_processor());
+    klog() << "Enabling local APIC for cpu #0";
+    SpuriousInterruptHandler::initialize(IRQ_APIC_SPURIOUS);
     enable(0);
 }
 
+u32 current_id()
+{
+    return read_register(APIC_REG_ID) >> 24;
+}
+
 void enable(u32 cpu)
 {
-    klog() << "Enabling local APIC for cpu #" << cpu;
 
     // dummy read, apparently to avoid a bug in old CPUs.
     read_register(APIC_REG_SIV);
@@ -201,9 +315,7 @@ void enable(u32 cpu)
     write_register(APIC_REG_DF, 0xf0000000);
 
     // set destination id (note that this limits it to 8 cpus)
-    write_register(APIC_REG_LD, 0);
-
-    SpuriousInterruptHandler::initialize(IRQ_APIC_SPURIOUS);
+    write_register(APIC_REG_LD, (1 << cpu) << 24);
 
     write_register(APIC_REG_LVT_TIMER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
     write_register(APIC_REG_LVT_THERMAL, APIC_LVT(0, 0) | APIC_LVT_MASKED);
@@ -213,24 +325,70 @@ void enable(u32 cpu)
     write_register(APIC_REG_LVT_ERR, APIC_LVT(0, 0) | APIC_LVT_MASKED);
 
     write_register(APIC_REG_TPR, 0);
+}
 
-    if (cpu != 0) {
-        static volatile u32 foo = 0;
-
-        // INIT
-        write_icr(ICRReg(0, ICRReg::INIT, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::AllExcludingSelf));
+void boot_aps()
+{
+    ASSERT(Processor::current().is_bootstrap_processor());
+    if (!s_apic_registers)
+        return;
+
+    u32 processor_count = InterruptManagement::the().enabled_processor_count();
+    if (processor_count > Processor::max_processor_count) {
+        klog() << "APIC: Only using " << Processor::max_processor_count << " of " << processor_count << " processors";
+        processor_count = Processor::max_processor_count;
+    }
+    if (processor_count <= 1)
+        return;
+    u32 ap_count = processor_count - 1;
+
+    // Each application processor needs a stack of its own to get into the kernel.
+    auto* stack_tops = new u32[ap_count];
+    for (u32 i = 0; i < ap_count; ++i) {
+        auto stack_region = MM.allocate_kernel_region(ap_stack_size, String::format("AP %u Stack", i + 1), Region::Access::Read | Region::Access::Write, false, true);
+        stack_tops[i] = stack_region->vaddr().offset(ap_stack_size).get() & 0xfffffff0;
+        (void)stack_region.leak_ptr();
+    }
 
-        for (foo = 0; foo < 0x800000; foo++)
-            ; // TODO: 10 millisecond delay
+    auto* trampoline = (u8*)low_physical_to_virtual(ap_start_paddr);
+    memcpy(trampoline, (const void*)apic_ap_start, apic_ap_start_size);
+
+    // While the trampoline turns on paging it needs the low 2 MB identity mapped and executable,
+    // which the kernel page directory doesn't provide. The kernel half is shared as-is.
+    auto* page_directory = (u64*)low_physical_to_virtual(ap_page_directory_paddr);
+    memset(page_directory, 0, PAGE_SIZE);
+    page_directory[0] = 0x83; // Present, writable, 2 MB page.
+
+    // We're still running on the kernel page directory, since nothing has been scheduled yet.
+    u32 kernel_cr3 = read_cr3();
+    auto* kernel_pdpt = (const u64*)low_physical_to_virtual(kernel_cr3);
+    auto& data = *(APStartData*)(trampoline + (apic_ap_start_data - (const u8*)apic_ap_start));
+    data.pdpt[0] = ap_page_directory_paddr | 1;
+    data.pdpt[1] = kernel_pdpt[1];
+    data.pdpt[2] = kernel_pdpt[2];
+    data.pdpt[3] = kernel_pdpt[3];
+    data.next_index = 0;
+    data.ap_count = ap_count;
+    data.nx = g_cpu_supports_nx;
+    data.stack_tops = (FlatPtr)stack_tops;
+    data.entry = (FlatPtr)init_ap;
+    data.kernel_cr3 = kernel_cr3;
+
+    klog() << "APIC: Starting " << ap_count << " application processor(s)";
+
+    write_icr(ICRReg(0, ICRReg::INIT, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::AllExcludingSelf));
+    delay_microseconds(10000);
+
+    for (int i = 0; i < 2; i++) {
+        write_icr(ICRReg(ap_start_paddr >> 12, ICRReg::StartUp, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::AllExcludingSelf));
+        delay_microseconds(200);
+    }
 
-        for (int i = 0; i < 2; i++) {
-            // SIPI
-            write_icr(ICRReg(0x08, ICRReg::StartUp, ICRReg::Physical, ICRReg::Assert, ICRReg::TriggerMode::Edge, ICRReg::AllExcludingSelf)); // start execution at P8000
+    // Give everyone up to a second to check in.
+    for (u32 i = 0; i < 1000 && Processor::count() < processor_count; ++i)
+        delay_microseconds(1000);
 
-            for (foo = 0; foo < 0x80000; foo++)
-                ; // TODO: 200 microsecond delay
-        }
-    }
+    klog() << "APIC: " << Processor::count() << " of " << processor_count << " processor(s) online";
 }
 
 }
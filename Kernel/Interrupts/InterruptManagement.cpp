@@ -203,8 +203,15 @@ void InterruptManagement::locate_apic_data()
     size_t entry_index = 0;
     size_t entries_length = madt.h.length - sizeof(ACPI::Structures::MADT);
     auto* madt_entry = madt.entries;
+    u32 enabled_processor_count = 0;
     while (entries_length > 0) {
         size_t entry_length = madt_entry->length;
+        if (madt_entry->type == (u8)ACPI::Structures::MADTEntryType::LocalAPIC) {
+            auto* local_apic_entry = (const ACPI::Structures::MADTEntries::ProcessorLocalAPIC*)madt_entry;
+            // Bit 0 of the flags means the processor is enabled.
+            if (local_apic_entry->flags & 0x1)
+                enabled_processor_count++;
+        }
         if (madt_entry->type == (u8)ACPI::Structures::MADTEntryType::IOAPIC) {
             auto* ioapic_entry = (const ACPI::Structures::MADTEntries::IOAPIC*)madt_entry;
             dbg() << "IOAPIC found @ MADT entry " << entry_index << ", MMIO Registers @ Px" << String::format("%x", ioapic_entry->ioapic_address);
@@ -225,6 +232,9 @@ void InterruptManagement::locate_apic_data()
         entries_length -= entry_length;
         entry_index++;
     }
+    if (enabled_processor_count)
+        m_enabled_processor_count = enabled_processor_count;
+    dbg() << "Interrupts: " << m_enabled_processor_count << " enabled processor(s) in the MADT";
 }
 void InterruptManagement::locate_pci_interrupt_overrides()
 {
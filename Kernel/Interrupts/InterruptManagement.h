@@ -54,6 +54,7 @@ public:
     virtual void switch_to_ioapic_mode();
 
     bool smp_enabled() const { return m_smp_enabled; }
+    u32 enabled_processor_count() const { return m_enabled_processor_count; }
     RefPtr<IRQController> get_responsible_irq_controller(u8 interrupt_vector);
 
     Vector<RefPtr<ISAInterruptOverrideMetadata>> isa_overrides();
@@ -70,6 +71,7 @@ private:
     void locate_apic_data();
     void locate_pci_interrupt_overrides();
     bool m_smp_enabled { false };
+    u32 m_enabled_processor_count { 1 };
     FixedArray<RefPtr<IRQController>> m_interrupt_controllers { 1 };
     Vector<RefPtr<ISAInterruptOverrideMetadata>> m_isa_interrupt_overrides;
     Vector<RefPtr<PCIInterruptOverrideMetadata>> m_pci_interrupt_overrides;
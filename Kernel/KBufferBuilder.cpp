@@ -44,8 +44,8 @@ KBuffer KBufferBuilder::build()
     return m_buffer;
 }
 
-KBufferBuilder::KBufferBuilder()
-    : m_buffer(KBuffer::create_with_size(4 * MB, Region::Access::Read | Region::Access::Write))
+KBufferBuilder::KBufferBuilder(size_t capacity)
+    : m_buffer(KBuffer::create_with_size(capacity, Region::Access::Read | Region::Access::Write))
 {
 }
 
@@ -65,7 +65,7 @@ void KBufferBuilder::append(const char* characters, int length)
         return;
     if (!can_append(length))
         return;
-    memcpy(insertion_ptr() + m_size, characters, length);
+    memcpy(insertion_ptr(), characters, length);
     m_size += length;
 }
 
@@ -36,7 +36,7 @@ class KBufferBuilder {
 public:
     using OutputType = KBuffer;
 
-    explicit KBufferBuilder();
+    explicit KBufferBuilder(size_t capacity = 4 * MB);
     ~KBufferBuilder() {}
 
     void append(const StringView&);
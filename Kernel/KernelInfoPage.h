@@ -34,7 +34,29 @@
 #    include <sys/time.h>
 #endif
 
+// The kernel bumps `serial` to an odd value before it touches the page and back to an even value afterwards.
+// Readers retry until they have seen the same even serial before and after copying the fields out.
 struct KernelInfoPage {
     volatile u32 serial;
     volatile struct timeval now;
+
+    // CLOCK_MONOTONIC as of the last update, and what to add to it to get CLOCK_REALTIME.
+    volatile u64 monotonic_nanoseconds;
+    volatile u32 epoch_offset_seconds;
+
+    // If userspace is allowed to read an invariant TSC, CLOCK_MONOTONIC can be extrapolated from it:
+    // monotonic_nanoseconds + tsc_delta_to_nanoseconds(rdtsc() - tsc_base, tsc_multiplier)
+    volatile u32 tsc_is_usable;
+    volatile u32 tsc_multiplier;
+    volatile u64 tsc_base;
 };
+
+#define KERNEL_INFO_PAGE_TSC_SHIFT 22
+
+inline u64 tsc_delta_to_nanoseconds(u64 tsc_delta, u32 multiplier)
+{
+    // Split the delta so that the 64-bit multiplications can't overflow.
+    u64 high = (tsc_delta >> 32) * multiplier;
+    u64 low = (tsc_delta & 0xffffffff) * multiplier;
+    return (high << (32 - KERNEL_INFO_PAGE_TSC_SHIFT)) + (low >> KERNEL_INFO_PAGE_TSC_SHIFT);
+}
@@ -26,10 +26,79 @@
 
 #include <Kernel/KSyms.h>
 #include <Kernel/Lock.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/Thread.h>
+#include <LibBareMetal/StdLib.h>
 
 namespace Kernel {
 
+static constexpr size_t max_lock_statistics = 128;
+static LockStatistics s_lock_statistics[max_lock_statistics];
+static size_t s_lock_statistics_count;
+static SpinLock s_lock_statistics_lock;
+
+// How many times we'll spin on a lock held by a running thread before going to sleep.
+static constexpr int max_spin_count = 128;
+
+LockStatistics& LockStatistics::for_name(const char* name)
+{
+    if (!name)
+        name = "(unnamed)";
+    ScopedSpinLock locker(s_lock_statistics_lock);
+    for (size_t i = 0; i < s_lock_statistics_count; ++i) {
+        if (!strcmp(s_lock_statistics[i].name, name))
+            return s_lock_statistics[i];
+    }
+    if (s_lock_statistics_count == max_lock_statistics - 1) {
+        auto& overflow = s_lock_statistics[max_lock_statistics - 1];
+        overflow.name = "(other)";
+        return overflow;
+    }
+    auto& statistics = s_lock_statistics[s_lock_statistics_count++];
+    statistics.name = name;
+    return statistics;
+}
+
+void LockStatistics::for_each(Function<void(const LockStatistics&)> callback)
+{
+    size_t count = s_lock_statistics_count;
+    if (s_lock_statistics[max_lock_statistics - 1].name)
+        count = max_lock_statistics;
+    for (size_t i = 0; i < count; ++i)
+        callback(s_lock_statistics[i]);
+}
+
+void LockStatistics::did_acquire_after_contention(u64 cycles, bool while_spinning)
+{
+    did_acquire();
+    ScopedSpinLock locker(s_lock_statistics_lock);
+    ++contentions;
+    if (while_spinning)
+        ++spin_acquisitions;
+    wait_cycles += cycles;
+    if (cycles > max_wait_cycles)
+        max_wait_cycles = cycles;
+}
+
+LockStatistics& Lock::statistics()
+{
+    if (!m_statistics)
+        m_statistics = &LockStatistics::for_name(m_name);
+    return *m_statistics;
+}
+
+static inline bool should_spin_on(const Thread* holder, int& spin_count)
+{
+    // If the holder is running right now, it's on another processor and will
+    // probably let go soon, so sleeping would only add latency.
+    if (!holder || holder->state() != Thread::Running || holder == Thread::current())
+        return false;
+    if (spin_count++ >= max_spin_count)
+        return false;
+    asm volatile("pause");
+    return true;
+}
+
 void Lock::lock()
 {
     ASSERT(!Scheduler::is_active());
@@ -38,16 +107,31 @@ void Lock::lock()
         dump_backtrace();
         hang();
     }
+    auto& statistics = this->statistics();
+    u64 wait_start = 0;
+    int spin_count = 0;
+    bool slept = false;
     for (;;) {
         bool expected = false;
         if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            if (!m_holder || m_holder == Thread::current) {
-                m_holder = Thread::current;
+            if (!m_holder || m_holder == Thread::current()) {
+                m_holder = Thread::current();
                 ++m_level;
                 m_lock.store(false, AK::memory_order_release);
+                if (wait_start)
+                    statistics.did_acquire_after_contention(read_tsc() - wait_start, !slept);
+                else
+                    statistics.did_acquire();
                 return;
             }
-            Thread::current->wait_on(m_queue, &m_lock, m_holder, m_name);
+            if (!wait_start)
+                wait_start = read_tsc();
+            if (should_spin_on(m_holder, spin_count)) {
+                m_lock.store(false, AK::memory_order_release);
+                continue;
+            }
+            slept = true;
+            Thread::current()->wait_on(m_queue, &m_lock, m_holder, m_name);
         }
     }
 }
@@ -57,7 +141,7 @@ void Lock::unlock()
     for (;;) {
         bool expected = false;
         if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            ASSERT(m_holder == Thread::current);
+            ASSERT(m_holder == Thread::current());
             ASSERT(m_level);
             --m_level;
             if (m_level) {
@@ -76,10 +160,10 @@ void Lock::unlock()
 bool Lock::force_unlock_if_locked()
 {
     InterruptDisabler disabler;
-    if (m_holder != Thread::current)
+    if (m_holder != Thread::current())
         return false;
     ASSERT(m_level == 1);
-    ASSERT(m_holder == Thread::current);
+    ASSERT(m_holder == Thread::current());
     m_holder = nullptr;
     --m_level;
     m_queue.wake_one();
@@ -92,4 +176,120 @@ void Lock::clear_waiters()
     m_queue.clear();
 }
 
+LockStatistics& RWLock::statistics()
+{
+    if (!m_statistics)
+        m_statistics = &LockStatistics::for_name(m_name);
+    return *m_statistics;
+}
+
+void RWLock::lock_read()
+{
+    ASSERT(!Scheduler::is_active());
+    ASSERT(are_interrupts_enabled());
+    auto& statistics = this->statistics();
+    u64 wait_start = 0;
+    int spin_count = 0;
+    bool slept = false;
+    for (;;) {
+        bool expected = false;
+        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
+            // Queue up behind waiting writers so that a steady stream of readers can't starve them.
+            // The writer itself may always read what it's holding.
+            if ((!m_writer && !m_waiting_writers) || m_writer == Thread::current()) {
+                ++m_readers;
+                m_lock.store(false, AK::memory_order_release);
+                if (wait_start)
+                    statistics.did_acquire_after_contention(read_tsc() - wait_start, !slept);
+                else
+                    statistics.did_acquire();
+                return;
+            }
+            if (!wait_start)
+                wait_start = read_tsc();
+            if (should_spin_on(m_writer, spin_count)) {
+                m_lock.store(false, AK::memory_order_release);
+                continue;
+            }
+            slept = true;
+            Thread::current()->wait_on(m_queue, &m_lock, m_writer, m_name);
+        }
+    }
+}
+
+void RWLock::unlock_read()
+{
+    for (;;) {
+        bool expected = false;
+        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
+            ASSERT(m_readers);
+            --m_readers;
+            if (m_readers) {
+                m_lock.store(false, AK::memory_order_release);
+                return;
+            }
+            m_queue.wake_all(&m_lock);
+            return;
+        }
+        Scheduler::yield();
+    }
+}
+
+void RWLock::lock_write()
+{
+    ASSERT(!Scheduler::is_active());
+    ASSERT(are_interrupts_enabled());
+    auto& statistics = this->statistics();
+    u64 wait_start = 0;
+    int spin_count = 0;
+    bool slept = false;
+    for (;;) {
+        bool expected = false;
+        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
+            if ((!m_writer && !m_readers) || m_writer == Thread::current()) {
+                if (wait_start)
+                    --m_waiting_writers;
+                m_writer = Thread::current();
+                ++m_write_level;
+                m_lock.store(false, AK::memory_order_release);
+                if (wait_start)
+                    statistics.did_acquire_after_contention(read_tsc() - wait_start, !slept);
+                else
+                    statistics.did_acquire();
+                return;
+            }
+            if (!wait_start) {
+                wait_start = read_tsc();
+                ++m_waiting_writers;
+            }
+            if (should_spin_on(m_writer, spin_count)) {
+                m_lock.store(false, AK::memory_order_release);
+                continue;
+            }
+            slept = true;
+            Thread::current()->wait_on(m_queue, &m_lock, m_writer, m_name);
+        }
+    }
+}
+
+void RWLock::unlock_write()
+{
+    for (;;) {
+        bool expected = false;
+        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
+            ASSERT(m_writer == Thread::current());
+            ASSERT(m_write_level);
+            --m_write_level;
+            if (m_write_level) {
+                m_lock.store(false, AK::memory_order_release);
+                return;
+            }
+            m_writer = nullptr;
+            m_queue.wake_all(&m_lock);
+            return;
+        }
+        Scheduler::yield();
+    }
+}
+
 }
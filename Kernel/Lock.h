@@ -28,6 +28,7 @@
 
 #include <AK/Assertions.h>
 #include <AK/Atomic.h>
+#include <AK/Function.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Forward.h>
@@ -35,6 +36,22 @@
 
 namespace Kernel {
 
+// Contention counters, shared by every lock with the same name. Exposed via /proc/locks.
+struct LockStatistics {
+    const char* name { nullptr };
+    Atomic<u32> acquisitions { 0 };
+    u32 contentions { 0 };
+    u32 spin_acquisitions { 0 };
+    u64 wait_cycles { 0 };
+    u64 max_wait_cycles { 0 };
+
+    static LockStatistics& for_name(const char*);
+    static void for_each(Function<void(const LockStatistics&)>);
+
+    void did_acquire() { acquisitions.fetch_add(1, AK::memory_order_relaxed); }
+    void did_acquire_after_contention(u64 wait_cycles, bool while_spinning);
+};
+
 class Lock {
 public:
     Lock(const char* name = nullptr)
@@ -52,10 +69,47 @@ public:
     const char* name() const { return m_name; }
 
 private:
+    LockStatistics& statistics();
+
     Atomic<bool> m_lock { false };
     u32 m_level { 0 };
     Thread* m_holder { nullptr };
     const char* m_name { nullptr };
+    LockStatistics* m_statistics { nullptr };
+    WaitQueue m_queue;
+};
+
+// A lock that can be held by any number of readers, or by a single writer.
+// Writers are recursive, readers are not: a thread that takes the read lock twice
+// may deadlock against a writer waiting in between.
+class RWLock {
+public:
+    RWLock(const char* name = nullptr)
+        : m_name(name)
+    {
+    }
+    ~RWLock() {}
+
+    void lock_read();
+    void unlock_read();
+    void lock_write();
+    void unlock_write();
+
+    bool is_write_locked() const { return m_writer; }
+    u32 reader_count() const { return m_readers; }
+
+    const char* name() const { return m_name; }
+
+private:
+    LockStatistics& statistics();
+
+    Atomic<bool> m_lock { false };
+    u32 m_readers { 0 };
+    u32 m_waiting_writers { 0 };
+    u32 m_write_level { 0 };
+    Thread* m_writer { nullptr };
+    const char* m_name { nullptr };
+    LockStatistics* m_statistics { nullptr };
     WaitQueue m_queue;
 };
 
@@ -76,6 +130,32 @@ private:
 
 #define LOCKER(lock) Locker locker(lock)
 
+class ReadLocker {
+public:
+    [[gnu::always_inline]] inline explicit ReadLocker(RWLock& l)
+        : m_lock(l)
+    {
+        m_lock.lock_read();
+    }
+    [[gnu::always_inline]] inline ~ReadLocker() { m_lock.unlock_read(); }
+
+private:
+    RWLock& m_lock;
+};
+
+class WriteLocker {
+public:
+    [[gnu::always_inline]] inline explicit WriteLocker(RWLock& l)
+        : m_lock(l)
+    {
+        m_lock.lock_write();
+    }
+    [[gnu::always_inline]] inline ~WriteLocker() { m_lock.unlock_write(); }
+
+private:
+    RWLock& m_lock;
+};
+
 template<typename T>
 class Lockable {
 public:
@@ -98,4 +178,19 @@ private:
     Lock m_lock;
 };
 
+template<typename T>
+class RWLockable {
+public:
+    RWLockable(const char* name = nullptr)
+        : m_lock(name)
+    {
+    }
+    RWLock& lock() { return m_lock; }
+    T& resource() { return m_resource; }
+
+private:
+    T m_resource;
+    RWLock m_lock;
+};
+
 }
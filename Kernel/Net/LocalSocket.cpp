@@ -63,8 +63,8 @@ LocalSocket::LocalSocket(int type)
     LOCKER(all_sockets().lock());
     all_sockets().resource().append(this);
 
-    m_prebind_uid = Process::current->uid();
-    m_prebind_gid = Process::current->gid();
+    m_prebind_uid = Process::current()->uid();
+    m_prebind_gid = Process::current()->gid();
     m_prebind_mode = 0666;
 
 #ifdef DEBUG_LOCAL_SOCKET
@@ -110,7 +110,7 @@ KResult LocalSocket::bind(const sockaddr* user_address, socklen_t address_size)
 
     mode_t mode = S_IFSOCK | (m_prebind_mode & 04777);
     UidAndGid owner { m_prebind_uid, m_prebind_gid };
-    auto result = VFS::the().open(path, O_CREAT | O_EXCL | O_NOFOLLOW_NOERROR, mode, Process::current->current_directory(), owner);
+    auto result = VFS::the().open(path, O_CREAT | O_EXCL | O_NOFOLLOW_NOERROR, mode, Process::current()->current_directory(), owner);
     if (result.is_error()) {
         if (result.error() == -EEXIST)
             return KResult(-EADDRINUSE);
@@ -148,7 +148,7 @@ KResult LocalSocket::connect(FileDescription& description, const sockaddr* addre
     dbg() << "LocalSocket{" << this << "} connect(" << safe_address << ")";
 #endif
 
-    auto description_or_error = VFS::the().open(safe_address, O_RDWR, 0, Process::current->current_directory());
+    auto description_or_error = VFS::the().open(safe_address, O_RDWR, 0, Process::current()->current_directory());
     if (description_or_error.is_error())
         return KResult(-ECONNREFUSED);
 
@@ -175,7 +175,7 @@ KResult LocalSocket::connect(FileDescription& description, const sockaddr* addre
         return KSuccess;
     }
 
-    if (Thread::current->block<Thread::ConnectBlocker>(description) != Thread::BlockResult::WokeNormally) {
+    if (Thread::current()->block<Thread::ConnectBlocker>(description) != Thread::BlockResult::WokeNormally) {
         m_connect_side_role = Role::None;
         return KResult(-EINTR);
     }
@@ -265,7 +265,7 @@ ssize_t LocalSocket::sendto(FileDescription& description, const void* data, size
         return -EPIPE;
     ssize_t nwritten = send_buffer_for(description).write((const u8*)data, data_size);
     if (nwritten > 0)
-        Thread::current->did_unix_socket_write(nwritten);
+        Thread::current()->did_unix_socket_write(nwritten);
     return nwritten;
 }
 
@@ -299,7 +299,7 @@ ssize_t LocalSocket::recvfrom(FileDescription& description, void* buffer, size_t
             return -EAGAIN;
         }
     } else if (!can_read(description)) {
-        auto result = Thread::current->block<Thread::ReadBlocker>(description);
+        auto result = Thread::current()->block<Thread::ReadBlocker>(description);
         if (result != Thread::BlockResult::WokeNormally)
             return -EINTR;
     }
@@ -308,7 +308,7 @@ ssize_t LocalSocket::recvfrom(FileDescription& description, void* buffer, size_t
     ASSERT(!buffer_for_me.is_empty());
     int nread = buffer_for_me.read((u8*)buffer, buffer_size);
     if (nread > 0)
-        Thread::current->did_unix_socket_read(nread);
+        Thread::current()->did_unix_socket_read(nread);
     return nread;
 }
 
@@ -389,7 +389,7 @@ KResult LocalSocket::chown(uid_t uid, gid_t gid)
     if (m_file)
         return m_file->chown(uid, gid);
 
-    if (!Process::current->is_superuser() && (Process::current->euid() != uid || !Process::current->in_group(gid)))
+    if (!Process::current()->is_superuser() && (Process::current()->euid() != uid || !Process::current()->in_group(gid)))
         return KResult(-EPERM);
 
     m_prebind_uid = uid;
@@ -104,7 +104,7 @@ void NetworkTask_main()
     for (;;) {
         size_t packet_size = dequeue_packet(buffer, buffer_size);
         if (!packet_size) {
-            Thread::current->wait_on(packet_wait_queue);
+            Thread::current()->wait_on(packet_wait_queue);
             continue;
         }
         if (packet_size < sizeof(EthernetFrameHeader)) {
@@ -177,7 +177,7 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
         // Someone has this IPv4 address. I guess we can try to remember that.
         // FIXME: Protect against ARP spamming.
         // FIXME: Support static ARP table entries.
-        LOCKER(arp_table().lock());
+        WriteLocker locker(arp_table().lock());
         arp_table().resource().set(packet.sender_protocol_address(), packet.sender_hardware_address());
 
         klog() << "ARP table (" << arp_table().resource().size() << " entries):";
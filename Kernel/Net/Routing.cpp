@@ -33,11 +33,11 @@
 
 namespace Kernel {
 
-Lockable<HashMap<IPv4Address, MACAddress>>& arp_table()
+RWLockable<HashMap<IPv4Address, MACAddress>>& arp_table()
 {
-    static Lockable<HashMap<IPv4Address, MACAddress>>* the;
+    static RWLockable<HashMap<IPv4Address, MACAddress>>* the;
     if (!the)
-        the = new Lockable<HashMap<IPv4Address, MACAddress>>;
+        the = new RWLockable<HashMap<IPv4Address, MACAddress>>("ARP table");
     return *the;
 }
 
@@ -113,7 +113,7 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
     }
 
     {
-        LOCKER(arp_table().lock());
+        ReadLocker locker(arp_table().lock());
         auto addr = arp_table().resource().get(next_hop_ip);
         if (addr.has_value()) {
 #ifdef ROUTING_DEBUG
@@ -135,12 +135,12 @@ RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, c
     request.set_sender_protocol_address(adapter->ipv4_address());
     adapter->send({ 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }, request);
 
-    (void)Thread::current->block_until("Routing (ARP)", [next_hop_ip] {
+    (void)Thread::current()->block_until("Routing (ARP)", [next_hop_ip] {
         return arp_table().resource().get(next_hop_ip).has_value();
     });
 
     {
-        LOCKER(arp_table().lock());
+        ReadLocker locker(arp_table().lock());
         auto addr = arp_table().resource().get(next_hop_ip);
         if (addr.has_value()) {
 #ifdef ROUTING_DEBUG
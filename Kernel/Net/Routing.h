@@ -39,6 +39,6 @@ struct RoutingDecision {
 
 RoutingDecision route_to(const IPv4Address& target, const IPv4Address& source, const RefPtr<NetworkAdapter> through = nullptr);
 
-Lockable<HashMap<IPv4Address, MACAddress>>& arp_table();
+RWLockable<HashMap<IPv4Address, MACAddress>>& arp_table();
 
 }
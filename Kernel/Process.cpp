@@ -67,6 +67,7 @@
 #include <Kernel/Thread.h>
 #include <Kernel/ThreadTracer.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/PurgeableVMObject.h>
@@ -93,8 +94,6 @@ namespace Kernel {
 static void create_signal_trampolines();
 static void create_kernel_info_page();
 
-Process* Process::current;
-
 static pid_t next_pid;
 InlineLinkedList<Process>* g_processes;
 static String* s_hostname;
@@ -125,9 +124,21 @@ void Process::initialize()
 
 void Process::update_info_page_timestamp(const timeval& tv)
 {
+    auto& time_management = TimeManagement::the();
+    auto& tsc_clock = time_management.tsc_clock();
     auto* info_page = (KernelInfoPage*)s_info_page_address_for_kernel.as_ptr();
     info_page->serial++;
     const_cast<timeval&>(info_page->now) = tv;
+    info_page->epoch_offset_seconds = time_management.epoch_time() - time_management.seconds_since_boot();
+    if (tsc_clock.is_usable) {
+        info_page->monotonic_nanoseconds = tsc_clock.nanoseconds_base;
+        info_page->tsc_base = tsc_clock.tsc_base;
+        info_page->tsc_multiplier = tsc_clock.multiplier;
+        info_page->tsc_is_usable = true;
+    } else {
+        info_page->monotonic_nanoseconds = time_management.monotonic_nanoseconds();
+    }
+    info_page->serial++;
 }
 
 Vector<pid_t> Process::all_pids()
@@ -243,6 +254,8 @@ bool Process::deallocate_region(Region& region)
     InterruptDisabler disabler;
     if (m_region_lookup_cache.region == &region)
         m_region_lookup_cache.region = nullptr;
+    if (!m_region_tree.remove(region.vaddr().get()))
+        return false;
     for (size_t i = 0; i < m_regions.size(); ++i) {
         if (&m_regions[i] == &region) {
             m_regions.unstable_remove(i);
@@ -257,24 +270,28 @@ Region* Process::region_from_range(const Range& range)
     if (m_region_lookup_cache.range == range && m_region_lookup_cache.region)
         return m_region_lookup_cache.region;
 
-    size_t size = PAGE_ROUND_UP(range.size());
-    for (auto& region : m_regions) {
-        if (region.vaddr() == range.base() && region.size() == size) {
-            m_region_lookup_cache.range = range;
-            m_region_lookup_cache.region = region.make_weak_ptr();
-            return &region;
-        }
-    }
-    return nullptr;
+    auto* region = m_region_tree.find(range.base().get());
+    if (!region || (*region)->size() != PAGE_ROUND_UP(range.size()))
+        return nullptr;
+    m_region_lookup_cache.range = range;
+    m_region_lookup_cache.region = (*region)->make_weak_ptr();
+    return *region;
 }
 
 Region* Process::region_containing(const Range& range)
 {
-    for (auto& region : m_regions) {
-        if (region.contains(range))
-            return &region;
-    }
-    return nullptr;
+    auto* region = m_region_tree.find_largest_not_above(range.base().get());
+    if (!region || !(*region)->contains(range))
+        return nullptr;
+    return *region;
+}
+
+Region* Process::region_containing(VirtualAddress vaddr)
+{
+    auto* region = m_region_tree.find_largest_not_above(vaddr.get());
+    if (!region || !(*region)->contains(vaddr))
+        return nullptr;
+    return *region;
 }
 
 int Process::sys$set_mmap_name(const Syscall::SC_set_mmap_name_params* user_params)
@@ -540,6 +557,8 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
             && !validate_inode_mmap_prot(*this, prot, static_cast<const InodeVMObject&>(whole_region->vmobject()).inode(), whole_region->is_shared())) {
             return -EACCES;
         }
+        if (prot & PROT_WRITE)
+            whole_region->detach_from_shared_inode_vmobject_if_needed();
         whole_region->set_readable(prot & PROT_READ);
         whole_region->set_writable(prot & PROT_WRITE);
         whole_region->set_executable(prot & PROT_EXEC);
@@ -566,6 +585,8 @@ int Process::sys$mprotect(void* addr, size_t size, int prot)
 
         size_t new_range_offset_in_vmobject = old_region->offset_in_vmobject() + (range_to_mprotect.base().get() - old_region->range().base().get());
         auto& new_region = allocate_split_region(*old_region, range_to_mprotect, new_range_offset_in_vmobject);
+        if (prot & PROT_WRITE)
+            new_region.detach_from_shared_inode_vmobject_if_needed();
         new_region.set_readable(prot & PROT_READ);
         new_region.set_writable(prot & PROT_WRITE);
         new_region.set_executable(prot & PROT_EXEC);
@@ -740,6 +761,8 @@ pid_t Process::sys$fork(RegisterState& regs)
     {
         InterruptDisabler disabler;
         g_processes->prepend(child);
+        if (Profiling::is_system_wide())
+            Profiling::did_fork(*child);
     }
 #ifdef TASK_DEBUG
     klog() << "Process " << child->pid() << " (" << child->name().characters() << ") forked from " << m_pid << " @ " << String::format("%p", child_tss.eip);
@@ -757,7 +780,7 @@ void Process::kill_threads_except_self()
         return;
 
     for_each_thread([&](Thread& thread) {
-        if (&thread == Thread::current
+        if (&thread == Thread::current()
             || thread.state() == Thread::State::Dead
             || thread.state() == Thread::State::Dying)
             return IterationDecision::Continue;
@@ -819,10 +842,13 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
 
     // Mark this thread as the current thread that does exec
     // No other thread from this process will be scheduled to run
-    m_exec_tid = Thread::current->tid();
+    // A process being built by someone else (posix_spawn(), the initial processes) has no other threads.
+    if (Process::current() == this)
+        m_exec_tid = Thread::current()->tid();
 
     auto old_page_directory = move(m_page_directory);
     auto old_regions = move(m_regions);
+    auto old_region_tree = move(m_region_tree);
     m_page_directory = PageDirectory::create_for_userspace(*this);
 #ifdef MM_DEBUG
     dbg() << "Process " << pid() << " exec: PD=" << m_page_directory.ptr() << " created";
@@ -859,10 +885,11 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     OwnPtr<ELFLoader> loader;
     {
         ArmedScopeGuard rollback_regions_guard([&]() {
-            ASSERT(Process::current == this);
             m_page_directory = move(old_page_directory);
             m_regions = move(old_regions);
-            MM.enter_process_paging_scope(*this);
+            m_region_tree = move(old_region_tree);
+            // NOTE: posix_spawn() execs into a process that isn't the current one.
+            MM.enter_process_paging_scope(*Process::current());
         });
         loader = make<ELFLoader>(region->vaddr().as_ptr(), loader_metadata.size);
         // Load the correct executable -- either interp or main program.
@@ -957,10 +984,6 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
             m_egid = main_program_metadata.gid;
     }
 
-    Thread::current->set_default_signal_dispositions();
-    Thread::current->m_signal_mask = 0;
-    Thread::current->m_pending_signals = 0;
-
     m_futex_queues.clear();
 
     m_region_lookup_cache = {};
@@ -976,8 +999,8 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     }
 
     Thread* new_main_thread = nullptr;
-    if (Process::current == this) {
-        new_main_thread = Thread::current;
+    if (Process::current() == this) {
+        new_main_thread = Thread::current();
     } else {
         for_each_thread([&](auto& thread) {
             new_main_thread = &thread;
@@ -986,6 +1009,10 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     }
     ASSERT(new_main_thread);
 
+    new_main_thread->set_default_signal_dispositions();
+    new_main_thread->m_signal_mask = 0;
+    new_main_thread->m_pending_signals = 0;
+
     // NOTE: We create the new stack before disabling interrupts since it will zero-fault
     //       and we don't want to deal with faults after this point.
     u32 new_userspace_esp = new_main_thread->make_userspace_stack_for_main_thread(move(arguments), move(environment));
@@ -993,7 +1020,7 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     // We cli() manually here because we don't want to get interrupted between do_exec() and Schedule::yield().
     // The reason is that the task redirection we've set up above will be clobbered by the timer IRQ.
     // If we used an InterruptDisabler that sti()'d on exit, we might timer tick'd too soon in exec().
-    if (Process::current == this)
+    if (Process::current() == this)
         cli();
 
     // NOTE: Be careful to not trigger any page faults below!
@@ -1035,11 +1062,16 @@ int Process::do_exec(NonnullRefPtr<FileDescription> main_program_description, Ve
     klog() << "Process exec'd " << path.characters() << " @ " << String::format("%p", tss.eip);
 #endif
 
-    if (was_profiling)
-        Profiling::did_exec(path);
+    if (was_profiling || Profiling::is_system_wide())
+        Profiling::did_exec(*this, path);
 
-    new_main_thread->set_state(Thread::State::Skip1SchedulerPass);
+    // A process that isn't exec'ing itself is started by whoever is building it, once it's ready to run.
+    if (Process::current() == this)
+        new_main_thread->set_state(Thread::State::Skip1SchedulerPass);
     big_lock().force_unlock_if_locked();
+
+    if (Process::current() != this)
+        MM.enter_process_paging_scope(*Process::current());
     return 0;
 }
 
@@ -1215,7 +1247,7 @@ int Process::exec(String path, Vector<String> arguments, Vector<String> environm
     if (rc < 0)
         return rc;
 
-    if (Process::current == this) {
+    if (Process::current() == this) {
         Scheduler::yield();
         ASSERT_NOT_REACHED();
     }
@@ -1236,7 +1268,7 @@ int Process::sys$execve(const Syscall::SC_execve_params* user_params)
         return -E2BIG;
 
     if (m_wait_for_tracer_at_next_execve)
-        Thread::current->send_urgent_signal_to_self(SIGSTOP);
+        Thread::current()->send_urgent_signal_to_self(SIGSTOP);
 
     String path;
     {
@@ -1246,29 +1278,12 @@ int Process::sys$execve(const Syscall::SC_execve_params* user_params)
         path = path_arg.value();
     }
 
-    auto copy_user_strings = [&](const auto& list, auto& output) {
-        if (!list.length)
-            return true;
-        if (!validate_read_typed(list.strings, list.length))
-            return false;
-        Vector<Syscall::StringArgument, 32> strings;
-        strings.resize(list.length);
-        copy_from_user(strings.data(), list.strings, list.length * sizeof(Syscall::StringArgument));
-        for (size_t i = 0; i < list.length; ++i) {
-            auto string = validate_and_copy_string_from_user(strings[i]);
-            if (string.is_null())
-                return false;
-            output.append(move(string));
-        }
-        return true;
-    };
-
     Vector<String> arguments;
-    if (!copy_user_strings(params.arguments, arguments))
+    if (!copy_user_string_list(params.arguments, arguments))
         return -EFAULT;
 
     Vector<String> environment;
-    if (!copy_user_strings(params.environment, environment))
+    if (!copy_user_string_list(params.environment, environment))
         return -EFAULT;
 
     int rc = exec(move(path), move(arguments), move(environment));
@@ -1276,6 +1291,213 @@ int Process::sys$execve(const Syscall::SC_execve_params* user_params)
     return rc;
 }
 
+bool Process::copy_user_string_list(const Syscall::StringListArgument& list, Vector<String>& output)
+{
+    if (!list.length)
+        return true;
+    if (!validate_read_typed(list.strings, list.length))
+        return false;
+    Vector<Syscall::StringArgument, 32> strings;
+    strings.resize(list.length);
+    copy_from_user(strings.data(), list.strings, list.length * sizeof(Syscall::StringArgument));
+    for (size_t i = 0; i < list.length; ++i) {
+        auto string = validate_and_copy_string_from_user(strings[i]);
+        if (string.is_null())
+            return false;
+        output.append(move(string));
+    }
+    return true;
+}
+
+static pid_t get_sid_from_pgid(pid_t pgid);
+
+pid_t Process::sys$posix_spawn(const Syscall::SC_posix_spawn_params* user_params)
+{
+    REQUIRE_PROMISE(proc);
+    REQUIRE_PROMISE(exec);
+
+    // Unlike fork(), posix_spawn() never clones the parent's regions.
+    // The child starts out with an empty address space and the file actions
+    // are applied to its descriptor table directly, before exec.
+    Syscall::SC_posix_spawn_params params;
+    if (!validate_read_and_copy_typed(&params, user_params))
+        return -EFAULT;
+
+    if (params.arguments.length > ARG_MAX || params.environment.length > ARG_MAX)
+        return -E2BIG;
+
+    if (params.file_action_count > (size_t)m_max_open_file_descriptors * 4)
+        return -EINVAL;
+
+    String path;
+    {
+        auto path_arg = get_syscall_path_argument(params.path);
+        if (path_arg.is_error())
+            return path_arg.error();
+        path = path_arg.value();
+    }
+
+    Vector<String> arguments;
+    if (!copy_user_string_list(params.arguments, arguments))
+        return -EFAULT;
+
+    Vector<String> environment;
+    if (!copy_user_string_list(params.environment, environment))
+        return -EFAULT;
+
+    Vector<Syscall::SC_posix_spawn_file_action> file_actions;
+    Vector<String> file_action_paths;
+    if (params.file_action_count) {
+        if (!validate_read_typed(params.file_actions, params.file_action_count))
+            return -EFAULT;
+        file_actions.resize(params.file_action_count);
+        copy_from_user(file_actions.data(), params.file_actions, params.file_action_count * sizeof(Syscall::SC_posix_spawn_file_action));
+        file_action_paths.resize(params.file_action_count);
+        for (size_t i = 0; i < file_actions.size(); ++i) {
+            auto& action = file_actions[i];
+            if (action.type == Syscall::SpawnFileActionType::Open) {
+                if (action.flags & (O_NOFOLLOW_NOERROR | O_UNLINK_INTERNAL))
+                    return -EINVAL;
+                if (action.flags & O_WRONLY)
+                    REQUIRE_PROMISE(wpath);
+                else if (action.flags & O_RDONLY)
+                    REQUIRE_PROMISE(rpath);
+                if (action.flags & O_CREAT)
+                    REQUIRE_PROMISE(cpath);
+            } else if (action.type == Syscall::SpawnFileActionType::Chdir) {
+                REQUIRE_PROMISE(rpath);
+            } else {
+                continue;
+            }
+            auto path_arg = get_syscall_path_argument(action.path);
+            if (path_arg.is_error())
+                return path_arg.error();
+            file_action_paths[i] = path_arg.value();
+        }
+    }
+
+    if (params.flags & POSIX_SPAWN_SETPGROUP && params.pgroup < 0)
+        return -EINVAL;
+
+    // The terminal is the caller's, so the child has to stay in the caller's session to be put in front of it.
+    RefPtr<FileDescription> tty_description;
+    if (params.flags & POSIX_SPAWN_TCSETPGROUP) {
+        if (params.flags & POSIX_SPAWN_SETSID)
+            return -EINVAL;
+        tty_description = file_description(params.tcsetpgrp_fd);
+        if (!tty_description)
+            return -EBADF;
+        if (!tty_description->is_tty())
+            return -ENOTTY;
+    }
+
+    Thread* child_first_thread = nullptr;
+    auto* child = new Process(child_first_thread, m_name, m_uid, m_gid, m_pid, m_ring, m_cwd, m_executable, m_tty);
+    child->m_euid = m_euid;
+    child->m_egid = m_egid;
+    child->m_extra_gids = m_extra_gids;
+    child->m_root_directory = m_root_directory;
+    child->m_root_directory_relative_to_global_root = m_root_directory_relative_to_global_root;
+    child->m_promises = m_promises;
+    child->m_execpromises = m_execpromises;
+    child->m_fds = m_fds;
+    child->m_sid = m_sid;
+    child->m_pgid = m_pgid;
+    child->m_umask = m_umask;
+
+    auto fail = [&](int error) {
+        delete child_first_thread;
+        delete child;
+        return error;
+    };
+
+    if (params.flags & POSIX_SPAWN_RESETIDS) {
+        child->m_euid = m_uid;
+        child->m_egid = m_gid;
+    }
+
+    if (params.flags & POSIX_SPAWN_SETSID) {
+        child->m_sid = child->m_pid;
+        child->m_pgid = child->m_pid;
+        child->m_tty = nullptr;
+    } else if (params.flags & POSIX_SPAWN_SETPGROUP) {
+        pid_t new_pgid = params.pgroup ? params.pgroup : child->m_pid;
+        if (new_pgid != child->m_pid && get_sid_from_pgid(new_pgid) != m_sid)
+            return fail(-EPERM);
+        child->m_pgid = new_pgid;
+    }
+
+    for (size_t i = 0; i < file_actions.size(); ++i) {
+        auto& action = file_actions[i];
+        if (action.type == Syscall::SpawnFileActionType::Chdir) {
+            auto directory_or_error = VFS::the().open_directory(file_action_paths[i], child->current_directory());
+            if (directory_or_error.is_error())
+                return fail(directory_or_error.error());
+            child->m_cwd = *directory_or_error.value();
+            continue;
+        }
+        if (action.fd < 0 || action.fd >= m_max_open_file_descriptors)
+            return fail(-EBADF);
+        auto& fd_slot = child->m_fds[action.fd];
+        switch (action.type) {
+        case Syscall::SpawnFileActionType::Open: {
+            auto result = VFS::the().open(file_action_paths[i], action.flags, (action.mode & 04777) & ~child->umask(), child->current_directory());
+            if (result.is_error())
+                return fail(result.error());
+            auto description = result.value();
+            if (fd_slot.description)
+                fd_slot.description->close();
+            fd_slot.set(move(description), action.flags & O_CLOEXEC ? FD_CLOEXEC : 0);
+            break;
+        }
+        case Syscall::SpawnFileActionType::Close:
+            if (fd_slot.description)
+                fd_slot.description->close();
+            fd_slot = {};
+            break;
+        case Syscall::SpawnFileActionType::Dup2: {
+            if (action.new_fd < 0 || action.new_fd >= m_max_open_file_descriptors)
+                return fail(-EBADF);
+            auto description = child->file_description(action.fd);
+            if (!description)
+                return fail(-EBADF);
+            // Like dup2(), a descriptor duplicated onto itself keeps its FD_CLOEXEC flag. Otherwise the new one is inheritable.
+            if (action.fd != action.new_fd) {
+                auto& new_fd_slot = child->m_fds[action.new_fd];
+                if (new_fd_slot.description)
+                    new_fd_slot.description->close();
+                new_fd_slot.set(*description);
+            } else {
+                fd_slot.flags &= ~FD_CLOEXEC;
+            }
+            break;
+        }
+        default:
+            return fail(-EINVAL);
+        }
+    }
+
+    int rc = child->exec(move(path), move(arguments), move(environment));
+    if (rc < 0)
+        return fail(rc);
+
+    // exec() leaves the thread for us to start, so it can't run before its mask is in place or it's a known process.
+    if (params.flags & POSIX_SPAWN_SETSIGMASK)
+        child_first_thread->m_signal_mask = params.sigmask;
+
+    {
+        InterruptDisabler disabler;
+        g_processes->prepend(child);
+        if (tty_description)
+            tty_description->tty()->set_pgid(child->pgid());
+        child_first_thread->set_state(Thread::State::Skip1SchedulerPass);
+    }
+#ifdef TASK_DEBUG
+    klog() << "Process " << child->pid() << " (" << child->name().characters() << ") spawned from " << m_pid << " @ " << String::format("%p", child_first_thread->tss().eip);
+#endif
+    return child->pid();
+}
+
 Process* Process::create_user_process(Thread*& first_thread, const String& path, uid_t uid, gid_t gid, pid_t parent_pid, int& error, Vector<String>&& arguments, Vector<String>&& environment, TTY* tty)
 {
     auto parts = path.split('/');
@@ -1315,6 +1537,7 @@ Process* Process::create_user_process(Thread*& first_thread, const String& path,
     {
         InterruptDisabler disabler;
         g_processes->prepend(process);
+        first_thread->set_state(Thread::State::Skip1SchedulerPass);
     }
 #ifdef TASK_DEBUG
     klog() << "Process " << process->pid() << " (" << process->name().characters() << ") spawned @ " << String::format("%p", first_thread->tss().eip);
@@ -1364,7 +1587,7 @@ Process::Process(Thread*& first_thread, const String& name, uid_t uid, gid_t gid
 
     if (fork_parent) {
         // NOTE: fork() doesn't clone all threads; the thread that called fork() becomes the only thread in the new process.
-        first_thread = Thread::current->clone(*this);
+        first_thread = Thread::current()->clone(*this);
     } else {
         // NOTE: This non-forked code path is only taken when the kernel creates a process "manually" (at boot.)
         first_thread = new Thread(*this);
@@ -1374,6 +1597,8 @@ Process::Process(Thread*& first_thread, const String& name, uid_t uid, gid_t gid
 Process::~Process()
 {
     ASSERT(thread_count() == 0);
+    if (m_alarm_timer_id)
+        TimerQueue::the().cancel_timer(m_alarm_timer_id);
 }
 
 void Process::dump_regions()
@@ -1399,7 +1624,7 @@ void Process::sys$exit(int status)
     m_termination_status = status;
     m_termination_signal = 0;
     die();
-    Thread::current->die_if_needed();
+    Thread::current()->die_if_needed();
     ASSERT_NOT_REACHED();
 }
 
@@ -1472,7 +1697,7 @@ int Process::sys$sigreturn(RegisterState& registers)
     //pop the stored eax, ebp, return address, handler and signal code
     stack_ptr += 5;
 
-    Thread::current->m_signal_mask = *stack_ptr;
+    Thread::current()->m_signal_mask = *stack_ptr;
     stack_ptr++;
 
     //pop edi, esi, ebp, esp, ebx, edx, ecx and eax
@@ -1493,7 +1718,7 @@ void Process::crash(int signal, u32 eip)
 {
     ASSERT_INTERRUPTS_DISABLED();
     ASSERT(!is_dead());
-    ASSERT(Process::current == this);
+    ASSERT(Process::current() == this);
 
     if (eip >= 0xc0000000 && ksyms_ready) {
         auto* ksym = ksymbolicate(eip);
@@ -1511,7 +1736,7 @@ void Process::crash(int signal, u32 eip)
     die();
     // We can not return from here, as there is nowhere
     // to unwind to, so die right away.
-    Thread::current->die_if_needed();
+    Thread::current()->die_if_needed();
     ASSERT_NOT_REACHED();
 }
 
@@ -1669,7 +1894,7 @@ ssize_t Process::do_write(FileDescription& description, const u8* data, int data
 #ifdef IO_DEBUG
             dbg() << "block write on " << description.absolute_path();
 #endif
-            if (Thread::current->block<Thread::WriteBlocker>(description) != Thread::BlockResult::WokeNormally) {
+            if (Thread::current()->block<Thread::WriteBlocker>(description) != Thread::BlockResult::WokeNormally) {
                 if (nwritten == 0)
                     return -EINTR;
             }
@@ -1732,7 +1957,7 @@ ssize_t Process::sys$read(int fd, u8* buffer, ssize_t size)
         return -EISDIR;
     if (description->is_blocking()) {
         if (!description->can_read()) {
-            if (Thread::current->block<Thread::ReadBlocker>(*description) != Thread::BlockResult::WokeNormally)
+            if (Thread::current()->block<Thread::ReadBlocker>(*description) != Thread::BlockResult::WokeNormally)
                 return -EINTR;
             if (!description->can_read())
                 return -EAGAIN;
@@ -2109,11 +2334,29 @@ unsigned Process::sys$alarm(unsigned seconds)
     if (m_alarm_deadline && m_alarm_deadline > g_uptime) {
         previous_alarm_remaining = (m_alarm_deadline - g_uptime) / TimeManagement::the().ticks_per_second();
     }
+    if (m_alarm_timer_id) {
+        TimerQueue::the().cancel_timer(m_alarm_timer_id);
+        m_alarm_timer_id = 0;
+    }
     if (!seconds) {
         m_alarm_deadline = 0;
         return previous_alarm_remaining;
     }
     m_alarm_deadline = g_uptime + seconds * TimeManagement::the().ticks_per_second();
+
+    auto timer = make<Timer>();
+    timer->expires = m_alarm_deadline;
+    // Hold on to the Process itself rather than its pid, which exec() from a secondary thread changes.
+    // die() and ~Process() cancel the timer, so it can't outlive us.
+    timer->callback = [this] {
+        InterruptDisabler disabler;
+        m_alarm_deadline = 0;
+        m_alarm_timer_id = 0;
+        if (is_dead())
+            return;
+        send_signal(SIGALRM, nullptr);
+    };
+    m_alarm_timer_id = TimerQueue::the().add_timer(move(timer));
     return previous_alarm_remaining;
 }
 
@@ -2204,9 +2447,9 @@ int Process::sys$kill(pid_t pid, int signal)
     if (pid == m_pid) {
         if (signal == 0)
             return 0;
-        if (!Thread::current->should_ignore_signal(signal)) {
-            Thread::current->send_signal(signal, this);
-            (void)Thread::current->block<Thread::SemiPermanentBlocker>(Thread::SemiPermanentBlocker::Reason::Signal);
+        if (!Thread::current()->should_ignore_signal(signal)) {
+            Thread::current()->send_signal(signal, this);
+            (void)Thread::current()->block<Thread::SemiPermanentBlocker>(Thread::SemiPermanentBlocker::Reason::Signal);
         }
         return 0;
     }
@@ -2222,7 +2465,7 @@ int Process::sys$usleep(useconds_t usec)
     REQUIRE_PROMISE(stdio);
     if (!usec)
         return 0;
-    u64 wakeup_time = Thread::current->sleep(usec / 1000);
+    u64 wakeup_time = Thread::current()->sleep(usec / 1000);
     if (wakeup_time > g_uptime)
         return -EINTR;
     return 0;
@@ -2233,7 +2476,7 @@ int Process::sys$sleep(unsigned seconds)
     REQUIRE_PROMISE(stdio);
     if (!seconds)
         return 0;
-    u64 wakeup_time = Thread::current->sleep(seconds * TimeManagement::the().ticks_per_second());
+    u64 wakeup_time = Thread::current()->sleep(seconds * TimeManagement::the().ticks_per_second());
     if (wakeup_time > g_uptime) {
         u32 ticks_left_until_original_wakeup_time = wakeup_time - g_uptime;
         return ticks_left_until_original_wakeup_time / TimeManagement::the().ticks_per_second();
@@ -2386,7 +2629,7 @@ KResultOr<siginfo_t> Process::do_waitid(idtype_t idtype, int id, int options)
         return KResult(-EINVAL);
     }
 
-    if (Thread::current->block<Thread::WaitBlocker>(options, waitee_pid) != Thread::BlockResult::WokeNormally)
+    if (Thread::current()->block<Thread::WaitBlocker>(options, waitee_pid) != Thread::BlockResult::WokeNormally)
         return KResult(-EINTR);
 
     InterruptDisabler disabler;
@@ -2609,7 +2852,7 @@ int Process::sys$sigprocmask(int how, const sigset_t* set, sigset_t* old_set)
     if (old_set) {
         if (!validate_write_typed(old_set))
             return -EFAULT;
-        copy_to_user(old_set, &Thread::current->m_signal_mask);
+        copy_to_user(old_set, &Thread::current()->m_signal_mask);
     }
     if (set) {
         if (!validate_read_typed(set))
@@ -2618,13 +2861,13 @@ int Process::sys$sigprocmask(int how, const sigset_t* set, sigset_t* old_set)
         copy_from_user(&set_value, set);
         switch (how) {
         case SIG_BLOCK:
-            Thread::current->m_signal_mask &= ~set_value;
+            Thread::current()->m_signal_mask &= ~set_value;
             break;
         case SIG_UNBLOCK:
-            Thread::current->m_signal_mask |= set_value;
+            Thread::current()->m_signal_mask |= set_value;
             break;
         case SIG_SETMASK:
-            Thread::current->m_signal_mask = set_value;
+            Thread::current()->m_signal_mask = set_value;
             break;
         default:
             return -EINVAL;
@@ -2638,7 +2881,7 @@ int Process::sys$sigpending(sigset_t* set)
     REQUIRE_PROMISE(stdio);
     if (!validate_write_typed(set))
         return -EFAULT;
-    copy_to_user(set, &Thread::current->m_pending_signals);
+    copy_to_user(set, &Thread::current()->m_pending_signals);
     return 0;
 }
 
@@ -2650,7 +2893,7 @@ int Process::sys$sigaction(int signum, const sigaction* act, sigaction* old_act)
     if (!validate_read_typed(act))
         return -EFAULT;
     InterruptDisabler disabler; // FIXME: This should use a narrower lock. Maybe a way to ignore signals temporarily?
-    auto& action = Thread::current->m_signal_action_data[signum];
+    auto& action = Thread::current()->m_signal_action_data[signum];
     if (old_act) {
         if (!validate_write_typed(old_act))
             return -EFAULT;
@@ -2825,7 +3068,7 @@ int Process::sys$select(const Syscall::SC_select_params* params)
 #endif
 
     if (!timeout || select_has_timeout) {
-        if (Thread::current->block<Thread::SelectBlocker>(computed_timeout, select_has_timeout, rfds, wfds, efds) != Thread::BlockResult::WokeNormally)
+        if (Thread::current()->block<Thread::SelectBlocker>(computed_timeout, select_has_timeout, rfds, wfds, efds) != Thread::BlockResult::WokeNormally)
             return -EINTR;
         // While we blocked, the process lock was dropped. This gave other threads
         // the opportunity to mess with the memory. For example, it could free the
@@ -2897,7 +3140,7 @@ int Process::sys$poll(pollfd* fds, int nfds, int timeout)
 #endif
 
     if (has_timeout || timeout < 0) {
-        if (Thread::current->block<Thread::SelectBlocker>(actual_timeout, has_timeout, rfds, wfds, Thread::SelectBlocker::FDVector()) != Thread::BlockResult::WokeNormally)
+        if (Thread::current()->block<Thread::SelectBlocker>(actual_timeout, has_timeout, rfds, wfds, Thread::SelectBlocker::FDVector()) != Thread::BlockResult::WokeNormally)
             return -EINTR;
     }
 
@@ -3034,7 +3277,7 @@ int Process::sys$chown(const Syscall::SC_chown_params* user_params)
 
 void Process::finalize()
 {
-    ASSERT(Thread::current == g_finalizer);
+    ASSERT(Thread::current() == g_finalizer);
 #ifdef PROCESS_DEBUG
     dbg() << "Finalizing process " << *this;
 #endif
@@ -3068,6 +3311,7 @@ void Process::finalize()
         }
     }
 
+    m_region_tree.clear();
     m_regions.clear();
 
     m_dead = true;
@@ -3081,6 +3325,11 @@ void Process::die()
     // slave owner, we have to allow the PTY pair to be torn down.
     m_tty = nullptr;
 
+    if (m_alarm_timer_id) {
+        TimerQueue::the().cancel_timer(m_alarm_timer_id);
+        m_alarm_timer_id = 0;
+    }
+
     kill_all_threads();
 }
 
@@ -3244,7 +3493,7 @@ int Process::sys$accept(int accepting_socket_fd, sockaddr* user_address, socklen
     auto& socket = *accepting_socket_description->socket();
     if (!socket.can_accept()) {
         if (accepting_socket_description->is_blocking()) {
-            if (Thread::current->block<Thread::AcceptBlocker>(*accepting_socket_description) != Thread::BlockResult::WokeNormally)
+            if (Thread::current()->block<Thread::AcceptBlocker>(*accepting_socket_description) != Thread::BlockResult::WokeNormally)
                 return -EINTR;
         } else {
             return -EAGAIN;
@@ -3445,7 +3694,7 @@ int Process::sys$sched_setparam(int tid, const struct sched_param* param)
     copy_from_user(&desired_priority, &param->sched_priority);
 
     InterruptDisabler disabler;
-    auto* peer = Thread::current;
+    auto* peer = Thread::current();
     if (tid != 0)
         peer = Thread::from_tid(tid);
 
@@ -3469,7 +3718,7 @@ int Process::sys$sched_getparam(pid_t pid, struct sched_param* param)
         return -EFAULT;
 
     InterruptDisabler disabler;
-    auto* peer = Thread::current;
+    auto* peer = Thread::current();
     if (pid != 0)
         peer = Thread::from_tid(pid);
 
@@ -3778,10 +4027,10 @@ void Process::sys$exit_thread(void* exit_value)
 {
     REQUIRE_PROMISE(thread);
     cli();
-    Thread::current->m_exit_value = exit_value;
-    Thread::current->set_should_die();
+    Thread::current()->m_exit_value = exit_value;
+    Thread::current()->set_should_die();
     big_lock().force_unlock_if_locked();
-    Thread::current->die_if_needed();
+    Thread::current()->die_if_needed();
     ASSERT_NOT_REACHED();
 }
 
@@ -3811,13 +4060,13 @@ int Process::sys$join_thread(int tid, void** exit_value)
     if (!thread || thread->pid() != pid())
         return -ESRCH;
 
-    if (thread == Thread::current)
+    if (thread == Thread::current())
         return -EDEADLK;
 
-    if (thread->m_joinee == Thread::current)
+    if (thread->m_joinee == Thread::current())
         return -EDEADLK;
 
-    ASSERT(thread->m_joiner != Thread::current);
+    ASSERT(thread->m_joiner != Thread::current());
     if (thread->m_joiner)
         return -EINVAL;
 
@@ -3828,15 +4077,15 @@ int Process::sys$join_thread(int tid, void** exit_value)
 
     // NOTE: pthread_join() cannot be interrupted by signals. Only by death.
     for (;;) {
-        auto result = Thread::current->block<Thread::JoinBlocker>(*thread, joinee_exit_value);
+        auto result = Thread::current()->block<Thread::JoinBlocker>(*thread, joinee_exit_value);
         if (result == Thread::BlockResult::InterruptedByDeath) {
             // NOTE: This cleans things up so that Thread::finalize() won't
             //       get confused about a missing joiner when finalizing the joinee.
             InterruptDisabler disabler_t;
 
-            if (Thread::current->m_joinee) {
-                Thread::current->m_joinee->m_joiner = nullptr;
-                Thread::current->m_joinee = nullptr;
+            if (Thread::current()->m_joinee) {
+                Thread::current()->m_joinee->m_joiner = nullptr;
+                Thread::current()->m_joinee = nullptr;
             }
 
             break;
@@ -3894,7 +4143,7 @@ int Process::sys$get_thread_name(int tid, char* buffer, size_t buffer_size)
 int Process::sys$gettid()
 {
     REQUIRE_PROMISE(stdio);
-    return Thread::current->tid();
+    return Thread::current()->tid();
 }
 
 int Process::sys$donate(int tid)
@@ -4243,14 +4492,16 @@ int Process::sys$clock_gettime(clockid_t clock_id, timespec* user_ts)
     timespec ts;
     memset(&ts, 0, sizeof(ts));
 
+    // Keep in step with the clocks LibC computes from the kernel info page.
+    u64 monotonic_nanoseconds = TimeManagement::the().clock_monotonic_nanoseconds();
+    ts.tv_sec = monotonic_nanoseconds / 1000000000ull;
+    ts.tv_nsec = monotonic_nanoseconds % 1000000000ull;
+
     switch (clock_id) {
     case CLOCK_MONOTONIC:
-        ts.tv_sec = TimeManagement::the().seconds_since_boot();
-        ts.tv_nsec = TimeManagement::the().ticks_this_second() * 1000000;
         break;
     case CLOCK_REALTIME:
-        ts.tv_sec = TimeManagement::the().epoch_time();
-        ts.tv_nsec = TimeManagement::the().ticks_this_second() * 1000000;
+        ts.tv_sec += TimeManagement::the().epoch_time() - TimeManagement::the().seconds_since_boot();
         break;
     default:
         return -EINVAL;
@@ -4298,15 +4549,37 @@ int Process::sys$clock_nanosleep(const Syscall::SC_clock_nanosleep_params* user_
 
     switch (params.clock_id) {
     case CLOCK_MONOTONIC: {
+        if (TimeManagement::the().is_tickless()) {
+            // With a one-shot timer we can sleep until the exact deadline rather than the next tick.
+            u64 requested_nanoseconds = (u64)requested_sleep.tv_sec * 1000000000ull + requested_sleep.tv_nsec;
+            u64 deadline = requested_nanoseconds;
+            if (!is_absolute)
+                deadline += TimeManagement::the().monotonic_nanoseconds();
+            if (Thread::current()->sleep_until_nanoseconds(deadline))
+                return 0;
+            u64 now = TimeManagement::the().monotonic_nanoseconds();
+            if (now >= deadline)
+                return 0;
+            if (!is_absolute && params.remaining_sleep) {
+                if (!validate_write_typed(params.remaining_sleep))
+                    return -EFAULT;
+                timespec remaining_sleep;
+                remaining_sleep.tv_sec = (deadline - now) / 1000000000ull;
+                remaining_sleep.tv_nsec = (deadline - now) % 1000000000ull;
+                copy_to_user(params.remaining_sleep, &remaining_sleep);
+            }
+            return -EINTR;
+        }
+
         u64 wakeup_time;
         if (is_absolute) {
             u64 time_to_wake = (requested_sleep.tv_sec * 1000 + requested_sleep.tv_nsec / 1000000);
-            wakeup_time = Thread::current->sleep_until(time_to_wake);
+            wakeup_time = Thread::current()->sleep_until(time_to_wake);
         } else {
             u32 ticks_to_sleep = (requested_sleep.tv_sec * 1000 + requested_sleep.tv_nsec / 1000000);
             if (!ticks_to_sleep)
                 return 0;
-            wakeup_time = Thread::current->sleep(ticks_to_sleep);
+            wakeup_time = Thread::current()->sleep(ticks_to_sleep);
         }
         if (wakeup_time > g_uptime) {
             u32 ticks_left = wakeup_time - g_uptime;
@@ -4344,14 +4617,14 @@ int Process::sys$sync()
 int Process::sys$yield()
 {
     REQUIRE_PROMISE(stdio);
-    Thread::current->yield_without_holding_big_lock();
+    Thread::current()->yield_without_holding_big_lock();
     return 0;
 }
 
 int Process::sys$beep()
 {
     PCSpeaker::tone_on(440);
-    u64 wakeup_time = Thread::current->sleep(100);
+    u64 wakeup_time = Thread::current()->sleep(100);
     PCSpeaker::tone_off();
     if (wakeup_time > g_uptime)
         return -EINTR;
@@ -4504,6 +4777,12 @@ int Process::sys$profiling_enable(pid_t pid)
 {
     REQUIRE_NO_PROMISES;
     InterruptDisabler disabler;
+    if (pid == Profiling::all_processes) {
+        if (!is_superuser())
+            return -EPERM;
+        Profiling::start_system_wide();
+        return 0;
+    }
     auto* process = Process::from_pid(pid);
     if (!process)
         return -ESRCH;
@@ -4519,6 +4798,12 @@ int Process::sys$profiling_enable(pid_t pid)
 int Process::sys$profiling_disable(pid_t pid)
 {
     InterruptDisabler disabler;
+    if (pid == Profiling::all_processes) {
+        if (!is_superuser())
+            return -EPERM;
+        Profiling::stop();
+        return 0;
+    }
     auto* process = Process::from_pid(pid);
     if (!process)
         return -ESRCH;
@@ -4586,7 +4871,7 @@ int Process::sys$futex(const Syscall::SC_futex_params* user_params)
             return -EAGAIN;
         // FIXME: This is supposed to be interruptible by a signal, but right now WaitQueue cannot be interrupted.
         // FIXME: Support timeout!
-        Thread::current->wait_on(futex_queue(userspace_address));
+        Thread::current()->wait_on(futex_queue(userspace_address));
         break;
     case FUTEX_WAKE:
         if (value == 0)
@@ -4739,6 +5024,7 @@ int Process::sys$pledge(const Syscall::SC_pledge_params* user_params)
 Region& Process::add_region(NonnullOwnPtr<Region> region)
 {
     auto* ptr = region.ptr();
+    m_region_tree.insert(ptr->vaddr().get(), ptr);
     m_regions.append(move(region));
     return *ptr;
 }
@@ -4851,7 +5137,7 @@ int Process::sys$get_stack_bounds(FlatPtr* user_stack_base, size_t* user_stack_s
     if (!validate_write_typed(user_stack_size))
         return -EFAULT;
 
-    FlatPtr stack_pointer = Thread::current->get_register_dump_from_stack().userspace_esp;
+    FlatPtr stack_pointer = Thread::current()->get_register_dump_from_stack().userspace_esp;
     auto* stack_region = MM.region_from_vaddr(*this, VirtualAddress(stack_pointer));
     if (!stack_region) {
         ASSERT_NOT_REACHED();
@@ -4873,7 +5159,7 @@ int Process::sys$ptrace(const Syscall::SC_ptrace_params* user_params)
         return -EFAULT;
 
     if (params.request == PT_TRACE_ME) {
-        if (Thread::current->tracer())
+        if (Thread::current()->tracer())
             return -EBUSY;
 
         m_wait_for_tracer_at_next_execve = true;
@@ -30,6 +30,7 @@
 #include <AK/HashMap.h>
 #include <AK/InlineLinkedList.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/RedBlackTree.h>
 #include <AK/String.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/FileSystem/InodeMetadata.h>
@@ -99,7 +100,11 @@ class Process : public InlineLinkedListNode<Process> {
     friend class Thread;
 
 public:
-    static Process* current;
+    static Process* current()
+    {
+        auto* thread = Thread::current();
+        return thread ? &thread->process() : nullptr;
+    }
 
     static Process* create_kernel_process(Thread*& first_thread, String&& name, void (*entry)());
     static Process* create_user_process(Thread*& first_thread, const String& path, uid_t, gid_t, pid_t ppid, int& error, Vector<String>&& arguments = Vector<String>(), Vector<String>&& environment = Vector<String>(), TTY* = nullptr);
@@ -222,6 +227,7 @@ public:
     int sys$ptsname_r(int fd, char*, ssize_t);
     pid_t sys$fork(RegisterState&);
     int sys$execve(const Syscall::SC_execve_params*);
+    pid_t sys$posix_spawn(const Syscall::SC_posix_spawn_params*);
     int sys$getdtablesize();
     int sys$dup(int oldfd);
     int sys$dup2(int oldfd, int newfd);
@@ -349,6 +355,7 @@ public:
 
     Custody& current_directory();
     Custody* executable() { return m_executable.ptr(); }
+    const Custody* executable() const { return m_executable.ptr(); }
 
     int number_of_open_file_descriptors() const;
     int max_open_file_descriptors() const { return m_max_open_file_descriptors; }
@@ -423,6 +430,7 @@ private:
     void kill_threads_except_self();
     void kill_all_threads();
 
+    bool copy_user_string_list(const Syscall::StringListArgument&, Vector<String>& output);
     int do_exec(NonnullRefPtr<FileDescription> main_program_description, Vector<String> arguments, Vector<String> environment, RefPtr<FileDescription> interpreter_description);
     ssize_t do_write(FileDescription&, const u8*, int data_size);
 
@@ -486,8 +494,11 @@ private:
 
     Region* region_from_range(const Range&);
     Region* region_containing(const Range&);
+    Region* region_containing(VirtualAddress);
 
     NonnullOwnPtrVector<Region> m_regions;
+    // Index of m_regions keyed by base address, for O(log n) lookups on faults and syscall validation.
+    RedBlackTree<FlatPtr, Region*> m_region_tree;
     struct RegionLookupCache {
         Range range;
         WeakPtr<Region> region;
@@ -506,6 +517,7 @@ private:
     Lock m_big_lock { "Process" };
 
     u64 m_alarm_deadline { 0 };
+    u64 m_alarm_timer_id { 0 };
 
     int m_icon_id { -1 };
 
@@ -535,14 +547,14 @@ public:
     ProcessInspectionHandle(Process& process)
         : m_process(process)
     {
-        if (&process != Process::current) {
+        if (&process != Process::current()) {
             InterruptDisabler disabler;
             m_process.increment_inspector_count({});
         }
     }
     ~ProcessInspectionHandle()
     {
-        if (&m_process != Process::current) {
+        if (&m_process != Process::current()) {
             InterruptDisabler disabler;
             m_process.decrement_inspector_count({});
         }
@@ -659,25 +671,25 @@ inline u32 Thread::effective_priority() const
     return m_priority + m_process.priority_boost() + m_priority_boost + m_extra_priority;
 }
 
-#define REQUIRE_NO_PROMISES                      \
-    do {                                         \
-        if (Process::current->has_promises()) {  \
-            dbg() << "Has made a promise";       \
-            cli();                               \
-            Process::current->crash(SIGABRT, 0); \
-            ASSERT_NOT_REACHED();                \
-        }                                        \
+#define REQUIRE_NO_PROMISES                        \
+    do {                                           \
+        if (Process::current()->has_promises()) {  \
+            dbg() << "Has made a promise";         \
+            cli();                                 \
+            Process::current()->crash(SIGABRT, 0); \
+            ASSERT_NOT_REACHED();                  \
+        }                                          \
     } while (0)
 
-#define REQUIRE_PROMISE(promise)                                   \
-    do {                                                           \
-        if (Process::current->has_promises()                       \
-            && !Process::current->has_promised(Pledge::promise)) { \
-            dbg() << "Has not pledged " << #promise;               \
-            cli();                                                 \
-            Process::current->crash(SIGABRT, 0);                   \
-            ASSERT_NOT_REACHED();                                  \
-        }                                                          \
+#define REQUIRE_PROMISE(promise)                                     \
+    do {                                                             \
+        if (Process::current()->has_promises()                       \
+            && !Process::current()->has_promised(Pledge::promise)) { \
+            dbg() << "Has not pledged " << #promise;                 \
+            cli();                                                   \
+            Process::current()->crash(SIGABRT, 0);                   \
+            ASSERT_NOT_REACHED();                                    \
+        }                                                            \
     } while (0)
 
 }
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// Binary layout of /proc/all_snapshot.
+// The file starts with a ProcessSnapshotHeader, followed by process_count
+// records. Each record is a ProcessSnapshot immediately followed by its
+// thread_count ThreadSnapshot entries.
+// Bump PROCESS_SNAPSHOT_VERSION whenever any of these structures change.
+
+#define PROCESS_SNAPSHOT_VERSION 1
+
+struct ProcessSnapshotHeader {
+    u32 version;
+    u32 header_size;
+    u32 process_size;
+    u32 thread_size;
+    u32 process_count;
+};
+
+struct ThreadSnapshot {
+    i32 tid;
+    u32 times_scheduled;
+    u32 ticks;
+    u32 priority;
+    u32 effective_priority;
+    u32 syscall_count;
+    u32 inode_faults;
+    u32 zero_faults;
+    u32 cow_faults;
+    u32 unix_socket_read_bytes;
+    u32 unix_socket_write_bytes;
+    u32 ipv4_socket_read_bytes;
+    u32 ipv4_socket_write_bytes;
+    u32 file_read_bytes;
+    u32 file_write_bytes;
+    char state[16];
+    char name[32];
+};
+
+enum class ProcessSnapshotVeilState : u32 {
+    None,
+    Dropped,
+    Locked,
+};
+
+struct ProcessSnapshot {
+    i32 pid;
+    u32 pgid;
+    u32 pgp;
+    u32 sid;
+    u32 uid;
+    u32 gid;
+    i32 ppid;
+    u32 nfds;
+    u32 amount_virtual;
+    u32 amount_resident;
+    u32 amount_dirty_private;
+    u32 amount_clean_inode;
+    u32 amount_shared;
+    u32 amount_purgeable_volatile;
+    u32 amount_purgeable_nonvolatile;
+    i32 icon_id;
+    ProcessSnapshotVeilState veil;
+    u32 thread_count;
+    char name[32];
+    char tty[16];
+    char pledge[192];
+};
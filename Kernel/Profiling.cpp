@@ -31,6 +31,7 @@
 #include <Kernel/KSyms.h>
 #include <Kernel/Process.h>
 #include <Kernel/Profiling.h>
+#include <Kernel/Scheduler.h>
 #include <LibELF/ELFLoader.h>
 
 namespace Kernel {
@@ -39,37 +40,105 @@ namespace Profiling {
 
 static KBufferImpl* s_profiling_buffer;
 static size_t s_slot_count;
-static size_t s_next_slot_index;
-static u32 s_pid;
-
-String& executable_path()
+// The samples form a ring in the buffer, so that readers can take the oldest ones without moving the rest.
+static size_t s_first_sample_index;
+static size_t s_sample_count;
+static size_t s_lost_sample_count;
+static size_t s_lost_executable_mapping_count;
+static pid_t s_pid;
+static uid_t s_uid;
+static bool s_system_wide;
+
+static Vector<ExecutableMapping>& executable_mappings()
 {
-    static String* path;
-    if (!path)
-        path = new String;
-    return *path;
+    static Vector<ExecutableMapping>* mappings;
+    if (!mappings)
+        mappings = new Vector<ExecutableMapping>;
+    return *mappings;
 }
 
-u32 pid()
+pid_t pid()
 {
     return s_pid;
 }
 
-void start(Process& process)
+uid_t uid()
+{
+    return s_uid;
+}
+
+bool is_system_wide()
+{
+    return s_system_wide;
+}
+
+size_t lost_sample_count()
+{
+    return s_lost_sample_count;
+}
+
+size_t lost_executable_mapping_count()
+{
+    return s_lost_executable_mapping_count;
+}
+
+size_t sample_count()
+{
+    return s_sample_count;
+}
+
+static void add_executable_mapping(pid_t pid, String path)
+{
+    if (executable_mappings().size() >= max_executable_mapping_count) {
+        ++s_lost_executable_mapping_count;
+        return;
+    }
+    executable_mappings().append({ pid, g_uptime, move(path) });
+}
+
+static void add_executable_mapping(const Process& process)
 {
+    String path;
     if (process.executable())
-        executable_path() = process.executable()->absolute_path().impl();
-    else
-        executable_path() = {};
-    s_pid = process.pid();
+        path = process.executable()->absolute_path();
+    add_executable_mapping(process.pid(), move(path));
+}
 
+static void reset()
+{
     if (!s_profiling_buffer) {
         s_profiling_buffer = RefPtr<KBufferImpl>(KBuffer::create_with_size(8 * MB).impl()).leak_ref();
         s_profiling_buffer->region().commit();
         s_slot_count = s_profiling_buffer->size() / sizeof(Sample);
     }
 
-    s_next_slot_index = 0;
+    s_first_sample_index = 0;
+    s_sample_count = 0;
+    s_lost_sample_count = 0;
+    s_lost_executable_mapping_count = 0;
+    executable_mappings().clear();
+}
+
+void start(Process& process)
+{
+    reset();
+    s_pid = process.pid();
+    s_uid = process.uid();
+    s_system_wide = false;
+    add_executable_mapping(process);
+}
+
+void start_system_wide()
+{
+    reset();
+    s_pid = all_processes;
+    s_uid = 0;
+    s_system_wide = true;
+    add_executable_mapping(*Scheduler::colonel());
+    Process::for_each([](auto& process) {
+        add_executable_mapping(process);
+        return IterationDecision::Continue;
+    });
 }
 
 static Sample& sample_slot(size_t index)
@@ -77,30 +146,51 @@ static Sample& sample_slot(size_t index)
     return ((Sample*)s_profiling_buffer->data())[index];
 }
 
-Sample& next_sample_slot()
+Sample* next_sample_slot()
 {
-    auto& slot = sample_slot(s_next_slot_index++);
-    if (s_next_slot_index >= s_slot_count)
-        s_next_slot_index = 0;
-    return slot;
+    // Rather than silently overwriting old samples, we drop new ones until
+    // someone drains the buffer by reading /proc/profile.
+    if (s_sample_count >= s_slot_count) {
+        ++s_lost_sample_count;
+        return nullptr;
+    }
+    return &sample_slot((s_first_sample_index + s_sample_count++) % s_slot_count);
 }
 
 void stop()
 {
+    s_system_wide = false;
 }
 
-void did_exec(const String& new_executable_path)
+void did_fork(const Process& child)
 {
-    executable_path() = new_executable_path;
-    s_next_slot_index = 0;
+    add_executable_mapping(child);
 }
 
-void for_each_sample(Function<void(Sample&)> callback)
+void did_exec(const Process& process, const String& new_executable_path)
 {
-    for (size_t i = 0; i < s_next_slot_index; ++i) {
-        auto& sample = sample_slot(i);
-        callback(sample);
-    }
+    add_executable_mapping(process.pid(), new_executable_path);
+}
+
+void for_each_executable_mapping(Function<void(const ExecutableMapping&)> callback)
+{
+    for (auto& mapping : executable_mappings())
+        callback(mapping);
+}
+
+size_t take_samples(Sample* samples, size_t max_count)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    size_t count = min(max_count, s_sample_count);
+    if (!count)
+        return 0;
+    size_t count_before_wrap = min(count, s_slot_count - s_first_sample_index);
+    memcpy(samples, &sample_slot(s_first_sample_index), count_before_wrap * sizeof(Sample));
+    memcpy(samples + count_before_wrap, &sample_slot(0), (count - count_before_wrap) * sizeof(Sample));
+    // Keep whatever the reader didn't get to, for the next read.
+    s_first_sample_index = (s_first_sample_index + count) % s_slot_count;
+    s_sample_count -= count;
+    return count;
 }
 
 }
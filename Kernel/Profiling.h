@@ -29,6 +29,7 @@
 #include <AK/Function.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <Kernel/UnixTypes.h>
 
 namespace Kernel {
 
@@ -38,6 +39,12 @@ namespace Profiling {
 
 constexpr size_t max_stack_frame_count = 30;
 
+// Passing this to sys$profiling_enable() samples every process in the system.
+constexpr pid_t all_processes = -1;
+
+// A system-wide profile of a busy system would otherwise keep growing as long as processes keep forking.
+constexpr size_t max_executable_mapping_count = 4096;
+
 struct Sample {
     i32 pid;
     i32 tid;
@@ -45,14 +52,28 @@ struct Sample {
     u32 frames[max_stack_frame_count];
 };
 
-extern u32 pid();
-extern String& executable_path();
+struct ExecutableMapping {
+    pid_t pid;
+    u64 timestamp;
+    String path;
+};
+
+extern pid_t pid();
+extern uid_t uid();
+extern bool is_system_wide();
+extern size_t lost_sample_count();
+extern size_t lost_executable_mapping_count();
+extern size_t sample_count();
 
-Sample& next_sample_slot();
+Sample* next_sample_slot();
 void start(Process&);
+void start_system_wide();
 void stop();
-void did_exec(const String& new_executable_path);
-void for_each_sample(Function<void(Sample&)>);
+void did_fork(const Process& child);
+void did_exec(const Process&, const String& new_executable_path);
+void for_each_executable_mapping(Function<void(const ExecutableMapping&)>);
+// Copies out up to `max_count` of the oldest samples and drops them from the buffer.
+size_t take_samples(Sample*, size_t max_count);
 
 }
 
@@ -26,6 +26,7 @@
 
 #include <AK/QuickSort.h>
 #include <AK/TemporaryChange.h>
+#include <AK/Time.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Net/Socket.h>
 #include <Kernel/Process.h>
@@ -34,6 +35,7 @@
 #include <Kernel/Scheduler.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/TimerQueue.h>
+#include <Kernel/Tracing.h>
 
 //#define LOG_EVERY_CONTEXT_SWITCH
 //#define SCHEDULER_DEBUG
@@ -77,6 +79,8 @@ Thread* g_colonel;
 WaitQueue* g_finalizer_wait_queue;
 bool g_finalizer_has_work;
 static Process* s_colonel_process;
+static bool s_preempting;
+static u64 s_last_context_switch_tsc;
 u64 g_uptime;
 
 struct TaskRedirectionData {
@@ -91,13 +95,19 @@ bool Scheduler::is_active()
     return s_active;
 }
 
+static u64 timeval_to_ticks(const timeval& tv)
+{
+    u64 ticks_per_second = TimeManagement::the().ticks_per_second();
+    return (u64)tv.tv_sec * ticks_per_second + ((u64)tv.tv_usec * ticks_per_second + 999999) / 1000000;
+}
+
 Thread::JoinBlocker::JoinBlocker(Thread& joinee, void*& joinee_exit_value)
     : m_joinee(joinee)
     , m_joinee_exit_value(joinee_exit_value)
 {
     ASSERT(m_joinee.m_joiner == nullptr);
-    m_joinee.m_joiner = Thread::current;
-    Thread::current->m_joinee = &joinee;
+    m_joinee.m_joiner = Thread::current();
+    Thread::current()->m_joinee = &joinee;
 }
 
 bool Thread::JoinBlocker::should_unblock(Thread& joiner, time_t, long)
@@ -143,22 +153,14 @@ Thread::WriteBlocker::WriteBlocker(const FileDescription& description)
     if (description.is_socket()) {
         auto& socket = *description.socket();
         if (socket.has_send_timeout()) {
-            timeval deadline = Scheduler::time_since_boot();
-            deadline.tv_sec += socket.send_timeout().tv_sec;
-            deadline.tv_usec += socket.send_timeout().tv_usec;
-            deadline.tv_sec += (socket.send_timeout().tv_usec / 1000000) * 1;
-            deadline.tv_usec %= 1000000;
-            m_deadline = deadline;
+            u64 ticks = timeval_to_ticks(socket.send_timeout());
+            set_timeout(g_uptime + ticks, TimerQueue::default_slack(ticks));
         }
     }
 }
 
-bool Thread::WriteBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
+bool Thread::WriteBlocker::should_unblock(Thread&, time_t, long)
 {
-    if (m_deadline.has_value()) {
-        bool timed_out = now_sec > m_deadline.value().tv_sec || (now_sec == m_deadline.value().tv_sec && now_usec >= m_deadline.value().tv_usec);
-        return timed_out || blocked_description().can_write();
-    }
     return blocked_description().can_write();
 }
 
@@ -168,22 +170,14 @@ Thread::ReadBlocker::ReadBlocker(const FileDescription& description)
     if (description.is_socket()) {
         auto& socket = *description.socket();
         if (socket.has_receive_timeout()) {
-            timeval deadline = Scheduler::time_since_boot();
-            deadline.tv_sec += socket.receive_timeout().tv_sec;
-            deadline.tv_usec += socket.receive_timeout().tv_usec;
-            deadline.tv_sec += (socket.receive_timeout().tv_usec / 1000000) * 1;
-            deadline.tv_usec %= 1000000;
-            m_deadline = deadline;
+            u64 ticks = timeval_to_ticks(socket.receive_timeout());
+            set_timeout(g_uptime + ticks, TimerQueue::default_slack(ticks));
         }
     }
 }
 
-bool Thread::ReadBlocker::should_unblock(Thread&, time_t now_sec, long now_usec)
+bool Thread::ReadBlocker::should_unblock(Thread&, time_t, long)
 {
-    if (m_deadline.has_value()) {
-        bool timed_out = now_sec > m_deadline.value().tv_sec || (now_sec == m_deadline.value().tv_sec && now_usec >= m_deadline.value().tv_usec);
-        return timed_out || blocked_description().can_read();
-    }
     return blocked_description().can_read();
 }
 
@@ -199,32 +193,46 @@ bool Thread::ConditionBlocker::should_unblock(Thread&, time_t, long)
     return m_block_until_condition();
 }
 
-Thread::SleepBlocker::SleepBlocker(u64 wakeup_time)
-    : m_wakeup_time(wakeup_time)
+Thread::SleepBlocker::SleepBlocker(u64 wakeup_time, u64 deadline_nanoseconds)
+    : m_deadline_nanoseconds(deadline_nanoseconds)
 {
+    // With a precise deadline, should_unblock() lets us go as soon as it passes and the timeout is only a backstop.
+    u64 ticks = wakeup_time > g_uptime ? wakeup_time - g_uptime : 0;
+    set_timeout(wakeup_time, deadline_nanoseconds ? 0 : TimerQueue::default_slack(ticks));
 }
 
 bool Thread::SleepBlocker::should_unblock(Thread&, time_t, long)
 {
-    return m_wakeup_time <= g_uptime;
+    if (m_deadline_nanoseconds)
+        return m_deadline_nanoseconds <= TimeManagement::the().monotonic_nanoseconds();
+    return false;
+}
+
+Optional<u64> Thread::SleepBlocker::precise_deadline_nanoseconds() const
+{
+    if (m_deadline_nanoseconds)
+        return m_deadline_nanoseconds;
+    return {};
 }
 
 Thread::SelectBlocker::SelectBlocker(const timeval& tv, bool select_has_timeout, const FDVector& read_fds, const FDVector& write_fds, const FDVector& except_fds)
-    : m_select_timeout(tv)
-    , m_select_has_timeout(select_has_timeout)
-    , m_select_read_fds(read_fds)
+    : m_select_read_fds(read_fds)
     , m_select_write_fds(write_fds)
     , m_select_exceptional_fds(except_fds)
 {
+    if (select_has_timeout) {
+        // The deadline is relative to Scheduler::time_since_boot().
+        timeval now = Scheduler::time_since_boot();
+        timeval remaining { 0, 0 };
+        if (tv.tv_sec > now.tv_sec || (tv.tv_sec == now.tv_sec && tv.tv_usec > now.tv_usec))
+            timeval_sub(tv, now, remaining);
+        u64 ticks = timeval_to_ticks(remaining);
+        set_timeout(g_uptime + ticks, TimerQueue::default_slack(ticks));
+    }
 }
 
-bool Thread::SelectBlocker::should_unblock(Thread& thread, time_t now_sec, long now_usec)
+bool Thread::SelectBlocker::should_unblock(Thread& thread, time_t, long)
 {
-    if (m_select_has_timeout) {
-        if (now_sec > m_select_timeout.tv_sec || (now_sec == m_select_timeout.tv_sec && now_usec >= m_select_timeout.tv_usec))
-            return true;
-    }
-
     auto& process = thread.process();
     for (int fd : m_select_read_fds) {
         if (!process.m_fds[fd])
@@ -308,7 +316,7 @@ void Thread::consider_unblock(time_t now_sec, long now_usec)
         return;
     case Thread::Blocked:
         ASSERT(m_blocker != nullptr);
-        if (m_blocker->should_unblock(*this, now_sec, now_usec))
+        if (m_blocker->has_timed_out() || m_blocker->should_unblock(*this, now_sec, now_usec))
             unblock();
         return;
     case Thread::Skip1SchedulerPass:
@@ -320,6 +328,43 @@ void Thread::consider_unblock(time_t now_sec, long now_usec)
     }
 }
 
+Optional<u64> Thread::wakeup_deadline_nanoseconds(u64 now_nanoseconds) const
+{
+    switch (state()) {
+    case Thread::Blocked:
+        // Tick-granular timeouts are on the TimerQueue, which next_wakeup_nanoseconds() looks at already.
+        ASSERT(m_blocker != nullptr);
+        return m_blocker->precise_deadline_nanoseconds();
+    case Thread::Skip1SchedulerPass:
+    case Thread::Skip0SchedulerPasses:
+        // These only need another scheduler pass to become runnable.
+        return now_nanoseconds;
+    default:
+        return {};
+    }
+}
+
+u64 Scheduler::next_wakeup_nanoseconds(u64 now_nanoseconds, u64 max_idle_nanoseconds)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    u64 deadline = now_nanoseconds + max_idle_nanoseconds;
+
+    if (auto timer_due = TimerQueue::the().next_timer_due()) {
+        // TimerQueue::fire() runs timers once g_uptime has reached their expiry.
+        u64 ticks = timer_due > g_uptime ? timer_due - g_uptime : 0;
+        deadline = min(deadline, now_nanoseconds + ticks * TimeManagement::the().nanoseconds_per_tick());
+    }
+
+    for_each_nonrunnable([&](Thread& thread) {
+        auto thread_deadline = thread.wakeup_deadline_nanoseconds(now_nanoseconds);
+        if (thread_deadline.has_value())
+            deadline = min(deadline, thread_deadline.value());
+        return IterationDecision::Continue;
+    });
+
+    return deadline;
+}
+
 bool Scheduler::pick_next()
 {
     ASSERT_INTERRUPTS_DISABLED();
@@ -329,7 +374,7 @@ bool Scheduler::pick_next()
 
     ASSERT(s_active);
 
-    if (!Thread::current) {
+    if (!Thread::current()) {
         // XXX: The first ever context_switch() goes to the idle process.
         //      This to setup a reliable place we can return to.
         return context_switch(*g_colonel);
@@ -348,7 +393,7 @@ bool Scheduler::pick_next()
 
     Process::for_each([&](Process& process) {
         if (process.is_dead()) {
-            if (Process::current->pid() != process.pid() && (!process.ppid() || !Process::from_pid(process.ppid()))) {
+            if (Process::current()->pid() != process.pid() && (!process.ppid() || !Process::from_pid(process.ppid()))) {
                 auto name = process.name();
                 auto pid = process.pid();
                 auto exit_status = Process::reap(process);
@@ -356,10 +401,6 @@ bool Scheduler::pick_next()
             }
             return IterationDecision::Continue;
         }
-        if (process.m_alarm_deadline && g_uptime > process.m_alarm_deadline) {
-            process.m_alarm_deadline = 0;
-            process.send_signal(SIGALRM, nullptr);
-        }
         return IterationDecision::Continue;
     });
 
@@ -370,7 +411,7 @@ bool Scheduler::pick_next()
         // FIXME: It would be nice if the Scheduler didn't have to worry about who is "current"
         //        For now, avoid dispatching signals to "current" and do it in a scheduling pass
         //        while some other process is interrupted. Otherwise a mess will be made.
-        if (&thread == Thread::current)
+        if (&thread == Thread::current())
             return IterationDecision::Continue;
         // We know how to interrupt blocked processes, but if they are just executing
         // at some random point in the kernel, let them continue.
@@ -448,7 +489,7 @@ bool Scheduler::donate_to(Thread* beneficiary, const char* reason)
         return false;
 
     (void)reason;
-    unsigned ticks_left = Thread::current->ticks_left();
+    unsigned ticks_left = Thread::current()->ticks_left();
     if (!beneficiary || beneficiary->state() != Thread::Runnable || ticks_left <= 1)
         return yield();
 
@@ -465,7 +506,7 @@ bool Scheduler::donate_to(Thread* beneficiary, const char* reason)
 bool Scheduler::yield()
 {
     InterruptDisabler disabler;
-    ASSERT(Thread::current);
+    ASSERT(Thread::current());
     if (!pick_next())
         return false;
     switch_now();
@@ -481,10 +522,68 @@ void Scheduler::pick_next_and_switch_now()
 
 void Scheduler::switch_now()
 {
-    Descriptor& descriptor = get_gdt_entry(Thread::current->selector());
+    Descriptor& descriptor = get_gdt_entry(Thread::current()->selector());
     descriptor.type = 9;
     asm("sti\n"
-        "ljmp *(%%eax)\n" ::"a"(&Thread::current->far_ptr()));
+        "ljmp *(%%eax)\n" ::"a"(&Thread::current()->far_ptr()));
+}
+
+static void trace_context_switch(Thread& outgoing_thread, Thread& incoming_thread)
+{
+    bool tracing_context_switches = Tracing::is_enabled(Tracing::Tracepoint::ContextSwitch);
+    bool tracing_syscalls = Tracing::is_enabled(Tracing::Tracepoint::Syscall);
+    if (!tracing_context_switches)
+        s_last_context_switch_tsc = 0;
+    if (!tracing_syscalls)
+        incoming_thread.set_off_cpu_tsc(0);
+
+    // The wakeup timestamp is only taken while wakeups are being traced, so this is the common case.
+    if (!tracing_context_switches && !tracing_syscalls && !incoming_thread.wakeup_tsc())
+        return;
+
+    u64 now = read_tsc();
+
+    if (incoming_thread.wakeup_tsc()) {
+        Tracing::record(Tracing::Tracepoint::Wakeup, now - incoming_thread.wakeup_tsc());
+        incoming_thread.set_wakeup_tsc(0);
+    }
+
+    if (tracing_syscalls) {
+        outgoing_thread.set_off_cpu_tsc(now);
+        if (incoming_thread.off_cpu_tsc()) {
+            incoming_thread.add_off_cpu_cycles(now - incoming_thread.off_cpu_tsc());
+            incoming_thread.set_off_cpu_tsc(0);
+        }
+    }
+
+    if (!tracing_context_switches)
+        return;
+
+    // We classify the switch by what the outgoing thread is doing right now.
+    switch (outgoing_thread.state()) {
+    case Thread::Running:
+        Tracing::did_context_switch(s_preempting ? Tracing::ContextSwitchReason::Preempted : Tracing::ContextSwitchReason::Yielded);
+        break;
+    case Thread::Blocked:
+    case Thread::Queued:
+        Tracing::did_context_switch(Tracing::ContextSwitchReason::Blocked);
+        break;
+    case Thread::Stopped:
+        Tracing::did_context_switch(Tracing::ContextSwitchReason::Stopped);
+        break;
+    case Thread::Dying:
+    case Thread::Dead:
+        Tracing::did_context_switch(Tracing::ContextSwitchReason::Exited);
+        break;
+    default:
+        Tracing::did_context_switch(Tracing::ContextSwitchReason::Yielded);
+        break;
+    }
+
+    // The recorded latency is how long the outgoing thread got to run.
+    if (s_last_context_switch_tsc)
+        Tracing::record(Tracing::Tracepoint::ContextSwitch, now - s_last_context_switch_tsc);
+    s_last_context_switch_tsc = now;
 }
 
 bool Scheduler::context_switch(Thread& thread)
@@ -492,50 +591,51 @@ bool Scheduler::context_switch(Thread& thread)
     thread.set_ticks_left(time_slice_for(thread));
     thread.did_schedule();
 
-    if (Thread::current == &thread)
+    if (Thread::current() == &thread)
         return false;
 
-    if (Thread::current) {
+    if (Thread::current()) {
+        trace_context_switch(*Thread::current(), thread);
+
         // If the last process hasn't blocked (still marked as running),
         // mark it as runnable for the next round.
-        if (Thread::current->state() == Thread::Running)
-            Thread::current->set_state(Thread::Runnable);
+        if (Thread::current()->state() == Thread::Running)
+            Thread::current()->set_state(Thread::Runnable);
 
         asm volatile("fxsave %0"
-                     : "=m"(Thread::current->fpu_state()));
+                     : "=m"(Thread::current()->fpu_state()));
 
 #ifdef LOG_EVERY_CONTEXT_SWITCH
-        dbg() << "Scheduler: " << *Thread::current << " -> " << thread << " [" << thread.priority() << "] " << String::format("%w", thread.tss().cs) << ":" << String::format("%x", thread.tss().eip);
+        dbg() << "Scheduler: " << *Thread::current() << " -> " << thread << " [" << thread.priority() << "] " << String::format("%w", thread.tss().cs) << ":" << String::format("%x", thread.tss().eip);
 #endif
     }
 
-    Thread::current = &thread;
-    Process::current = &thread.process();
+    Processor::current().set_current_thread(&thread);
 
     thread.set_state(Thread::Running);
 
-    asm volatile("fxrstor %0" ::"m"(Thread::current->fpu_state()));
+    asm volatile("fxrstor %0" ::"m"(Thread::current()->fpu_state()));
 
-    if (!thread.selector()) {
+    if (!thread.selector())
         thread.set_selector(gdt_alloc_entry());
-        auto& descriptor = get_gdt_entry(thread.selector());
-        descriptor.set_base(&thread.tss());
-        descriptor.set_limit(sizeof(TSS32));
-        descriptor.dpl = 0;
-        descriptor.segment_present = 1;
-        descriptor.granularity = 0;
-        descriptor.zero = 0;
-        descriptor.operation_size = 1;
-        descriptor.descriptor_type = 0;
-    }
+
+    // Every processor has its own GDT, and this one may not have run the thread before.
+    auto& descriptor = get_gdt_entry(thread.selector());
+    descriptor.set_base(&thread.tss());
+    descriptor.set_limit(sizeof(TSS32));
+    descriptor.dpl = 0;
+    descriptor.segment_present = 1;
+    descriptor.granularity = 0;
+    descriptor.zero = 0;
+    descriptor.operation_size = 1;
+    descriptor.descriptor_type = 0;
 
     if (!thread.thread_specific_data().is_null()) {
-        auto& descriptor = thread_specific_descriptor();
-        descriptor.set_base(thread.thread_specific_data().as_ptr());
-        descriptor.set_limit(sizeof(ThreadSpecificData*));
+        auto& tls_descriptor = thread_specific_descriptor();
+        tls_descriptor.set_base(thread.thread_specific_data().as_ptr());
+        tls_descriptor.set_limit(sizeof(ThreadSpecificData*));
     }
 
-    auto& descriptor = get_gdt_entry(thread.selector());
     descriptor.type = 11; // Busy TSS
     return true;
 }
@@ -559,7 +659,7 @@ void Scheduler::prepare_for_iret_to_new_process()
 {
     auto& descriptor = get_gdt_entry(s_redirection.selector);
     descriptor.type = 9;
-    s_redirection.tss.backlink = Thread::current->selector();
+    s_redirection.tss.backlink = Thread::current()->selector();
     load_task_register(s_redirection.selector);
 }
 
@@ -568,7 +668,7 @@ void Scheduler::prepare_to_modify_tss(Thread& thread)
     // This ensures that a currently running process modifying its own TSS
     // in order to yield() and end up somewhere else doesn't just end up
     // right after the yield().
-    if (Thread::current == &thread)
+    if (Thread::current() == &thread)
         load_task_register(s_redirection.selector);
 }
 
@@ -589,38 +689,46 @@ void Scheduler::initialize()
     load_task_register(s_redirection.selector);
 }
 
-void Scheduler::timer_tick(const RegisterState& regs)
+void Scheduler::timer_tick(const RegisterState& regs, u32 elapsed_ticks)
 {
-    if (!Thread::current)
+    if (!Thread::current())
         return;
 
-    ++g_uptime;
+    g_uptime += elapsed_ticks;
 
     timeval tv;
     tv.tv_sec = TimeManagement::the().epoch_time();
     tv.tv_usec = TimeManagement::the().ticks_this_second() * 1000;
     Process::update_info_page_timestamp(tv);
 
-    if (Process::current->is_profiling()) {
+    if (Profiling::is_system_wide() || Process::current()->is_profiling()) {
         SmapDisabler disabler;
-        auto backtrace = Thread::current->raw_backtrace(regs.ebp);
-        auto& sample = Profiling::next_sample_slot();
-        sample.pid = Process::current->pid();
-        sample.tid = Thread::current->tid();
-        sample.timestamp = g_uptime;
-        for (size_t i = 0; i < min(backtrace.size(), Profiling::max_stack_frame_count); ++i) {
-            sample.frames[i] = backtrace[i];
+        if (auto* sample = Profiling::next_sample_slot()) {
+            auto backtrace = Thread::current()->raw_backtrace(regs.ebp);
+            sample->pid = Process::current()->pid();
+            sample->tid = Thread::current()->tid();
+            sample->timestamp = g_uptime;
+            size_t frame_count = min(backtrace.size(), Profiling::max_stack_frame_count);
+            for (size_t i = 0; i < frame_count; ++i)
+                sample->frames[i] = backtrace[i];
+            if (frame_count < Profiling::max_stack_frame_count)
+                sample->frames[frame_count] = 0;
         }
     }
 
     TimerQueue::the().fire();
 
-    if (Thread::current->tick())
+    if (Thread::current()->tick())
         return;
 
-    auto& outgoing_tss = Thread::current->tss();
+    auto& outgoing_tss = Thread::current()->tss();
 
-    if (!pick_next())
+    bool did_pick_next;
+    {
+        TemporaryChange<bool> change(s_preempting, true);
+        did_pick_next = pick_next();
+    }
+    if (!did_pick_next)
         return;
 
     outgoing_tss.gs = regs.gs;
@@ -658,9 +766,12 @@ void Scheduler::timer_tick(const RegisterState& regs)
 
 static bool s_should_stop_idling = false;
 
+// Wake up at least this often, so a 32-bit HPET main counter can't wrap around unnoticed.
+static constexpr u64 max_tickless_idle_nanoseconds = 1000000000ull;
+
 void Scheduler::stop_idling()
 {
-    if (Thread::current != g_colonel)
+    if (Thread::current() != g_colonel)
         return;
 
     s_should_stop_idling = true;
@@ -669,6 +780,21 @@ void Scheduler::stop_idling()
 void Scheduler::idle_loop()
 {
     for (;;) {
+        if (TimeManagement::the().is_tickless()) {
+            // Sleep until the next deadline instead of waking up on every tick.
+            // Any interrupt may have made a blocked thread runnable, so always reschedule afterwards.
+            cli();
+            auto now = TimeManagement::the().monotonic_nanoseconds();
+            if (TimeManagement::the().set_idle_wakeup(next_wakeup_nanoseconds(now, max_tickless_idle_nanoseconds)))
+                asm volatile("sti\nhlt");
+            TimeManagement::the().wake_from_idle();
+            // g_uptime may have jumped ahead past timers that the interrupt which woke us up didn't see yet.
+            TimerQueue::the().fire();
+            sti();
+            s_should_stop_idling = false;
+            yield();
+            continue;
+        }
         asm("hlt");
         if (s_should_stop_idling) {
             s_should_stop_idling = false;
@@ -50,7 +50,7 @@ extern SchedulerData* g_scheduler_data;
 class Scheduler {
 public:
     static void initialize();
-    static void timer_tick(const RegisterState&);
+    static void timer_tick(const RegisterState&, u32 elapsed_ticks = 1);
     static bool pick_next();
     static timeval time_since_boot();
     static void pick_next_and_switch_now();
@@ -64,6 +64,7 @@ public:
     static void beep();
     static void idle_loop();
     static void stop_idling();
+    static u64 next_wakeup_nanoseconds(u64 now_nanoseconds, u64 max_idle_nanoseconds);
 
     template<typename Callback>
     static inline IterationDecision for_each_runnable(Callback);
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Noncopyable.h>
+#include <AK/Types.h>
+#include <Kernel/Arch/i386/CPU.h>
+
+namespace Kernel {
+
+// A SpinLock protects short critical sections that may be entered from any processor.
+// Taking it disables interrupts on the local processor, so it also covers everything
+// that InterruptDisabler used to protect on a single processor.
+// Never block or yield while holding a SpinLock.
+class SpinLock {
+    AK_MAKE_NONCOPYABLE(SpinLock);
+
+public:
+    SpinLock() {}
+
+    u32 lock()
+    {
+        u32 flags = cpu_flags();
+        cli();
+        while (m_lock.exchange(1, AK::memory_order_acquire) != 0) {
+            do {
+                asm volatile("pause");
+            } while (m_lock.load(AK::memory_order_relaxed));
+        }
+        return flags;
+    }
+
+    void unlock(u32 previous_flags)
+    {
+        ASSERT(is_locked());
+        m_lock.store(0, AK::memory_order_release);
+        if (previous_flags & 0x200)
+            sti();
+    }
+
+    bool is_locked() const { return m_lock.load(AK::memory_order_relaxed) != 0; }
+
+private:
+    Atomic<u32> m_lock { 0 };
+};
+
+// Like SpinLock, but the processor already holding it may take it again.
+class RecursiveSpinLock {
+    AK_MAKE_NONCOPYABLE(RecursiveSpinLock);
+
+public:
+    RecursiveSpinLock() {}
+
+    u32 lock()
+    {
+        u32 flags = cpu_flags();
+        cli();
+        FlatPtr processor = (FlatPtr)&Processor::current();
+        FlatPtr expected = 0;
+        while (!m_owner.compare_exchange_strong(expected, processor, AK::memory_order_acquire)) {
+            if (expected == processor)
+                break;
+            expected = 0;
+            asm volatile("pause");
+        }
+        ++m_recursions;
+        return flags;
+    }
+
+    void unlock(u32 previous_flags)
+    {
+        ASSERT(m_recursions);
+        ASSERT(m_owner.load(AK::memory_order_relaxed) == (FlatPtr)&Processor::current());
+        if (--m_recursions == 0)
+            m_owner.store(0, AK::memory_order_release);
+        if (previous_flags & 0x200)
+            sti();
+    }
+
+    bool is_locked() const { return m_owner.load(AK::memory_order_relaxed) != 0; }
+
+private:
+    Atomic<FlatPtr> m_owner { 0 };
+    u32 m_recursions { 0 };
+};
+
+template<typename LockType>
+class ScopedSpinLock {
+    AK_MAKE_NONCOPYABLE(ScopedSpinLock);
+
+public:
+    explicit ScopedSpinLock(LockType& lock)
+        : m_lock(lock)
+    {
+        m_previous_flags = m_lock.lock();
+    }
+
+    ~ScopedSpinLock()
+    {
+        m_lock.unlock(m_previous_flags);
+    }
+
+private:
+    LockType& m_lock;
+    u32 m_previous_flags { 0 };
+};
+
+}
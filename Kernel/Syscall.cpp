@@ -29,6 +29,7 @@
 #include <Kernel/Random.h>
 #include <Kernel/Syscall.h>
 #include <Kernel/ThreadTracer.h>
+#include <Kernel/Tracing.h>
 #include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
@@ -49,6 +50,8 @@ asm(
     "    mov $0x10, %ax\n"
     "    mov %ax, %ds\n"
     "    mov %ax, %es\n"
+    "    mov $0x30, %ax\n"
+    "    mov %ax, %fs\n"
     "    cld\n"
     "    xor %esi, %esi\n"
     "    xor %edi, %edi\n"
@@ -86,8 +89,8 @@ static Handler s_syscall_table[] = {
 int handle(RegisterState& regs, u32 function, u32 arg1, u32 arg2, u32 arg3)
 {
     ASSERT_INTERRUPTS_ENABLED();
-    auto& process = *Process::current;
-    Thread::current->did_syscall();
+    auto& process = *Process::current();
+    Thread::current()->did_syscall();
 
     if (function == SC_exit || function == SC_exit_thread) {
         // These syscalls need special handling since they never return to the caller.
@@ -125,14 +128,14 @@ void syscall_handler(RegisterState& regs)
     // Special handling of the "gettid" syscall since it's extremely hot.
     // FIXME: Remove this hack once userspace locks stop calling it so damn much.
     if (regs.eax == SC_gettid) {
-        regs.eax = Process::current->sys$gettid();
-        Thread::current->did_syscall();
+        regs.eax = Process::current()->sys$gettid();
+        Thread::current()->did_syscall();
         return;
     }
 
-    if (Thread::current->tracer() && Thread::current->tracer()->is_tracing_syscalls()) {
-        Thread::current->tracer()->set_trace_syscalls(false);
-        Thread::current->tracer_trap(regs);
+    if (Thread::current()->tracer() && Thread::current()->tracer()->is_tracing_syscalls()) {
+        Thread::current()->tracer()->set_trace_syscalls(false);
+        Thread::current()->tracer_trap(regs);
     }
 
     // Make sure SMAP protection is enabled on syscall entry.
@@ -144,7 +147,7 @@ void syscall_handler(RegisterState& regs)
     asm volatile(""
                  : "=m"(*ptr));
 
-    auto& process = *Process::current;
+    auto& process = *Process::current();
 
     if (!MM.validate_user_stack(process, VirtualAddress(regs.userspace_esp))) {
         dbg() << "Invalid stack pointer: " << String::format("%p", regs.userspace_esp);
@@ -170,20 +173,28 @@ void syscall_handler(RegisterState& regs)
     u32 arg1 = regs.edx;
     u32 arg2 = regs.ecx;
     u32 arg3 = regs.ebx;
+    u64 syscall_start = Tracing::is_enabled(Tracing::Tracepoint::Syscall) ? read_tsc() : 0;
+    u64 off_cpu_cycles_before = Thread::current()->off_cpu_cycles();
     regs.eax = (u32)Syscall::handle(regs, function, arg1, arg2, arg3);
+    if (syscall_start) {
+        // Don't count the time this thread spent blocked (or preempted) in the middle of the syscall.
+        u64 cycles = read_tsc() - syscall_start;
+        u64 off_cpu_cycles = Thread::current()->off_cpu_cycles() - off_cpu_cycles_before;
+        Tracing::did_syscall(function, cycles > off_cpu_cycles ? cycles - off_cpu_cycles : 0);
+    }
 
-    if (Thread::current->tracer() && Thread::current->tracer()->is_tracing_syscalls()) {
-        Thread::current->tracer()->set_trace_syscalls(false);
-        Thread::current->tracer_trap(regs);
+    if (Thread::current()->tracer() && Thread::current()->tracer()->is_tracing_syscalls()) {
+        Thread::current()->tracer()->set_trace_syscalls(false);
+        Thread::current()->tracer_trap(regs);
     }
 
     process.big_lock().unlock();
 
     // Check if we're supposed to return to userspace or just die.
-    Thread::current->die_if_needed();
+    Thread::current()->die_if_needed();
 
-    if (Thread::current->has_unmasked_pending_signals())
-        (void)Thread::current->block<Thread::SemiPermanentBlocker>(Thread::SemiPermanentBlocker::Reason::Signal);
+    if (Thread::current()->has_unmasked_pending_signals())
+        (void)Thread::current()->block<Thread::SemiPermanentBlocker>(Thread::SemiPermanentBlocker::Reason::Signal);
 }
 
 }
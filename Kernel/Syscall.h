@@ -182,7 +182,8 @@ namespace Kernel {
     __ENUMERATE_SYSCALL(perf_event)           \
     __ENUMERATE_SYSCALL(shutdown)             \
     __ENUMERATE_SYSCALL(get_stack_bounds)     \
-    __ENUMERATE_SYSCALL(ptrace)
+    __ENUMERATE_SYSCALL(ptrace)               \
+    __ENUMERATE_SYSCALL(posix_spawn)
 
 namespace Syscall {
 
@@ -362,6 +363,34 @@ struct SC_execve_params {
     StringListArgument environment;
 };
 
+enum class SpawnFileActionType : int {
+    Open,
+    Close,
+    Dup2,
+    Chdir,
+};
+
+struct SC_posix_spawn_file_action {
+    SpawnFileActionType type;
+    int fd;
+    int new_fd;
+    int flags;
+    u16 mode;
+    StringArgument path;
+};
+
+struct SC_posix_spawn_params {
+    StringArgument path;
+    StringListArgument arguments;
+    StringListArgument environment;
+    const SC_posix_spawn_file_action* file_actions;
+    size_t file_action_count;
+    int flags;
+    int pgroup;
+    u32 sigmask;
+    int tcsetpgrp_fd;
+};
+
 struct SC_readlink_params {
     StringArgument path;
     MutableBufferArgument<char, size_t> buffer;
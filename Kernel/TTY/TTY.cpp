@@ -282,7 +282,7 @@ void TTY::set_termios(const termios& t)
 int TTY::ioctl(FileDescription&, unsigned request, unsigned arg)
 {
     REQUIRE_PROMISE(tty);
-    auto& process = *Process::current;
+    auto& process = *Process::current();
     pid_t pgid;
     termios* tp;
     winsize* ws;
@@ -308,7 +308,7 @@ int TTY::ioctl(FileDescription&, unsigned request, unsigned arg)
                 return -EPERM;
             if (pgid != process->pgid())
                 return -EPERM;
-            if (Process::current->sid() != process->sid())
+            if (Process::current()->sid() != process->sid())
                 return -EPERM;
         }
         m_pgid = pgid;
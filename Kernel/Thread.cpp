@@ -34,6 +34,9 @@
 #include <Kernel/Scheduler.h>
 #include <Kernel/Thread.h>
 #include <Kernel/ThreadTracer.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
+#include <Kernel/Tracing.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
 #include <Kernel/VM/ProcessPagingScope.h>
@@ -45,25 +48,11 @@
 
 namespace Kernel {
 
-Thread* Thread::current;
-
 static FPUState s_clean_fpu_state;
 
 u16 thread_specific_selector()
 {
-    static u16 selector;
-    if (!selector) {
-        selector = gdt_alloc_entry();
-        auto& descriptor = get_gdt_entry(selector);
-        descriptor.dpl = 3;
-        descriptor.segment_present = 1;
-        descriptor.granularity = 0;
-        descriptor.zero = 0;
-        descriptor.operation_size = 1;
-        descriptor.descriptor_type = 1;
-        descriptor.type = 2;
-    }
-    return selector;
+    return GDT_SELECTOR_TLS;
 }
 
 Descriptor& thread_specific_descriptor()
@@ -102,23 +91,25 @@ Thread::Thread(Process& process)
 
     // Only IF is set when a process boots.
     m_tss.eflags = 0x0202;
-    u16 cs, ds, ss, gs;
+    u16 cs, ds, ss, fs, gs;
 
     if (m_process.is_ring0()) {
         cs = 0x08;
         ds = 0x10;
         ss = 0x10;
+        fs = GDT_SELECTOR_PROC;
         gs = 0;
     } else {
         cs = 0x1b;
         ds = 0x23;
         ss = 0x23;
+        fs = 0x23;
         gs = thread_specific_selector() | 3;
     }
 
     m_tss.ds = ds;
     m_tss.es = ds;
-    m_tss.fs = ds;
+    m_tss.fs = fs;
     m_tss.gs = gs;
     m_tss.ss = ss;
     m_tss.cs = cs;
@@ -163,7 +154,7 @@ Thread::~Thread()
 
 void Thread::unblock()
 {
-    if (current == this) {
+    if (Thread::current() == this) {
         if (m_should_die)
             set_state(Thread::Dying);
         else
@@ -208,7 +199,7 @@ void Thread::set_should_die()
 
 void Thread::die_if_needed()
 {
-    ASSERT(current == this);
+    ASSERT(Thread::current() == this);
 
     if (!m_should_die)
         return;
@@ -240,11 +231,33 @@ void Thread::relock_process()
     process().big_lock().lock();
 }
 
+u64 Thread::add_blocker_timeout(Blocker& blocker)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(blocker.timeout().has_value());
+    auto timer = make<Timer>();
+    // A timeout that is already due still has to wait for the next tick, the TimerQueue only takes future timers.
+    timer->expires = max(blocker.timeout().value(), g_uptime + 1);
+    timer->slack = blocker.timeout_slack();
+    // The timer is cancelled before block() returns, so the blocker outlives it.
+    timer->callback = [this, &blocker] {
+        blocker.m_has_timed_out = true;
+        if (state() == Thread::Blocked)
+            unblock();
+    };
+    return TimerQueue::the().add_timer(move(timer));
+}
+
+void Thread::cancel_blocker_timeout(u64 timer_id)
+{
+    TimerQueue::the().cancel_timer(timer_id);
+}
+
 u64 Thread::sleep(u32 ticks)
 {
     ASSERT(state() == Thread::Running);
     u64 wakeup_time = g_uptime + ticks;
-    auto ret = Thread::current->block<Thread::SleepBlocker>(wakeup_time);
+    auto ret = Thread::current()->block<Thread::SleepBlocker>(wakeup_time);
     if (wakeup_time > g_uptime) {
         ASSERT(ret != Thread::BlockResult::WokeNormally);
     }
@@ -254,12 +267,26 @@ u64 Thread::sleep(u32 ticks)
 u64 Thread::sleep_until(u64 wakeup_time)
 {
     ASSERT(state() == Thread::Running);
-    auto ret = Thread::current->block<Thread::SleepBlocker>(wakeup_time);
+    auto ret = Thread::current()->block<Thread::SleepBlocker>(wakeup_time);
     if (wakeup_time > g_uptime)
         ASSERT(ret != Thread::BlockResult::WokeNormally);
     return wakeup_time;
 }
 
+bool Thread::sleep_until_nanoseconds(u64 deadline_nanoseconds)
+{
+    ASSERT(state() == Thread::Running);
+    auto& time_management = TimeManagement::the();
+    u64 now = time_management.monotonic_nanoseconds();
+    if (deadline_nanoseconds <= now)
+        return true;
+    // The tick-based wakeup time is only a fallback, the blocker checks the precise deadline itself.
+    u64 nanoseconds_per_tick = time_management.nanoseconds_per_tick();
+    u64 wakeup_time = g_uptime + (deadline_nanoseconds - now + nanoseconds_per_tick - 1) / nanoseconds_per_tick;
+    auto ret = Thread::current()->block<Thread::SleepBlocker>(wakeup_time, deadline_nanoseconds);
+    return ret == Thread::BlockResult::WokeNormally;
+}
+
 const char* Thread::state_string() const
 {
     switch (state()) {
@@ -292,7 +319,7 @@ const char* Thread::state_string() const
 
 void Thread::finalize()
 {
-    ASSERT(current == g_finalizer);
+    ASSERT(Thread::current() == g_finalizer);
 
 #ifdef THREAD_DEBUG
     dbg() << "Finalizing thread " << *this;
@@ -314,7 +341,7 @@ void Thread::finalize()
 
 void Thread::finalize_dying_threads()
 {
-    ASSERT(current == g_finalizer);
+    ASSERT(Thread::current() == g_finalizer);
     Vector<Thread*, 32> dying_threads;
     {
         InterruptDisabler disabler;
@@ -757,6 +784,9 @@ void Thread::set_state(State new_state)
         ASSERT(m_blocker != nullptr);
     }
 
+    if (new_state == Runnable && (m_state == Blocked || m_state == Queued) && Tracing::is_enabled(Tracing::Tracepoint::Wakeup))
+        m_wakeup_tsc = read_tsc();
+
     m_state = new_state;
     if (m_process.pid() != 0) {
         Scheduler::update_state_for_thread(*this);
@@ -809,7 +839,7 @@ String Thread::backtrace_impl() const
     Vector<RecognizedSymbol, 128> recognized_symbols;
 
     u32 start_frame;
-    if (current == this) {
+    if (Thread::current() == this) {
         asm volatile("movl %%ebp, %%eax"
                      : "=a"(start_frame));
     } else {
@@ -888,7 +918,7 @@ void Thread::wait_on(WaitQueue& queue, Atomic<bool>* lock, Thread* beneficiary,
     if (lock)
         *lock = false;
     set_state(State::Queued);
-    queue.enqueue(*current);
+    queue.enqueue(*Thread::current());
     // Yield and wait for the queue to wake us up again.
     if (beneficiary)
         Scheduler::donate_to(beneficiary, reason);
@@ -67,7 +67,7 @@ class Thread {
     friend class Scheduler;
 
 public:
-    static Thread* current;
+    static Thread* current() { return Processor::current().current_thread(); }
 
     explicit Thread(Process&);
     ~Thread();
@@ -123,12 +123,30 @@ public:
         virtual bool should_unblock(Thread&, time_t now_s, long us) = 0;
         virtual const char* state_string() const = 0;
         virtual bool is_reason_signal() const { return false; }
+        // A deadline finer than a tick, in monotonic nanoseconds since boot, that the tickless idle loop should wake up for.
+        virtual Optional<u64> precise_deadline_nanoseconds() const { return {}; }
         void set_interrupted_by_death() { m_was_interrupted_by_death = true; }
         bool was_interrupted_by_death() const { return m_was_interrupted_by_death; }
         void set_interrupted_by_signal() { m_was_interrupted_while_blocked = true; }
         bool was_interrupted_by_signal() const { return m_was_interrupted_while_blocked; }
 
+        // The g_uptime tick at which this blocker times out, if it has a timeout at all.
+        // Thread::block() queues it on the TimerQueue rather than having the scheduler poll for it.
+        const Optional<u64>& timeout() const { return m_timeout; }
+        u64 timeout_slack() const { return m_timeout_slack; }
+        bool has_timed_out() const { return m_has_timed_out; }
+
+    protected:
+        void set_timeout(u64 timeout, u64 slack = 0)
+        {
+            m_timeout = timeout;
+            m_timeout_slack = slack;
+        }
+
     private:
+        Optional<u64> m_timeout;
+        u64 m_timeout_slack { 0 };
+        bool m_has_timed_out { false };
         bool m_was_interrupted_while_blocked { false };
         bool m_was_interrupted_by_death { false };
         friend class Thread;
@@ -176,9 +194,6 @@ public:
         explicit WriteBlocker(const FileDescription&);
         virtual bool should_unblock(Thread&, time_t, long) override;
         virtual const char* state_string() const override { return "Writing"; }
-
-    private:
-        Optional<timeval> m_deadline;
     };
 
     class ReadBlocker final : public FileDescriptionBlocker {
@@ -186,9 +201,6 @@ public:
         explicit ReadBlocker(const FileDescription&);
         virtual bool should_unblock(Thread&, time_t, long) override;
         virtual const char* state_string() const override { return "Reading"; }
-
-    private:
-        Optional<timeval> m_deadline;
     };
 
     class ConditionBlocker final : public Blocker {
@@ -204,12 +216,13 @@ public:
 
     class SleepBlocker final : public Blocker {
     public:
-        explicit SleepBlocker(u64 wakeup_time);
+        explicit SleepBlocker(u64 wakeup_time, u64 deadline_nanoseconds = 0);
         virtual bool should_unblock(Thread&, time_t, long) override;
         virtual const char* state_string() const override { return "Sleeping"; }
+        virtual Optional<u64> precise_deadline_nanoseconds() const override;
 
     private:
-        u64 m_wakeup_time { 0 };
+        u64 m_deadline_nanoseconds { 0 };
     };
 
     class SelectBlocker final : public Blocker {
@@ -220,8 +233,6 @@ public:
         virtual const char* state_string() const override { return "Selecting"; }
 
     private:
-        timeval m_select_timeout;
-        bool m_select_has_timeout { false };
         const FDVector& m_select_read_fds;
         const FDVector& m_select_write_fds;
         const FDVector& m_select_exceptional_fds;
@@ -283,6 +294,7 @@ public:
 
     u64 sleep(u32 ticks);
     u64 sleep_until(u64 wakeup_time);
+    bool sleep_until_nanoseconds(u64 deadline_nanoseconds);
 
     enum class BlockResult {
         WokeNormally,
@@ -298,8 +310,15 @@ public:
         ASSERT(m_blocker == nullptr);
 
         T t(forward<Args>(args)...);
-        m_blocker = &t;
-        set_state(Thread::Blocked);
+        u64 timeout_timer_id = 0;
+        {
+            // Queue the timeout together with blocking, so the timer interrupt can't come in between.
+            InterruptDisabler disabler;
+            m_blocker = &t;
+            set_state(Thread::Blocked);
+            if (t.timeout().has_value())
+                timeout_timer_id = add_blocker_timeout(t);
+        }
 
         // Yield to the scheduler, and wait for us to resume unblocked.
         yield_without_holding_big_lock();
@@ -308,6 +327,8 @@ public:
         ASSERT(state() != Thread::Blocked);
 
         // Remove ourselves...
+        if (timeout_timer_id)
+            cancel_blocker_timeout(timeout_timer_id);
         m_blocker = nullptr;
 
         if (t.was_interrupted_by_signal())
@@ -340,6 +361,15 @@ public:
     void set_ticks_left(u32 t) { m_ticks_left = t; }
     u32 ticks_left() const { return m_ticks_left; }
 
+    u64 wakeup_tsc() const { return m_wakeup_tsc; }
+    void set_wakeup_tsc(u64 tsc) { m_wakeup_tsc = tsc; }
+
+    // Cycles spent switched out, only counted while syscalls are being traced. Blocking isn't part of a syscall's cost.
+    u64 off_cpu_cycles() const { return m_off_cpu_cycles; }
+    u64 off_cpu_tsc() const { return m_off_cpu_tsc; }
+    void set_off_cpu_tsc(u64 tsc) { m_off_cpu_tsc = tsc; }
+    void add_off_cpu_cycles(u64 cycles) { m_off_cpu_cycles += cycles; }
+
     u32 kernel_stack_base() const { return m_kernel_stack_base; }
     u32 kernel_stack_top() const { return m_kernel_stack_top; }
 
@@ -349,6 +379,7 @@ public:
     void send_urgent_signal_to_self(u8 signal);
     void send_signal(u8 signal, Process* sender);
     void consider_unblock(time_t now_sec, long now_usec);
+    Optional<u64> wakeup_deadline_nanoseconds(u64 now_nanoseconds) const;
 
     void set_dump_backtrace_on_finalization() { m_dump_backtrace_on_finalization = true; }
 
@@ -448,6 +479,8 @@ private:
     friend class WaitQueue;
     bool unlock_process_if_locked();
     void relock_process();
+    u64 add_blocker_timeout(Blocker&);
+    void cancel_blocker_timeout(u64 timer_id);
     String backtrace_impl() const;
     void reset_fpu_state();
 
@@ -458,6 +491,9 @@ private:
     u32 m_ticks { 0 };
     u32 m_ticks_left { 0 };
     u32 m_times_scheduled { 0 };
+    u64 m_wakeup_tsc { 0 };
+    u64 m_off_cpu_tsc { 0 };
+    u64 m_off_cpu_cycles { 0 };
     u32 m_pending_signals { 0 };
     u32 m_signal_mask { 0 };
     u32 m_kernel_stack_base { 0 };
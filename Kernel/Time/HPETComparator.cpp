@@ -72,6 +72,13 @@ void HPETComparator::set_new_countdown()
     HPET::the().set_non_periodic_comparator_value(*this, HPET::the().frequency() / m_frequency);
 }
 
+void HPETComparator::set_one_shot_countdown(u64 main_counter_ticks)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(!is_periodic());
+    HPET::the().set_non_periodic_comparator_value(*this, main_counter_ticks);
+}
+
 size_t HPETComparator::ticks_per_second() const
 {
     return m_frequency;
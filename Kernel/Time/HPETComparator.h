@@ -55,6 +55,9 @@ public:
     virtual bool is_capable_of_frequency(size_t frequency) const override;
     virtual size_t calculate_nearest_possible_frequency(size_t frequency) const override;
 
+    // Arms a non-periodic comparator to fire once, the given number of main counter ticks from now.
+    void set_one_shot_countdown(u64 main_counter_ticks);
+
 private:
     void set_new_countdown();
     virtual void handle_irq(const RegisterState&) override;
@@ -26,6 +26,7 @@
 
 #include <Kernel/ACPI/ACPIParser.h>
 #include <Kernel/KParams.h>
+#include <Kernel/KernelInfoPage.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/Time/HPET.h>
 #include <Kernel/Time/HPETComparator.h>
@@ -66,6 +67,7 @@ void TimeManagement::initialize(bool probe_non_legacy_hardware_timers)
 {
     ASSERT(!TimeManagement::initialized());
     s_time_management = new TimeManagement(probe_non_legacy_hardware_timers);
+    s_time_management->initialize_tsc_clock();
 }
 time_t TimeManagement::seconds_since_boot() const
 {
@@ -154,11 +156,16 @@ bool TimeManagement::is_hpet_periodic_mode_allowed()
     auto hpet_mode = KParams::the().get("hpet");
     if (hpet_mode == "periodic")
         return true;
-    if (hpet_mode == "nonperiodic")
+    if (hpet_mode == "nonperiodic" || hpet_mode == "tickless")
         return false;
     ASSERT_NOT_REACHED();
 }
 
+bool TimeManagement::is_tickless_mode_requested()
+{
+    return KParams::the().has("hpet") && KParams::the().get("hpet") == "tickless";
+}
+
 bool TimeManagement::probe_and_set_non_legacy_hardware_timers()
 {
     if (!ACPI::Parser::the().is_operable())
@@ -203,6 +210,13 @@ bool TimeManagement::probe_and_set_non_legacy_hardware_timers()
     m_system_timer->change_function([](const RegisterState& regs) { update_scheduler_ticks(regs); });
     dbg() << "Reset timers";
     m_system_timer->try_to_set_frequency(m_system_timer->calculate_nearest_possible_frequency(1024));
+    if (is_tickless_mode_requested() && !m_system_timer->is_periodic()) {
+        // The time keeper isn't needed, time is read from the main counter instead.
+        InterruptDisabler disabler;
+        HPET::the().disable(static_cast<const HPETComparator&>(*m_time_keeper_timer));
+        enable_tickless_mode();
+        return true;
+    }
     m_time_keeper_timer->change_function([](const RegisterState& regs) { update_time(regs); });
     m_time_keeper_timer->try_to_set_frequency(OPTIMAL_TICKS_PER_SECOND_RATE);
 
@@ -256,6 +270,168 @@ void TimeManagement::update_scheduler_ticks(const RegisterState& regs)
 
 void TimeManagement::update_ticks(const RegisterState& regs)
 {
+    if (m_tsc_calibration_enabled)
+        calibrate_tsc_clock();
+    if (m_tickless) {
+        Scheduler::timer_tick(regs, account_elapsed_ticks());
+        return;
+    }
     Scheduler::timer_tick(regs);
 }
+
+void TimeManagement::enable_tickless_mode()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    auto hpet_frequency = HPET::the().frequency();
+    m_main_counter_ticks_per_tick = hpet_frequency / m_system_timer->ticks_per_second();
+    m_main_counter_ticks_per_time_tick = hpet_frequency / OPTIMAL_TICKS_PER_SECOND_RATE;
+    m_last_main_counter = HPET::the().main_counter_value();
+    m_boot_main_counter = m_last_main_counter;
+    m_last_tick_main_counter = m_last_main_counter;
+    m_last_time_main_counter = m_last_main_counter;
+    m_tickless = true;
+    klog() << "Time: Running tickless, " << m_system_timer->ticks_per_second() << " ticks per second";
+}
+
+u64 TimeManagement::read_main_counter()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    u64 counter = HPET::the().main_counter_value();
+    if (!HPET::the().is_main_counter_64_bit()) {
+        // Extend a 32-bit main counter by hand. We read it at least once a second, which is far more often than it wraps.
+        u64 low = counter & 0xffffffff;
+        u64 high = m_last_main_counter & ~0xffffffffull;
+        if (low < (m_last_main_counter & 0xffffffff))
+            high += 0x100000000ull;
+        counter = high | low;
+    }
+    m_last_main_counter = counter;
+    return counter;
+}
+
+u32 TimeManagement::account_elapsed_ticks()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(m_tickless);
+    u64 counter = read_main_counter();
+
+    u64 time_ticks = (counter - m_last_time_main_counter) / m_main_counter_ticks_per_time_tick;
+    m_last_time_main_counter += time_ticks * m_main_counter_ticks_per_time_tick;
+    m_ticks_this_second += time_ticks;
+    while (m_ticks_this_second >= OPTIMAL_TICKS_PER_SECOND_RATE) {
+        m_ticks_this_second -= OPTIMAL_TICKS_PER_SECOND_RATE;
+        ++m_seconds_since_boot;
+        ++m_epoch_time;
+    }
+
+    u64 ticks = (counter - m_last_tick_main_counter) / m_main_counter_ticks_per_tick;
+    m_last_tick_main_counter += ticks * m_main_counter_ticks_per_tick;
+    return ticks;
+}
+
+u64 TimeManagement::monotonic_nanoseconds()
+{
+    InterruptDisabler disabler;
+    if (!m_tickless)
+        return (u64)m_seconds_since_boot * 1000000000ull + (u64)m_ticks_this_second * (1000000000ull / OPTIMAL_TICKS_PER_SECOND_RATE);
+    u64 elapsed = read_main_counter() - m_boot_main_counter;
+    u64 frequency = HPET::the().frequency();
+    return (elapsed / frequency) * 1000000000ull + (elapsed % frequency) * 1000000000ull / frequency;
+}
+
+void TimeManagement::initialize_tsc_clock()
+{
+    // Handing the TSC to userspace makes timing attacks easier, so it has to be asked for explicitly.
+    if (!KParams::the().has("tsc") || KParams::the().get("tsc") != "user")
+        return;
+    if (!g_cpu_supports_tsc || !g_cpu_supports_invariant_tsc) {
+        klog() << "Time: No invariant TSC, userspace clocks stay at tick resolution";
+        return;
+    }
+    allow_user_tsc();
+    m_tsc_calibration_enabled = true;
+}
+
+void TimeManagement::calibrate_tsc_clock()
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    u64 tsc = read_tsc();
+    u64 nanoseconds = monotonic_nanoseconds();
+    if (!m_tsc_calibration_start_tsc) {
+        m_tsc_calibration_start_tsc = tsc;
+        m_tsc_calibration_start_nanoseconds = nanoseconds;
+        return;
+    }
+
+    // Measure over windows of 1, 2, 4, ... 512 seconds so the clock becomes usable quickly
+    // and the error from the reference clock's granularity shrinks as uptime grows.
+    u64 elapsed_nanoseconds = nanoseconds - m_tsc_calibration_start_nanoseconds;
+    if (elapsed_nanoseconds < m_tsc_calibration_window_seconds * 1000000000ull)
+        return;
+    u64 elapsed_tsc = tsc - m_tsc_calibration_start_tsc;
+    if (!elapsed_tsc)
+        return;
+
+    // Rebase on the clock as it reads right now, so it never goes backwards. If it lagged behind the reference, catch up.
+    u64 base = nanoseconds;
+    if (m_tsc_clock.is_usable)
+        base = max(base, m_tsc_clock.nanoseconds_base + tsc_delta_to_nanoseconds(tsc - m_tsc_clock.tsc_base, m_tsc_clock.multiplier));
+    m_tsc_clock.multiplier = (elapsed_nanoseconds << KERNEL_INFO_PAGE_TSC_SHIFT) / elapsed_tsc;
+    m_tsc_clock.tsc_base = tsc;
+    m_tsc_clock.nanoseconds_base = base;
+
+    if (!m_tsc_clock.is_usable) {
+        m_tsc_clock.is_usable = true;
+        klog() << "Time: Userspace clocks extrapolated from the TSC, " << (elapsed_tsc / 1000) * 1000000000ull / elapsed_nanoseconds << " kHz";
+    }
+#ifdef TIME_DEBUG
+    dbg() << "Time: TSC calibrated over " << m_tsc_calibration_window_seconds << "s, multiplier " << m_tsc_clock.multiplier;
+#endif
+
+    if (m_tsc_calibration_window_seconds < 512) {
+        m_tsc_calibration_window_seconds *= 2;
+    } else {
+        m_tsc_calibration_start_tsc = tsc;
+        m_tsc_calibration_start_nanoseconds = nanoseconds;
+    }
+}
+
+u64 TimeManagement::clock_monotonic_nanoseconds()
+{
+    if (!m_tsc_clock.is_usable)
+        return monotonic_nanoseconds();
+    InterruptDisabler disabler;
+    return m_tsc_clock.nanoseconds_base + tsc_delta_to_nanoseconds(read_tsc() - m_tsc_clock.tsc_base, m_tsc_clock.multiplier);
+}
+
+u64 TimeManagement::nanoseconds_per_tick() const
+{
+    return 1000000000ull / ticks_per_second();
+}
+
+bool TimeManagement::set_idle_wakeup(u64 deadline_nanoseconds)
+{
+    ASSERT_INTERRUPTS_DISABLED();
+    ASSERT(m_tickless);
+    u64 now = monotonic_nanoseconds();
+    if (deadline_nanoseconds <= now)
+        return false;
+    u64 delta_nanoseconds = deadline_nanoseconds - now;
+    u64 frequency = HPET::the().frequency();
+    u64 delta = (delta_nanoseconds / 1000000000ull) * frequency + (delta_nanoseconds % 1000000000ull) * frequency / 1000000000ull;
+    if (!delta)
+        return false;
+    u64 armed_at = read_main_counter();
+    static_cast<HPETComparator&>(*m_system_timer).set_one_shot_countdown(delta);
+    // If the counter went past the comparator while we were programming it, the interrupt is lost.
+    return read_main_counter() - armed_at < delta;
+}
+
+void TimeManagement::wake_from_idle()
+{
+    InterruptDisabler disabler;
+    ASSERT(m_tickless);
+    g_uptime += account_elapsed_ticks();
+    static_cast<HPETComparator&>(*m_system_timer).set_one_shot_countdown(m_main_counter_ticks_per_tick);
+}
 }
@@ -61,6 +61,28 @@ public:
 
     static void stale_function(const RegisterState&);
     static bool is_hpet_periodic_mode_allowed();
+    static bool is_tickless_mode_requested();
+
+    // Nanoseconds since boot, read straight from the HPET main counter when running tickless.
+    u64 monotonic_nanoseconds();
+    u64 nanoseconds_per_tick() const;
+
+    // In tickless mode the system timer is a one-shot HPET comparator. It re-arms itself
+    // for the next tick after every interrupt, and the idle loop pushes it out to the next deadline.
+    bool is_tickless() const { return m_tickless; }
+    bool set_idle_wakeup(u64 deadline_nanoseconds);
+    void wake_from_idle();
+
+    // CLOCK_MONOTONIC as userspace sees it through the kernel info page. If userspace may read an invariant TSC,
+    // it's extrapolated from the TSC with a multiplier that is periodically recalibrated against monotonic_nanoseconds().
+    struct TSCClock {
+        bool is_usable { false };
+        u32 multiplier { 0 };
+        u64 tsc_base { 0 };
+        u64 nanoseconds_base { 0 };
+    };
+    const TSCClock& tsc_clock() const { return m_tsc_clock; }
+    u64 clock_monotonic_nanoseconds();
 
 private:
     explicit TimeManagement(bool probe_non_legacy_hardware_timers);
@@ -68,11 +90,28 @@ private:
     bool probe_and_set_non_legacy_hardware_timers();
     Vector<size_t> scan_and_initialize_periodic_timers();
     Vector<size_t> scan_for_non_periodic_timers();
+    void enable_tickless_mode();
+    u64 read_main_counter();
+    u32 account_elapsed_ticks();
+    void initialize_tsc_clock();
+    void calibrate_tsc_clock();
     FixedArray<RefPtr<HardwareTimer>> m_hardware_timers { 2 };
 
     u32 m_ticks_this_second { 0 };
     u32 m_seconds_since_boot { 0 };
     time_t m_epoch_time { 0 };
+    bool m_tickless { false };
+    u64 m_boot_main_counter { 0 };
+    u64 m_last_main_counter { 0 };
+    u64 m_last_tick_main_counter { 0 };
+    u64 m_last_time_main_counter { 0 };
+    u64 m_main_counter_ticks_per_tick { 0 };
+    u64 m_main_counter_ticks_per_time_tick { 0 };
+    TSCClock m_tsc_clock;
+    bool m_tsc_calibration_enabled { false };
+    u64 m_tsc_calibration_start_tsc { 0 };
+    u64 m_tsc_calibration_start_nanoseconds { 0 };
+    u64 m_tsc_calibration_window_seconds { 1 };
     RefPtr<HardwareTimer> m_system_timer;
     RefPtr<HardwareTimer> m_time_keeper_timer;
     Function<void(RegisterState&)> m_scheduler_ticking { update_time };
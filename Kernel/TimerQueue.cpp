@@ -27,6 +27,8 @@
 #include <AK/Function.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <Kernel/Arch/i386/CPU.h>
 #include <Kernel/Scheduler.h>
 #include <Kernel/TimerQueue.h>
 
@@ -43,60 +45,85 @@ TimerQueue& TimerQueue::the()
 
 u64 TimerQueue::add_timer(NonnullOwnPtr<Timer>&& timer)
 {
+    InterruptDisabler disabler;
     ASSERT(timer->expires > g_uptime);
 
     timer->id = ++m_timer_id_count;
+    if (timer->slack)
+        timer->expires = coalesced_expiration(timer->expires, timer->slack);
 
-    auto following_timer = m_timer_queue.find([&timer](auto& other) { return other->expires > timer->expires; });
-    if (following_timer.is_end())
-        m_timer_queue.append(move(timer));
-    else
-        m_timer_queue.insert_before(following_timer, move(timer));
+    TimerKey key { timer->expires, timer->id };
+    m_timer_expirations.set(timer->id, timer->expires);
+    m_timer_tree.insert(key, move(timer));
 
     update_next_timer_due();
 
     return m_timer_id_count;
 }
 
-u64 TimerQueue::add_timer(u64 duration, TimeUnit unit, Function<void()>&& callback)
+u64 TimerQueue::add_timer(u64 duration, TimeUnit unit, Function<void()>&& callback, u64 slack)
 {
     NonnullOwnPtr timer = make<Timer>();
     timer->expires = g_uptime + duration * unit;
+    timer->slack = slack;
     timer->callback = move(callback);
     return add_timer(move(timer));
 }
 
 bool TimerQueue::cancel_timer(u64 id)
 {
-    auto it = m_timer_queue.find([id](auto& timer) { return timer->id == id; });
-    if (it.is_end())
+    InterruptDisabler disabler;
+    auto it = m_timer_expirations.find(id);
+    if (it == m_timer_expirations.end())
         return false;
-    m_timer_queue.remove(it);
+    m_timer_tree.remove({ (*it).value, id });
+    m_timer_expirations.remove(it);
     update_next_timer_due();
     return true;
 }
 
+u64 TimerQueue::coalesced_expiration(u64 expires, u64 slack) const
+{
+    // Prefer piggybacking on a timer that already fires within our slack window.
+    auto* neighbour = m_timer_tree.find_smallest_not_below({ expires, 0 });
+    if (neighbour && (*neighbour)->expires <= expires + slack)
+        return (*neighbour)->expires;
+
+    // Otherwise round up to a boundary that other timers with similar slack will pick as well.
+    u64 granularity = 1;
+    while (granularity * 2 <= slack)
+        granularity *= 2;
+    return (expires + granularity - 1) & ~(granularity - 1);
+}
+
 void TimerQueue::fire()
 {
-    if (m_timer_queue.is_empty())
+    if (!m_next_timer_due || g_uptime < m_next_timer_due)
         return;
 
-    ASSERT(m_next_timer_due == m_timer_queue.first()->expires);
+    // Unlink every expired timer first and only then run the callbacks,
+    // so that callbacks can freely add or cancel timers.
+    Vector<NonnullOwnPtr<Timer>, 16> expired_timers;
+    for (auto it = m_timer_tree.begin(); it != m_timer_tree.end() && g_uptime >= it.key().expires; ++it)
+        expired_timers.append((*it).release_nonnull());
 
-    while (!m_timer_queue.is_empty() && g_uptime > m_timer_queue.first()->expires) {
-        auto timer = m_timer_queue.take_first();
-        timer->callback();
+    for (auto& timer : expired_timers) {
+        m_timer_tree.remove({ timer->expires, timer->id });
+        m_timer_expirations.remove(timer->id);
     }
 
     update_next_timer_due();
+
+    for (auto& timer : expired_timers)
+        timer->callback();
 }
 
 void TimerQueue::update_next_timer_due()
 {
-    if (m_timer_queue.is_empty())
+    if (m_timer_tree.is_empty())
         m_next_timer_due = 0;
     else
-        m_next_timer_due = m_timer_queue.first()->expires;
+        m_next_timer_due = m_timer_tree.begin().key().expires;
 }
 
 }
@@ -27,9 +27,10 @@
 #pragma once
 
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
-#include <AK/SinglyLinkedList.h>
+#include <AK/RedBlackTree.h>
 #include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
@@ -37,6 +38,8 @@ namespace Kernel {
 struct Timer {
     u64 id;
     u64 expires;
+    // How many ticks past `expires` the timer may fire so it can share a wakeup with its neighbours.
+    u64 slack { 0 };
     Function<void()> callback;
     bool operator<(const Timer& rhs) const
     {
@@ -63,16 +66,36 @@ public:
     static TimerQueue& the();
 
     u64 add_timer(NonnullOwnPtr<Timer>&&);
-    u64 add_timer(u64 duration, TimeUnit, Function<void()>&& callback);
+    u64 add_timer(u64 duration, TimeUnit, Function<void()>&& callback, u64 slack = 0);
     bool cancel_timer(u64 id);
     void fire();
 
+    u64 next_timer_due() const { return m_next_timer_due; }
+
+    // The slack to give a timeout that is `duration` ticks away: about a thousandth of it, but no more than 100ms.
+    static u64 default_slack(u64 duration) { return min<u64>(duration / 1024, 100 * TimeUnit::MS); }
+
 private:
+    // Timers are ordered by deadline, with the id breaking ties, so that
+    // insertion, cancellation and finding the next deadline are all O(log n).
+    struct TimerKey {
+        u64 expires;
+        u64 id;
+        bool operator<(const TimerKey& other) const
+        {
+            if (expires != other.expires)
+                return expires < other.expires;
+            return id < other.id;
+        }
+    };
+
+    u64 coalesced_expiration(u64 expires, u64 slack) const;
     void update_next_timer_due();
 
     u64 m_next_timer_due { 0 };
     u64 m_timer_id_count { 0 };
-    SinglyLinkedList<NonnullOwnPtr<Timer>> m_timer_queue;
+    RedBlackTree<TimerKey, OwnPtr<Timer>> m_timer_tree;
+    HashMap<u64, u64> m_timer_expirations;
 };
 
 }
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <Kernel/FileSystem/ProcFS.h>
+#include <Kernel/Lock.h>
+#include <Kernel/Syscall.h>
+#include <Kernel/Tracing.h>
+
+namespace Kernel {
+
+namespace Tracing {
+
+TracepointData g_tracepoints[(size_t)Tracepoint::__Count];
+
+static u64 s_context_switch_counts[(size_t)ContextSwitchReason::__Count];
+static u64 s_syscall_counts[Syscall::Function::__Count];
+static u64 s_syscall_cycles[Syscall::Function::__Count];
+
+const char* to_string(Tracepoint tracepoint)
+{
+    switch (tracepoint) {
+#define __ENUMERATE_TRACEPOINT(x, name) \
+    case Tracepoint::x:                 \
+        return name;
+        ENUMERATE_TRACEPOINTS
+#undef __ENUMERATE_TRACEPOINT
+    default:
+        break;
+    }
+    return "Unknown";
+}
+
+const char* to_string(ContextSwitchReason reason)
+{
+    switch (reason) {
+#define __ENUMERATE_CONTEXT_SWITCH_REASON(x) \
+    case ContextSwitchReason::x:             \
+        return #x;
+        ENUMERATE_CONTEXT_SWITCH_REASONS
+#undef __ENUMERATE_CONTEXT_SWITCH_REASON
+    default:
+        break;
+    }
+    return "Unknown";
+}
+
+static void reset(Tracepoint tracepoint)
+{
+    InterruptDisabler disabler;
+    auto& data = g_tracepoints[(size_t)tracepoint];
+    data.event_count = 0;
+    data.total_cycles = 0;
+    data.max_cycles = 0;
+    for (auto& bucket : data.histogram)
+        bucket = 0;
+
+    if (tracepoint == Tracepoint::ContextSwitch) {
+        for (auto& count : s_context_switch_counts)
+            count = 0;
+    }
+
+    if (tracepoint == Tracepoint::Syscall) {
+        for (size_t i = 0; i < Syscall::Function::__Count; ++i) {
+            s_syscall_counts[i] = 0;
+            s_syscall_cycles[i] = 0;
+        }
+    }
+}
+
+void initialize()
+{
+    // Each tracepoint gets a /proc/sys/trace_<name> switch. The hot paths only ever
+    // look at the plain bool in g_tracepoints, which we update from the notify callback.
+    for (size_t i = 0; i < (size_t)Tracepoint::__Count; ++i) {
+        auto tracepoint = (Tracepoint)i;
+        auto* variable = new Lockable<bool>(false);
+        ProcFS::add_sys_bool(String::format("trace_%s", to_string(tracepoint)), *variable, [variable, tracepoint] {
+            bool enabled = variable->resource();
+            if (enabled && !is_enabled(tracepoint))
+                reset(tracepoint);
+            g_tracepoints[(size_t)tracepoint].enabled = enabled;
+        });
+    }
+}
+
+static size_t bucket_for(u64 cycles)
+{
+    size_t bucket = 0;
+    while (cycles >>= 1)
+        ++bucket;
+    return min(bucket, histogram_bucket_count - 1);
+}
+
+void record(Tracepoint tracepoint, u64 cycles)
+{
+    InterruptDisabler disabler;
+    auto& data = g_tracepoints[(size_t)tracepoint];
+    ++data.event_count;
+    data.total_cycles += cycles;
+    if (cycles > data.max_cycles)
+        data.max_cycles = cycles;
+    ++data.histogram[bucket_for(cycles)];
+}
+
+void did_syscall(u32 function, u64 cycles)
+{
+    record(Tracepoint::Syscall, cycles);
+    if (function >= Syscall::Function::__Count)
+        return;
+    InterruptDisabler disabler;
+    ++s_syscall_counts[function];
+    s_syscall_cycles[function] += cycles;
+}
+
+void did_context_switch(ContextSwitchReason reason)
+{
+    ++s_context_switch_counts[(size_t)reason];
+}
+
+u64 context_switch_count(ContextSwitchReason reason)
+{
+    return s_context_switch_counts[(size_t)reason];
+}
+
+u64 syscall_count(u32 function)
+{
+    ASSERT(function < Syscall::Function::__Count);
+    return s_syscall_counts[function];
+}
+
+u64 syscall_cycles(u32 function)
+{
+    ASSERT(function < Syscall::Function::__Count);
+    return s_syscall_cycles[function];
+}
+
+}
+
+}
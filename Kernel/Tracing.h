@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <Kernel/Arch/i386/CPU.h>
+
+namespace Kernel {
+
+namespace Tracing {
+
+#define ENUMERATE_TRACEPOINTS                               \
+    __ENUMERATE_TRACEPOINT(Syscall, "syscall")              \
+    __ENUMERATE_TRACEPOINT(PageFault, "page_fault")         \
+    __ENUMERATE_TRACEPOINT(Wakeup, "wakeup")                \
+    __ENUMERATE_TRACEPOINT(ContextSwitch, "context_switch") \
+    __ENUMERATE_TRACEPOINT(BlockRequest, "block_request")
+
+enum class Tracepoint {
+#define __ENUMERATE_TRACEPOINT(x, name) x,
+    ENUMERATE_TRACEPOINTS
+#undef __ENUMERATE_TRACEPOINT
+        __Count
+};
+
+#define ENUMERATE_CONTEXT_SWITCH_REASONS         \
+    __ENUMERATE_CONTEXT_SWITCH_REASON(Preempted) \
+    __ENUMERATE_CONTEXT_SWITCH_REASON(Yielded)   \
+    __ENUMERATE_CONTEXT_SWITCH_REASON(Blocked)   \
+    __ENUMERATE_CONTEXT_SWITCH_REASON(Stopped)   \
+    __ENUMERATE_CONTEXT_SWITCH_REASON(Exited)
+
+enum class ContextSwitchReason {
+#define __ENUMERATE_CONTEXT_SWITCH_REASON(x) x,
+    ENUMERATE_CONTEXT_SWITCH_REASONS
+#undef __ENUMERATE_CONTEXT_SWITCH_REASON
+        __Count
+};
+
+// Bucket N counts events that took [2^N, 2^(N+1)) TSC cycles.
+constexpr size_t histogram_bucket_count = 40;
+
+struct TracepointData {
+    bool enabled { false };
+    u64 event_count { 0 };
+    u64 total_cycles { 0 };
+    u64 max_cycles { 0 };
+    u32 histogram[histogram_bucket_count] {};
+};
+
+extern TracepointData g_tracepoints[(size_t)Tracepoint::__Count];
+
+inline bool is_enabled(Tracepoint tracepoint)
+{
+    return g_tracepoints[(size_t)tracepoint].enabled;
+}
+
+void initialize();
+const char* to_string(Tracepoint);
+const char* to_string(ContextSwitchReason);
+
+void record(Tracepoint, u64 cycles);
+void did_syscall(u32 function, u64 cycles);
+void did_context_switch(ContextSwitchReason);
+
+u64 context_switch_count(ContextSwitchReason);
+u64 syscall_count(u32 function);
+u64 syscall_cycles(u32 function);
+
+// Records the lifetime of the scope as one event, if the tracepoint was enabled on entry.
+class ScopedTracepoint {
+public:
+    explicit ScopedTracepoint(Tracepoint tracepoint)
+        : m_tracepoint(tracepoint)
+    {
+        if (is_enabled(tracepoint))
+            m_start = read_tsc();
+    }
+
+    ~ScopedTracepoint()
+    {
+        if (m_start)
+            record(m_tracepoint, read_tsc() - m_start);
+    }
+
+private:
+    Tracepoint m_tracepoint;
+    u64 m_start { 0 };
+};
+
+}
+
+}
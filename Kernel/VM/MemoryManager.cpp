@@ -248,11 +248,8 @@ Region* MemoryManager::kernel_region_from_vaddr(VirtualAddress vaddr)
 
 Region* MemoryManager::user_region_from_vaddr(Process& process, VirtualAddress vaddr)
 {
-    // FIXME: Use a binary search tree (maybe red/black?) or some other more appropriate data structure!
-    for (auto& region : process.m_regions) {
-        if (region.contains(vaddr))
-            return &region;
-    }
+    if (auto* region = process.region_containing(vaddr))
+        return region;
 #ifdef MM_DEBUG
     dbg() << process << " Couldn't find user region for " << vaddr;
 #endif
@@ -287,8 +284,8 @@ Region* MemoryManager::region_from_vaddr(VirtualAddress vaddr)
 PageFaultResponse MemoryManager::handle_page_fault(const PageFault& fault)
 {
     ASSERT_INTERRUPTS_DISABLED();
-    ASSERT(Thread::current);
-    if (g_in_irq) {
+    ASSERT(Thread::current());
+    if (Processor::current().in_irq()) {
         dbg() << "BUG! Page fault while handling IRQ! code=" << fault.code() << ", vaddr=" << fault.vaddr();
         dump_kernel_regions();
     }
@@ -524,10 +521,10 @@ RefPtr<PhysicalPage> MemoryManager::allocate_supervisor_physical_page()
 
 void MemoryManager::enter_process_paging_scope(Process& process)
 {
-    ASSERT(Thread::current);
+    ASSERT(Thread::current());
     InterruptDisabler disabler;
 
-    Thread::current->tss().cr3 = process.page_directory().cr3();
+    Thread::current()->tss().cr3 = process.page_directory().cr3();
     write_cr3(process.page_directory().cr3());
 }
 
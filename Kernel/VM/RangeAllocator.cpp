@@ -24,8 +24,6 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/BinarySearch.h>
-#include <AK/QuickSort.h>
 #include <Kernel/Random.h>
 #include <Kernel/Thread.h>
 #include <Kernel/VM/RangeAllocator.h>
@@ -42,7 +40,7 @@ RangeAllocator::RangeAllocator()
 void RangeAllocator::initialize_with_range(VirtualAddress base, size_t size)
 {
     m_total_range = { base, size };
-    m_available_ranges.append({ base, size });
+    insert_available_range({ base, size });
 #ifdef VRA_DEBUG
     dump();
 #endif
@@ -61,7 +59,8 @@ RangeAllocator::~RangeAllocator()
 void RangeAllocator::dump() const
 {
     dbg() << "RangeAllocator{" << this << "}";
-    for (auto& range : m_available_ranges) {
+    for (auto& available_range : m_available_ranges) {
+        auto& range = available_range.range;
         dbg() << "    " << String::format("%x", range.base().get()) << " -> " << String::format("%x", range.end().get() - 1);
     }
 }
@@ -83,13 +82,36 @@ Vector<Range, 2> Range::carve(const Range& taken)
     return parts;
 }
 
-void RangeAllocator::carve_at_index(int index, const Range& range)
+void RangeAllocator::insert_available_range(const Range& range)
 {
-    auto remaining_parts = m_available_ranges[index].carve(range);
-    ASSERT(remaining_parts.size() >= 1);
-    m_available_ranges[index] = remaining_parts[0];
-    if (remaining_parts.size() == 2)
-        m_available_ranges.insert(index + 1, move(remaining_parts[1]));
+    m_available_ranges.insert(range.base().get(), AvailableRange { range, range.size() });
+}
+
+void RangeAllocator::carve_from_available_range(Range available_range, const Range& range)
+{
+    auto remaining_parts = available_range.carve(range);
+    m_available_ranges.remove(available_range.base().get());
+    for (auto& part : remaining_parts)
+        insert_available_range(part);
+}
+
+const Range* RangeAllocator::find_lowest_range_with_size_at_least(size_t size) const
+{
+    auto* node = m_available_ranges.root();
+    while (node) {
+        if (node->left && node->left->value.largest_size_in_subtree >= size) {
+            node = node->left;
+            continue;
+        }
+        if (node->value.range.size() >= size)
+            return &node->value.range;
+        if (node->right && node->right->value.largest_size_in_subtree >= size) {
+            node = node->right;
+            continue;
+        }
+        break;
+    }
+    return nullptr;
 }
 
 Range RangeAllocator::allocate_anywhere(size_t size, size_t alignment)
@@ -106,32 +128,31 @@ Range RangeAllocator::allocate_anywhere(size_t size, size_t alignment)
     size_t offset_from_effective_base = 0;
 #endif
 
-    for (size_t i = 0; i < m_available_ranges.size(); ++i) {
-        auto& available_range = m_available_ranges[i];
-        // FIXME: This check is probably excluding some valid candidates when using a large alignment.
-        if (available_range.size() < (effective_size + alignment))
-            continue;
+    // FIXME: This check is probably excluding some valid candidates when using a large alignment.
+    auto* candidate = find_lowest_range_with_size_at_least(effective_size + alignment);
+    if (!candidate) {
+        klog() << "VRA: Failed to allocate anywhere: " << size << ", " << alignment;
+        return {};
+    }
+    Range available_range = *candidate;
 
-        FlatPtr initial_base = available_range.base().offset(offset_from_effective_base).get();
-        FlatPtr aligned_base = round_up_to_power_of_two(initial_base, alignment);
+    FlatPtr initial_base = available_range.base().offset(offset_from_effective_base).get();
+    FlatPtr aligned_base = round_up_to_power_of_two(initial_base, alignment);
 
-        Range allocated_range(VirtualAddress(aligned_base), size);
-        if (available_range == allocated_range) {
-#ifdef VRA_DEBUG
-            dbg() << "VRA: Allocated perfect-fit anywhere(" << String::format("%zu", size) << ", " << String::format("%zu", alignment) << "): " << String::format("%x", allocated_range.base().get());
-#endif
-            m_available_ranges.remove(i);
-            return allocated_range;
-        }
-        carve_at_index(i, allocated_range);
+    Range allocated_range(VirtualAddress(aligned_base), size);
+    if (available_range == allocated_range) {
 #ifdef VRA_DEBUG
-        dbg() << "VRA: Allocated anywhere(" << String::format("%zu", size) << ", " << String::format("%zu", alignment) << "): " << String::format("%x", allocated_range.base().get());
-        dump();
+        dbg() << "VRA: Allocated perfect-fit anywhere(" << String::format("%zu", size) << ", " << String::format("%zu", alignment) << "): " << String::format("%x", allocated_range.base().get());
 #endif
+        m_available_ranges.remove(available_range.base().get());
         return allocated_range;
     }
-    klog() << "VRA: Failed to allocate anywhere: " << size << ", " << alignment;
-    return {};
+    carve_from_available_range(available_range, allocated_range);
+#ifdef VRA_DEBUG
+    dbg() << "VRA: Allocated anywhere(" << String::format("%zu", size) << ", " << String::format("%zu", alignment) << "): " << String::format("%x", allocated_range.base().get());
+    dump();
+#endif
+    return allocated_range;
 }
 
 Range RangeAllocator::allocate_specific(VirtualAddress base, size_t size)
@@ -140,23 +161,22 @@ Range RangeAllocator::allocate_specific(VirtualAddress base, size_t size)
         return {};
 
     Range allocated_range(base, size);
-    for (size_t i = 0; i < m_available_ranges.size(); ++i) {
-        auto& available_range = m_available_ranges[i];
-        if (!available_range.contains(base, size))
-            continue;
-        if (available_range == allocated_range) {
-            m_available_ranges.remove(i);
-            return allocated_range;
-        }
-        carve_at_index(i, allocated_range);
-#ifdef VRA_DEBUG
-        dbg() << "VRA: Allocated specific(" << size << "): " << String::format("%x", available_range.base().get());
-        dump();
-#endif
+    auto* candidate = m_available_ranges.find_largest_not_above(base.get());
+    if (!candidate || !candidate->range.contains(base, size)) {
+        dbg() << "VRA: Failed to allocate specific range: " << base << "(" << size << ")";
+        return {};
+    }
+    Range available_range = candidate->range;
+    if (available_range == allocated_range) {
+        m_available_ranges.remove(available_range.base().get());
         return allocated_range;
     }
-    dbg() << "VRA: Failed to allocate specific range: " << base << "(" << size << ")";
-    return {};
+    carve_from_available_range(available_range, allocated_range);
+#ifdef VRA_DEBUG
+    dbg() << "VRA: Allocated specific(" << size << "): " << String::format("%x", available_range.base().get());
+    dump();
+#endif
+    return allocated_range;
 }
 
 void RangeAllocator::deallocate(Range range)
@@ -170,37 +190,25 @@ void RangeAllocator::deallocate(Range range)
     dump();
 #endif
 
-    ASSERT(!m_available_ranges.is_empty());
-
-    int nearby_index = 0;
-    auto* existing_range = binary_search(
-        m_available_ranges.data(), m_available_ranges.size(), range, [](auto& a, auto& b) {
-            return a.base().get() - b.end().get();
-        },
-        &nearby_index);
-
-    size_t inserted_index = 0;
-    if (existing_range) {
-        existing_range->m_size += range.size();
-        inserted_index = nearby_index;
-    } else {
-        m_available_ranges.insert_before_matching(
-            Range(range), [&](auto& entry) {
-                return entry.base() >= range.end();
-            },
-            nearby_index, &inserted_index);
-    }
+    Range merged_range = range;
 
-    if (inserted_index < (m_available_ranges.size() - 1)) {
-        // We already merged with previous. Try to merge with next.
-        auto& inserted_range = m_available_ranges[inserted_index];
-        auto& next_range = m_available_ranges[inserted_index + 1];
-        if (inserted_range.end() == next_range.base()) {
-            inserted_range.m_size += next_range.size();
-            m_available_ranges.remove(inserted_index + 1);
-            return;
+    // Merge with the free range immediately before this one, if there is one.
+    if (auto* previous = m_available_ranges.find_largest_not_above(range.base().get())) {
+        ASSERT(previous->range.end() <= range.base());
+        if (previous->range.end() == range.base()) {
+            merged_range = { previous->range.base(), previous->range.size() + range.size() };
+            m_available_ranges.remove(previous->range.base().get());
         }
     }
+
+    // Merge with the free range immediately after this one, if there is one.
+    if (auto* next = m_available_ranges.find(range.end().get())) {
+        merged_range.m_size += next->range.size();
+        m_available_ranges.remove(range.end().get());
+    }
+
+    insert_available_range(merged_range);
+
 #ifdef VRA_DEBUG
     dbg() << "VRA: After deallocate";
     dump();
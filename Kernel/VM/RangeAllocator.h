@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/RedBlackTree.h>
 #include <AK/String.h>
 #include <AK/Traits.h>
 #include <AK/Vector.h>
@@ -91,9 +92,33 @@ public:
     void dump() const;
 
 private:
-    void carve_at_index(int, const Range&);
-
-    Vector<Range> m_available_ranges;
+    struct AvailableRange {
+        Range range;
+        size_t largest_size_in_subtree { 0 };
+    };
+
+    struct LargestSizeAugmenter {
+        template<typename Node>
+        static void update(Node& node)
+        {
+            size_t largest = node.value.range.size();
+            if (node.left && node.left->value.largest_size_in_subtree > largest)
+                largest = node.left->value.largest_size_in_subtree;
+            if (node.right && node.right->value.largest_size_in_subtree > largest)
+                largest = node.right->value.largest_size_in_subtree;
+            node.value.largest_size_in_subtree = largest;
+        }
+    };
+
+    using AvailableRangeTree = RedBlackTree<FlatPtr, AvailableRange, LargestSizeAugmenter>;
+
+    const Range* find_lowest_range_with_size_at_least(size_t) const;
+    void insert_available_range(const Range&);
+    void carve_from_available_range(Range available_range, const Range&);
+
+    // Free ranges keyed by base address. Each node also knows the largest free range in its subtree,
+    // which lets allocate_anywhere() find the lowest-addressed fit in O(log n).
+    AvailableRangeTree m_available_ranges;
     Range m_total_range;
 };
 
@@ -32,6 +32,7 @@
 #include <Kernel/VM/AnonymousVMObject.h>
 #include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/PageDirectory.h>
+#include <Kernel/VM/PrivateInodeVMObject.h>
 #include <Kernel/VM/Region.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
@@ -66,9 +67,12 @@ Region::~Region()
 
 NonnullOwnPtr<Region> Region::clone()
 {
-    ASSERT(Process::current);
+    ASSERT(Process::current());
 
-    if (m_shared) {
+    // Read-only private file mappings share the inode's page cache, and can keep sharing it in the child.
+    bool is_read_only_private_inode_mapping = !m_shared && vmobject().is_shared_inode() && !is_writable();
+
+    if (m_shared || is_read_only_private_inode_mapping) {
         ASSERT(!m_stack);
 #ifdef MM_DEBUG
         dbg() << "Region::clone(): Sharing " << name() << " (" << vaddr() << ")";
@@ -104,6 +108,21 @@ NonnullOwnPtr<Region> Region::clone()
     return clone_region;
 }
 
+void Region::set_vmobject(NonnullRefPtr<VMObject>&& vmobject)
+{
+    m_vmobject = move(vmobject);
+}
+
+void Region::detach_from_shared_inode_vmobject_if_needed()
+{
+    if (m_shared || !vmobject().is_shared_inode())
+        return;
+#ifdef MM_DEBUG
+    dbg() << "Region::detach_from_shared_inode_vmobject_if_needed(): Giving " << name() << " (" << vaddr() << ") a private VMObject";
+#endif
+    set_vmobject(PrivateInodeVMObject::create_with_inode(static_cast<InodeVMObject&>(vmobject()).inode()));
+}
+
 bool Region::commit()
 {
     InterruptDisabler disabler;
@@ -351,8 +370,8 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
         return PageFaultResponse::Continue;
     }
 
-    if (Thread::current)
-        Thread::current->did_zero_fault();
+    if (Thread::current())
+        Thread::current()->did_zero_fault();
 
     auto physical_page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
     if (physical_page.is_null()) {
@@ -381,8 +400,8 @@ PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
         return PageFaultResponse::Continue;
     }
 
-    if (Thread::current)
-        Thread::current->did_cow_fault();
+    if (Thread::current())
+        Thread::current()->did_cow_fault();
 
 #ifdef PAGE_FAULT_DEBUG
     dbg() << "    >> It's a COW page and it's time to COW!";
@@ -430,8 +449,8 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
         return PageFaultResponse::Continue;
     }
 
-    if (Thread::current)
-        Thread::current->did_inode_fault();
+    if (Thread::current())
+        Thread::current()->did_inode_fault();
 
 #ifdef MM_DEBUG
     dbg() << "MM: page_in_from_inode ready to read from inode";
@@ -74,6 +74,7 @@ public:
 
     const VMObject& vmobject() const { return *m_vmobject; }
     VMObject& vmobject() { return *m_vmobject; }
+    void set_vmobject(NonnullRefPtr<VMObject>&&);
 
     bool is_shared() const { return m_shared; }
     void set_shared(bool shared) { m_shared = shared; }
@@ -91,6 +92,10 @@ public:
 
     NonnullOwnPtr<Region> clone();
 
+    // Read-only private file mappings are backed by the inode's SharedInodeVMObject.
+    // This must be called before such a region is made writable.
+    void detach_from_shared_inode_vmobject_if_needed();
+
     bool contains(VirtualAddress vaddr) const
     {
         return m_range.contains(vaddr);
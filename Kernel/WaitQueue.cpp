@@ -39,13 +39,13 @@ WaitQueue::~WaitQueue()
 
 void WaitQueue::enqueue(Thread& thread)
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock locker(m_lock);
     m_threads.append(thread);
 }
 
 void WaitQueue::wake_one(Atomic<bool>* lock)
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock locker(m_lock);
     if (lock)
         *lock = false;
     if (m_threads.is_empty())
@@ -55,9 +55,11 @@ void WaitQueue::wake_one(Atomic<bool>* lock)
     Scheduler::stop_idling();
 }
 
-void WaitQueue::wake_all()
+void WaitQueue::wake_all(Atomic<bool>* lock)
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock locker(m_lock);
+    if (lock)
+        *lock = false;
     if (m_threads.is_empty())
         return;
     while (!m_threads.is_empty())
@@ -67,7 +69,7 @@ void WaitQueue::wake_all()
 
 void WaitQueue::clear()
 {
-    InterruptDisabler disabler;
+    ScopedSpinLock locker(m_lock);
     m_threads.clear();
 }
 
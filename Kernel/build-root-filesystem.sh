@@ -175,6 +175,7 @@ echo "done"
 
 printf "installing dynamic libraries... "
 cp ../Demos/DynamicLink/LinkLib/libDynamicLib.so mnt/usr/lib
+cp ../Libraries/LibM/shared/libm.so mnt/usr/lib
 echo "done"
 
 printf "installing shortcuts... "
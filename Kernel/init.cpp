@@ -70,6 +70,7 @@
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/Tracing.h>
 #include <Kernel/VM/MemoryManager.h>
 
 // Defined in the linker script
@@ -94,6 +95,9 @@ VirtualConsole* tty0;
 
 extern "C" [[noreturn]] void init()
 {
+    // Everything that asks for the current thread or process goes through the Processor.
+    Processor::initialize(0);
+
     setup_serial_debug();
 
     cpu_setup();
@@ -106,7 +110,6 @@ extern "C" [[noreturn]] void init()
     MemoryManager::initialize();
 
     bool text_debug = KParams::the().has("text_debug");
-    gdt_init();
     idt_init();
 
     setup_interrupts();
@@ -127,6 +130,8 @@ extern "C" [[noreturn]] void init()
     for (ctor_func_t* ctor = &start_ctors; ctor < &end_ctors; ctor++)
         (*ctor)();
 
+    APIC::boot_aps();
+
     new KeyboardDevice;
     new PS2MouseDevice;
     setup_vmmouse();
@@ -175,17 +180,17 @@ extern "C" [[noreturn]] void init()
     Process::create_kernel_process(syncd_thread, "syncd", [] {
         for (;;) {
             VFS::the().sync();
-            Thread::current->sleep(1 * TimeManagement::the().ticks_per_second());
+            Thread::current()->sleep(1 * TimeManagement::the().ticks_per_second());
         }
     });
 
     Process::create_kernel_process(g_finalizer, "Finalizer", [] {
-        Thread::current->set_priority(THREAD_PRIORITY_LOW);
+        Thread::current()->set_priority(THREAD_PRIORITY_LOW);
         for (;;) {
             {
                 InterruptDisabler disabler;
                 if (!g_finalizer_has_work)
-                    Thread::current->wait_on(*g_finalizer_wait_queue);
+                    Thread::current()->wait_on(*g_finalizer_wait_queue);
                 ASSERT(g_finalizer_has_work);
                 g_finalizer_has_work = false;
             }
@@ -201,9 +206,27 @@ extern "C" [[noreturn]] void init()
     ASSERT_NOT_REACHED();
 }
 
+// Application processors arrive here from the trampoline in APIC.cpp.
+extern "C" [[noreturn]] void init_ap(u32 cpu, u32 kernel_cr3)
+{
+    // The trampoline's page tables are only good for getting here, switch to the real ones.
+    write_cr3(kernel_cr3);
+
+    Processor::initialize(cpu);
+    flush_idt();
+    cpu_setup();
+    APIC::enable(cpu);
+
+    // FIXME: Application processors don't run threads yet. That needs per-CPU run queues and idle threads,
+    //        and has to wait until the rest of the kernel stops relying on InterruptDisabler for mutual exclusion.
+    for (;;)
+        asm volatile("sti; hlt");
+}
+
 void init_stage2()
 {
     Syscall::initialize();
+    Tracing::initialize();
 
     new ZeroDevice;
     new FullDevice;
@@ -303,7 +326,7 @@ void init_stage2()
         hang();
     }
 
-    Process::current->set_root_directory(VFS::the().root_custody());
+    Process::current()->set_root_directory(VFS::the().root_custody());
 
     dbg() << "Load ksyms";
     load_ksyms();
@@ -338,7 +361,7 @@ void init_stage2()
         Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main);
     }
 
-    Process::current->sys$exit(0);
+    Process::current()->sys$exit(0);
     ASSERT_NOT_REACHED();
 }
 
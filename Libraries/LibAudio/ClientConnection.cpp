@@ -39,6 +39,7 @@ void ClientConnection::handshake()
 {
     auto response = send_sync<Messages::AudioServer::Greet>();
     set_my_client_id(response->client_id());
+    enable_shared_rings();
 }
 
 void ClientConnection::enqueue(const Buffer& buffer)
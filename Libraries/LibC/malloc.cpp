@@ -30,6 +30,7 @@
 #include <AK/Vector.h>
 #include <LibThread/Lock.h>
 #include <assert.h>
+#include <bits/pthread_integration.h>
 #include <mallocdefs.h>
 #include <serenity.h>
 #include <stdio.h>
@@ -37,8 +38,6 @@
 #include <string.h>
 #include <sys/mman.h>
 
-// FIXME: Thread safety.
-
 //#define MALLOC_DEBUG
 #define RECYCLE_BIG_ALLOCATIONS
 
@@ -52,16 +51,23 @@ static LibThread::Lock& malloc_lock()
     return *reinterpret_cast<LibThread::Lock*>(&lock_storage);
 }
 
-constexpr int number_of_chunked_blocks_to_keep_around_per_size_class = 4;
+constexpr int number_of_chunked_blocks_to_keep_around_per_size_class = 16;
 constexpr int number_of_big_blocks_to_keep_around_per_size_class = 8;
 
 static bool s_log_malloc = false;
-static bool s_scrub_malloc = true;
-static bool s_scrub_free = true;
+static bool s_scrub_malloc = false;
+static bool s_scrub_free = false;
 static bool s_profiling = false;
 static unsigned short size_classes[] = { 8, 16, 32, 64, 128, 252, 508, 1016, 2036, 4090, 8188, 16376, 32756, 0 };
 static constexpr size_t num_size_classes = sizeof(size_classes) / sizeof(unsigned short);
 
+// The smallest size classes (up to 1016 bytes) are served from a per-thread cache of chunks
+// without taking the malloc lock. Cached chunks still count as used in their ChunkedBlock;
+// the cache is refilled from, and flushed back to, the blocks in batches under the lock.
+constexpr size_t number_of_thread_cached_size_classes = 8;
+constexpr size_t thread_cache_capacity_per_size_class = 32;
+constexpr size_t thread_cache_batch_size = thread_cache_capacity_per_size_class / 2;
+
 constexpr size_t block_size = 64 * KB;
 constexpr size_t block_mask = ~(block_size - 1);
 
@@ -132,6 +138,20 @@ struct BigAllocator {
     Vector<BigAllocationBlock*, number_of_big_blocks_to_keep_around_per_size_class> blocks;
 };
 
+struct ThreadCache {
+    FreelistEntry* chunks[number_of_thread_cached_size_classes];
+    size_t chunk_count[number_of_thread_cached_size_classes];
+
+    // Calls served without the lock, folded into g_malloc_stats whenever the lock is taken.
+    size_t pending_malloc_count;
+    size_t pending_free_count;
+};
+
+static __thread ThreadCache t_thread_cache;
+
+// Protected by malloc_lock(). Block counts are filled in by get_malloc_stats().
+static malloc_stats g_malloc_stats;
+
 // Allocators will be initialized in __malloc_init.
 // We can not rely on global constructors to initialize them,
 // because they must be initialized before other global constructors
@@ -151,6 +171,11 @@ static inline BigAllocator (&big_allocators())[1]
     return reinterpret_cast<BigAllocator(&)[1]>(g_big_allocators_storage);
 }
 
+static size_t size_class_index(const Allocator& allocator)
+{
+    return &allocator - &allocators()[0];
+}
+
 static Allocator* allocator_for_size(size_t size, size_t& good_size)
 {
     for (int i = 0; size_classes[i]; ++i) {
@@ -194,55 +219,28 @@ static void os_free(void* ptr, size_t size)
     assert(rc == 0);
 }
 
-static void* malloc_impl(size_t size)
+static void fold_thread_cache_stats()
 {
-    LOCKER(malloc_lock());
-
-    if (s_log_malloc)
-        dbgprintf("LibC: malloc(%zu)\n", size);
-
-    if (!size)
-        return nullptr;
-
-    size_t good_size;
-    auto* allocator = allocator_for_size(size, good_size);
-
-    if (!allocator) {
-        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, block_size);
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(real_size)) {
-            if (!allocator->blocks.is_empty()) {
-                auto* block = allocator->blocks.take_last();
-                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
-                bool this_block_was_purged = rc == 1;
-                if (rc < 0) {
-                    perror("madvise");
-                    ASSERT_NOT_REACHED();
-                }
-                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
-                    perror("mprotect");
-                    ASSERT_NOT_REACHED();
-                }
-                if (this_block_was_purged)
-                    new (block) BigAllocationBlock(real_size);
-                return &block->m_slot[0];
-            }
-        }
-#endif
-        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
-        new (block) BigAllocationBlock(real_size);
-        return &block->m_slot[0];
-    }
+    auto& cache = t_thread_cache;
+    g_malloc_stats.malloc_count += cache.pending_malloc_count;
+    g_malloc_stats.thread_cache_malloc_count += cache.pending_malloc_count;
+    g_malloc_stats.free_count += cache.pending_free_count;
+    g_malloc_stats.thread_cache_free_count += cache.pending_free_count;
+    cache.pending_malloc_count = 0;
+    cache.pending_free_count = 0;
+}
 
+static void* allocate_chunk(Allocator& allocator, size_t good_size)
+{
     ChunkedBlock* block = nullptr;
 
-    for (block = allocator->usable_blocks.head(); block; block = block->next()) {
+    for (block = allocator.usable_blocks.head(); block; block = block->next()) {
         if (block->free_chunks())
             break;
     }
 
-    if (!block && allocator->empty_block_count) {
-        block = allocator->empty_blocks[--allocator->empty_block_count];
+    if (!block && allocator.empty_block_count) {
+        block = allocator.empty_blocks[--allocator.empty_block_count];
         int rc = madvise(block, block_size, MADV_SET_NONVOLATILE);
         bool this_block_was_purged = rc == 1;
         if (rc < 0) {
@@ -256,7 +254,7 @@ static void* malloc_impl(size_t size)
         }
         if (this_block_was_purged)
             new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
+        allocator.usable_blocks.append(block);
     }
 
     if (!block) {
@@ -264,8 +262,8 @@ static void* malloc_impl(size_t size)
         snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
         block = (ChunkedBlock*)os_alloc(block_size, buffer);
         new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
-        ++allocator->block_count;
+        allocator.usable_blocks.append(block);
+        ++allocator.block_count;
     }
 
     --block->m_free_chunks;
@@ -275,62 +273,17 @@ static void* malloc_impl(size_t size)
 #ifdef MALLOC_DEBUG
         dbgprintf("Block %p is now full in size class %zu\n", block, good_size);
 #endif
-        allocator->usable_blocks.remove(block);
-        allocator->full_blocks.append(block);
+        allocator.usable_blocks.remove(block);
+        allocator.full_blocks.append(block);
     }
 #ifdef MALLOC_DEBUG
     dbgprintf("LibC: allocated %p (chunk in block %p, size %zu)\n", ptr, block, block->bytes_per_chunk());
 #endif
-    if (s_scrub_malloc)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
     return ptr;
 }
 
-static void free_impl(void* ptr)
+static void release_chunk(ChunkedBlock* block, void* ptr)
 {
-    ScopedValueRollback rollback(errno);
-
-    if (!ptr)
-        return;
-
-    LOCKER(malloc_lock());
-
-    void* block_base = (void*)((FlatPtr)ptr & block_mask);
-    size_t magic = *(size_t*)block_base;
-
-    if (magic == MAGIC_BIGALLOC_HEADER) {
-        auto* block = (BigAllocationBlock*)block_base;
-#ifdef RECYCLE_BIG_ALLOCATIONS
-        if (auto* allocator = big_allocator_for_size(block->m_size)) {
-            if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
-                allocator->blocks.append(block);
-                size_t this_block_size = block->m_size;
-                if (mprotect(block, this_block_size, PROT_NONE) < 0) {
-                    perror("mprotect");
-                    ASSERT_NOT_REACHED();
-                }
-                if (madvise(block, this_block_size, MADV_SET_VOLATILE) != 0) {
-                    perror("madvise");
-                    ASSERT_NOT_REACHED();
-                }
-                return;
-            }
-        }
-#endif
-        os_free(block, block->m_size);
-        return;
-    }
-
-    assert(magic == MAGIC_PAGE_HEADER);
-    auto* block = (ChunkedBlock*)block_base;
-
-#ifdef MALLOC_DEBUG
-    dbgprintf("LibC: freeing %p in allocator %p (size=%u, used=%u)\n", ptr, block, block->bytes_per_chunk(), block->used_chunks());
-#endif
-
-    if (s_scrub_free)
-        memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
-
     auto* entry = (FreelistEntry*)ptr;
     entry->next = block->m_freelist;
     block->m_freelist = entry;
@@ -350,7 +303,7 @@ static void free_impl(void* ptr)
     if (!block->used_chunks()) {
         size_t good_size;
         auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
+        if (allocator->empty_block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
 #ifdef MALLOC_DEBUG
             dbgprintf("Keeping block %p around for size class %u\n", block, good_size);
 #endif
@@ -369,6 +322,184 @@ static void free_impl(void* ptr)
     }
 }
 
+static void refill_thread_cache(Allocator& allocator, size_t good_size)
+{
+    LOCKER(malloc_lock());
+    fold_thread_cache_stats();
+    auto index = size_class_index(allocator);
+    auto& cache = t_thread_cache;
+    for (size_t i = 0; i < thread_cache_batch_size; ++i) {
+        auto* entry = (FreelistEntry*)allocate_chunk(allocator, good_size);
+        entry->next = cache.chunks[index];
+        cache.chunks[index] = entry;
+        ++cache.chunk_count[index];
+    }
+}
+
+static void flush_thread_cache(size_t index, size_t count)
+{
+    LOCKER(malloc_lock());
+    fold_thread_cache_stats();
+    auto& cache = t_thread_cache;
+    for (size_t i = 0; i < count && cache.chunks[index]; ++i) {
+        auto* entry = cache.chunks[index];
+        cache.chunks[index] = entry->next;
+        --cache.chunk_count[index];
+        release_chunk((ChunkedBlock*)((FlatPtr)entry & block_mask), entry);
+    }
+}
+
+static void* malloc_impl(size_t size)
+{
+    if (s_log_malloc)
+        dbgprintf("LibC: malloc(%zu)\n", size);
+
+    if (!size)
+        return nullptr;
+
+    size_t good_size;
+    auto* allocator = allocator_for_size(size, good_size);
+
+    if (allocator && size_class_index(*allocator) < number_of_thread_cached_size_classes) {
+        auto index = size_class_index(*allocator);
+        auto& cache = t_thread_cache;
+        if (!cache.chunks[index])
+            refill_thread_cache(*allocator, good_size);
+        auto* ptr = cache.chunks[index];
+        cache.chunks[index] = ptr->next;
+        --cache.chunk_count[index];
+        ++cache.pending_malloc_count;
+        if (s_scrub_malloc)
+            memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+        return ptr;
+    }
+
+    LOCKER(malloc_lock());
+    ++g_malloc_stats.malloc_count;
+
+    if (!allocator) {
+        size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, block_size);
+        ++g_malloc_stats.big_allocation_count;
+#ifdef RECYCLE_BIG_ALLOCATIONS
+        if (auto* allocator = big_allocator_for_size(real_size)) {
+            if (!allocator->blocks.is_empty()) {
+                auto* block = allocator->blocks.take_last();
+                int rc = madvise(block, real_size, MADV_SET_NONVOLATILE);
+                bool this_block_was_purged = rc == 1;
+                if (rc < 0) {
+                    perror("madvise");
+                    ASSERT_NOT_REACHED();
+                }
+                if (mprotect(block, real_size, PROT_READ | PROT_WRITE) < 0) {
+                    perror("mprotect");
+                    ASSERT_NOT_REACHED();
+                }
+                if (this_block_was_purged)
+                    new (block) BigAllocationBlock(real_size);
+                return &block->m_slot[0];
+            }
+        }
+#endif
+        auto* block = (BigAllocationBlock*)os_alloc(real_size, "malloc: BigAllocationBlock");
+        new (block) BigAllocationBlock(real_size);
+        return &block->m_slot[0];
+    }
+
+    void* ptr = allocate_chunk(*allocator, good_size);
+    if (s_scrub_malloc)
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+    return ptr;
+}
+
+static void free_impl(void* ptr)
+{
+    ScopedValueRollback rollback(errno);
+
+    if (!ptr)
+        return;
+
+    // The block header doesn't change while one of its chunks is allocated, so we can look at it without the lock.
+    void* block_base = (void*)((FlatPtr)ptr & block_mask);
+    size_t magic = *(size_t*)block_base;
+
+    if (magic == MAGIC_PAGE_HEADER) {
+        auto* block = (ChunkedBlock*)block_base;
+#ifdef MALLOC_DEBUG
+        dbgprintf("LibC: freeing %p in allocator %p (size=%u, used=%u)\n", ptr, block, block->bytes_per_chunk(), block->used_chunks());
+#endif
+        if (s_scrub_free)
+            memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        auto index = size_class_index(*allocator);
+        if (index < number_of_thread_cached_size_classes) {
+            auto& cache = t_thread_cache;
+            if (cache.chunk_count[index] >= thread_cache_capacity_per_size_class)
+                flush_thread_cache(index, thread_cache_batch_size);
+            auto* entry = (FreelistEntry*)ptr;
+            entry->next = cache.chunks[index];
+            cache.chunks[index] = entry;
+            ++cache.chunk_count[index];
+            ++cache.pending_free_count;
+            return;
+        }
+
+        LOCKER(malloc_lock());
+        ++g_malloc_stats.free_count;
+        release_chunk(block, ptr);
+        return;
+    }
+
+    assert(magic == MAGIC_BIGALLOC_HEADER);
+
+    LOCKER(malloc_lock());
+    ++g_malloc_stats.free_count;
+    --g_malloc_stats.big_allocation_count;
+
+    auto* block = (BigAllocationBlock*)block_base;
+#ifdef RECYCLE_BIG_ALLOCATIONS
+    if (auto* allocator = big_allocator_for_size(block->m_size)) {
+        if (allocator->blocks.size() < number_of_big_blocks_to_keep_around_per_size_class) {
+            allocator->blocks.append(block);
+            size_t this_block_size = block->m_size;
+            if (mprotect(block, this_block_size, PROT_NONE) < 0) {
+                perror("mprotect");
+                ASSERT_NOT_REACHED();
+            }
+            if (madvise(block, this_block_size, MADV_SET_VOLATILE) != 0) {
+                perror("madvise");
+                ASSERT_NOT_REACHED();
+            }
+            return;
+        }
+    }
+#endif
+    os_free(block, block->m_size);
+}
+
+void __malloc_thread_exit()
+{
+    for (size_t i = 0; i < number_of_thread_cached_size_classes; ++i)
+        flush_thread_cache(i, t_thread_cache.chunk_count[i]);
+    LOCKER(malloc_lock());
+    fold_thread_cache_stats();
+}
+
+void get_malloc_stats(malloc_stats* stats)
+{
+    LOCKER(malloc_lock());
+    fold_thread_cache_stats();
+    *stats = g_malloc_stats;
+    stats->chunked_block_count = 0;
+    stats->empty_chunked_block_count = 0;
+    for (size_t i = 0; i < num_size_classes; ++i) {
+        stats->chunked_block_count += allocators()[i].block_count;
+        stats->empty_chunked_block_count += allocators()[i].empty_block_count;
+    }
+    stats->recycled_big_block_count = big_allocators()[0].blocks.size();
+}
+
 void* malloc(size_t size)
 {
     void* ptr = malloc_impl(size);
@@ -396,7 +527,6 @@ size_t malloc_size(void* ptr)
 {
     if (!ptr)
         return 0;
-    LOCKER(malloc_lock());
     void* page_base = (void*)((FlatPtr)ptr & block_mask);
     auto* header = (const CommonHeader*)page_base;
     auto size = header->m_size;
@@ -409,7 +539,6 @@ void* realloc(void* ptr, size_t size)
 {
     if (!ptr)
         return malloc(size);
-    LOCKER(malloc_lock());
     auto existing_allocation_size = malloc_size(ptr);
     if (size <= existing_allocation_size)
         return ptr;
@@ -422,10 +551,10 @@ void* realloc(void* ptr, size_t size)
 void __malloc_init()
 {
     new (&malloc_lock()) LibThread::Lock();
-    if (getenv("LIBC_NOSCRUB_MALLOC"))
-        s_scrub_malloc = false;
-    if (getenv("LIBC_NOSCRUB_FREE"))
-        s_scrub_free = false;
+    if (getenv("LIBC_SCRUB_MALLOC")) {
+        s_scrub_malloc = true;
+        s_scrub_free = true;
+    }
     if (getenv("LIBC_LOG_MALLOC"))
         s_log_malloc = true;
     if (getenv("LIBC_PROFILE_MALLOC"))
@@ -70,4 +70,17 @@ int perf_event(int type, uintptr_t arg1, uintptr_t arg2);
 
 int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size);
 
+struct malloc_stats {
+    size_t malloc_count;
+    size_t free_count;
+    size_t thread_cache_malloc_count;
+    size_t thread_cache_free_count;
+    size_t chunked_block_count;
+    size_t empty_chunked_block_count;
+    size_t big_allocation_count;
+    size_t recycled_big_block_count;
+};
+
+void get_malloc_stats(struct malloc_stats*);
+
 __END_DECLS
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ScopedValueRollback.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <Kernel/Syscall.h>
+#include <errno.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern "C" {
+
+static Syscall::SC_posix_spawn_file_action* append_file_action(posix_spawn_file_actions_t* file_actions)
+{
+    if (file_actions->action_count == file_actions->action_capacity) {
+        size_t new_capacity = file_actions->action_capacity ? file_actions->action_capacity * 2 : 4;
+        auto* new_actions = realloc(file_actions->actions, new_capacity * sizeof(Syscall::SC_posix_spawn_file_action));
+        if (!new_actions)
+            return nullptr;
+        file_actions->actions = new_actions;
+        file_actions->action_capacity = new_capacity;
+    }
+    auto* action = &static_cast<Syscall::SC_posix_spawn_file_action*>(file_actions->actions)[file_actions->action_count++];
+    *action = {};
+    return action;
+}
+
+static int do_posix_spawn(pid_t* pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    if (!envp)
+        envp = environ;
+
+    auto copy_strings = [](char* const strings[], Vector<Syscall::StringArgument, 32>& output) {
+        for (size_t i = 0; strings[i]; ++i)
+            output.append({ strings[i], strlen(strings[i]) });
+    };
+
+    Vector<Syscall::StringArgument, 32> arguments;
+    Vector<Syscall::StringArgument, 32> environment;
+    copy_strings(argv, arguments);
+    copy_strings(envp, environment);
+
+    Syscall::SC_posix_spawn_params params;
+    params.path = { path, strlen(path) };
+    params.arguments = { arguments.data(), arguments.size() };
+    params.environment = { environment.data(), environment.size() };
+    params.file_actions = file_actions ? static_cast<const Syscall::SC_posix_spawn_file_action*>(file_actions->actions) : nullptr;
+    params.file_action_count = file_actions ? file_actions->action_count : 0;
+    params.flags = attr ? attr->flags : 0;
+    params.pgroup = attr ? attr->pgroup : 0;
+    params.sigmask = attr ? attr->sigmask : 0;
+    params.tcsetpgrp_fd = attr ? attr->tcsetpgrp_fd : -1;
+
+    int rc = syscall(SC_posix_spawn, &params);
+    if (rc < 0)
+        return -rc;
+    if (pid)
+        *pid = rc;
+    return 0;
+}
+
+int posix_spawn(pid_t* pid, const char* path, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    return do_posix_spawn(pid, path, file_actions, attr, argv, envp);
+}
+
+int posix_spawnp(pid_t* pid, const char* file, const posix_spawn_file_actions_t* file_actions, const posix_spawnattr_t* attr, char* const argv[], char* const envp[])
+{
+    if (strchr(file, '/'))
+        return do_posix_spawn(pid, file, file_actions, attr, argv, envp);
+
+    String path = getenv("PATH");
+    if (path.is_empty())
+        path = "/bin:/usr/bin";
+    // Find the program before spawning anything, so there's only ever one child
+    // and its file actions (which may truncate or create files) only happen once.
+    ScopedValueRollback errno_rollback(errno);
+    int error = ENOENT;
+    auto parts = path.split(':');
+    for (auto& part : parts) {
+        auto candidate = String::format("%s/%s", part.characters(), file);
+        if (access(candidate.characters(), X_OK) == 0)
+            return do_posix_spawn(pid, candidate.characters(), file_actions, attr, argv, envp);
+        if (errno == EACCES)
+            error = EACCES;
+    }
+    return error;
+}
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t* file_actions)
+{
+    file_actions->actions = nullptr;
+    file_actions->action_count = 0;
+    file_actions->action_capacity = 0;
+    return 0;
+}
+
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t* file_actions)
+{
+    auto* actions = static_cast<Syscall::SC_posix_spawn_file_action*>(file_actions->actions);
+    for (size_t i = 0; i < file_actions->action_count; ++i)
+        free(const_cast<char*>(actions[i].path.characters));
+    free(actions);
+    return posix_spawn_file_actions_init(file_actions);
+}
+
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t* file_actions, int fd, const char* path, int flags, mode_t mode)
+{
+    if (fd < 0)
+        return EBADF;
+    char* path_copy = strdup(path);
+    if (!path_copy)
+        return ENOMEM;
+    auto* action = append_file_action(file_actions);
+    if (!action) {
+        free(path_copy);
+        return ENOMEM;
+    }
+    action->type = Syscall::SpawnFileActionType::Open;
+    action->fd = fd;
+    action->flags = flags;
+    action->mode = mode;
+    action->path = { path_copy, strlen(path_copy) };
+    return 0;
+}
+
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t* file_actions, int fd)
+{
+    if (fd < 0)
+        return EBADF;
+    auto* action = append_file_action(file_actions);
+    if (!action)
+        return ENOMEM;
+    action->type = Syscall::SpawnFileActionType::Close;
+    action->fd = fd;
+    return 0;
+}
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t* file_actions, int old_fd, int new_fd)
+{
+    if (old_fd < 0 || new_fd < 0)
+        return EBADF;
+    auto* action = append_file_action(file_actions);
+    if (!action)
+        return ENOMEM;
+    action->type = Syscall::SpawnFileActionType::Dup2;
+    action->fd = old_fd;
+    action->new_fd = new_fd;
+    return 0;
+}
+
+int posix_spawn_file_actions_addchdir(posix_spawn_file_actions_t* file_actions, const char* path)
+{
+    char* path_copy = strdup(path);
+    if (!path_copy)
+        return ENOMEM;
+    auto* action = append_file_action(file_actions);
+    if (!action) {
+        free(path_copy);
+        return ENOMEM;
+    }
+    action->type = Syscall::SpawnFileActionType::Chdir;
+    action->path = { path_copy, strlen(path_copy) };
+    return 0;
+}
+
+int posix_spawnattr_init(posix_spawnattr_t* attr)
+{
+    attr->flags = 0;
+    attr->pgroup = 0;
+    attr->sigdefault = 0;
+    attr->sigmask = 0;
+    attr->tcsetpgrp_fd = -1;
+    return 0;
+}
+
+int posix_spawnattr_destroy(posix_spawnattr_t*)
+{
+    return 0;
+}
+
+int posix_spawnattr_getflags(const posix_spawnattr_t* attr, short* flags)
+{
+    *flags = attr->flags;
+    return 0;
+}
+
+int posix_spawnattr_setflags(posix_spawnattr_t* attr, short flags)
+{
+    if (flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSID | POSIX_SPAWN_TCSETPGROUP))
+        return EINVAL;
+    attr->flags = flags;
+    return 0;
+}
+
+int posix_spawnattr_getpgroup(const posix_spawnattr_t* attr, pid_t* pgroup)
+{
+    *pgroup = attr->pgroup;
+    return 0;
+}
+
+int posix_spawnattr_setpgroup(posix_spawnattr_t* attr, pid_t pgroup)
+{
+    attr->pgroup = pgroup;
+    return 0;
+}
+
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t* attr, sigset_t* sigdefault)
+{
+    *sigdefault = attr->sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_setsigdefault(posix_spawnattr_t* attr, const sigset_t* sigdefault)
+{
+    // NOTE: exec() already resets every signal disposition to its default,
+    //       so the set is only stored for posix_spawnattr_getsigdefault().
+    attr->sigdefault = *sigdefault;
+    return 0;
+}
+
+int posix_spawnattr_getsigmask(const posix_spawnattr_t* attr, sigset_t* sigmask)
+{
+    *sigmask = attr->sigmask;
+    return 0;
+}
+
+int posix_spawnattr_setsigmask(posix_spawnattr_t* attr, const sigset_t* sigmask)
+{
+    attr->sigmask = *sigmask;
+    return 0;
+}
+
+int posix_spawnattr_tcgetpgrp_np(const posix_spawnattr_t* attr, int* fd)
+{
+    *fd = attr->tcsetpgrp_fd;
+    return 0;
+}
+
+int posix_spawnattr_tcsetpgrp_np(posix_spawnattr_t* attr, int fd)
+{
+    attr->tcsetpgrp_fd = fd;
+    return 0;
+}
+}
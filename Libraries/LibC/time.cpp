@@ -49,18 +49,45 @@ time_t time(time_t* tloc)
     return tv.tv_sec;
 }
 
-int gettimeofday(struct timeval* __restrict__ tv, void* __restrict__)
+static volatile KernelInfoPage* kernel_info_page()
 {
     static volatile KernelInfoPage* kernel_info;
     if (!kernel_info)
         kernel_info = (volatile KernelInfoPage*)syscall(SC_get_kernel_info_page);
+    return kernel_info;
+}
+
+static inline u64 read_tsc()
+{
+    u32 lsw;
+    u32 msw;
+    asm volatile("rdtsc"
+                 : "=d"(msw), "=a"(lsw));
+    return ((u64)msw << 32) | lsw;
+}
 
+static u64 read_monotonic_nanoseconds(u32& epoch_offset_seconds)
+{
+    auto* kernel_info = kernel_info_page();
     for (;;) {
-        auto serial = kernel_info->serial;
-        *tv = const_cast<struct timeval&>(kernel_info->now);
+        u32 serial = kernel_info->serial;
+        if (serial & 1)
+            continue;
+        u64 nanoseconds = kernel_info->monotonic_nanoseconds;
+        if (kernel_info->tsc_is_usable)
+            nanoseconds += tsc_delta_to_nanoseconds(read_tsc() - kernel_info->tsc_base, kernel_info->tsc_multiplier);
+        epoch_offset_seconds = kernel_info->epoch_offset_seconds;
         if (serial == kernel_info->serial)
-            break;
+            return nanoseconds;
     }
+}
+
+int gettimeofday(struct timeval* __restrict__ tv, void* __restrict__)
+{
+    u32 epoch_offset_seconds;
+    u64 nanoseconds = read_monotonic_nanoseconds(epoch_offset_seconds);
+    tv->tv_sec = nanoseconds / 1000000000ull + epoch_offset_seconds;
+    tv->tv_usec = (nanoseconds % 1000000000ull) / 1000;
     return 0;
 }
 
@@ -323,6 +350,15 @@ clock_t clock()
 
 int clock_gettime(clockid_t clock_id, struct timespec* ts)
 {
+    if (clock_id == CLOCK_MONOTONIC || clock_id == CLOCK_REALTIME) {
+        u32 epoch_offset_seconds;
+        u64 nanoseconds = read_monotonic_nanoseconds(epoch_offset_seconds);
+        ts->tv_sec = nanoseconds / 1000000000ull;
+        ts->tv_nsec = nanoseconds % 1000000000ull;
+        if (clock_id == CLOCK_REALTIME)
+            ts->tv_sec += epoch_offset_seconds;
+        return 0;
+    }
     int rc = syscall(SC_clock_gettime, clock_id, ts);
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
@@ -62,9 +62,14 @@ int fchown(int fd, uid_t uid, gid_t gid)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+// A thread's id never changes, so we only ask the kernel once. fork() resets this in the child.
+static __thread int s_cached_tid = 0;
+
 pid_t fork()
 {
     int rc = syscall(SC_fork);
+    if (rc == 0)
+        s_cached_tid = 0;
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
@@ -549,7 +554,9 @@ int ftruncate(int fd, off_t length)
 
 int gettid()
 {
-    return syscall(SC_gettid);
+    if (s_cached_tid == 0)
+        s_cached_tid = syscall(SC_gettid);
+    return s_cached_tid;
 }
 
 int donate(int tid)
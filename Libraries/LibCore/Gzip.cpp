@@ -27,9 +27,6 @@
 #include <AK/ByteBuffer.h>
 #include <AK/Optional.h>
 #include <LibCore/Gzip.h>
-#include <LibCore/puff.h>
-#include <limits.h>
-#include <stddef.h>
 
 //#define DEBUG_GZIP
 
@@ -40,116 +37,103 @@ bool Gzip::is_compressed(const ByteBuffer& data)
     return data.size() > 2 && data[0] == 0x1F && data[1] == 0x8b;
 }
 
-// skips the gzip header
+// Returns the size of the gzip member header at the start of `data`, 0 if more data is needed, or -1 if it is invalid.
 // see: https://tools.ietf.org/html/rfc1952#page-5
-static Optional<ByteBuffer> get_gzip_payload(const ByteBuffer& data)
+static int parse_gzip_header(const u8* data, size_t size)
 {
-    size_t current = 0;
-    auto read_byte = [&]() {
-        if (current >= data.size()) {
-            ASSERT_NOT_REACHED();
-            return (u8)0;
-        }
-        // dbg() << "read_byte: " << String::format("%x", data[current]);
-        return data[current++];
-    };
-
-    dbg() << "get_gzip_payload: Skipping over gzip header.";
+    if (size < 10)
+        return 0;
 
     // Magic Header
-    if (read_byte() != 0x1F || read_byte() != 0x8B) {
-        dbg() << "get_gzip_payload: Wrong magic number.";
-        return Optional<ByteBuffer>();
+    if (data[0] != 0x1F || data[1] != 0x8B) {
+        dbg() << "parse_gzip_header: Wrong magic number.";
+        return -1;
     }
 
     // Compression method
-    auto method = read_byte();
-    if (method != 8) {
-        dbg() << "get_gzip_payload: Wrong compression method = " << method;
-        return Optional<ByteBuffer>();
+    if (data[2] != 8) {
+        dbg() << "parse_gzip_header: Wrong compression method = " << (int)data[2];
+        return -1;
     }
 
-    u8 flags = read_byte();
+    u8 flags = data[3];
 
     // Timestamp, Extra flags, OS
-    current += 6;
+    size_t current = 10;
 
     // FEXTRA
     if (flags & 4) {
-        u16 length = read_byte() & read_byte() << 8;
-        dbg() << "get_gzip_payload: Header has FEXTRA flag set. Length = " << length;
-        current += length;
-    }
-
-    // FNAME
-    if (flags & 8) {
-        dbg() << "get_gzip_payload: Header has FNAME flag set.";
-        while (read_byte() != '\0')
-            ;
+        if (current + 2 > size)
+            return 0;
+        u16 length = data[current] | data[current + 1] << 8;
+#ifdef DEBUG_GZIP
+        dbg() << "parse_gzip_header: Header has FEXTRA flag set. Length = " << length;
+#endif
+        current += 2 + length;
     }
 
-    // FCOMMENT
-    if (flags & 16) {
-        dbg() << "get_gzip_payload: Header has FCOMMENT flag set.";
-        while (read_byte() != '\0')
-            ;
+    // FNAME, FCOMMENT
+    for (u8 flag : { 8, 16 }) {
+        if (!(flags & flag))
+            continue;
+        do {
+            if (current >= size)
+                return 0;
+        } while (data[current++] != '\0');
     }
 
     // FHCRC
-    if (flags & 2) {
-        dbg() << "get_gzip_payload: Header has FHCRC flag set.";
+    if (flags & 2)
         current += 2;
+
+    if (current > size)
+        return 0;
+    return current;
+}
+
+GzipDecompressor::Status GzipDecompressor::write(const u8* data, size_t size)
+{
+    if (m_header_is_invalid)
+        return Status::Error;
+    if (m_header_is_parsed)
+        return m_inflater.write(data, size);
+
+    m_header.append(data, size);
+    int header_size = parse_gzip_header(m_header.data(), m_header.size());
+    if (header_size == 0)
+        return Status::NeedsMoreInput;
+    if (header_size < 0) {
+        m_header_is_invalid = true;
+        return Status::Error;
     }
 
-    auto new_size = data.size() - current;
-    dbg() << "get_gzip_payload: Returning slice from " << current << " with size " << new_size;
-    return data.slice(current, new_size);
+    m_header_is_parsed = true;
+    auto status = m_inflater.write(m_header.data() + header_size, m_header.size() - header_size);
+    m_header.clear();
+    return status;
 }
 
 Optional<ByteBuffer> Gzip::decompress(const ByteBuffer& data)
 {
     ASSERT(is_compressed(data));
 
-    dbg() << "Gzip::decompress: Decompressing gzip compressed data. Size = " << data.size();
-    auto optional_payload = get_gzip_payload(data);
-    if (!optional_payload.has_value()) {
-        return Optional<ByteBuffer>();
-    }
-
-    auto source = optional_payload.value();
-    unsigned long source_len = source.size();
-    auto destination = ByteBuffer::create_uninitialized(1024);
-    while (true) {
-        unsigned long destination_len = destination.size();
-
 #ifdef DEBUG_GZIP
-        dbg() << "Gzip::decompress: Calling puff()\n"
-              << "  destination_data = " << destination.data() << "\n"
-              << "  destination_len = " << destination_len << "\n"
-              << "  source_data = " << source.data() << "\n"
-              << "  source_len = " << source_len;
+    dbg() << "Gzip::decompress: Decompressing gzip compressed data. Size = " << data.size();
 #endif
 
-        auto puff_ret = puff(
-            destination.data(), &destination_len,
-            source.data(), &source_len);
-
-        if (puff_ret == 0) {
-            dbg() << "Gzip::decompress: Decompression success.";
-            break;
-        }
-
-        if (puff_ret == 1) {
-            // FIXME: Find a better way of decompressing without needing to try over and over again.
-            dbg() << "Gzip::decompress: Output buffer exhausted. Growing.";
-            destination.grow(destination.size() * 2);
-        } else {
-            dbg() << "Gzip::decompress: Error. puff() returned: " << puff_ret;
-            ASSERT_NOT_REACHED();
-        }
+    Vector<u8> output;
+    GzipDecompressor decompressor;
+    decompressor.set_on_output([&](const u8* bytes, size_t size) {
+        output.append(bytes, size);
+    });
+
+    auto status = decompressor.write(data.data(), data.size());
+    if (status != GzipDecompressor::Status::Finished) {
+        dbg() << "Gzip::decompress: Error. Inflater status: " << (int)status;
+        return {};
     }
 
-    return destination;
+    return ByteBuffer::copy(output.data(), output.size());
 }
 
 }
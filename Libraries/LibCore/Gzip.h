@@ -24,9 +24,13 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#pragma once
+
 #include <AK/ByteBuffer.h>
 #include <AK/Optional.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/Inflate.h>
 
 namespace Core {
 
@@ -36,4 +40,22 @@ public:
     static Optional<ByteBuffer> decompress(const ByteBuffer& data);
 };
 
+// Decodes a gzip stream as it arrives: the member header is parsed once enough of it is buffered,
+// and the payload goes straight into an Inflater.
+class GzipDecompressor {
+public:
+    using Status = Inflater::Status;
+
+    Status write(const u8* data, size_t size);
+    Status status() const { return m_inflater.status(); }
+
+    void set_on_output(Function<void(const u8*, size_t)> on_output) { m_inflater.on_output = move(on_output); }
+
+private:
+    bool m_header_is_parsed { false };
+    bool m_header_is_invalid { false };
+    Vector<u8> m_header;
+    Inflater m_inflater;
+};
+
 }
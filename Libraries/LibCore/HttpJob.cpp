@@ -35,39 +35,6 @@
 
 namespace Core {
 
-static ByteBuffer handle_content_encoding(const ByteBuffer& buf, const String& content_encoding)
-{
-#ifdef CHTTPJOB_DEBUG
-    dbg() << "HttpJob::handle_content_encoding: buf has content_encoding = " << content_encoding;
-#endif
-
-    if (content_encoding == "gzip") {
-        if (!Gzip::is_compressed(buf)) {
-            dbg() << "HttpJob::handle_content_encoding: buf is not gzip compressed!";
-        }
-
-#ifdef CHTTPJOB_DEBUG
-        dbg() << "HttpJob::handle_content_encoding: buf is gzip compressed!";
-#endif
-
-        auto uncompressed = Gzip::decompress(buf);
-        if (!uncompressed.has_value()) {
-            dbg() << "HttpJob::handle_content_encoding: Gzip::decompress() failed. Returning original buffer.";
-            return buf;
-        }
-
-#ifdef CHTTPJOB_DEBUG
-        dbg() << "HttpJob::handle_content_encoding: Gzip::decompress() successful.\n"
-              << "  Input size = " << buf.size() << "\n"
-              << "  Output size = " << uncompressed.value().size();
-#endif
-
-        return uncompressed.value();
-    }
-
-    return buf;
-}
-
 HttpJob::HttpJob(const HttpRequest& request)
     : m_request(request)
 {
@@ -125,6 +92,7 @@ void HttpJob::on_socket_connected()
             auto chomped_line = String::copy(line, Chomp);
             if (chomped_line.is_empty()) {
                 m_state = State::InBody;
+                start_content_decoding();
                 return;
             }
             auto parts = chomped_line.split(':');
@@ -152,8 +120,18 @@ void HttpJob::on_socket_connected()
                 return finish_up();
             return deferred_invoke([this](auto&) { did_fail(NetworkJob::Error::ProtocolFailed); });
         }
-        m_received_buffers.append(payload);
         m_received_size += payload.size();
+        if (m_gzip_decompressor) {
+            // The body is inflated as it arrives, so m_received_buffers only ever holds decoded data.
+            auto status = m_gzip_decompressor->write(payload.data(), payload.size());
+            if (status == GzipDecompressor::Status::Error) {
+                fprintf(stderr, "HttpJob: Failed to decode gzip content\n");
+                return deferred_invoke([this](auto&) { did_fail(NetworkJob::Error::ProtocolFailed); });
+            }
+        } else {
+            m_received_buffers.append(payload);
+            did_receive_data(payload);
+        }
 
         auto content_length_header = m_headers.get("Content-Length");
         if (content_length_header.has_value()) {
@@ -164,21 +142,40 @@ void HttpJob::on_socket_connected()
     };
 }
 
+void HttpJob::start_content_decoding()
+{
+    auto content_encoding = m_headers.get("Content-Encoding");
+    if (!content_encoding.has_value() || content_encoding.value() != "gzip")
+        return;
+#ifdef CHTTPJOB_DEBUG
+    dbg() << "HttpJob: Decoding gzip content as it arrives";
+#endif
+    m_gzip_decompressor = make<GzipDecompressor>();
+    m_gzip_decompressor->set_on_output([this](const u8* data, size_t size) {
+        m_received_buffers.append(ByteBuffer::copy(data, size));
+        did_receive_data(m_received_buffers.last());
+    });
+}
+
 void HttpJob::finish_up()
 {
     m_state = State::Finished;
-    auto flattened_buffer = ByteBuffer::create_uninitialized(m_received_size);
+    if (m_gzip_decompressor && m_gzip_decompressor->status() != GzipDecompressor::Status::Finished) {
+        fprintf(stderr, "HttpJob: gzip content ended early\n");
+        return deferred_invoke([this](auto&) { did_fail(NetworkJob::Error::ProtocolFailed); });
+    }
+
+    size_t body_size = 0;
+    for (auto& received_buffer : m_received_buffers)
+        body_size += received_buffer.size();
+    auto flattened_buffer = ByteBuffer::create_uninitialized(body_size);
     u8* flat_ptr = flattened_buffer.data();
     for (auto& received_buffer : m_received_buffers) {
         memcpy(flat_ptr, received_buffer.data(), received_buffer.size());
         flat_ptr += received_buffer.size();
     }
     m_received_buffers.clear();
-
-    auto content_encoding = m_headers.get("Content-Encoding");
-    if (content_encoding.has_value()) {
-        flattened_buffer = handle_content_encoding(flattened_buffer, content_encoding.value());
-    }
+    m_gzip_decompressor = nullptr;
 
     auto response = HttpResponse::create(m_code, move(m_headers), move(flattened_buffer));
     deferred_invoke([this, response](auto&) {
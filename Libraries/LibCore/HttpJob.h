@@ -27,6 +27,8 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <LibCore/Gzip.h>
 #include <LibCore/HttpRequest.h>
 #include <LibCore/HttpResponse.h>
 #include <LibCore/NetworkJob.h>
@@ -47,6 +49,7 @@ public:
 
 private:
     void on_socket_connected();
+    void start_content_decoding();
     void finish_up();
 
     enum class State {
@@ -63,6 +66,7 @@ private:
     HashMap<String, String> m_headers;
     Vector<ByteBuffer> m_received_buffers;
     size_t m_received_size { 0 };
+    OwnPtr<GzipDecompressor> m_gzip_decompressor;
 };
 
 }
@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCore/Inflate.h>
+#include <string.h>
+
+//#define INFLATE_DEBUG
+
+namespace Core {
+
+static constexpr size_t history_size = 32 * KB;
+static constexpr size_t window_size = 2 * history_size;
+static constexpr size_t max_match_length = 258;
+
+static const u16 s_length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const u8 s_length_extra_bits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const u16 s_distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const u8 s_distance_extra_bits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const u8 s_code_length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+int Inflater::HuffmanTable::build(const u8* lengths, size_t count)
+{
+    memset(counts, 0, sizeof(counts));
+    memset(fast, 0, sizeof(fast));
+    for (size_t i = 0; i < count; ++i)
+        counts[lengths[i]]++;
+    // No codes at all is fine as long as nothing tries to decode with this table.
+    if (counts[0] == count)
+        return 0;
+
+    int left = 1;
+    for (int length = 1; length < 16; ++length) {
+        left <<= 1;
+        left -= counts[length];
+        if (left < 0)
+            return left;
+    }
+
+    u16 offsets[16];
+    offsets[1] = 0;
+    for (int length = 1; length < 15; ++length)
+        offsets[length + 1] = offsets[length] + counts[length];
+    for (size_t symbol = 0; symbol < count; ++symbol) {
+        if (lengths[symbol])
+            symbols[offsets[lengths[symbol]]++] = symbol;
+    }
+
+    // Walk the codes in canonical order and spread each short one over every fast-table slot it prefixes.
+    // DEFLATE packs Huffman codes starting from the most significant bit, so the index is bit-reversed.
+    u32 code = 0;
+    size_t index = 0;
+    for (int length = 1; length <= fast_bits; ++length) {
+        for (int i = 0; i < counts[length]; ++i, ++code, ++index) {
+            u32 reversed = 0;
+            for (int bit = 0; bit < length; ++bit)
+                reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+            u16 entry = (symbols[index] << 4) | length;
+            for (u32 slot = reversed; slot < (1u << fast_bits); slot += 1u << length)
+                fast[slot] = entry;
+        }
+        code <<= 1;
+    }
+    return left;
+}
+
+bool Inflater::HuffmanTable::is_complete_or_single_code(int left) const
+{
+    if (left < 0)
+        return false;
+    if (left == 0)
+        return true;
+    int used_lengths = 0;
+    for (int length = 1; length < 16; ++length)
+        used_lengths += counts[length];
+    return used_lengths == 1;
+}
+
+static const Inflater::HuffmanTable& fixed_literal_table()
+{
+    static Inflater::HuffmanTable* table;
+    if (!table) {
+        u8 lengths[288];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        table = new Inflater::HuffmanTable;
+        table->build(lengths, 288);
+    }
+    return *table;
+}
+
+static const Inflater::HuffmanTable& fixed_distance_table()
+{
+    static Inflater::HuffmanTable* table;
+    if (!table) {
+        u8 lengths[30];
+        memset(lengths, 5, 30);
+        table = new Inflater::HuffmanTable;
+        table->build(lengths, 30);
+    }
+    return *table;
+}
+
+Inflater::Inflater()
+{
+}
+
+Inflater::~Inflater()
+{
+}
+
+void Inflater::reset()
+{
+    m_status = Status::NeedsMoreInput;
+    m_state = State::BlockHeader;
+    m_in_final_block = false;
+    m_stored_bytes_remaining = 0;
+    m_pending_input.clear_with_capacity();
+    m_bit_buffer = 0;
+    m_bit_count = 0;
+    m_window_offset = 0;
+    m_window_flushed_offset = 0;
+    m_total_output_size = 0;
+    m_literal_table = nullptr;
+    m_distance_table = nullptr;
+}
+
+int Inflater::decode_symbol(const HuffmanTable& table)
+{
+    if (m_bit_count < 15)
+        fill_bit_buffer();
+
+    u16 entry = table.fast[m_bit_buffer & ((1 << HuffmanTable::fast_bits) - 1)];
+    if (entry) {
+        u32 length = entry & 15;
+        if (length > m_bit_count)
+            return -1;
+        m_bit_buffer >>= length;
+        m_bit_count -= length;
+        return entry >> 4;
+    }
+
+    // The code is longer than the fast table covers, so walk the canonical code one bit at a time.
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (u32 length = 1; length < 16; ++length) {
+        if (length > m_bit_count)
+            return -1;
+        code |= (m_bit_buffer >> (length - 1)) & 1;
+        int count = table.counts[length];
+        if (code - count < first) {
+            m_bit_buffer >>= length;
+            m_bit_count -= length;
+            return table.symbols[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -2;
+}
+
+void Inflater::flush_window(bool slide)
+{
+    if (m_window_offset > m_window_flushed_offset) {
+        if (on_output)
+            on_output(m_window.data() + m_window_flushed_offset, m_window_offset - m_window_flushed_offset);
+        m_total_output_size += m_window_offset - m_window_flushed_offset;
+    }
+    m_window_flushed_offset = m_window_offset;
+
+    if (!slide || m_window_offset < history_size)
+        return;
+    memmove(m_window.data(), m_window.data() + m_window_offset - history_size, history_size);
+    m_window_offset = history_size;
+    m_window_flushed_offset = history_size;
+}
+
+bool Inflater::read_dynamic_tables()
+{
+    u32 literal_count, distance_count, code_length_count;
+    if (!read_bits(5, literal_count) || !read_bits(5, distance_count) || !read_bits(4, code_length_count))
+        return false;
+    literal_count += 257;
+    distance_count += 1;
+    code_length_count += 4;
+    if (literal_count > 286 || distance_count > 30) {
+        m_status = Status::Error;
+        return false;
+    }
+
+    u8 lengths[286 + 30];
+    memset(lengths, 0, 19);
+    for (u32 i = 0; i < code_length_count; ++i) {
+        u32 length;
+        if (!read_bits(3, length))
+            return false;
+        lengths[s_code_length_order[i]] = length;
+    }
+
+    HuffmanTable code_length_table;
+    if (code_length_table.build(lengths, 19) != 0) {
+        m_status = Status::Error;
+        return false;
+    }
+
+    u32 index = 0;
+    while (index < literal_count + distance_count) {
+        int symbol = decode_symbol(code_length_table);
+        if (symbol == -1)
+            return false;
+        if (symbol < 0) {
+            m_status = Status::Error;
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = symbol;
+            continue;
+        }
+
+        u8 repeated_length = 0;
+        u32 repeat;
+        if (symbol == 16) {
+            if (index == 0) {
+                m_status = Status::Error;
+                return false;
+            }
+            repeated_length = lengths[index - 1];
+            if (!read_bits(2, repeat))
+                return false;
+            repeat += 3;
+        } else if (symbol == 17) {
+            if (!read_bits(3, repeat))
+                return false;
+            repeat += 3;
+        } else {
+            if (!read_bits(7, repeat))
+                return false;
+            repeat += 11;
+        }
+        if (index + repeat > literal_count + distance_count) {
+            m_status = Status::Error;
+            return false;
+        }
+        while (repeat--)
+            lengths[index++] = repeated_length;
+    }
+
+    // Without an end-of-block code, the block could never end.
+    // Incomplete codes are only allowed when they consist of a single code, as in zlib.
+    if (lengths[256] == 0
+        || !m_dynamic_literal_table.is_complete_or_single_code(m_dynamic_literal_table.build(lengths, literal_count))
+        || !m_dynamic_distance_table.is_complete_or_single_code(m_dynamic_distance_table.build(lengths + literal_count, distance_count))) {
+        m_status = Status::Error;
+        return false;
+    }
+    m_literal_table = &m_dynamic_literal_table;
+    m_distance_table = &m_dynamic_distance_table;
+    return true;
+}
+
+bool Inflater::read_block_header()
+{
+    auto start = checkpoint();
+    u32 is_final, type;
+    if (!read_bits(1, is_final) || !read_bits(2, type)) {
+        rewind_to(start);
+        return false;
+    }
+
+    switch (type) {
+    case 0: {
+        // Stored blocks start on a byte boundary, with the length and its complement.
+        m_bit_buffer >>= m_bit_count % 8;
+        m_bit_count -= m_bit_count % 8;
+        u32 length, complement;
+        if (!read_bits(16, length) || !read_bits(16, complement)) {
+            rewind_to(start);
+            return false;
+        }
+        if (length != (~complement & 0xffff)) {
+            m_status = Status::Error;
+            return false;
+        }
+        m_stored_bytes_remaining = length;
+        m_state = State::StoredBlock;
+        break;
+    }
+    case 1:
+        m_literal_table = &fixed_literal_table();
+        m_distance_table = &fixed_distance_table();
+        m_state = State::CompressedBlock;
+        break;
+    case 2:
+        if (!read_dynamic_tables()) {
+            if (m_status != Status::Error)
+                rewind_to(start);
+            return false;
+        }
+        m_state = State::CompressedBlock;
+        break;
+    default:
+        m_status = Status::Error;
+        return false;
+    }
+
+    m_in_final_block = is_final;
+    return true;
+}
+
+bool Inflater::copy_stored_bytes()
+{
+    while (m_stored_bytes_remaining) {
+        if (m_window_offset == window_size)
+            flush_window(true);
+
+        // A few bytes may still sit in the bit buffer from the header.
+        if (m_bit_count) {
+            u32 byte;
+            if (!read_bits(8, byte))
+                return false;
+            m_window.data()[m_window_offset++] = byte;
+            --m_stored_bytes_remaining;
+            continue;
+        }
+
+        size_t available = m_input_size - m_input_offset;
+        if (!available)
+            return false;
+        size_t chunk = min(min((size_t)m_stored_bytes_remaining, available), window_size - m_window_offset);
+        memcpy(m_window.data() + m_window_offset, m_input + m_input_offset, chunk);
+        m_window_offset += chunk;
+        m_input_offset += chunk;
+        m_stored_bytes_remaining -= chunk;
+    }
+    return true;
+}
+
+bool Inflater::decode_compressed_block()
+{
+    auto& literal_table = *m_literal_table;
+    auto& distance_table = *m_distance_table;
+    u8* window = m_window.data();
+
+    for (;;) {
+        if (m_window_offset > window_size - max_match_length) {
+            flush_window(true);
+            window = m_window.data();
+        }
+
+        // Each symbol is decoded completely before touching the window, so running out of input can rewind cleanly.
+        auto start = checkpoint();
+        int symbol = decode_symbol(literal_table);
+        if (symbol < 256) {
+            if (symbol == -1)
+                return false;
+            if (symbol < 0) {
+                m_status = Status::Error;
+                return false;
+            }
+            window[m_window_offset++] = symbol;
+            continue;
+        }
+        if (symbol == 256)
+            return true;
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            m_status = Status::Error;
+            return false;
+        }
+        u32 length_extra;
+        if (!read_bits(s_length_extra_bits[symbol], length_extra)) {
+            rewind_to(start);
+            return false;
+        }
+        u32 length = s_length_base[symbol] + length_extra;
+
+        int distance_symbol = decode_symbol(distance_table);
+        if (distance_symbol == -1) {
+            rewind_to(start);
+            return false;
+        }
+        if (distance_symbol < 0 || distance_symbol >= 30) {
+            m_status = Status::Error;
+            return false;
+        }
+        u32 distance_extra;
+        if (!read_bits(s_distance_extra_bits[distance_symbol], distance_extra)) {
+            rewind_to(start);
+            return false;
+        }
+        u32 distance = s_distance_base[distance_symbol] + distance_extra;
+        if (distance > m_window_offset) {
+            m_status = Status::Error;
+            return false;
+        }
+
+        u8* out = window + m_window_offset;
+        const u8* from = out - distance;
+        if (distance >= length) {
+            memcpy(out, from, length);
+        } else {
+            // Overlapping copies repeat the last `distance` bytes, which a forward byte copy does naturally.
+            for (u32 i = 0; i < length; ++i)
+                out[i] = from[i];
+        }
+        m_window_offset += length;
+    }
+}
+
+Inflater::Status Inflater::run()
+{
+    for (;;) {
+        switch (m_state) {
+        case State::BlockHeader:
+            if (!read_block_header())
+                return m_status;
+            break;
+        case State::StoredBlock:
+            if (!copy_stored_bytes())
+                return m_status;
+            m_state = m_in_final_block ? State::Done : State::BlockHeader;
+            break;
+        case State::CompressedBlock:
+            if (!decode_compressed_block())
+                return m_status;
+            m_state = m_in_final_block ? State::Done : State::BlockHeader;
+            break;
+        case State::Done:
+            m_status = Status::Finished;
+            return m_status;
+        }
+    }
+}
+
+Inflater::Status Inflater::write(const u8* data, size_t size)
+{
+    if (m_status != Status::NeedsMoreInput)
+        return m_status;
+
+    if (m_window.is_null())
+        m_window = ByteBuffer::create_uninitialized(window_size);
+
+    // Decode straight out of the caller's buffer unless we are holding on to the tail of the previous one.
+    if (!m_pending_input.is_empty()) {
+        m_pending_input.append(data, size);
+        m_input = m_pending_input.data();
+        m_input_size = m_pending_input.size();
+    } else {
+        m_input = data;
+        m_input_size = size;
+    }
+    m_input_offset = 0;
+
+    run();
+    flush_window(false);
+
+    if (m_status == Status::NeedsMoreInput) {
+        Vector<u8> unconsumed_input;
+        unconsumed_input.append(m_input + m_input_offset, m_input_size - m_input_offset);
+        m_pending_input = move(unconsumed_input);
+    } else {
+        m_pending_input.clear();
+    }
+    m_input = nullptr;
+    m_input_size = 0;
+    m_input_offset = 0;
+
+#ifdef INFLATE_DEBUG
+    dbg() << "Inflater::write: " << size << " bytes in, status " << (int)m_status << ", " << m_total_output_size << " bytes out so far";
+#endif
+    return m_status;
+}
+
+Optional<ByteBuffer> Inflater::decompress_all(const u8* data, size_t size)
+{
+    Vector<u8> output;
+    Inflater inflater;
+    inflater.on_output = [&](const u8* bytes, size_t count) {
+        output.append(bytes, count);
+    };
+    if (inflater.write(data, size) != Status::Finished)
+        return {};
+    return ByteBuffer::copy(output.data(), output.size());
+}
+
+}
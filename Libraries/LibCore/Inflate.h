@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace Core {
+
+// A streaming decoder for raw DEFLATE data (RFC 1951).
+//
+// Compressed input can be fed in pieces of any size, and decompressed output is handed to
+// on_output as soon as it is produced, straight out of the 32 KiB history window. The window
+// and Huffman tables are kept across reset(), so one Inflater can be reused for many streams.
+// Anything after the end of the DEFLATE stream (like a zlib or gzip trailer) is ignored.
+class Inflater {
+public:
+    enum class Status {
+        NeedsMoreInput,
+        Finished,
+        Error,
+    };
+
+    Inflater();
+    ~Inflater();
+
+    void reset();
+
+    Status write(const u8* data, size_t size);
+    Status status() const { return m_status; }
+
+    u64 total_output_size() const { return m_total_output_size; }
+
+    Function<void(const u8*, size_t)> on_output;
+
+    static Optional<ByteBuffer> decompress_all(const u8* data, size_t size);
+
+    struct HuffmanTable {
+        static constexpr int fast_bits = 9;
+        // Indexed by the next fast_bits input bits; (symbol << 4) | code length, or 0 for longer codes.
+        u16 fast[1 << fast_bits];
+        u16 counts[16];
+        u16 symbols[288];
+
+        // Returns how many codes are left unused (0 for a complete code), or a negative number for an over-subscribed one.
+        int build(const u8* lengths, size_t count);
+        bool is_complete_or_single_code(int left) const;
+    };
+
+private:
+    enum class State {
+        BlockHeader,
+        StoredBlock,
+        CompressedBlock,
+        Done,
+    };
+
+    struct Checkpoint {
+        size_t input_offset;
+        u32 bit_buffer;
+        u32 bit_count;
+    };
+
+    Status run();
+    bool read_block_header();
+    bool read_dynamic_tables();
+    bool copy_stored_bytes();
+    bool decode_compressed_block();
+
+    void fill_bit_buffer()
+    {
+        while (m_bit_count <= 24 && m_input_offset < m_input_size) {
+            m_bit_buffer |= (u32)m_input[m_input_offset++] << m_bit_count;
+            m_bit_count += 8;
+        }
+    }
+
+    bool read_bits(u32 count, u32& value)
+    {
+        if (m_bit_count < count) {
+            fill_bit_buffer();
+            if (m_bit_count < count)
+                return false;
+        }
+        value = m_bit_buffer & ((1u << count) - 1);
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+        return true;
+    }
+
+    // Returns the decoded symbol, -1 if the input runs out first, or -2 for an invalid code.
+    int decode_symbol(const HuffmanTable&);
+
+    Checkpoint checkpoint() const { return { m_input_offset, m_bit_buffer, m_bit_count }; }
+    void rewind_to(const Checkpoint& checkpoint)
+    {
+        m_input_offset = checkpoint.input_offset;
+        m_bit_buffer = checkpoint.bit_buffer;
+        m_bit_count = checkpoint.bit_count;
+    }
+
+    void flush_window(bool slide);
+
+    Status m_status { Status::NeedsMoreInput };
+    State m_state { State::BlockHeader };
+    bool m_in_final_block { false };
+    u32 m_stored_bytes_remaining { 0 };
+
+    const u8* m_input { nullptr };
+    size_t m_input_size { 0 };
+    size_t m_input_offset { 0 };
+    Vector<u8> m_pending_input;
+
+    u32 m_bit_buffer { 0 };
+    u32 m_bit_count { 0 };
+
+    ByteBuffer m_window;
+    size_t m_window_offset { 0 };
+    size_t m_window_flushed_offset { 0 };
+    u64 m_total_output_size { 0 };
+
+    const HuffmanTable* m_literal_table { nullptr };
+    const HuffmanTable* m_distance_table { nullptr };
+    HuffmanTable m_dynamic_literal_table;
+    HuffmanTable m_dynamic_distance_table;
+};
+
+}
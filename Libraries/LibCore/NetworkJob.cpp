@@ -63,6 +63,12 @@ void NetworkJob::did_finish(NonnullRefPtr<NetworkResponse>&& response)
     shutdown();
 }
 
+void NetworkJob::did_receive_data(const ByteBuffer& data)
+{
+    if (on_data_received)
+        on_data_received(data);
+}
+
 void NetworkJob::did_fail(Error error)
 {
     // NOTE: We protect ourselves here, since the on_finish callback may otherwise
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/Function.h>
 #include <LibCore/Object.h>
 
@@ -44,6 +45,8 @@ public:
     virtual ~NetworkJob() override;
 
     Function<void(bool success)> on_finish;
+    // Called with each piece of the (decoded) payload as it arrives, before on_finish.
+    Function<void(const ByteBuffer&)> on_data_received;
 
     bool is_cancelled() const { return m_error == Error::Cancelled; }
     bool has_error() const { return m_error != Error::None; }
@@ -64,6 +67,7 @@ protected:
     NetworkJob();
     void did_finish(NonnullRefPtr<NetworkResponse>&&);
     void did_fail(Error);
+    void did_receive_data(const ByteBuffer&);
 
 private:
     RefPtr<NetworkResponse> m_response;
@@ -27,6 +27,7 @@
 #include <AK/JsonArray.h>
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
+#include <Kernel/ProcessSnapshot.h>
 #include <LibCore/File.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
@@ -36,8 +37,108 @@ namespace Core {
 
 HashMap<uid_t, String> ProcessStatisticsReader::s_usernames;
 
+static String veil_state_to_string(ProcessSnapshotVeilState veil)
+{
+    switch (veil) {
+    case ProcessSnapshotVeilState::None:
+        return "None";
+    case ProcessSnapshotVeilState::Dropped:
+        return "Dropped";
+    case ProcessSnapshotVeilState::Locked:
+        return "Locked";
+    }
+    return {};
+}
+
+Optional<HashMap<pid_t, Core::ProcessStatistics>> ProcessStatisticsReader::get_all_from_snapshot()
+{
+    auto file = Core::File::construct("/proc/all_snapshot");
+    if (!file->open(Core::IODevice::ReadOnly))
+        return {};
+
+    auto buffer = file->read_all();
+    if (buffer.size() < sizeof(ProcessSnapshotHeader))
+        return {};
+
+    auto& header = *reinterpret_cast<const ProcessSnapshotHeader*>(buffer.data());
+    if (header.version != PROCESS_SNAPSHOT_VERSION
+        || header.header_size != sizeof(ProcessSnapshotHeader)
+        || header.process_size != sizeof(ProcessSnapshot)
+        || header.thread_size != sizeof(ThreadSnapshot)) {
+        return {};
+    }
+
+    HashMap<pid_t, Core::ProcessStatistics> map;
+    size_t offset = header.header_size;
+    for (u32 i = 0; i < header.process_count; ++i) {
+        if (offset + sizeof(ProcessSnapshot) > buffer.size())
+            return {};
+        auto& process_snapshot = *reinterpret_cast<const ProcessSnapshot*>(buffer.data() + offset);
+        offset += sizeof(ProcessSnapshot);
+
+        Core::ProcessStatistics process;
+        process.pid = process_snapshot.pid;
+        process.pgid = process_snapshot.pgid;
+        process.pgp = process_snapshot.pgp;
+        process.sid = process_snapshot.sid;
+        process.uid = process_snapshot.uid;
+        process.gid = process_snapshot.gid;
+        process.ppid = process_snapshot.ppid;
+        process.nfds = process_snapshot.nfds;
+        process.name = process_snapshot.name;
+        process.tty = process_snapshot.tty;
+        process.pledge = process_snapshot.pledge;
+        process.veil = veil_state_to_string(process_snapshot.veil);
+        process.amount_virtual = process_snapshot.amount_virtual;
+        process.amount_resident = process_snapshot.amount_resident;
+        process.amount_shared = process_snapshot.amount_shared;
+        process.amount_dirty_private = process_snapshot.amount_dirty_private;
+        process.amount_clean_inode = process_snapshot.amount_clean_inode;
+        process.amount_purgeable_volatile = process_snapshot.amount_purgeable_volatile;
+        process.amount_purgeable_nonvolatile = process_snapshot.amount_purgeable_nonvolatile;
+        process.icon_id = process_snapshot.icon_id;
+
+        if (offset + process_snapshot.thread_count * sizeof(ThreadSnapshot) > buffer.size())
+            return {};
+        process.threads.ensure_capacity(process_snapshot.thread_count);
+        for (u32 j = 0; j < process_snapshot.thread_count; ++j) {
+            auto& thread_snapshot = *reinterpret_cast<const ThreadSnapshot*>(buffer.data() + offset);
+            offset += sizeof(ThreadSnapshot);
+
+            Core::ThreadStatistics thread;
+            thread.tid = thread_snapshot.tid;
+            thread.times_scheduled = thread_snapshot.times_scheduled;
+            thread.name = thread_snapshot.name;
+            thread.state = thread_snapshot.state;
+            thread.ticks = thread_snapshot.ticks;
+            thread.priority = thread_snapshot.priority;
+            thread.effective_priority = thread_snapshot.effective_priority;
+            thread.syscall_count = thread_snapshot.syscall_count;
+            thread.inode_faults = thread_snapshot.inode_faults;
+            thread.zero_faults = thread_snapshot.zero_faults;
+            thread.cow_faults = thread_snapshot.cow_faults;
+            thread.unix_socket_read_bytes = thread_snapshot.unix_socket_read_bytes;
+            thread.unix_socket_write_bytes = thread_snapshot.unix_socket_write_bytes;
+            thread.ipv4_socket_read_bytes = thread_snapshot.ipv4_socket_read_bytes;
+            thread.ipv4_socket_write_bytes = thread_snapshot.ipv4_socket_write_bytes;
+            thread.file_read_bytes = thread_snapshot.file_read_bytes;
+            thread.file_write_bytes = thread_snapshot.file_write_bytes;
+            process.threads.append(move(thread));
+        }
+
+        process.username = username_from_uid(process.uid);
+        map.set(process.pid, move(process));
+    }
+
+    return map;
+}
+
 HashMap<pid_t, Core::ProcessStatistics> ProcessStatisticsReader::get_all()
 {
+    // Prefer the binary snapshot, and fall back to parsing JSON for older kernels.
+    if (auto map = get_all_from_snapshot(); map.has_value())
+        return map.release_value();
+
     auto file = Core::File::construct("/proc/all");
     if (!file->open(Core::IODevice::ReadOnly)) {
         fprintf(stderr, "ProcessStatisticsReader: Failed to open /proc/all: %s\n", file->error_string());
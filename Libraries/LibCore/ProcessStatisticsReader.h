@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/Optional.h>
 #include <AK/String.h>
 #include <unistd.h>
 
@@ -53,7 +54,7 @@ struct ThreadStatistics {
 };
 
 struct ProcessStatistics {
-    // Keep this in sync with /proc/all.
+    // Keep this in sync with /proc/all and Kernel/ProcessSnapshot.h.
     // From the kernel side:
     pid_t pid;
     unsigned pgid;
@@ -87,6 +88,7 @@ public:
     static HashMap<pid_t, Core::ProcessStatistics> get_all();
 
 private:
+    static Optional<HashMap<pid_t, Core::ProcessStatistics>> get_all_from_snapshot();
     static String username_from_uid(uid_t);
     static HashMap<uid_t, String> s_usernames;
 };
@@ -220,7 +220,7 @@ void ELFDynamicLoader::do_relocations()
         case R_386_32: {
             auto symbol = relocation.symbol();
             VERBOSE("Absolute relocation: name: '%s', value: %p\n", symbol.name(), symbol.value());
-            u32 symbol_address = symbol.value() + load_base_address;
+            u32 symbol_address = resolve_symbol(symbol);
             *patch_ptr += symbol_address;
             VERBOSE("   Symbol address: %p\n", *patch_ptr);
             break;
@@ -236,7 +236,7 @@ void ELFDynamicLoader::do_relocations()
         case R_386_GLOB_DAT: {
             auto symbol = relocation.symbol();
             VERBOSE("Global data relocation: '%s', value: %p\n", symbol.name(), symbol.value());
-            u32 symbol_location = load_base_address + symbol.value();
+            u32 symbol_location = resolve_symbol(symbol);
             *patch_ptr = symbol_location;
             VERBOSE("   Symbol address: %p\n", *patch_ptr);
             break;
@@ -323,7 +323,7 @@ Elf32_Addr ELFDynamicLoader::patch_plt_entry(u32 relocation_offset)
     auto sym = relocation.symbol();
 
     u8* relocation_address = relocation.address().as_ptr();
-    u32 symbol_location = sym.address().get();
+    u32 symbol_location = resolve_symbol(sym);
 
     VERBOSE("ELFDynamicLoader: Jump slot relocation: putting %s (%p) into PLT at %p\n", sym.name(), symbol_location, relocation_address);
 
@@ -332,6 +332,21 @@ Elf32_Addr ELFDynamicLoader::patch_plt_entry(u32 relocation_offset)
     return symbol_location;
 }
 
+u32 ELFDynamicLoader::resolve_symbol(const ELFDynamicObject::Symbol& symbol)
+{
+    if (m_resolved_symbols.is_empty()) {
+        m_resolved_symbols.resize(m_dynamic_object->symbol_count());
+        for (auto& address : m_resolved_symbols)
+            address = 0;
+    }
+
+    ASSERT(symbol.index() < m_resolved_symbols.size());
+    u32& resolved_address = m_resolved_symbols[symbol.index()];
+    if (!resolved_address)
+        resolved_address = symbol.address().get();
+    return resolved_address;
+}
+
 void ELFDynamicLoader::call_object_init_functions()
 {
     typedef void (*InitFunc)();
@@ -346,7 +361,7 @@ void ELFDynamicLoader::call_object_init_functions()
 
     InitFunc* init_begin = (InitFunc*)(init_array_section.address().as_ptr());
     InitFunc* init_end = init_begin + init_array_section.entry_count();
-    while (init_begin != init_end) {
+    for (; init_begin != init_end; ++init_begin) {
         // Android sources claim that these can be -1, to be ignored.
         // 0 definitely shows up. Apparently 0/-1 are valid? Confusing.
         if (!*init_begin || ((i32)*init_begin == -1))
@@ -355,7 +370,6 @@ void ELFDynamicLoader::call_object_init_functions()
         dbgprintf("Calling DT_INITARRAY entry at %p\n", *init_begin);
 #endif
         (*init_begin)();
-        ++init_begin;
     }
 }
 
@@ -30,6 +30,7 @@
 #include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibELF/ELFDynamicObject.h>
 #include <LibELF/ELFImage.h>
 #include <LibELF/exec_elf.h>
@@ -100,6 +101,9 @@ private:
     void setup_plt_trampoline();
     void call_object_init_functions();
 
+    // Relocations against the same symbol share one resolution, see m_resolved_symbols.
+    u32 resolve_symbol(const ELFDynamicObject::Symbol&);
+
     String m_filename;
     size_t m_file_size { 0 };
     int m_image_fd { -1 };
@@ -113,4 +117,7 @@ private:
 
     VirtualAddress m_tls_segment_address;
     VirtualAddress m_dynamic_section_address;
+
+    // Resolved symbol addresses for this load, indexed by the symbol's index in m_dynamic_object. 0 means not resolved yet.
+    Vector<u32> m_resolved_symbols;
 };
@@ -86,6 +86,9 @@ void ELFDynamicObject::parse()
         case DT_HASH:
             m_hash_table_offset = entry.ptr();
             break;
+        case DT_GNU_HASH:
+            m_gnu_hash_table_offset = entry.ptr();
+            break;
         case DT_SYMTAB:
             m_symbol_table_offset = entry.ptr();
             break;
@@ -142,9 +145,39 @@ void ELFDynamicObject::parse()
         return IterationDecision::Continue;
     });
 
-    auto hash_section_address = hash_section().address().as_ptr();
-    auto num_hash_chains = ((u32*)hash_section_address)[1];
-    m_symbol_count = num_hash_chains;
+    if (m_hash_table_offset) {
+        auto hash_section_address = hash_section(HashType::SYSV).address().as_ptr();
+        auto num_hash_chains = ((u32*)hash_section_address)[1];
+        m_symbol_count = num_hash_chains;
+    } else {
+        ASSERT(m_gnu_hash_table_offset);
+        m_symbol_count = symbol_count_from_gnu_hash_section();
+    }
+}
+
+unsigned ELFDynamicObject::symbol_count_from_gnu_hash_section() const
+{
+    // DT_GNU_HASH doesn't record the number of symbols, but every hashed symbol is in some chain,
+    // and the chains are laid out in symbol order. So the last symbol ends the chain that starts furthest along.
+    auto* hash_table = (const u32*)hash_section(HashType::GNU).address().as_ptr();
+    u32 num_buckets = hash_table[0];
+    u32 first_hashed_symbol = hash_table[1];
+    u32 bloom_size = hash_table[2];
+    auto* buckets = &hash_table[4 + bloom_size];
+    auto* chains = &buckets[num_buckets];
+
+    u32 last_chain_start = 0;
+    for (u32 i = 0; i < num_buckets; ++i) {
+        if (buckets[i] > last_chain_start)
+            last_chain_start = buckets[i];
+    }
+    if (last_chain_start < first_hashed_symbol)
+        return first_hashed_symbol;
+
+    u32 index = last_chain_start;
+    while (!(chains[index - first_hashed_symbol] & 1))
+        ++index;
+    return index + 1;
 }
 
 const ELFDynamicObject::Relocation ELFDynamicObject::RelocationSection::relocation(unsigned index) const
@@ -191,6 +224,14 @@ const ELFDynamicObject::Section ELFDynamicObject::fini_array_section() const
 
 const ELFDynamicObject::HashSection ELFDynamicObject::hash_section() const
 {
+    return hash_section(m_gnu_hash_table_offset ? HashType::GNU : HashType::SYSV);
+}
+
+const ELFDynamicObject::HashSection ELFDynamicObject::hash_section(HashType hash_type) const
+{
+    ASSERT(has_hash_section(hash_type));
+    if (hash_type == HashType::GNU)
+        return HashSection(Section(*this, m_gnu_hash_table_offset, 0, 0, "DT_GNU_HASH"), HashType::GNU);
     return HashSection(Section(*this, m_hash_table_offset, 0, 0, "DT_HASH"), HashType::SYSV);
 }
 
@@ -204,7 +245,7 @@ const ELFDynamicObject::RelocationSection ELFDynamicObject::plt_relocation_secti
     return RelocationSection(Section(*this, m_plt_relocation_offset_location, m_size_of_plt_relocation_entry_list, m_size_of_relocation_entry, "DT_JMPREL"));
 }
 
-u32 ELFDynamicObject::HashSection::calculate_elf_hash(const char* name) const
+u32 ELFDynamicObject::HashSection::calculate_elf_hash(const char* name)
 {
     // SYSV ELF hash algorithm
     // Note that the GNU HASH algorithm has less collisions
@@ -226,17 +267,27 @@ u32 ELFDynamicObject::HashSection::calculate_elf_hash(const char* name) const
     return hash;
 }
 
-u32 ELFDynamicObject::HashSection::calculate_gnu_hash(const char*) const
+u32 ELFDynamicObject::HashSection::calculate_gnu_hash(const char* name)
 {
-    // FIXME: Implement the GNU hash algorithm
-    ASSERT_NOT_REACHED();
+    // GNU ELF hash algorithm (Bernstein's djb2 with a multiplier of 33)
+    u32 hash = 5381;
+
+    for (; *name != '\0'; ++name)
+        hash = hash * 33 + (u8)*name;
+
+    return hash;
 }
 
 const ELFDynamicObject::Symbol ELFDynamicObject::HashSection::lookup_symbol(const char* name) const
 {
-    // FIXME: If we enable gnu hash in the compiler, we should use that here instead
-    //     The algo is way better with less collisions
-    u32 hash_value = (this->*(m_hash_function))(name);
+    if (m_hash_type == HashType::GNU)
+        return lookup_gnu_symbol(name);
+    return lookup_elf_symbol(name);
+}
+
+const ELFDynamicObject::Symbol ELFDynamicObject::HashSection::lookup_elf_symbol(const char* name) const
+{
+    u32 hash_value = calculate_elf_hash(name);
 
     u32* hash_table_begin = (u32*)address().as_ptr();
 
@@ -262,6 +313,54 @@ const ELFDynamicObject::Symbol ELFDynamicObject::HashSection::lookup_symbol(cons
     return m_dynamic.the_undefined_symbol();
 }
 
+const ELFDynamicObject::Symbol ELFDynamicObject::HashSection::lookup_gnu_symbol(const char* name) const
+{
+    // Layout: nbuckets, symoffset, bloom_size, bloom_shift, bloom[bloom_size], buckets[nbuckets], chains[]
+    constexpr u32 bloom_word_bits = sizeof(u32) * 8;
+
+    u32 hash_value = calculate_gnu_hash(name);
+
+    auto* hash_table_begin = (const u32*)address().as_ptr();
+    u32 num_buckets = hash_table_begin[0];
+    u32 first_hashed_symbol = hash_table_begin[1];
+    u32 bloom_size = hash_table_begin[2];
+    u32 bloom_shift = hash_table_begin[3];
+    auto* bloom_words = &hash_table_begin[4];
+    auto* buckets = &bloom_words[bloom_size];
+    auto* chains = &buckets[num_buckets];
+
+    // Both are used as divisors below. A table without buckets has no symbols, and one without a bloom filter is malformed.
+    if (!num_buckets || !bloom_size)
+        return m_dynamic.the_undefined_symbol();
+
+    // The bloom filter has two bits set for every symbol in the table. If either is clear, the name isn't here.
+    u32 bloom_word = bloom_words[(hash_value / bloom_word_bits) % bloom_size];
+    u32 bloom_mask = (1u << (hash_value % bloom_word_bits)) | (1u << ((hash_value >> bloom_shift) % bloom_word_bits));
+    if ((bloom_word & bloom_mask) != bloom_mask)
+        return m_dynamic.the_undefined_symbol();
+
+    u32 index = buckets[hash_value % num_buckets];
+    if (index < first_hashed_symbol)
+        return m_dynamic.the_undefined_symbol();
+
+    // Chain entries hold the symbol's hash with the lowest bit replaced by an end-of-chain marker.
+    for (;; ++index) {
+        u32 chain_hash = chains[index - first_hashed_symbol];
+        if ((hash_value | 1) == (chain_hash | 1)) {
+            auto symbol = m_dynamic.symbol(index);
+            if (strcmp(name, symbol.name()) == 0) {
+#ifdef DYNAMIC_LOAD_DEBUG
+                dbgprintf("Returning dynamic symbol with index %d for %s: %p\n", index, symbol.name(), symbol.address());
+#endif
+                return symbol;
+            }
+        }
+        if (chain_hash & 1)
+            break;
+    }
+    return m_dynamic.the_undefined_symbol();
+}
+
 const char* ELFDynamicObject::symbol_string_table_string(Elf32_Word index) const
 {
     return (const char*)base_address().offset(m_string_table_offset + index).as_ptr();
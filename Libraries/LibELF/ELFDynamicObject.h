@@ -78,7 +78,7 @@ public:
         unsigned index() const { return m_index; }
         unsigned type() const { return ELF32_ST_TYPE(m_sym.st_info); }
         unsigned bind() const { return ELF32_ST_BIND(m_sym.st_info); }
-        bool is_undefined() const { return this == &m_dynamic.the_undefined_symbol(); }
+        bool is_undefined() const { return m_index == STN_UNDEF; }
         VirtualAddress address() const { return m_dynamic.base_address().offset(value()); }
 
     private:
@@ -162,28 +162,22 @@ public:
     public:
         HashSection(const Section& section, HashType hash_type = HashType::SYSV)
             : Section(section.m_dynamic, section.m_section_offset, section.m_section_size_bytes, section.m_entry_size, section.m_name)
+            , m_hash_type(hash_type)
         {
-            switch (hash_type) {
-            case HashType::SYSV:
-                m_hash_function = &HashSection::calculate_elf_hash;
-                break;
-            case HashType::GNU:
-                m_hash_function = &HashSection::calculate_gnu_hash;
-                break;
-            default:
-                ASSERT_NOT_REACHED();
-                break;
-            }
         }
 
+        HashType hash_type() const { return m_hash_type; }
+
         const Symbol lookup_symbol(const char*) const;
 
+        static u32 calculate_elf_hash(const char* name);
+        static u32 calculate_gnu_hash(const char* name);
+
     private:
-        u32 calculate_elf_hash(const char* name) const;
-        u32 calculate_gnu_hash(const char* name) const;
+        const Symbol lookup_elf_symbol(const char*) const;
+        const Symbol lookup_gnu_symbol(const char*) const;
 
-        typedef u32 (HashSection::*HashFunction)(const char*) const;
-        HashFunction m_hash_function;
+        HashType m_hash_type;
     };
 
     unsigned symbol_count() const { return m_symbol_count; }
@@ -196,7 +190,10 @@ public:
     const Section init_array_section() const;
     const Section fini_array_section() const;
 
+    // Prefers DT_GNU_HASH, since its bloom filter rejects most misses without touching the symbol table.
     const HashSection hash_section() const;
+    const HashSection hash_section(HashType) const;
+    bool has_hash_section(HashType type) const { return type == HashType::GNU ? m_gnu_hash_table_offset : m_hash_table_offset; }
 
     const RelocationSection relocation_section() const;
     const RelocationSection plt_relocation_section() const;
@@ -214,6 +211,7 @@ public:
 private:
     const char* symbol_string_table_string(Elf32_Word) const;
     void parse();
+    unsigned symbol_count_from_gnu_hash_section() const;
 
     template<typename F>
     void for_each_symbol(F) const;
@@ -223,7 +221,8 @@ private:
 
     VirtualAddress m_base_address;
     VirtualAddress m_dynamic_address;
-    Symbol m_the_undefined_symbol { *this, 0, {} };
+    Elf32_Sym m_the_undefined_elf_symbol {};
+    Symbol m_the_undefined_symbol { *this, STN_UNDEF, m_the_undefined_elf_symbol };
 
     unsigned m_symbol_count { 0 };
 
@@ -237,6 +236,7 @@ private:
     size_t m_fini_array_size { 0 };
 
     FlatPtr m_hash_table_offset { 0 };
+    FlatPtr m_gnu_hash_table_offset { 0 };
 
     FlatPtr m_string_table_offset { 0 };
     size_t m_size_of_string_table { 0 };
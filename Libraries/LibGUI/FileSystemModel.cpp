@@ -466,7 +466,7 @@ static RefPtr<Gfx::Bitmap> render_thumbnail(const StringView& path)
         return nullptr;
     auto thumbnail = Gfx::Bitmap::create(png_bitmap->format(), { 32, 32 });
     Painter painter(*thumbnail);
-    painter.draw_scaled_bitmap(thumbnail->rect(), *png_bitmap, png_bitmap->rect());
+    painter.draw_scaled_bitmap(thumbnail->rect(), *png_bitmap, png_bitmap->rect(), Gfx::Painter::ScalingMode::Bilinear);
     return thumbnail;
 }
 
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibGfx/AlphaBlending.h>
+#include <string.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#    define ALPHA_BLENDING_HAS_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace Gfx {
+
+// Exact floor(value / 255) for value <= 255 * 255, applied to two 16-bit lanes at once.
+static inline u32 div_255_pair(u32 value)
+{
+    return ((value + 0x00010001 + ((value >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+}
+
+// Blends red+blue and alpha+green as two pairs of 16-bit lanes.
+static inline RGBA32 blend_channels(RGBA32 dst, RGBA32 src, u32 alpha)
+{
+    u32 inverse = 255 - alpha;
+    u32 red_blue = div_255_pair((dst & 0x00ff00ff) * inverse + (src & 0x00ff00ff) * alpha);
+    u32 alpha_green = div_255_pair(((dst >> 8) & 0x00ff00ff) * inverse + ((src >> 8) & 0x00ff00ff) * alpha);
+    return red_blue | (alpha_green << 8);
+}
+
+static inline RGBA32 blend_pixel(RGBA32 dst, RGBA32 src)
+{
+    u32 alpha = src >> 24;
+    if (alpha == 0xff)
+        return src;
+    if (!alpha)
+        return dst;
+    if ((dst >> 24) == 0xff)
+        return blend_channels(dst, src, alpha) | 0xff000000;
+    return Color::from_rgba(dst).blend(Color::from_rgba(src)).value();
+}
+
+static inline RGBA32 blend_premultiplied_pixel(RGBA32 dst, RGBA32 src)
+{
+    u32 inverse = 255 - (src >> 24);
+    u32 red_blue = div_255_pair((dst & 0x00ff00ff) * inverse);
+    u32 alpha_green = div_255_pair(((dst >> 8) & 0x00ff00ff) * inverse);
+    return src + (red_blue | (alpha_green << 8));
+}
+
+static inline RGBA32 premultiply_pixel(RGBA32 pixel)
+{
+    u32 alpha = pixel >> 24;
+    if (alpha == 0xff)
+        return pixel;
+    if (!alpha)
+        return 0;
+    u32 red_blue = div_255_pair((pixel & 0x00ff00ff) * alpha);
+    u32 green = div_255_pair(((pixel >> 8) & 0xff) * alpha);
+    return (alpha << 24) | red_blue | (green << 8);
+}
+
+static inline u32 unpremultiply_channel(u32 channel, u32 alpha)
+{
+    return min((channel * 255 + alpha / 2) / alpha, 255u);
+}
+
+static inline RGBA32 unpremultiply_pixel(RGBA32 pixel)
+{
+    u32 alpha = pixel >> 24;
+    if (alpha == 0xff || !alpha)
+        return pixel;
+    u32 red = unpremultiply_channel((pixel >> 16) & 0xff, alpha);
+    u32 green = unpremultiply_channel((pixel >> 8) & 0xff, alpha);
+    u32 blue = unpremultiply_channel(pixel & 0xff, alpha);
+    return (alpha << 24) | (red << 16) | (green << 8) | blue;
+}
+
+#ifdef ALPHA_BLENDING_HAS_SSE2
+
+static bool cpu_supports_sse2()
+{
+    u32 eax = 1;
+    u32 ebx;
+    u32 ecx;
+    u32 edx;
+    asm volatile("cpuid"
+                 : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+    return edx & (1 << 26);
+}
+
+static bool s_use_simd = cpu_supports_sse2();
+
+#    define SSE2_FUNCTION __attribute__((target("sse2")))
+
+SSE2_FUNCTION static inline __m128i div_255_epi16(__m128i value)
+{
+    value = _mm_add_epi16(_mm_add_epi16(value, _mm_set1_epi16(1)), _mm_srli_epi16(value, 8));
+    return _mm_srli_epi16(value, 8);
+}
+
+SSE2_FUNCTION static inline __m128i broadcast_alpha_epi16(__m128i pixels)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+SSE2_FUNCTION static inline bool all_lanes_equal(__m128i a, __m128i b)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(a, b)) == 0xffff;
+}
+
+// Four straight-alpha pixels over four opaque pixels, with per-pixel alpha.
+SSE2_FUNCTION static inline __m128i blend_over_opaque(__m128i dst, __m128i src)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(255);
+    __m128i src_low = _mm_unpacklo_epi8(src, zero);
+    __m128i src_high = _mm_unpackhi_epi8(src, zero);
+    __m128i alpha_low = broadcast_alpha_epi16(src_low);
+    __m128i alpha_high = broadcast_alpha_epi16(src_high);
+    __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(max, alpha_low)), _mm_mullo_epi16(src_low, alpha_low));
+    __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(max, alpha_high)), _mm_mullo_epi16(src_high, alpha_high));
+    return _mm_or_si128(_mm_packus_epi16(div_255_epi16(low), div_255_epi16(high)), _mm_set1_epi32(0xff000000));
+}
+
+SSE2_FUNCTION static void blend_scanline_sse2(RGBA32* dst, const RGBA32* src, size_t count)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i src_alpha = _mm_and_si128(src_pixels, alpha_mask);
+        if (all_lanes_equal(src_alpha, alpha_mask)) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), src_pixels);
+            continue;
+        }
+        if (all_lanes_equal(src_alpha, zero))
+            continue;
+        __m128i dst_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        if (!all_lanes_equal(_mm_and_si128(dst_pixels, alpha_mask), alpha_mask)) {
+            for (size_t j = i; j < i + 4; ++j)
+                dst[j] = blend_pixel(dst[j], src[j]);
+            continue;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blend_over_opaque(dst_pixels, src_pixels));
+    }
+    for (; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], src[i]);
+}
+
+SSE2_FUNCTION static void blend_premultiplied_scanline_sse2(RGBA32* dst, const RGBA32* src, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(255);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i dst_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i inverse_low = _mm_sub_epi16(max, broadcast_alpha_epi16(_mm_unpacklo_epi8(src_pixels, zero)));
+        __m128i inverse_high = _mm_sub_epi16(max, broadcast_alpha_epi16(_mm_unpackhi_epi8(src_pixels, zero)));
+        __m128i low = div_255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst_pixels, zero), inverse_low));
+        __m128i high = div_255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst_pixels, zero), inverse_high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(src_pixels, _mm_packus_epi16(low, high)));
+    }
+    for (; i < count; ++i)
+        dst[i] = blend_premultiplied_pixel(dst[i], src[i]);
+}
+
+SSE2_FUNCTION static void blend_scanline_with_opacity_sse2(RGBA32* dst, const RGBA32* src, size_t count, u8 opacity)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi16(opacity);
+    const __m128i inverse = _mm_set1_epi16(255 - opacity);
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i src_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i dst_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst_pixels, zero), inverse), _mm_mullo_epi16(_mm_unpacklo_epi8(src_pixels, zero), alpha));
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst_pixels, zero), inverse), _mm_mullo_epi16(_mm_unpackhi_epi8(src_pixels, zero), alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_packus_epi16(div_255_epi16(low), div_255_epi16(high)), alpha_mask));
+    }
+    for (; i < count; ++i)
+        dst[i] = blend_channels(dst[i], src[i], opacity) | 0xff000000;
+}
+
+SSE2_FUNCTION static void blend_fill_scanline_sse2(RGBA32* dst, size_t count, Color color)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi16(color.alpha());
+    const __m128i inverse = _mm_set1_epi16(255 - color.alpha());
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    const __m128i weighted_color = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32(color.value()), zero), alpha);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i dst_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        if (!all_lanes_equal(_mm_and_si128(dst_pixels, alpha_mask), alpha_mask)) {
+            for (size_t j = i; j < i + 4; ++j)
+                dst[j] = blend_pixel(dst[j], color.value());
+            continue;
+        }
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst_pixels, zero), inverse), weighted_color);
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst_pixels, zero), inverse), weighted_color);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_packus_epi16(div_255_epi16(low), div_255_epi16(high)), alpha_mask));
+    }
+    for (; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], color.value());
+}
+
+SSE2_FUNCTION static void lerp_scanlines_sse2(RGBA32* dst, const RGBA32* a, const RGBA32* b, size_t count, u32 weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i b_weight = _mm_set1_epi16(weight);
+    const __m128i a_weight = _mm_set1_epi16(256 - weight);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i b_pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a_pixels, zero), a_weight), _mm_mullo_epi16(_mm_unpacklo_epi8(b_pixels, zero), b_weight));
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a_pixels, zero), a_weight), _mm_mullo_epi16(_mm_unpackhi_epi8(b_pixels, zero), b_weight));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8)));
+    }
+    for (; i < count; ++i)
+        dst[i] = lerp_pixels(a[i], b[i], weight);
+}
+
+#else
+static bool s_use_simd = false;
+#endif
+
+bool alpha_blending_uses_simd()
+{
+    return s_use_simd;
+}
+
+void set_alpha_blending_uses_simd(bool enabled)
+{
+#ifdef ALPHA_BLENDING_HAS_SSE2
+    s_use_simd = enabled && cpu_supports_sse2();
+#else
+    (void)enabled;
+#endif
+}
+
+void blend_scanline(RGBA32* dst, const RGBA32* src, size_t count)
+{
+#ifdef ALPHA_BLENDING_HAS_SSE2
+    if (s_use_simd)
+        return blend_scanline_sse2(dst, src, count);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], src[i]);
+}
+
+void blend_premultiplied_scanline(RGBA32* dst, const RGBA32* src, size_t count)
+{
+#ifdef ALPHA_BLENDING_HAS_SSE2
+    if (s_use_simd)
+        return blend_premultiplied_scanline_sse2(dst, src, count);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = blend_premultiplied_pixel(dst[i], src[i]);
+}
+
+void blend_scanline_with_opacity(RGBA32* dst, const RGBA32* src, size_t count, u8 opacity)
+{
+#ifdef ALPHA_BLENDING_HAS_SSE2
+    if (s_use_simd)
+        return blend_scanline_with_opacity_sse2(dst, src, count, opacity);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = blend_channels(dst[i], src[i], opacity) | 0xff000000;
+}
+
+void blend_fill_scanline(RGBA32* dst, size_t count, Color color)
+{
+#ifdef ALPHA_BLENDING_HAS_SSE2
+    if (s_use_simd)
+        return blend_fill_scanline_sse2(dst, count, color);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = blend_pixel(dst[i], color.value());
+}
+
+void lerp_scanlines(RGBA32* dst, const RGBA32* a, const RGBA32* b, size_t count, u32 weight)
+{
+    if (!weight) {
+        if (dst != a)
+            memcpy(dst, a, count * sizeof(RGBA32));
+        return;
+    }
+#ifdef ALPHA_BLENDING_HAS_SSE2
+    if (s_use_simd)
+        return lerp_scanlines_sse2(dst, a, b, count, weight);
+#endif
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = lerp_pixels(a[i], b[i], weight);
+}
+
+void premultiply_scanline(RGBA32* dst, const RGBA32* src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = premultiply_pixel(src[i]);
+}
+
+void unpremultiply_scanline(RGBA32* pixels, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        pixels[i] = unpremultiply_pixel(pixels[i]);
+}
+
+}
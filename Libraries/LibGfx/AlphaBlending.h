@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <LibGfx/Color.h>
+
+namespace Gfx {
+
+// Source-over blending of whole scanlines. These use SSE2 when the CPU has it and fall back to scalar code otherwise.
+// Neither path divides per pixel, and straight-alpha results are bit-for-bit identical to Color::blend().
+
+// Straight alpha source over any destination, like blit_with_alpha().
+void blend_scanline(RGBA32* dst, const RGBA32* src, size_t count);
+
+// Premultiplied alpha source over a premultiplied (or opaque) destination.
+void blend_premultiplied_scanline(RGBA32* dst, const RGBA32* src, size_t count);
+
+// Source treated as opaque RGB with a constant alpha, over an opaque destination, like blit_with_opacity().
+void blend_scanline_with_opacity(RGBA32* dst, const RGBA32* src, size_t count, u8 opacity);
+
+// A single translucent color over any destination, like fill_rect().
+void blend_fill_scanline(RGBA32* dst, size_t count, Color);
+
+// Linear interpolation from `a` towards `b` by `weight`/256, on every channel. This is the vertical pass of bilinear scaling.
+void lerp_scanlines(RGBA32* dst, const RGBA32* a, const RGBA32* b, size_t count, u32 weight);
+
+inline RGBA32 lerp_pixels(RGBA32 a, RGBA32 b, u32 weight)
+{
+    u32 inverse = 256 - weight;
+    u32 red_blue = (((a & 0x00ff00ff) * inverse + (b & 0x00ff00ff) * weight) >> 8) & 0x00ff00ff;
+    u32 alpha_green = (((a >> 8) & 0x00ff00ff) * inverse + ((b >> 8) & 0x00ff00ff) * weight) & 0xff00ff00;
+    return red_blue | alpha_green;
+}
+
+// Conversions between straight and premultiplied alpha. Filtering has to happen on premultiplied pixels,
+// or the color of fully transparent pixels bleeds into their neighbours. `dst` may be `src`.
+void premultiply_scanline(RGBA32* dst, const RGBA32* src, size_t count);
+void unpremultiply_scanline(RGBA32* pixels, size_t count);
+
+// Whether the kernels above are using SSE2. Turning it off is only useful for benchmarking.
+bool alpha_blending_uses_simd();
+void set_alpha_blending_uses_simd(bool);
+
+}
@@ -28,6 +28,7 @@
 #include <AK/SharedBuffer.h>
 #include <AK/String.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/GIFLoader.h>
 #include <LibGfx/PNGLoader.h>
 #include <LibGfx/ShareableBitmap.h>
 #include <errno.h>
@@ -70,6 +71,8 @@ NonnullRefPtr<Bitmap> Bitmap::create_wrapper(BitmapFormat format, const Size& si
 
 RefPtr<Bitmap> Bitmap::load_from_file(const StringView& path)
 {
+    if (path.ends_with(".gif"))
+        return load_gif(path);
     return load_png(path);
 }
 
@@ -40,6 +40,36 @@ void DisjointRectSet::add(const Rect& new_rect)
         shatter();
 }
 
+DisjointRectSet DisjointRectSet::intersected(const Rect& rect) const
+{
+    DisjointRectSet intersection;
+    for (auto& existing_rect : m_rects) {
+        auto piece = existing_rect.intersected(rect);
+        if (!piece.is_empty())
+            intersection.m_rects.append(piece);
+    }
+    return intersection;
+}
+
+DisjointRectSet DisjointRectSet::shattered(const Rect& hammer) const
+{
+    DisjointRectSet remainder;
+    for (auto& existing_rect : m_rects) {
+        for (auto& piece : existing_rect.shatter(hammer))
+            remainder.m_rects.append(piece);
+    }
+    return remainder;
+}
+
+bool DisjointRectSet::intersects(const Rect& rect) const
+{
+    for (auto& existing_rect : m_rects) {
+        if (existing_rect.intersects(rect))
+            return true;
+    }
+    return false;
+}
+
 void DisjointRectSet::shatter()
 {
     Vector<Rect, 32> output;
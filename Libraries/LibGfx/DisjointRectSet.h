@@ -39,9 +39,19 @@ public:
         : m_rects(move(other.m_rects))
     {
     }
+    DisjointRectSet& operator=(DisjointRectSet&& other)
+    {
+        m_rects = move(other.m_rects);
+        return *this;
+    }
 
     void add(const Rect&);
 
+    // These keep the set disjoint without another shatter pass, since every piece stays inside one of our rects.
+    DisjointRectSet intersected(const Rect&) const;
+    DisjointRectSet shattered(const Rect& hammer) const;
+    bool intersects(const Rect&) const;
+
     bool is_empty() const { return m_rects.is_empty(); }
     size_t size() const { return m_rects.size(); }
 
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <AK/Utf8View.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/DisplayList.h>
+#include <LibGfx/Emoji.h>
+#include <LibGfx/Font.h>
+
+namespace Gfx {
+
+DisplayList::DisplayList()
+{
+}
+
+DisplayList::~DisplayList()
+{
+}
+
+void DisplayList::clear()
+{
+    m_commands.clear();
+    m_translation = {};
+    m_saved_translations.clear();
+}
+
+void DisplayList::append(const Rect& bounds, Function<void(Painter&)> function)
+{
+    m_commands.append({ bounds.translated(m_translation), move(function) });
+}
+
+void DisplayList::append_state_change(Function<void(Painter&)> function)
+{
+    m_commands.append({ {}, move(function) });
+}
+
+void DisplayList::clear_rect(const Rect& rect, Color color)
+{
+    append(rect, [=](Painter& painter) { painter.clear_rect(rect, color); });
+}
+
+void DisplayList::fill_rect(const Rect& rect, Color color)
+{
+    append(rect, [=](Painter& painter) { painter.fill_rect(rect, color); });
+}
+
+void DisplayList::fill_rect_with_checkerboard(const Rect& rect, const Size& cell_size, Color color_dark, Color color_light)
+{
+    append(rect, [=](Painter& painter) { painter.fill_rect_with_checkerboard(rect, cell_size, color_dark, color_light); });
+}
+
+void DisplayList::fill_rect_with_gradient(Orientation orientation, const Rect& rect, Color gradient_start, Color gradient_end)
+{
+    append(rect, [=](Painter& painter) { painter.fill_rect_with_gradient(orientation, rect, gradient_start, gradient_end); });
+}
+
+void DisplayList::draw_rect(const Rect& rect, Color color, bool rough)
+{
+    append(rect, [=](Painter& painter) { painter.draw_rect(rect, color, rough); });
+}
+
+void DisplayList::draw_line(const Point& p1, const Point& p2, Color color, int thickness, bool dotted)
+{
+    // Thick points are centered on the line, so they reach out by about half the thickness.
+    append(Rect::from_two_points(p1, p2).inflated(thickness * 2 + 2, thickness * 2 + 2), [=](Painter& painter) { painter.draw_line(p1, p2, color, thickness, dotted); });
+}
+
+void DisplayList::blit(const Point& position, const Bitmap& source, const Rect& src_rect, float opacity)
+{
+    append({ position, src_rect.size() }, [=, source = NonnullRefPtr<Bitmap>(source)](Painter& painter) { painter.blit(position, *source, src_rect, opacity); });
+}
+
+void DisplayList::draw_scaled_bitmap(const Rect& dst_rect, const Bitmap& source, const Rect& src_rect, Painter::ScalingMode scaling_mode)
+{
+    append(dst_rect, [=, source = NonnullRefPtr<Bitmap>(source)](Painter& painter) { painter.draw_scaled_bitmap(dst_rect, *source, src_rect, scaling_mode); });
+}
+
+void DisplayList::draw_tiled_bitmap(const Rect& dst_rect, const Bitmap& source)
+{
+    append(dst_rect, [=, source = NonnullRefPtr<Bitmap>(source)](Painter& painter) { painter.draw_tiled_bitmap(dst_rect, *source); });
+}
+
+void DisplayList::draw_text(const Rect& rect, const StringView& text, const Font& font, TextAlignment alignment, Color color, TextElision elision)
+{
+    // Playback may happen on several threads at once, so do everything that fills a cache now:
+    // build the font's glyph atlas and look up any emoji.
+    font.glyph_atlas();
+    int line_count = 1;
+    for (u32 codepoint : Utf8View(text)) {
+        if (codepoint == '\n')
+            ++line_count;
+        else if (codepoint >= 256)
+            Emoji::emoji_for_codepoint(codepoint);
+    }
+
+    // Lines are aligned within the rect but whole glyphs are drawn, so text can stick out of it
+    // by up to its own size on any side.
+    int text_width = font.width(text);
+    int text_height = line_count * (font.glyph_height() + 4);
+    append(rect.inflated(text_width * 2 + 2, text_height * 2 + 2), [=, text = String(text), font = NonnullRefPtr<Font>(font)](Painter& painter) { painter.draw_text(rect, text, *font, alignment, color, elision); });
+}
+
+void DisplayList::add_clip_rect(const Rect& rect)
+{
+    append_state_change([=](Painter& painter) { painter.add_clip_rect(rect); });
+}
+
+void DisplayList::translate(int dx, int dy)
+{
+    m_translation.move_by(dx, dy);
+    append_state_change([=](Painter& painter) { painter.translate(dx, dy); });
+}
+
+void DisplayList::set_draw_op(Painter::DrawOp draw_op)
+{
+    append_state_change([=](Painter& painter) { painter.set_draw_op(draw_op); });
+}
+
+void DisplayList::save()
+{
+    m_saved_translations.append(m_translation);
+    append_state_change([](Painter& painter) { painter.save(); });
+}
+
+void DisplayList::restore()
+{
+    if (!m_saved_translations.is_empty())
+        m_translation = m_saved_translations.take_last();
+    append_state_change([](Painter& painter) { painter.restore(); });
+}
+
+void DisplayList::paint(Painter& painter) const
+{
+    for (auto& command : m_commands)
+        command.function(painter);
+}
+
+void DisplayList::paint(Painter& painter, const Rect& rect) const
+{
+    for (auto& command : m_commands) {
+        if (!command.bounds.has_value() || command.bounds.value().intersects(rect))
+            command.function(painter);
+    }
+}
+
+}
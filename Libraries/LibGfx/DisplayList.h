@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibGfx/Color.h>
+#include <LibGfx/Forward.h>
+#include <LibGfx/Orientation.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Point.h>
+#include <LibGfx/Rect.h>
+#include <LibGfx/TextAlignment.h>
+#include <LibGfx/TextElision.h>
+
+namespace Gfx {
+
+// A recorded sequence of Painter operations that can be played back later, in whole or one clip rect at a time.
+// Bitmaps and fonts used by the operations are kept alive until the list is cleared or destroyed.
+class DisplayList {
+public:
+    DisplayList();
+    ~DisplayList();
+
+    void clear_rect(const Rect&, Color);
+    void fill_rect(const Rect&, Color);
+    void fill_rect_with_checkerboard(const Rect&, const Size&, Color color_dark, Color color_light);
+    void fill_rect_with_gradient(Orientation, const Rect&, Color gradient_start, Color gradient_end);
+    void draw_rect(const Rect&, Color, bool rough = false);
+    void draw_line(const Point&, const Point&, Color, int thickness = 1, bool dotted = false);
+    void blit(const Point&, const Bitmap&, const Rect& src_rect, float opacity = 1.0f);
+    void draw_scaled_bitmap(const Rect& dst_rect, const Bitmap&, const Rect& src_rect, Painter::ScalingMode = Painter::ScalingMode::NearestNeighbor);
+    void draw_tiled_bitmap(const Rect& dst_rect, const Bitmap&);
+    void draw_text(const Rect&, const StringView&, const Font&, TextAlignment = TextAlignment::TopLeft, Color = Color::Black, TextElision = TextElision::None);
+
+    void add_clip_rect(const Rect&);
+    void translate(int dx, int dy);
+    void set_draw_op(Painter::DrawOp);
+    void save();
+    void restore();
+
+    bool is_empty() const { return m_commands.is_empty(); }
+    size_t size() const { return m_commands.size(); }
+    void clear();
+
+    // Plays every operation back into the painter, in the order they were recorded.
+    void paint(Painter&) const;
+
+    // Like paint(), but skips drawing operations that can't touch the given rect.
+    // The rect is in the coordinate space the list is played back into, before any of its own translations.
+    void paint(Painter&, const Rect&) const;
+
+private:
+    struct Command {
+        // Everything the command may draw into, or no value for state changes, which always play back.
+        Optional<Rect> bounds;
+        Function<void(Painter&)> function;
+    };
+
+    void append(const Rect& bounds, Function<void(Painter&)>);
+    void append_state_change(Function<void(Painter&)>);
+
+    Vector<Command> m_commands;
+    Point m_translation;
+    Vector<Point> m_saved_translations;
+};
+
+}
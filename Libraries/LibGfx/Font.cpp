@@ -27,6 +27,7 @@
 #include "Font.h"
 #include "Bitmap.h"
 #include "Emoji.h"
+#include "GlyphAtlas.h"
 #include <AK/BufferStream.h>
 #include <AK/MappedFile.h>
 #include <AK/StdLibExtras.h>
@@ -150,6 +151,18 @@ Font::~Font()
 {
 }
 
+const GlyphAtlas& Font::glyph_atlas() const
+{
+    if (!m_glyph_atlas)
+        m_glyph_atlas = make<GlyphAtlas>(*this);
+    return *m_glyph_atlas;
+}
+
+void Font::invalidate_glyph_atlas()
+{
+    m_glyph_atlas = nullptr;
+}
+
 RefPtr<Font> Font::load_from_memory(const u8* data)
 {
     auto& header = *reinterpret_cast<const FontFileHeader*>(data);
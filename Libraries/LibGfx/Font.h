@@ -27,10 +27,12 @@
 #pragma once
 
 #include <AK/MappedFile.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <LibGfx/Forward.h>
 #include <LibGfx/Size.h>
 
 namespace Gfx {
@@ -86,6 +88,10 @@ public:
 
     GlyphBitmap glyph_bitmap(char ch) const { return GlyphBitmap(&m_rows[(u8)ch * m_glyph_height], { glyph_width(ch), m_glyph_height }); }
 
+    // Built on first use. Anything that edits glyph bits in place must call invalidate_glyph_atlas() afterwards.
+    const GlyphAtlas& glyph_atlas() const;
+    void invalidate_glyph_atlas();
+
     u8 glyph_width(char ch) const { return m_fixed_width ? m_glyph_width : m_glyph_widths[(u8)ch]; }
     int glyph_or_emoji_width(u32 codepoint) const;
     u8 glyph_height() const { return m_glyph_height; }
@@ -98,7 +104,11 @@ public:
     void set_name(const StringView& name) { m_name = name; }
 
     bool is_fixed_width() const { return m_fixed_width; }
-    void set_fixed_width(bool b) { m_fixed_width = b; }
+    void set_fixed_width(bool b)
+    {
+        m_fixed_width = b;
+        invalidate_glyph_atlas();
+    }
 
     u8 glyph_spacing() const { return m_glyph_spacing; }
     void set_glyph_spacing(u8 spacing) { m_glyph_spacing = spacing; }
@@ -107,6 +117,7 @@ public:
     {
         ASSERT(m_glyph_widths);
         m_glyph_widths[(u8)ch] = width;
+        invalidate_glyph_atlas();
     }
 
 private:
@@ -119,6 +130,7 @@ private:
     unsigned* m_rows { nullptr };
     u8* m_glyph_widths { nullptr };
     MappedFile m_mapped_file;
+    mutable OwnPtr<GlyphAtlas> m_glyph_atlas;
 
     u8 m_glyph_width { 0 };
     u8 m_glyph_height { 0 };
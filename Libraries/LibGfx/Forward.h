@@ -32,11 +32,13 @@ class Bitmap;
 class CharacterBitmap;
 class Color;
 class DisjointRectSet;
+class DisplayList;
 class Emoji;
 class FloatPoint;
 class FloatRect;
 class FloatSize;
 class Font;
+class GlyphAtlas;
 class GlyphBitmap;
 class ImageDecoder;
 class Painter;
@@ -48,6 +50,7 @@ class ShareableBitmap;
 class Size;
 class StylePainter;
 struct SystemTheme;
+class TiledPainter;
 class Triangle;
 
 enum class BitmapFormat;
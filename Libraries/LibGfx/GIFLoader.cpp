@@ -24,244 +24,669 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/BufferStream.h>
 #include <AK/ByteBuffer.h>
 #include <AK/FileSystemPath.h>
 #include <AK/MappedFile.h>
+#include <AK/Memory.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <LibGfx/GIFLoader.h>
 #include <stdio.h>
 #include <string.h>
 
+//#define GIF_DEBUG
+
 namespace Gfx {
 
-static RefPtr<Gfx::Bitmap> load_gif_impl(const u8*, size_t);
+// Composited frames of an animation are kept around up to this many bytes, so that looping doesn't mean decoding everything again.
+// They're volatile while not being displayed, so the kernel can take the memory back if it needs it.
+static const size_t frame_cache_budget = 8 * MB;
 
-RefPtr<Gfx::Bitmap> load_gif(const StringView& path)
-{
-    MappedFile mapped_file(path);
-    if (!mapped_file.is_valid())
-        return nullptr;
-    auto bitmap = load_gif_impl((const u8*)mapped_file.data(), mapped_file.size());
-    if (bitmap)
-        bitmap->set_mmap_name(String::format("Gfx::Bitmap [%dx%d] - Decoded GIF: %s", bitmap->width(), bitmap->height(), canonicalized_path(path).characters()));
-    return bitmap;
-}
+// Like browsers do, treat very short frame delays as a sign of a broken encoder rather than a request for 100 fps.
+static const int minimum_frame_duration = 20;
+static const int default_frame_duration = 100;
 
-RefPtr<Gfx::Bitmap> load_gif_from_memory(const u8* data, size_t length)
-{
-    auto bitmap = load_gif_impl(data, length);
-    if (bitmap)
-        bitmap->set_mmap_name(String::format("Gfx::Bitmap [%dx%d] - Decoded GIF: <memory>", bitmap->width(), bitmap->height()));
-    return bitmap;
-}
+// Keeps the canvas (and a copy of it for RestorePrevious) within reason, and its byte size well within a size_t.
+static const u16 max_gif_dimension = 16384;
 
-enum class GIFFormat {
-    GIF87a,
-    GIF89a,
+static const int max_lzw_code_size = 12;
+static const int max_lzw_table_size = 1 << max_lzw_code_size;
+
+enum class DisposalMethod {
+    None = 0,
+    DoNotDispose = 1,
+    RestoreBackground = 2,
+    RestorePrevious = 3,
 };
 
-struct RGB {
-    u8 r;
-    u8 g;
-    u8 b;
+// From the graphic control extension that comes before an image.
+struct GraphicControl {
+    DisposalMethod disposal_method { DisposalMethod::None };
+    bool has_transparency { false };
+    u8 transparent_index { 0 };
+    int duration { default_frame_duration };
 };
 
-struct LogicalScreen {
-    u16 width;
-    u16 height;
-    RGB color_map[256];
+struct GIFImageDescriptor {
+    u16 x { 0 };
+    u16 y { 0 };
+    u16 width { 0 };
+    u16 height { 0 };
+    bool interlaced { false };
+    bool use_global_color_map { true };
+    RGBA32 color_map[256];
+    u8 lzw_min_code_size { 0 };
+    // The image data sub-blocks stay where they are in the file; this is the offset of the first one.
+    size_t lzw_data_offset { 0 };
+
+    GraphicControl control;
+
+    Rect rect() const { return { x, y, width, height }; }
 };
 
-struct ImageDescriptor {
-    u16 x;
-    u16 y;
-    u16 width;
-    u16 height;
-    bool use_global_color_map;
-    RGB color_map[256];
-    u8 lzw_min_code_size;
-    Vector<u8> lzw_encoded_bytes;
+struct CachedFrame {
+    size_t index { 0 };
+    NonnullRefPtr<Gfx::Bitmap> bitmap;
 };
 
-RefPtr<Gfx::Bitmap> load_gif_impl(const u8* data, size_t data_size)
-{
-    if (data_size < 32)
-        return nullptr;
+struct GIFLoadingContext {
+    enum State {
+        NotDecoded = 0,
+        Error,
+        FrameDescriptorsLoaded,
+    };
+    State state { NotDecoded };
+    const u8* data { nullptr };
+    size_t data_size { 0 };
+
+    u16 width { 0 };
+    u16 height { 0 };
+    RGBA32 global_color_map[256];
+    size_t loop_count { 0 };
+    NonnullOwnPtrVector<GIFImageDescriptor> images;
+
+    // The animation as of frame `canvas_frame`, before that frame's disposal method is applied.
+    RefPtr<Gfx::Bitmap> canvas;
+    int canvas_frame { -1 };
+    // What the canvas looked like before a frame that wants it restored afterwards.
+    RefPtr<Gfx::Bitmap> previous_canvas;
+    // Color indices of the frame being decoded, row by row in the order they're stored.
+    ByteBuffer index_buffer;
+
+    Vector<CachedFrame> frame_cache;
+    size_t max_cached_frames { 1 };
+    // The frame most recently handed out, which is kept non-volatile while it's on screen.
+    RefPtr<Gfx::Bitmap> current_frame;
+    size_t current_frame_index { 0 };
+};
 
-    auto buffer = ByteBuffer::wrap(data, data_size);
-    BufferStream stream(buffer);
+// Reads from the chain of length-prefixed sub-blocks that follow an image descriptor or extension.
+class SubBlockReader {
+public:
+    SubBlockReader(const u8* data, size_t size, size_t offset)
+        : m_data(data)
+        , m_size(size)
+        , m_offset(offset)
+    {
+    }
 
-    static const char valid_header_87[] = "GIF87a";
-    static const char valid_header_89[] = "GIF89a";
+    // Returns false at the terminating empty block, or if the data ends before it.
+    bool read_byte(u8& value)
+    {
+        if (!m_remaining_in_block) {
+            if (m_at_end || m_offset >= m_size || !m_data[m_offset]) {
+                m_at_end = true;
+                return false;
+            }
+            m_remaining_in_block = m_data[m_offset++];
+        }
+        if (m_offset >= m_size) {
+            m_at_end = true;
+            return false;
+        }
+        value = m_data[m_offset++];
+        --m_remaining_in_block;
+        return true;
+    }
 
-    char header[6];
-    for (int i = 0; i < 6; ++i)
-        stream >> header[i];
+    // Moves past all remaining sub-blocks, including the terminator. Returns false if the data ends first.
+    bool skip_to_end()
+    {
+        m_offset += m_remaining_in_block;
+        m_remaining_in_block = 0;
+        while (m_offset < m_size) {
+            u8 length = m_data[m_offset++];
+            if (!length)
+                return true;
+            m_offset += length;
+        }
+        return false;
+    }
 
-    GIFFormat format;
-    if (!memcmp(header, valid_header_87, sizeof(header)))
-        format = GIFFormat::GIF87a;
-    else if (!memcmp(header, valid_header_89, sizeof(header)))
-        format = GIFFormat::GIF89a;
-    else
-        return nullptr;
+    size_t offset() const { return m_offset; }
 
-    printf("Format is %s\n", format == GIFFormat::GIF89a ? "GIF89a" : "GIF87a");
+private:
+    const u8* m_data { nullptr };
+    size_t m_size { 0 };
+    size_t m_offset { 0 };
+    size_t m_remaining_in_block { 0 };
+    bool m_at_end { false };
+};
 
-    LogicalScreen logical_screen;
-    stream >> logical_screen.width;
-    stream >> logical_screen.height;
-    if (stream.handle_read_failure())
-        return nullptr;
+// Decodes GIF-flavored LZW straight into a buffer of color indices.
+//
+// Each table entry remembers the code it extends, its last byte, its first byte and its length. That's
+// enough to write out a whole string back to front in one pass, directly into its final place in the output.
+class LZWDecoder {
+public:
+    LZWDecoder(SubBlockReader& reader, u8 min_code_size)
+        : m_reader(reader)
+        , m_min_code_size(min_code_size)
+        , m_clear_code(1 << min_code_size)
+        , m_end_of_information_code(m_clear_code + 1)
+    {
+        for (int code = 0; code < m_clear_code; ++code) {
+            m_prefix[code] = 0;
+            m_suffix[code] = code;
+            m_first[code] = code;
+            m_length[code] = 1;
+        }
+        reset();
+    }
 
-    u8 gcm_info = 0;
-    stream >> gcm_info;
+    // Fills `output` with decoded indices, and stops early at the end of the data or at an invalid code.
+    // Like other decoders, we show as much of a broken image as we can rather than nothing at all.
+    void decode(u8* output, size_t output_size)
+    {
+        size_t position = 0;
+        while (position < output_size) {
+            int code;
+            if (!read_code(code))
+                return;
+            if (code == m_clear_code) {
+                reset();
+                continue;
+            }
+            if (code == m_end_of_information_code)
+                return;
+
+            if (m_previous_code < 0) {
+                if (code >= m_clear_code)
+                    return;
+                output[position++] = code;
+                m_previous_code = code;
+                continue;
+            }
 
-    if (stream.handle_read_failure())
-        return nullptr;
+            if (code == m_next_code) {
+                // The one code the encoder can send before we know it: the previous string plus its own first byte.
+                add_entry(m_previous_code, m_first[m_previous_code]);
+            } else if (code < m_next_code) {
+                add_entry(m_previous_code, m_first[code]);
+            } else {
+                return;
+            }
+            position += write_string(code, output + position, output_size - position);
+            m_previous_code = code;
+        }
+    }
 
-    bool global_color_map_follows_descriptor = gcm_info & 0x80;
-    u8 bits_per_pixel = (gcm_info & 7) + 1;
-    u8 bits_of_color_resolution = (gcm_info >> 4) & 7;
+private:
+    void reset()
+    {
+        m_code_size = m_min_code_size + 1;
+        m_next_code = m_end_of_information_code + 1;
+        m_previous_code = -1;
+    }
 
-    printf("LogicalScreen: %dx%d\n", logical_screen.width, logical_screen.height);
-    printf("global_color_map_follows_descriptor: %u\n", global_color_map_follows_descriptor);
-    printf("bits_per_pixel: %u\n", bits_per_pixel);
-    printf("bits_of_color_resolution: %u\n", bits_of_color_resolution);
+    bool read_code(int& code)
+    {
+        while (m_bit_count < m_code_size) {
+            u8 byte;
+            if (!m_reader.read_byte(byte))
+                return false;
+            m_bit_buffer |= byte << m_bit_count;
+            m_bit_count += 8;
+        }
+        code = m_bit_buffer & ((1 << m_code_size) - 1);
+        m_bit_buffer >>= m_code_size;
+        m_bit_count -= m_code_size;
+        return true;
+    }
 
-    u8 background_color = 0;
-    stream >> background_color;
-    if (stream.handle_read_failure())
-        return nullptr;
+    // Once the table is full, nothing more is added until the encoder sends a clear code; until then, codes are just looked up.
+    void add_entry(int prefix, u8 suffix)
+    {
+        if (m_next_code >= max_lzw_table_size)
+            return;
+        m_prefix[m_next_code] = prefix;
+        m_suffix[m_next_code] = suffix;
+        m_first[m_next_code] = m_first[prefix];
+        m_length[m_next_code] = m_length[prefix] + 1;
+        ++m_next_code;
+        if (m_next_code == (1 << m_code_size) && m_code_size < max_lzw_code_size)
+            ++m_code_size;
+    }
 
-    printf("background_color: %u\n", background_color);
+    size_t write_string(int code, u8* output, size_t space)
+    {
+        size_t length = m_length[code];
+        // Whatever doesn't fit in the image is dropped.
+        while (length > space) {
+            code = m_prefix[code];
+            --length;
+        }
+        for (size_t i = length; i > 0; --i) {
+            output[i - 1] = m_suffix[code];
+            code = m_prefix[code];
+        }
+        return length;
+    }
+
+    SubBlockReader& m_reader;
+    int m_min_code_size { 0 };
+    int m_clear_code { 0 };
+    int m_end_of_information_code { 0 };
+    int m_code_size { 0 };
+    int m_next_code { 0 };
+    int m_previous_code { -1 };
+    u32 m_bit_buffer { 0 };
+    int m_bit_count { 0 };
+
+    u16 m_prefix[max_lzw_table_size];
+    u8 m_suffix[max_lzw_table_size];
+    u8 m_first[max_lzw_table_size];
+    u16 m_length[max_lzw_table_size];
+};
+
+static RefPtr<Gfx::Bitmap> load_gif_impl(const u8*, size_t);
 
-    u8 pixel_aspect_ratio = 0;
-    stream >> pixel_aspect_ratio;
-    if (stream.handle_read_failure())
+RefPtr<Gfx::Bitmap> load_gif(const StringView& path)
+{
+    MappedFile mapped_file(path);
+    if (!mapped_file.is_valid())
         return nullptr;
+    auto bitmap = load_gif_impl((const u8*)mapped_file.data(), mapped_file.size());
+    if (bitmap)
+        bitmap->set_mmap_name(String::format("Gfx::Bitmap [%dx%d] - Decoded GIF: %s", bitmap->width(), bitmap->height(), canonicalized_path(path).characters()));
+    return bitmap;
+}
 
-    int color_map_entry_count = 1;
-    for (int i = 0; i < bits_per_pixel; ++i)
-        color_map_entry_count *= 2;
+RefPtr<Gfx::Bitmap> load_gif_from_memory(const u8* data, size_t length)
+{
+    auto bitmap = load_gif_impl(data, length);
+    if (bitmap)
+        bitmap->set_mmap_name(String::format("Gfx::Bitmap [%dx%d] - Decoded GIF: <memory>", bitmap->width(), bitmap->height()));
+    return bitmap;
+}
 
-    printf("color_map_entry_count: %d\n", color_map_entry_count);
+static bool read_color_map(const u8* data, size_t data_size, size_t& offset, RGBA32* color_map, int entry_count)
+{
+    if (offset + entry_count * 3 > data_size)
+        return false;
+    for (int i = 0; i < entry_count; ++i, offset += 3)
+        color_map[i] = 0xff000000 | (data[offset] << 16) | (data[offset + 1] << 8) | data[offset + 2];
+    // Indices past the end of a short color map are invalid, but show up as black in every other decoder.
+    for (int i = entry_count; i < 256; ++i)
+        color_map[i] = 0xff000000;
+    return true;
+}
 
-    for (int i = 0; i < color_map_entry_count; ++i) {
-        stream >> logical_screen.color_map[i].r;
-        stream >> logical_screen.color_map[i].g;
-        stream >> logical_screen.color_map[i].b;
-    }
+static u16 read_u16(const u8* data)
+{
+    return data[0] | (data[1] << 8);
+}
 
-    if (stream.handle_read_failure())
-        return nullptr;
+// Walks the whole file once, recording where each frame's data is without decoding any of it.
+static bool load_gif_frame_descriptors(GIFLoadingContext& context)
+{
+    if (context.state >= GIFLoadingContext::State::FrameDescriptorsLoaded)
+        return true;
+    if (context.state == GIFLoadingContext::State::Error)
+        return false;
+
+    auto fail = [&] {
+        context.state = GIFLoadingContext::State::Error;
+        return false;
+    };
+
+    const u8* data = context.data;
+    size_t data_size = context.data_size;
+    if (data_size < 13 || (memcmp(data, "GIF87a", 6) && memcmp(data, "GIF89a", 6)))
+        return fail();
+
+    context.width = read_u16(data + 6);
+    context.height = read_u16(data + 8);
+    u8 screen_flags = data[10];
+    size_t offset = 13;
+    if (!context.width || context.width > max_gif_dimension || !context.height || context.height > max_gif_dimension) {
+        dbg() << "GIF: Unsupported size " << context.width << "x" << context.height;
+        return fail();
+    }
 
-    for (int i = 0; i < color_map_entry_count; ++i) {
-        auto& rgb = logical_screen.color_map[i];
-        printf("[%02x]: %s\n", i, Color(rgb.r, rgb.g, rgb.b).to_string().characters());
+    if (screen_flags & 0x80) {
+        if (!read_color_map(data, data_size, offset, context.global_color_map, 1 << ((screen_flags & 7) + 1)))
+            return fail();
+    } else {
+        read_color_map(data, data_size, offset, context.global_color_map, 0);
     }
 
-    NonnullOwnPtrVector<ImageDescriptor> images;
+#ifdef GIF_DEBUG
+    dbg() << "GIF: " << context.width << "x" << context.height << ", global color map: " << (bool)(screen_flags & 0x80);
+#endif
 
+    GraphicControl pending_control;
     for (;;) {
-        u8 sentinel = 0;
-        stream >> sentinel;
-        printf("Sentinel: %02x\n", sentinel);
+        if (offset >= data_size)
+            break;
+        u8 sentinel = data[offset++];
 
         if (sentinel == 0x21) {
-            u8 extension_type = 0;
-            stream >> extension_type;
-            if (stream.handle_read_failure())
-                return nullptr;
+            if (offset >= data_size)
+                return fail();
+            u8 extension_type = data[offset++];
+            SubBlockReader reader(data, data_size, offset);
+            if (extension_type == 0xf9 && offset + 5 < data_size && data[offset] >= 4) {
+                // Graphic control extension, for the next image.
+                u8 packed_fields = data[offset + 1];
+                pending_control.disposal_method = (DisposalMethod)((packed_fields >> 2) & 7);
+                pending_control.has_transparency = packed_fields & 1;
+                pending_control.duration = read_u16(data + offset + 2) * 10;
+                if (pending_control.duration < minimum_frame_duration)
+                    pending_control.duration = default_frame_duration;
+                pending_control.transparent_index = data[offset + 4];
+            } else if (extension_type == 0xff && offset + 15 < data_size && data[offset] == 11 && !memcmp(data + offset + 1, "NETSCAPE2.0", 11)) {
+                // The application extension with the loop count.
+                if (data[offset + 12] >= 3 && data[offset + 13] == 1)
+                    context.loop_count = read_u16(data + offset + 14);
+            }
+            if (!reader.skip_to_end())
+                return fail();
+            offset = reader.offset();
+            continue;
+        }
 
-            printf("Extension block of type %02x\n", extension_type);
+        if (sentinel == 0x2c) {
+            if (offset + 9 > data_size)
+                return fail();
+            auto image = make<GIFImageDescriptor>();
+            image->x = read_u16(data + offset);
+            image->y = read_u16(data + offset + 2);
+            image->width = read_u16(data + offset + 4);
+            image->height = read_u16(data + offset + 6);
+            u8 packed_fields = data[offset + 8];
+            offset += 9;
+            // Only the part on the canvas is ever shown, but the whole frame is decoded.
+            if (image->width > max_gif_dimension || image->height > max_gif_dimension)
+                return fail();
+            image->interlaced = packed_fields & 0x40;
+            image->use_global_color_map = !(packed_fields & 0x80);
+            if (!image->use_global_color_map && !read_color_map(data, data_size, offset, image->color_map, 1 << ((packed_fields & 7) + 1)))
+                return fail();
+
+            if (offset >= data_size)
+                return fail();
+            image->lzw_min_code_size = data[offset++];
+            if (image->lzw_min_code_size < 2 || image->lzw_min_code_size > 8)
+                return fail();
+            image->lzw_data_offset = offset;
+
+            image->control = pending_control;
+            pending_control = {};
+
+#ifdef GIF_DEBUG
+            dbg() << "GIF: Image " << context.images.size() << ": " << image->rect() << ", interlaced: " << image->interlaced << ", disposal: " << (int)image->control.disposal_method << ", " << image->control.duration << " ms";
+#endif
+
+            SubBlockReader reader(data, data_size, offset);
+            bool is_complete = reader.skip_to_end();
+            offset = reader.offset();
+            context.images.append(move(image));
+            // A truncated last frame still gets shown as far as it goes.
+            if (!is_complete)
+                break;
+            continue;
+        }
 
-            u8 sub_block_length = 0;
+        // The trailer, or garbage we can't make sense of after the frames we have.
+        break;
+    }
 
-            for (;;) {
-                stream >> sub_block_length;
+    if (context.images.is_empty())
+        return fail();
 
-                if (stream.handle_read_failure())
-                    return nullptr;
+    // Both dimensions are capped, so this is at most 1 GiB.
+    size_t frame_size = (size_t)context.width * context.height * sizeof(RGBA32);
+    context.max_cached_frames = max((size_t)1, min(context.images.size(), frame_cache_budget / frame_size));
 
-                if (sub_block_length == 0)
-                    break;
+    context.state = GIFLoadingContext::State::FrameDescriptorsLoaded;
+    return true;
+}
+
+static void clear_rect(Gfx::Bitmap& bitmap, const Rect& rect)
+{
+    auto clipped_rect = rect.intersected(bitmap.rect());
+    for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y)
+        fast_u32_fill(bitmap.scanline(y) + clipped_rect.left(), 0, clipped_rect.width());
+}
+
+static void copy_bitmap(Gfx::Bitmap& destination, const Gfx::Bitmap& source)
+{
+    ASSERT(destination.size() == source.size());
+    for (int y = 0; y < source.height(); ++y)
+        fast_u32_copy(destination.scanline(y), source.scanline(y), source.width());
+}
+
+// Maps the n'th stored row of an interlaced image to where it goes: every 8th row from 0, every 8th from 4, every 4th from 2, then every other row from 1.
+static int interlaced_row(int row, int height)
+{
+    int pass_1_rows = (height + 7) / 8;
+    if (row < pass_1_rows)
+        return row * 8;
+    row -= pass_1_rows;
+    int pass_2_rows = (height + 3) / 8;
+    if (row < pass_2_rows)
+        return row * 8 + 4;
+    row -= pass_2_rows;
+    int pass_3_rows = (height + 1) / 4;
+    if (row < pass_3_rows)
+        return row * 4 + 2;
+    row -= pass_3_rows;
+    return row * 2 + 1;
+}
 
-                u8 dummy;
-                for (u16 i = 0; i < sub_block_length; ++i)
-                    stream >> dummy;
+static void draw_frame(GIFLoadingContext& context, const GIFImageDescriptor& image)
+{
+    size_t pixel_count = (size_t)image.width * image.height;
+    if (!pixel_count)
+        return;
+    if (context.index_buffer.size() < pixel_count)
+        context.index_buffer = ByteBuffer::create_uninitialized(pixel_count);
+    u8* indices = context.index_buffer.data();
+    // Pixels the data doesn't cover are left transparent (or whatever was under them).
+    int fill_index = image.control.has_transparency ? image.control.transparent_index : 0;
+    memset(indices, fill_index, pixel_count);
+
+    SubBlockReader reader(context.data, context.data_size, image.lzw_data_offset);
+    auto decoder = make<LZWDecoder>(reader, image.lzw_min_code_size);
+    decoder->decode(indices, pixel_count);
+
+    auto* color_map = image.use_global_color_map ? context.global_color_map : image.color_map;
+    auto& canvas = *context.canvas;
+    auto clipped_rect = image.rect().intersected(canvas.rect());
+    for (int row = 0; row < image.height; ++row) {
+        int y = image.y + (image.interlaced ? interlaced_row(row, image.height) : row);
+        if (y < clipped_rect.top() || y > clipped_rect.bottom())
+            continue;
+        const u8* row_indices = indices + (size_t)row * image.width + (clipped_rect.left() - image.x);
+        RGBA32* pixels = canvas.scanline(y) + clipped_rect.left();
+        int count = clipped_rect.width();
+        if (image.control.has_transparency) {
+            for (int i = 0; i < count; ++i) {
+                if (row_indices[i] != image.control.transparent_index)
+                    pixels[i] = color_map[row_indices[i]];
+            }
+        } else {
+            for (int i = 0; i < count; ++i)
+                pixels[i] = color_map[row_indices[i]];
+        }
+    }
+}
 
-                if (stream.handle_read_failure())
-                    return nullptr;
+// Brings the canvas to the given frame, starting over from the first frame if that's behind us.
+static void compose_frame(GIFLoadingContext& context, int frame_index)
+{
+    if (!context.canvas) {
+        context.canvas = Gfx::Bitmap::create(BitmapFormat::RGBA32, { context.width, context.height });
+        context.canvas_frame = -1;
+    }
+    if (context.canvas_frame > frame_index) {
+        context.canvas_frame = -1;
+        context.previous_canvas = nullptr;
+    }
+    if (context.canvas_frame < 0)
+        clear_rect(*context.canvas, context.canvas->rect());
+
+    while (context.canvas_frame < frame_index) {
+        if (context.canvas_frame >= 0) {
+            auto& previous_image = context.images[context.canvas_frame];
+            if (previous_image.control.disposal_method == DisposalMethod::RestoreBackground) {
+                // Browsers agree on clearing to transparent here, rather than to the background color.
+                clear_rect(*context.canvas, previous_image.rect());
+            } else if (previous_image.control.disposal_method == DisposalMethod::RestorePrevious && context.previous_canvas) {
+                copy_bitmap(*context.canvas, *context.previous_canvas);
             }
+        }
+
+        auto& image = context.images[context.canvas_frame + 1];
+        if (image.control.disposal_method == DisposalMethod::RestorePrevious) {
+            if (!context.previous_canvas)
+                context.previous_canvas = Gfx::Bitmap::create(BitmapFormat::RGBA32, context.canvas->size());
+            copy_bitmap(*context.previous_canvas, *context.canvas);
+        }
+        draw_frame(context, image);
+        ++context.canvas_frame;
+    }
+}
+
+static RefPtr<Gfx::Bitmap> cached_frame(GIFLoadingContext& context, size_t frame_index)
+{
+    for (size_t i = 0; i < context.frame_cache.size(); ++i) {
+        if (context.frame_cache[i].index != frame_index)
             continue;
+        auto bitmap = context.frame_cache[i].bitmap;
+        context.frame_cache.remove(i);
+        if (!bitmap->set_nonvolatile()) {
+            // The kernel took it back while we weren't looking.
+            return nullptr;
         }
+        // Most recently used frames go at the back.
+        context.frame_cache.append({ frame_index, bitmap });
+        return bitmap;
+    }
+    return nullptr;
+}
 
-        if (sentinel == 0x2c) {
-            images.append(make<ImageDescriptor>());
-            auto& image = images.last();
-            u8 packed_fields { 0 };
-            stream >> image.x;
-            stream >> image.y;
-            stream >> image.width;
-            stream >> image.height;
-            stream >> packed_fields;
-            if (stream.handle_read_failure())
-                return nullptr;
-            printf("Image descriptor: %d,%d %dx%d, %02x\n", image.x, image.y, image.width, image.height, packed_fields);
+static RefPtr<Gfx::Bitmap> decode_frame(GIFLoadingContext& context, size_t frame_index)
+{
+    if (!load_gif_frame_descriptors(context))
+        return nullptr;
+    if (frame_index >= context.images.size())
+        return nullptr;
 
-            stream >> image.lzw_min_code_size;
+    if (context.current_frame && context.current_frame_index == frame_index)
+        return context.current_frame;
 
-            printf("min code size: %u\n", image.lzw_min_code_size);
+    if (context.current_frame)
+        context.current_frame->set_volatile();
+    context.current_frame_index = frame_index;
+    context.current_frame = cached_frame(context, frame_index);
+    if (context.current_frame)
+        return context.current_frame;
 
-            u8 lzw_encoded_bytes_expected = 0;
+    compose_frame(context, frame_index);
 
-            for (;;) {
-                stream >> lzw_encoded_bytes_expected;
+    auto bitmap = Gfx::Bitmap::create_purgeable(BitmapFormat::RGBA32, context.canvas->size());
+    copy_bitmap(*bitmap, *context.canvas);
+    if (context.frame_cache.size() >= context.max_cached_frames)
+        context.frame_cache.take_first();
+    context.frame_cache.append({ frame_index, bitmap });
+    context.current_frame = bitmap;
+    return bitmap;
+}
 
-                if (stream.handle_read_failure())
-                    return nullptr;
+static RefPtr<Gfx::Bitmap> load_gif_impl(const u8* data, size_t data_size)
+{
+    GIFLoadingContext context;
+    context.data = data;
+    context.data_size = data_size;
+    return decode_frame(context, 0);
+}
 
-                if (lzw_encoded_bytes_expected == 0)
-                    break;
+GIFImageDecoderPlugin::GIFImageDecoderPlugin(const u8* data, size_t size)
+{
+    m_context = make<GIFLoadingContext>();
+    m_context->data = data;
+    m_context->data_size = size;
+}
 
-                u8 buffer[256];
-                for (int i = 0; i < lzw_encoded_bytes_expected; ++i) {
-                    stream >> buffer[i];
-                }
+GIFImageDecoderPlugin::~GIFImageDecoderPlugin()
+{
+}
 
-                if (stream.handle_read_failure())
-                    return nullptr;
+Size GIFImageDecoderPlugin::size()
+{
+    if (!load_gif_frame_descriptors(*m_context))
+        return {};
+    return { m_context->width, m_context->height };
+}
 
-                for (int i = 0; i < lzw_encoded_bytes_expected; ++i) {
-                    image.lzw_encoded_bytes.append(buffer[i]);
-                }
-            }
-            continue;
-        }
+RefPtr<Gfx::Bitmap> GIFImageDecoderPlugin::bitmap()
+{
+    if (m_context->current_frame)
+        return m_context->current_frame;
+    return decode_frame(*m_context, 0);
+}
 
-        if (sentinel == 0x3b) {
-            printf("Trailer! Awesome :)\n");
-            break;
-        }
+void GIFImageDecoderPlugin::set_volatile()
+{
+    if (m_context->current_frame)
+        m_context->current_frame->set_volatile();
+    m_context->current_frame = nullptr;
+}
 
-        return nullptr;
-    }
+bool GIFImageDecoderPlugin::set_nonvolatile()
+{
+    // Frames are composited again from the encoded data whenever the kernel has taken them back, so there's always an image.
+    return m_context->state != GIFLoadingContext::State::Error;
+}
 
-    // We exited the block loop after finding a trailer. We should have everything needed.
-    printf("Image count: %zu\n", images.size());
-    if (images.is_empty())
-        return nullptr;
+bool GIFImageDecoderPlugin::is_animated()
+{
+    if (!load_gif_frame_descriptors(*m_context))
+        return false;
+    return m_context->images.size() > 1;
+}
 
-    for (size_t i = 0; i < images.size(); ++i) {
-        auto& image = images.at(i);
-        printf("Image %zu: %d,%d %dx%d  %zu bytes LZW-encoded\n", i, image.x, image.y, image.width, image.height, image.lzw_encoded_bytes.size());
+size_t GIFImageDecoderPlugin::loop_count()
+{
+    if (!load_gif_frame_descriptors(*m_context))
+        return 0;
+    return m_context->loop_count;
+}
 
-        // FIXME: Decode the LZW-encoded bytes and turn them into an image.
-    }
+size_t GIFImageDecoderPlugin::frame_count()
+{
+    if (!load_gif_frame_descriptors(*m_context))
+        return 0;
+    return m_context->images.size();
+}
 
-    return nullptr;
+ImageFrameDescriptor GIFImageDecoderPlugin::frame(size_t index)
+{
+    auto bitmap = decode_frame(*m_context, index);
+    if (!bitmap)
+        return {};
+    return { bitmap, m_context->images[index].control.duration };
 }
 
 }
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibGfx/Font.h>
+#include <LibGfx/GlyphAtlas.h>
+
+namespace Gfx {
+
+GlyphAtlas::GlyphAtlas(const Font& font)
+    : m_glyph_height(font.glyph_height())
+{
+    m_row_offsets.ensure_capacity(256 * m_glyph_height + 1);
+    for (int glyph = 0; glyph < 256; ++glyph) {
+        auto bitmap = font.glyph_bitmap((char)glyph);
+        int width = min(bitmap.width(), 32);
+        for (int row = 0; row < m_glyph_height; ++row) {
+            m_row_offsets.unchecked_append(m_spans.size());
+            unsigned bits = bitmap.row(row);
+            if (width < 32)
+                bits &= (1u << width) - 1;
+            while (bits) {
+                int start = __builtin_ctz(bits);
+                int end = start + 1;
+                while (end < width && (bits & (1u << end)))
+                    ++end;
+                m_spans.append({ (u8)start, (u8)(end - start) });
+                bits = end < 32 ? bits & (~0u << end) : 0;
+            }
+        }
+    }
+    m_row_offsets.unchecked_append(m_spans.size());
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibGfx/Forward.h>
+
+namespace Gfx {
+
+struct GlyphSpan {
+    u8 x;
+    u8 width;
+};
+
+// Every glyph of a font, pre-split into horizontal runs of set pixels.
+// Painting a glyph then becomes one span fill per run instead of one bit test per pixel.
+class GlyphAtlas {
+public:
+    explicit GlyphAtlas(const Font&);
+
+    const GlyphSpan* spans(u8 glyph, int row, size_t& count) const
+    {
+        size_t index = glyph * m_glyph_height + row;
+        size_t first = m_row_offsets[index];
+        count = m_row_offsets[index + 1] - first;
+        return m_spans.data() + first;
+    }
+
+    bool is_empty(u8 glyph) const { return m_row_offsets[glyph * m_glyph_height] == m_row_offsets[(glyph + 1) * m_glyph_height]; }
+
+private:
+    int m_glyph_height { 0 };
+    Vector<u32> m_row_offsets;
+    Vector<GlyphSpan> m_spans;
+};
+
+}
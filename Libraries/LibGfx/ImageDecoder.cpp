@@ -24,14 +24,24 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibGfx/GIFLoader.h>
 #include <LibGfx/ImageDecoder.h>
 #include <LibGfx/PNGLoader.h>
+#include <string.h>
 
 namespace Gfx {
 
+ImageDecoder::ImageDecoder()
+{
+    m_plugin = make<PNGImageDecoderPlugin>();
+}
+
 ImageDecoder::ImageDecoder(const u8* data, size_t size)
 {
-    m_plugin = make<PNGImageDecoderPlugin>(data, size);
+    if (size >= 6 && (!memcmp(data, "GIF87a", 6) || !memcmp(data, "GIF89a", 6)))
+        m_plugin = make<GIFImageDecoderPlugin>(data, size);
+    else
+        m_plugin = make<PNGImageDecoderPlugin>(data, size);
 }
 
 ImageDecoder::~ImageDecoder()
@@ -35,6 +35,12 @@ namespace Gfx {
 
 class Bitmap;
 
+struct ImageFrameDescriptor {
+    RefPtr<Gfx::Bitmap> image;
+    // How long the frame stays up, in milliseconds.
+    int duration { 0 };
+};
+
 class ImageDecoderPlugin {
 public:
     virtual ~ImageDecoderPlugin() {}
@@ -45,6 +51,22 @@ public:
     virtual void set_volatile() = 0;
     [[nodiscard]] virtual bool set_nonvolatile() = 0;
 
+    // For plugins created without data, which get it piece by piece instead. Returns false if the data is invalid.
+    virtual bool append_data(const u8*, size_t) { return false; }
+    virtual bool is_complete() { return true; }
+
+    virtual bool is_animated() { return false; }
+    // How many times an animation should play; 0 means forever.
+    virtual size_t loop_count() { return 0; }
+    virtual size_t frame_count() { return 1; }
+    // The returned image stays valid until the next call to frame() or set_volatile().
+    virtual ImageFrameDescriptor frame(size_t index)
+    {
+        if (index > 0)
+            return {};
+        return { bitmap(), 0 };
+    }
+
 protected:
     ImageDecoderPlugin() {}
 };
@@ -52,6 +74,9 @@ protected:
 class ImageDecoder : public RefCounted<ImageDecoder> {
 public:
     static NonnullRefPtr<ImageDecoder> create(const u8* data, size_t size) { return adopt(*new ImageDecoder(data, size)); }
+    // Creates a decoder that is fed with append_data() while the image is still arriving.
+    // Its bitmap() shows whatever has been decoded so far, as soon as the size is known.
+    static NonnullRefPtr<ImageDecoder> create_incremental() { return adopt(*new ImageDecoder); }
     ~ImageDecoder();
 
     Size size() const { return m_plugin->size(); }
@@ -61,7 +86,16 @@ public:
     void set_volatile() { m_plugin->set_volatile(); }
     [[nodiscard]] bool set_nonvolatile() { return m_plugin->set_nonvolatile(); }
 
+    [[nodiscard]] bool append_data(const u8* data, size_t size) { return m_plugin->append_data(data, size); }
+    bool is_complete() const { return m_plugin->is_complete(); }
+
+    bool is_animated() const { return m_plugin->is_animated(); }
+    size_t loop_count() const { return m_plugin->loop_count(); }
+    size_t frame_count() const { return m_plugin->frame_count(); }
+    ImageFrameDescriptor frame(size_t index) const { return m_plugin->frame(index); }
+
 private:
+    ImageDecoder();
     ImageDecoder(const u8*, size_t);
 
     mutable OwnPtr<ImageDecoderPlugin> m_plugin;
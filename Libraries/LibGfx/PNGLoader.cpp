@@ -27,21 +27,22 @@
 #include <AK/ByteBuffer.h>
 #include <AK/FileSystemPath.h>
 #include <AK/MappedFile.h>
+#include <AK/Memory.h>
 #include <AK/NetworkOrdered.h>
-#include <LibCore/puff.h>
+#include <LibCore/Inflate.h>
 #include <LibGfx/PNGLoader.h>
-#include <fcntl.h>
-#include <serenity.h>
 #include <stdio.h>
 #include <string.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <unistd.h>
 
 namespace Gfx {
 
 static const u8 png_header[8] = { 0x89, 'P', 'N', 'G', 13, 10, 26, 10 };
 
+// Keeps width * height * sizeof(RGBA32) well within a size_t, even on 32-bit.
+static const u32 max_png_dimension = 16384;
+// IHDR, PLTE and tRNS are the only chunks we keep in one piece, and none of them can legitimately be this big.
+static const u32 max_buffered_chunk_size = 1024;
+
 struct PNG_IHDR {
     NetworkOrdered<u32> width;
     NetworkOrdered<u32> height;
@@ -54,11 +55,6 @@ struct PNG_IHDR {
 
 static_assert(sizeof(PNG_IHDR) == 13);
 
-struct Scanline {
-    u8 filter { 0 };
-    ByteBuffer data {};
-};
-
 struct [[gnu::packed]] PaletteEntry
 {
     u8 r;
@@ -67,26 +63,30 @@ struct [[gnu::packed]] PaletteEntry
     //u8 a;
 };
 
-struct [[gnu::packed]] Triplet
-{
-    u8 r;
-    u8 g;
-    u8 b;
+// One pass over the image: every dx'th pixel of every dy'th row, starting at (x, y).
+// While a pass is the latest one decoded, each of its pixels stands in for the block_width x block_height
+// block to its lower right, which later passes fill in with real pixels.
+struct InterlacePass {
+    int x;
+    int y;
+    int dx;
+    int dy;
+    int block_width;
+    int block_height;
 };
 
-struct [[gnu::packed]] Triplet16
-{
-    u16 r;
-    u16 g;
-    u16 b;
+static const InterlacePass non_interlaced_passes[] = {
+    { 0, 0, 1, 1, 1, 1 },
 };
 
-struct [[gnu::packed]] Quad16
-{
-    u16 r;
-    u16 g;
-    u16 b;
-    u16 a;
+static const InterlacePass adam7_passes[] = {
+    { 0, 0, 8, 8, 8, 8 },
+    { 4, 0, 8, 8, 4, 8 },
+    { 0, 4, 4, 8, 4, 4 },
+    { 2, 0, 4, 4, 2, 4 },
+    { 0, 2, 2, 4, 2, 2 },
+    { 1, 0, 2, 2, 1, 2 },
+    { 0, 1, 1, 2, 1, 1 },
 };
 
 struct PNGLoadingContext {
@@ -95,12 +95,23 @@ struct PNGLoadingContext {
         Error,
         HeaderDecoded,
         SizeDecoded,
-        ChunksDecoded,
         BitmapDecoded,
     };
+    enum class ChunkState {
+        Signature,
+        ChunkHeader,
+        ChunkData,
+        ChunkCRC,
+        End,
+    };
     State state { State::NotDecoded };
+    // Set when the whole file is in memory up front; data_fed is how much of it has been decoded so far.
     const u8* data { nullptr };
     size_t data_size { 0 };
+    size_t data_fed { 0 };
+    // Set when the file arrives piece by piece: the bitmap is always RGBA32 so that the
+    // part that hasn't arrived yet is transparent, and interlaced passes are spread out for display.
+    bool is_incremental { false };
     int width { -1 };
     int height { -1 };
     u8 bit_depth { 0 };
@@ -109,69 +120,41 @@ struct PNGLoadingContext {
     u8 filter_method { 0 };
     u8 interlace_method { 0 };
     u8 bytes_per_pixel { 0 };
-    bool has_seen_zlib_header { false };
     bool has_alpha() const { return color_type & 4 || palette_transparency_data.size() > 0; }
-    Vector<Scanline> scanlines;
     RefPtr<Gfx::Bitmap> bitmap;
-    u8* decompression_buffer { nullptr };
-    int decompression_buffer_size { 0 };
-    Vector<u8> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
-};
-
-class Streamer {
-public:
-    Streamer(const u8* data, int size)
-        : m_original_data(data)
-        , m_original_size(size)
-        , m_data_ptr(data)
-        , m_size_remaining(size)
-    {
-    }
-
-    template<typename T>
-    bool read(T& value)
-    {
-        if (m_size_remaining < (int)sizeof(T))
-            return false;
-        value = *((const NetworkOrdered<T>*)m_data_ptr);
-        m_data_ptr += sizeof(T);
-        m_size_remaining -= sizeof(T);
-        return true;
-    }
-
-    bool read_bytes(u8* buffer, int count)
-    {
-        if (m_size_remaining < count)
-            return false;
-        memcpy(buffer, m_data_ptr, count);
-        m_data_ptr += count;
-        m_size_remaining -= count;
-        return true;
-    }
-
-    bool wrap_bytes(ByteBuffer& buffer, int count)
-    {
-        if (m_size_remaining < count)
-            return false;
-        buffer = ByteBuffer::wrap(m_data_ptr, count);
-        m_data_ptr += count;
-        m_size_remaining -= count;
-        return true;
-    }
-
-    bool at_end() const { return !m_size_remaining; }
-
-private:
-    const u8* m_original_data;
-    int m_original_size;
-    const u8* m_data_ptr;
-    int m_size_remaining;
+    RGBA32 palette_colors[256];
+
+    ChunkState chunk_state { ChunkState::Signature };
+    char chunk_type[5] { 0 };
+    u32 chunk_size { 0 };
+    u32 chunk_size_remaining { 0 };
+    // Partially received signature, chunk header, CRC or chunk data that we need in one piece.
+    Vector<u8> pending;
+
+    OwnPtr<Core::Inflater> inflater;
+    u8 zlib_header[2];
+    u8 zlib_header_size { 0 };
+    bool image_data_is_invalid { false };
+
+    const InterlacePass* passes { nullptr };
+    int pass_count { 0 };
+    int pass_index { -1 };
+    int pass_width { 0 };
+    int pass_height { 0 };
+    int pass_row { 0 };
+    // The filter type byte plus pass_width pixels. The previous row is needed to unfilter the current one.
+    ByteBuffer scanline_storage;
+    u8* scanline { nullptr };
+    u8* previous_scanline { nullptr };
+    size_t scanline_size { 0 };
+    size_t scanline_filled { 0 };
+    Vector<RGBA32> pass_pixels;
 };
 
 static RefPtr<Gfx::Bitmap> load_png_impl(const u8*, int);
-static bool process_chunk(Streamer&, PNGLoadingContext& context, bool decode_size_only);
+static bool decode_png_data(PNGLoadingContext&, const u8*, size_t);
 
 RefPtr<Gfx::Bitmap> load_png(const StringView& path)
 {
@@ -205,353 +188,247 @@ RefPtr<Gfx::Bitmap> load_png_from_memory(const u8* data, size_t length)
     return c;
 }
 
-union [[gnu::packed]] Pixel
-{
-    RGBA32 rgba { 0 };
-    u8 v[4];
-    struct {
-        u8 r;
-        u8 g;
-        u8 b;
-        u8 a;
-    };
-};
-static_assert(sizeof(Pixel) == 4);
-
-template<bool has_alpha, u8 filter_type>
-[[gnu::always_inline]] static inline void unfilter_impl(Gfx::Bitmap& bitmap, int y, const void* dummy_scanline_data)
+// Undoes the filter on one row of raw samples, in place. Filters work on bytes, with "the pixel to the left"
+// being bytes_per_pixel bytes back, so the inner loops get unrolled for each possible pixel size.
+template<size_t bytes_per_pixel>
+static void unfilter_scanline_impl(u8 filter, u8* row, const u8* previous_row, size_t size)
 {
-    auto* dummy_scanline = (const Pixel*)dummy_scanline_data;
-    if constexpr (filter_type == 0) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
-
-    if constexpr (filter_type == 1) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        swap(pixels[0].r, pixels[0].b);
-        for (int i = 1; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            auto& a = (const Pixel&)pixels[i - 1];
-            x.v[0] += a.v[0];
-            x.v[1] += a.v[1];
-            x.v[2] += a.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += a.v[3];
-        }
+    switch (filter) {
+    case 0:
         return;
-    }
-    if constexpr (filter_type == 2) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] += b.v[0];
-            x.v[1] += b.v[1];
-            x.v[2] += b.v[2];
-            if constexpr (has_alpha)
-                x.v[3] += b.v[3];
-        }
+    case 1:
+        for (size_t i = bytes_per_pixel; i < size; ++i)
+            row[i] += row[i - bytes_per_pixel];
         return;
-    }
-    if constexpr (filter_type == 3) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            if (i != 0)
-                a = pixels[i - 1];
-            const Pixel& b = pixels_y_minus_1[i];
-            x.v[0] = x.v[0] + ((a.v[0] + b.v[0]) / 2);
-            x.v[1] = x.v[1] + ((a.v[1] + b.v[1]) / 2);
-            x.v[2] = x.v[2] + ((a.v[2] + b.v[2]) / 2);
-            if constexpr (has_alpha)
-                x.v[3] = x.v[3] + ((a.v[3] + b.v[3]) / 2);
-        }
+    case 2:
+        for (size_t i = 0; i < size; ++i)
+            row[i] += previous_row[i];
+        return;
+    case 3:
+        for (size_t i = 0; i < bytes_per_pixel; ++i)
+            row[i] += previous_row[i] / 2;
+        for (size_t i = bytes_per_pixel; i < size; ++i)
+            row[i] += (row[i - bytes_per_pixel] + previous_row[i]) / 2;
         return;
+    case 4:
+        for (size_t i = 0; i < bytes_per_pixel; ++i)
+            row[i] += previous_row[i];
+        for (size_t i = bytes_per_pixel; i < size; ++i)
+            row[i] += paeth_predictor(row[i - bytes_per_pixel], previous_row[i], previous_row[i - bytes_per_pixel]);
+        return;
+    default:
+        ASSERT_NOT_REACHED();
     }
-    if constexpr (filter_type == 4) {
-        auto* pixels = (Pixel*)bitmap.scanline(y);
-        auto* pixels_y_minus_1 = y == 0 ? dummy_scanline : (Pixel*)bitmap.scanline(y - 1);
-        for (int i = 0; i < bitmap.width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-            Pixel a;
-            const Pixel& b = pixels_y_minus_1[i];
-            Pixel c;
-            if (i != 0) {
-                a = pixels[i - 1];
-                c = pixels_y_minus_1[i - 1];
-            }
-            x.v[0] += paeth_predictor(a.v[0], b.v[0], c.v[0]);
-            x.v[1] += paeth_predictor(a.v[1], b.v[1], c.v[1]);
-            x.v[2] += paeth_predictor(a.v[2], b.v[2], c.v[2]);
-            if constexpr (has_alpha)
-                x.v[3] += paeth_predictor(a.v[3], b.v[3], c.v[3]);
-        }
+}
+
+static void unfilter_scanline(u8 filter, u8* row, const u8* previous_row, size_t size, u8 bytes_per_pixel)
+{
+    switch (bytes_per_pixel) {
+    case 1:
+        return unfilter_scanline_impl<1>(filter, row, previous_row, size);
+    case 3:
+        return unfilter_scanline_impl<3>(filter, row, previous_row, size);
+    case 4:
+        return unfilter_scanline_impl<4>(filter, row, previous_row, size);
+    case 6:
+        return unfilter_scanline_impl<6>(filter, row, previous_row, size);
+    case 8:
+        return unfilter_scanline_impl<8>(filter, row, previous_row, size);
+    default:
+        ASSERT_NOT_REACHED();
     }
 }
 
-[[gnu::noinline]] static void unfilter(PNGLoadingContext& context)
+// Converts one unfiltered row of samples to pixels. 16-bit samples are stored big-endian, so their first byte is the one we keep.
+static void unpack_scanline(const PNGLoadingContext& context, const u8* row, RGBA32* pixels, int count)
 {
-    // First unpack the scanlines to RGBA:
     switch (context.color_type) {
     case 2:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = (Triplet*)context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r;
-                    pixel.g = triplets[i].g;
-                    pixel.b = triplets[i].b;
-                    pixel.a = 0xff;
-                }
-            }
-        } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = (Triplet16*)context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r & 0xFF;
-                    pixel.g = triplets[i].g & 0xFF;
-                    pixel.b = triplets[i].b & 0xFF;
-                    pixel.a = 0xff;
-                }
-            }
+            for (int i = 0; i < count; ++i, row += 3)
+                pixels[i] = 0xff000000 | (row[0] << 16) | (row[1] << 8) | row[2];
         } else {
-            ASSERT_NOT_REACHED();
+            for (int i = 0; i < count; ++i, row += 6)
+                pixels[i] = 0xff000000 | (row[0] << 16) | (row[2] << 8) | row[4];
         }
         break;
     case 6:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
-            }
-        } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* triplets = (Quad16*)context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = triplets[i].r & 0xFF;
-                    pixel.g = triplets[i].g & 0xFF;
-                    pixel.b = triplets[i].b & 0xFF;
-                    pixel.a = triplets[i].a & 0xFF;
-                }
-            }
+            for (int i = 0; i < count; ++i, row += 4)
+                pixels[i] = (row[3] << 24) | (row[0] << 16) | (row[1] << 8) | row[2];
         } else {
-            ASSERT_NOT_REACHED();
+            for (int i = 0; i < count; ++i, row += 8)
+                pixels[i] = (row[6] << 24) | (row[0] << 16) | (row[2] << 8) | row[4];
         }
         break;
     case 3:
-        for (int y = 0; y < context.height; ++y) {
-            auto* palette_index = (u8*)context.scanlines[y].data.data();
-            for (int i = 0; i < context.width; ++i) {
-                auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                auto& color = context.palette_data.at((int)palette_index[i]);
-                auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
-                    ? context.palette_transparency_data.data()[palette_index[i]]
-                    : 0xff;
-                pixel.r = color.r;
-                pixel.g = color.g;
-                pixel.b = color.b;
-                pixel.a = transparency;
-            }
-        }
+        for (int i = 0; i < count; ++i)
+            pixels[i] = context.palette_colors[row[i]];
         break;
     default:
         ASSERT_NOT_REACHED();
-        break;
-    }
-
-    auto dummy_scanline = ByteBuffer::create_zeroed(context.width * sizeof(RGBA32));
-
-    for (int y = 0; y < context.height; ++y) {
-        auto filter = context.scanlines[y].filter;
-        if (filter == 0) {
-            if (context.has_alpha())
-                unfilter_impl<true, 0>(*context.bitmap, y, dummy_scanline.data());
-            else
-                unfilter_impl<false, 0>(*context.bitmap, y, dummy_scanline.data());
-            continue;
-        }
-        if (filter == 1) {
-            if (context.has_alpha())
-                unfilter_impl<true, 1>(*context.bitmap, y, dummy_scanline.data());
-            else
-                unfilter_impl<false, 1>(*context.bitmap, y, dummy_scanline.data());
-            continue;
-        }
-        if (filter == 2) {
-            if (context.has_alpha())
-                unfilter_impl<true, 2>(*context.bitmap, y, dummy_scanline.data());
-            else
-                unfilter_impl<false, 2>(*context.bitmap, y, dummy_scanline.data());
-            continue;
-        }
-        if (filter == 3) {
-            if (context.has_alpha())
-                unfilter_impl<true, 3>(*context.bitmap, y, dummy_scanline.data());
-            else
-                unfilter_impl<false, 3>(*context.bitmap, y, dummy_scanline.data());
-            continue;
-        }
-        if (filter == 4) {
-            if (context.has_alpha())
-                unfilter_impl<true, 4>(*context.bitmap, y, dummy_scanline.data());
-            else
-                unfilter_impl<false, 4>(*context.bitmap, y, dummy_scanline.data());
-            continue;
-        }
     }
 }
 
-static bool decode_png_header(PNGLoadingContext& context)
+static void set_error(PNGLoadingContext& context)
 {
-    if (context.state >= PNGLoadingContext::HeaderDecoded)
-        return true;
-
-    if (memcmp(context.data, png_header, sizeof(png_header)) != 0) {
-        dbg() << "Invalid PNG header";
-        context.state = PNGLoadingContext::State::Error;
-        return false;
-    }
-
-    context.state = PNGLoadingContext::HeaderDecoded;
-    return true;
+    context.state = PNGLoadingContext::State::Error;
+    context.inflater = nullptr;
+    context.scanline_storage.clear();
+    context.pending.clear();
 }
 
-static bool decode_png_size(PNGLoadingContext& context)
+static bool start_next_pass(PNGLoadingContext& context)
 {
-    if (context.state >= PNGLoadingContext::SizeDecoded)
+    while (++context.pass_index < context.pass_count) {
+        auto& pass = context.passes[context.pass_index];
+        context.pass_width = context.width > pass.x ? (context.width - pass.x + pass.dx - 1) / pass.dx : 0;
+        context.pass_height = context.height > pass.y ? (context.height - pass.y + pass.dy - 1) / pass.dy : 0;
+        // Passes without any pixels in them are left out of the image data altogether.
+        if (!context.pass_width || !context.pass_height)
+            continue;
+        context.pass_row = 0;
+        context.scanline_size = 1 + (size_t)context.pass_width * context.bytes_per_pixel;
+        context.scanline_filled = 0;
+        memset(context.previous_scanline, 0, context.scanline_size);
         return true;
-
-    if (context.state < PNGLoadingContext::HeaderDecoded) {
-        if (!decode_png_header(context))
-            return false;
-    }
-
-    const u8* data_ptr = context.data + sizeof(png_header);
-    size_t data_remaining = context.data_size - sizeof(png_header);
-
-    Streamer streamer(data_ptr, data_remaining);
-    while (!streamer.at_end()) {
-        if (!process_chunk(streamer, context, true)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
-        if (context.width && context.height) {
-            context.state = PNGLoadingContext::State::SizeDecoded;
-            return true;
-        }
     }
-
+    context.state = PNGLoadingContext::State::BitmapDecoded;
+    context.scanline_storage.clear();
+    context.pass_pixels.clear();
     return false;
 }
 
-static bool decode_png_chunks(PNGLoadingContext& context)
+static void decode_scanline(PNGLoadingContext& context)
 {
-    if (context.state >= PNGLoadingContext::State::ChunksDecoded)
-        return true;
-
-    if (context.state < PNGLoadingContext::HeaderDecoded) {
-        if (!decode_png_header(context))
-            return false;
+    u8 filter = context.scanline[0];
+    if (filter > 4) {
+        dbg() << "PNGLoader: Invalid filter type " << (int)filter;
+        context.image_data_is_invalid = true;
+        return;
     }
-
-    const u8* data_ptr = context.data + sizeof(png_header);
-    int data_remaining = context.data_size - sizeof(png_header);
-
-    context.compressed_data.ensure_capacity(context.data_size);
-
-    Streamer streamer(data_ptr, data_remaining);
-    while (!streamer.at_end()) {
-        if (!process_chunk(streamer, context, false)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
+    unfilter_scanline(filter, context.scanline + 1, context.previous_scanline + 1, context.scanline_size - 1, context.bytes_per_pixel);
+
+    auto& pass = context.passes[context.pass_index];
+    int y = pass.y + context.pass_row * pass.dy;
+    auto* pixels = context.bitmap->scanline(y);
+    if (pass.dx == 1) {
+        unpack_scanline(context, context.scanline + 1, pixels, context.width);
+    } else {
+        unpack_scanline(context, context.scanline + 1, context.pass_pixels.data(), context.pass_width);
+        if (context.is_incremental) {
+            // Show the pass at full size until the later passes have arrived.
+            int block_height = min(pass.block_height, context.height - y);
+            for (int i = 0; i < context.pass_width; ++i) {
+                int x = pass.x + i * pass.dx;
+                int block_width = min(pass.block_width, context.width - x);
+                fast_u32_fill(pixels + x, context.pass_pixels[i], block_width);
+                for (int block_y = 1; block_y < block_height; ++block_y)
+                    memcpy(context.bitmap->scanline(y + block_y) + x, pixels + x, block_width * sizeof(RGBA32));
+            }
+        } else {
+            for (int i = 0; i < context.pass_width; ++i)
+                pixels[pass.x + i * pass.dx] = context.pass_pixels[i];
         }
     }
 
-    context.state = PNGLoadingContext::State::ChunksDecoded;
-    return true;
+    swap(context.scanline, context.previous_scanline);
+    context.scanline_filled = 0;
+    if (++context.pass_row == context.pass_height)
+        start_next_pass(context);
 }
 
-static bool decode_png_bitmap(PNGLoadingContext& context)
+// Receives inflated image data straight out of the inflater's window and turns every complete scanline into pixels.
+static void decode_scanline_bytes(PNGLoadingContext& context, const u8* data, size_t size)
 {
-    if (context.state < PNGLoadingContext::State::ChunksDecoded) {
-        if (!decode_png_chunks(context))
-            return false;
+    while (size && !context.image_data_is_invalid && context.state != PNGLoadingContext::State::BitmapDecoded) {
+        size_t chunk_size = min(context.scanline_size - context.scanline_filled, size);
+        memcpy(context.scanline + context.scanline_filled, data, chunk_size);
+        context.scanline_filled += chunk_size;
+        data += chunk_size;
+        size -= chunk_size;
+        if (context.scanline_filled == context.scanline_size)
+            decode_scanline(context);
     }
+}
 
-    if (context.state >= PNGLoadingContext::State::BitmapDecoded)
-        return true;
-
-    unsigned long srclen = context.compressed_data.size() - 6;
-    unsigned long destlen = context.decompression_buffer_size;
-    int ret = puff(context.decompression_buffer, &destlen, context.compressed_data.data() + 2, &srclen);
-    if (ret < 0) {
-        context.state = PNGLoadingContext::State::Error;
+static bool begin_image_data(PNGLoadingContext& context)
+{
+    if (context.state < PNGLoadingContext::State::SizeDecoded)
         return false;
-    }
-    context.compressed_data.clear();
-
-    context.scanlines.ensure_capacity(context.height);
-    Streamer streamer(context.decompression_buffer, context.decompression_buffer_size);
-    for (int y = 0; y < context.height; ++y) {
-        u8 filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
-        }
 
-        context.scanlines.append({ filter });
-        auto& scanline_buffer = context.scanlines.last().data;
-        if (!streamer.wrap_bytes(scanline_buffer, context.width * context.bytes_per_pixel)) {
-            context.state = PNGLoadingContext::State::Error;
-            return false;
+    for (size_t i = 0; i < 256; ++i) {
+        if (i >= context.palette_data.size()) {
+            context.palette_colors[i] = 0xff000000;
+            continue;
         }
+        auto& color = context.palette_data[i];
+        u8 alpha = i < context.palette_transparency_data.size() ? context.palette_transparency_data[i] : 0xff;
+        context.palette_colors[i] = (alpha << 24) | (color.r << 16) | (color.g << 8) | color.b;
     }
 
-    context.bitmap = Bitmap::create_purgeable(context.has_alpha() ? BitmapFormat::RGBA32 : BitmapFormat::RGB32, { context.width, context.height });
+    auto format = context.is_incremental || context.has_alpha() ? BitmapFormat::RGBA32 : BitmapFormat::RGB32;
+    context.bitmap = Bitmap::create_purgeable(format, { context.width, context.height });
 
-    unfilter(context);
+    if (context.interlace_method == 1) {
+        context.passes = adam7_passes;
+        context.pass_count = sizeof(adam7_passes) / sizeof(adam7_passes[0]);
+        context.pass_pixels.resize(context.width);
+    } else {
+        context.passes = non_interlaced_passes;
+        context.pass_count = 1;
+    }
 
-    munmap(context.decompression_buffer, context.decompression_buffer_size);
-    context.decompression_buffer = nullptr;
-    context.decompression_buffer_size = 0;
+    size_t max_scanline_size = 1 + (size_t)context.width * context.bytes_per_pixel;
+    context.scanline_storage = ByteBuffer::create_uninitialized(max_scanline_size * 2);
+    context.scanline = context.scanline_storage.data();
+    context.previous_scanline = context.scanline_storage.data() + max_scanline_size;
+    start_next_pass(context);
 
-    context.state = PNGLoadingContext::State::BitmapDecoded;
+    context.inflater = make<Core::Inflater>();
+    context.inflater->on_output = [&context](const u8* data, size_t size) {
+        decode_scanline_bytes(context, data, size);
+    };
     return true;
 }
 
-static RefPtr<Gfx::Bitmap> load_png_impl(const u8* data, int data_size)
+static bool decode_image_data(PNGLoadingContext& context, const u8* data, size_t size)
 {
-    PNGLoadingContext context;
-    context.data = data;
-    context.data_size = data_size;
-
-    if (!decode_png_chunks(context))
-        return nullptr;
+    if (!context.inflater && !begin_image_data(context))
+        return false;
 
-    if (!decode_png_bitmap(context))
-        return nullptr;
+    while (context.zlib_header_size < 2 && size) {
+        context.zlib_header[context.zlib_header_size++] = *data++;
+        --size;
+        if (context.zlib_header_size == 2) {
+            u8 cmf = context.zlib_header[0];
+            u8 flg = context.zlib_header[1];
+            // Deflate, a valid header check, and no preset dictionary.
+            if ((cmf & 0xf) != 8 || ((cmf << 8) | flg) % 31 || (flg & 0x20)) {
+                dbg() << "PNGLoader: Invalid zlib header";
+                return false;
+            }
+        }
+    }
+    if (!size)
+        return true;
 
-    return context.bitmap;
+    // Anything after the end of the deflate stream (like the Adler-32 checksum) is ignored by the inflater.
+    auto status = context.inflater->write(data, size);
+    if (status == Core::Inflater::Status::Error || context.image_data_is_invalid)
+        return false;
+    return true;
 }
 
-static bool process_IHDR(const ByteBuffer& data, PNGLoadingContext& context, bool decode_size_only = false)
+static bool process_IHDR(const Vector<u8>& data, PNGLoadingContext& context)
 {
-    if (data.size() < (int)sizeof(PNG_IHDR))
+    if (data.size() < sizeof(PNG_IHDR))
         return false;
     auto& ihdr = *(const PNG_IHDR*)data.data();
+    if (ihdr.width == 0 || ihdr.width > max_png_dimension || ihdr.height == 0 || ihdr.height > max_png_dimension) {
+        dbgprintf("PNGLoader::process_IHDR: Unsupported size %ux%u.\n", (u32)ihdr.width, (u32)ihdr.height);
+        return false;
+    }
     context.width = ihdr.width;
     context.height = ihdr.height;
     context.bit_depth = ihdr.bit_depth;
@@ -568,9 +445,8 @@ static bool process_IHDR(const ByteBuffer& data, PNGLoadingContext& context, boo
     printf(" Interlace type: %d\n", context.interlace_method);
 #endif
 
-    // FIXME: Implement Adam7 deinterlacing
-    if (context.interlace_method != 0) {
-        dbgprintf("PNGLoader::process_IHDR: Interlaced PNGs not currently supported.\n");
+    if (context.interlace_method > 1) {
+        dbgprintf("PNGLoader::process_IHDR: Unknown interlace method %d.\n", context.interlace_method);
         return false;
     }
 
@@ -581,6 +457,8 @@ static bool process_IHDR(const ByteBuffer& data, PNGLoadingContext& context, boo
         dbgprintf("PNGLoader::process_IHDR: Unsupported grayscale format.\n");
         return false;
     case 2:
+        if (ihdr.bit_depth != 8 && ihdr.bit_depth != 16)
+            return false;
         context.bytes_per_pixel = 3 * (ihdr.bit_depth / 8);
         break;
     case 3: // Each pixel is a palette index; a PLTE chunk must appear.
@@ -592,32 +470,26 @@ static bool process_IHDR(const ByteBuffer& data, PNGLoadingContext& context, boo
         context.bytes_per_pixel = 1;
         break;
     case 6:
+        if (ihdr.bit_depth != 8 && ihdr.bit_depth != 16)
+            return false;
         context.bytes_per_pixel = 4 * (ihdr.bit_depth / 8);
         break;
     default:
-        ASSERT_NOT_REACHED();
-    }
-
-    if (!decode_size_only) {
-        context.decompression_buffer_size = (context.width * context.height * context.bytes_per_pixel + context.height);
-        context.decompression_buffer = (u8*)mmap_with_name(nullptr, context.decompression_buffer_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0, "PNG decompression buffer");
+        dbgprintf("PNGLoader::process_IHDR: Invalid color type %d.\n", context.color_type);
+        return false;
     }
-    return true;
-}
 
-static bool process_IDAT(const ByteBuffer& data, PNGLoadingContext& context)
-{
-    context.compressed_data.append(data.data(), data.size());
+    context.state = PNGLoadingContext::State::SizeDecoded;
     return true;
 }
 
-static bool process_PLTE(const ByteBuffer& data, PNGLoadingContext& context)
+static bool process_PLTE(const Vector<u8>& data, PNGLoadingContext& context)
 {
     context.palette_data.append((const PaletteEntry*)data.data(), data.size() / 3);
     return true;
 }
 
-static bool process_tRNS(const ByteBuffer& data, PNGLoadingContext& context)
+static bool process_tRNS(const Vector<u8>& data, PNGLoadingContext& context)
 {
     switch (context.color_type) {
     case 3:
@@ -627,44 +499,169 @@ static bool process_tRNS(const ByteBuffer& data, PNGLoadingContext& context)
     return true;
 }
 
-static bool process_chunk(Streamer& streamer, PNGLoadingContext& context, bool decode_size_only)
+static bool chunk_is(const PNGLoadingContext& context, const char* type)
+{
+    return !strcmp(context.chunk_type, type);
+}
+
+// Whether we need the chunk's data in one piece. Image data is decoded as it arrives, and everything else is skipped.
+static bool chunk_needs_buffering(const PNGLoadingContext& context)
 {
-    u32 chunk_size;
-    if (!streamer.read(chunk_size)) {
-        printf("Bail at chunk_size\n");
+    return chunk_is(context, "IHDR") || chunk_is(context, "PLTE") || chunk_is(context, "tRNS");
+}
+
+static bool process_chunk(PNGLoadingContext& context)
+{
+#ifdef PNG_DEBUG
+    printf("Chunk type: '%s', size: %u\n", context.chunk_type, context.chunk_size);
+#endif
+    if (chunk_is(context, "IHDR"))
+        return process_IHDR(context.pending, context);
+    if (chunk_is(context, "PLTE"))
+        return process_PLTE(context.pending, context);
+    if (chunk_is(context, "tRNS"))
+        return process_tRNS(context.pending, context);
+    return true;
+}
+
+// Moves bytes from the input into context.pending until it holds `wanted` of them. Returns false if the input ran out first.
+static bool buffer_bytes(PNGLoadingContext& context, size_t wanted, const u8*& data, size_t& size)
+{
+    size_t count = min(wanted - context.pending.size(), size);
+    context.pending.append(data, count);
+    data += count;
+    size -= count;
+    return context.pending.size() == wanted;
+}
+
+static bool decode_png_data(PNGLoadingContext& context, const u8* data, size_t size)
+{
+    if (context.state == PNGLoadingContext::State::Error)
         return false;
+
+    for (;;) {
+        switch (context.chunk_state) {
+        case PNGLoadingContext::ChunkState::Signature:
+            if (!buffer_bytes(context, sizeof(png_header), data, size))
+                return true;
+            if (memcmp(context.pending.data(), png_header, sizeof(png_header)) != 0) {
+                dbg() << "Invalid PNG header";
+                set_error(context);
+                return false;
+            }
+            context.pending.clear();
+            context.state = PNGLoadingContext::State::HeaderDecoded;
+            context.chunk_state = PNGLoadingContext::ChunkState::ChunkHeader;
+            break;
+        case PNGLoadingContext::ChunkState::ChunkHeader:
+            if (!buffer_bytes(context, 8, data, size))
+                return true;
+            context.chunk_size = *(const NetworkOrdered<u32>*)context.pending.data();
+            memcpy(context.chunk_type, context.pending.data() + 4, 4);
+            context.pending.clear();
+            context.chunk_size_remaining = context.chunk_size;
+            // The size must fit in 31 bits, and IHDR must come first.
+            if (context.chunk_size > 0x7fffffff || (chunk_needs_buffering(context) && context.chunk_size > max_buffered_chunk_size)
+                || (context.state < PNGLoadingContext::State::SizeDecoded && !chunk_is(context, "IHDR"))) {
+                set_error(context);
+                return false;
+            }
+            context.chunk_state = PNGLoadingContext::ChunkState::ChunkData;
+            break;
+        case PNGLoadingContext::ChunkState::ChunkData:
+            if (chunk_needs_buffering(context)) {
+                if (!buffer_bytes(context, context.chunk_size, data, size))
+                    return true;
+                bool success = process_chunk(context);
+                context.pending.clear();
+                if (!success) {
+                    set_error(context);
+                    return false;
+                }
+            } else if (context.chunk_size_remaining) {
+                if (!size)
+                    return true;
+                size_t count = min((size_t)context.chunk_size_remaining, size);
+                if (chunk_is(context, "IDAT") && !decode_image_data(context, data, count)) {
+                    set_error(context);
+                    return false;
+                }
+                data += count;
+                size -= count;
+                context.chunk_size_remaining -= count;
+                if (context.chunk_size_remaining)
+                    return true;
+            }
+            context.chunk_state = PNGLoadingContext::ChunkState::ChunkCRC;
+            break;
+        case PNGLoadingContext::ChunkState::ChunkCRC:
+            if (!buffer_bytes(context, 4, data, size))
+                return true;
+            context.pending.clear();
+            context.chunk_state = chunk_is(context, "IEND") ? PNGLoadingContext::ChunkState::End : PNGLoadingContext::ChunkState::ChunkHeader;
+            break;
+        case PNGLoadingContext::ChunkState::End:
+            return true;
+        }
     }
-    u8 chunk_type[5];
-    chunk_type[4] = '\0';
-    if (!streamer.read_bytes(chunk_type, 4)) {
-        printf("Bail at chunk_type\n");
+}
+
+// Decodes the in-memory file up to the given offset.
+static bool decode_png_data_from_memory(PNGLoadingContext& context, size_t end)
+{
+    end = min(end, context.data_size);
+    if (context.data_fed >= end)
+        return context.state != PNGLoadingContext::State::Error;
+    size_t start = context.data_fed;
+    context.data_fed = end;
+    return decode_png_data(context, context.data + start, end - start);
+}
+
+static bool decode_png_size(PNGLoadingContext& context)
+{
+    if (context.state >= PNGLoadingContext::SizeDecoded)
+        return true;
+
+    // IHDR is always the first chunk, so there's no need to look any further than that.
+    if (!decode_png_data_from_memory(context, sizeof(png_header) + 8 + sizeof(PNG_IHDR)))
         return false;
-    }
-    ByteBuffer chunk_data;
-    if (!streamer.wrap_bytes(chunk_data, chunk_size)) {
-        printf("Bail at chunk_data\n");
+    return context.state >= PNGLoadingContext::SizeDecoded;
+}
+
+static bool decode_png_bitmap(PNGLoadingContext& context)
+{
+    if (context.state >= PNGLoadingContext::State::BitmapDecoded)
+        return true;
+
+    if (!decode_png_data_from_memory(context, context.data_size))
         return false;
-    }
-    u32 chunk_crc;
-    if (!streamer.read(chunk_crc)) {
-        printf("Bail at chunk_crc\n");
+
+    if (context.state != PNGLoadingContext::State::BitmapDecoded) {
+        dbg() << "PNGLoader: Image data ended early";
+        set_error(context);
         return false;
     }
-#ifdef PNG_DEBUG
-    printf("Chunk type: '%s', size: %u, crc: %x\n", chunk_type, chunk_size, chunk_crc);
-#endif
-
-    if (!strcmp((const char*)chunk_type, "IHDR"))
-        return process_IHDR(chunk_data, context, decode_size_only);
-    if (!strcmp((const char*)chunk_type, "IDAT"))
-        return process_IDAT(chunk_data, context);
-    if (!strcmp((const char*)chunk_type, "PLTE"))
-        return process_PLTE(chunk_data, context);
-    if (!strcmp((const char*)chunk_type, "tRNS"))
-        return process_tRNS(chunk_data, context);
     return true;
 }
 
+static RefPtr<Gfx::Bitmap> load_png_impl(const u8* data, int data_size)
+{
+    PNGLoadingContext context;
+    context.data = data;
+    context.data_size = data_size;
+
+    if (!decode_png_bitmap(context))
+        return nullptr;
+
+    return context.bitmap;
+}
+
+PNGImageDecoderPlugin::PNGImageDecoderPlugin()
+{
+    m_context = make<PNGLoadingContext>();
+    m_context->is_incremental = true;
+}
+
 PNGImageDecoderPlugin::PNGImageDecoderPlugin(const u8* data, size_t size)
 {
     m_context = make<PNGLoadingContext>();
@@ -682,6 +679,8 @@ Size PNGImageDecoderPlugin::size()
         return {};
 
     if (m_context->state < PNGLoadingContext::State::SizeDecoded) {
+        if (m_context->is_incremental)
+            return {};
         bool success = decode_png_size(*m_context);
         if (!success)
             return {};
@@ -695,6 +694,10 @@ RefPtr<Gfx::Bitmap> PNGImageDecoderPlugin::bitmap()
     if (m_context->state == PNGLoadingContext::State::Error)
         return nullptr;
 
+    // Whatever has arrived so far.
+    if (m_context->is_incremental)
+        return m_context->bitmap;
+
     if (m_context->state < PNGLoadingContext::State::BitmapDecoded) {
         // NOTE: This forces the chunk decoding to happen.
         bool success = decode_png_bitmap(*m_context);
@@ -706,9 +709,22 @@ RefPtr<Gfx::Bitmap> PNGImageDecoderPlugin::bitmap()
     return m_context->bitmap;
 }
 
+bool PNGImageDecoderPlugin::append_data(const u8* data, size_t size)
+{
+    if (!m_context->is_incremental)
+        return false;
+    return decode_png_data(*m_context, data, size);
+}
+
+bool PNGImageDecoderPlugin::is_complete()
+{
+    return m_context->state == PNGLoadingContext::State::BitmapDecoded;
+}
+
 void PNGImageDecoderPlugin::set_volatile()
 {
-    if (m_context->bitmap)
+    // A bitmap that is still being decoded into can't be thrown away.
+    if (m_context->bitmap && m_context->state == PNGLoadingContext::State::BitmapDecoded)
         m_context->bitmap->set_volatile();
 }
 
@@ -716,6 +732,8 @@ bool PNGImageDecoderPlugin::set_nonvolatile()
 {
     if (!m_context->bitmap)
         return false;
+    if (m_context->state != PNGLoadingContext::State::BitmapDecoded)
+        return m_context->state != PNGLoadingContext::State::Error;
     return m_context->bitmap->set_nonvolatile();
 }
 
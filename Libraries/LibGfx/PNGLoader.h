@@ -39,6 +39,7 @@ struct PNGLoadingContext;
 class PNGImageDecoderPlugin final : public ImageDecoderPlugin {
 public:
     virtual ~PNGImageDecoderPlugin() override;
+    PNGImageDecoderPlugin();
     PNGImageDecoderPlugin(const u8*, size_t);
 
     virtual Size size() override;
@@ -46,6 +47,9 @@ public:
     virtual void set_volatile() override;
     [[nodiscard]] virtual bool set_nonvolatile() override;
 
+    virtual bool append_data(const u8*, size_t) override;
+    virtual bool is_complete() override;
+
 private:
     OwnPtr<PNGLoadingContext> m_context;
 };
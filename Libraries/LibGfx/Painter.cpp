@@ -28,12 +28,14 @@
 #include "Bitmap.h"
 #include "Emoji.h"
 #include "Font.h"
+#include "GlyphAtlas.h"
 #include <AK/Assertions.h>
 #include <AK/Function.h>
 #include <AK/Memory.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf8View.h>
+#include <LibGfx/AlphaBlending.h>
 #include <LibGfx/CharacterBitmap.h>
 #include <math.h>
 #include <stdio.h>
@@ -53,18 +55,6 @@
 
 namespace Gfx {
 
-template<BitmapFormat format = BitmapFormat::Invalid>
-static ALWAYS_INLINE Color get_pixel(const Gfx::Bitmap& bitmap, int x, int y)
-{
-    if constexpr (format == BitmapFormat::Indexed8)
-        return bitmap.palette_color(bitmap.bits(y)[x]);
-    if constexpr (format == BitmapFormat::RGB32)
-        return Color::from_rgb(bitmap.scanline(y)[x]);
-    if constexpr (format == BitmapFormat::RGBA32)
-        return Color::from_rgba(bitmap.scanline(y)[x]);
-    return bitmap.get_pixel(x, y);
-}
-
 Painter::Painter(Gfx::Bitmap& bitmap)
     : m_target(bitmap)
 {
@@ -136,25 +126,28 @@ void Painter::fill_rect(const Rect& a_rect, Color color)
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
     for (int i = rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < rect.width(); ++j)
-            dst[j] = Color::from_rgba(dst[j]).blend(color).value();
+        blend_fill_scanline(dst, rect.width(), color);
         dst += dst_skip;
     }
 }
 
 void Painter::fill_rect_with_checkerboard(const Rect& a_rect, const Size& cell_size, Color color_dark, Color color_light)
 {
-    auto rect = a_rect.translated(translation()).intersected(clip_rect());
+    auto translated_rect = a_rect.translated(translation());
+    auto rect = translated_rect.intersected(clip_rect());
     if (rect.is_empty())
         return;
 
     RGBA32* dst = m_target->scanline(rect.top()) + rect.left();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
+    // Cells are counted from the rect's corner, not the clip's, so the pattern doesn't shift with the clip.
+    int first_row = rect.top() - translated_rect.top();
+    int first_column = rect.left() - translated_rect.left();
 
     for (int i = 0; i < rect.height(); ++i) {
         for (int j = 0; j < rect.width(); ++j) {
-            int cell_row = i / cell_size.height();
-            int cell_col = j / cell_size.width();
+            int cell_row = (first_row + i) / cell_size.height();
+            int cell_col = (first_column + j) / cell_size.width();
             dst[j] = ((cell_row % 2) ^ (cell_col % 2)) ? color_light.value() : color_dark.value();
         }
         dst += dst_skip;
@@ -176,6 +169,8 @@ void Painter::fill_rect_with_gradient(Orientation orientation, const Rect& a_rec
     RGBA32* dst = m_target->scanline(clipped_rect.top()) + clipped_rect.left();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    // Colors are computed from the distance to the rect's edge rather than accumulated across the clipped part,
+    // so the same pixel gets the same color however the rect is clipped.
     float increment = (1.0 / ((rect.primary_size_for_orientation(orientation)) / 255.0));
 
     int r2 = gradient_start.red();
@@ -187,20 +182,19 @@ void Painter::fill_rect_with_gradient(Orientation orientation, const Rect& a_rec
 
     if (orientation == Orientation::Horizontal) {
         for (int i = clipped_rect.height() - 1; i >= 0; --i) {
-            float c = offset * increment;
             for (int j = 0; j < clipped_rect.width(); ++j) {
+                float c = (offset + j) * increment;
                 dst[j] = Color(
                     r1 / 255.0 * c + r2 / 255.0 * (255 - c),
                     g1 / 255.0 * c + g2 / 255.0 * (255 - c),
                     b1 / 255.0 * c + b2 / 255.0 * (255 - c))
                              .value();
-                c += increment;
             }
             dst += dst_skip;
         }
     } else {
-        float c = offset * increment;
-        for (int i = clipped_rect.height() - 1; i >= 0; --i) {
+        for (int i = 0; i < clipped_rect.height(); ++i) {
+            float c = (offset + i) * increment;
             Color color(
                 r1 / 255.0 * c + r2 / 255.0 * (255 - c),
                 g1 / 255.0 * c + g2 / 255.0 * (255 - c),
@@ -208,7 +202,6 @@ void Painter::fill_rect_with_gradient(Orientation orientation, const Rect& a_rec
             for (int j = 0; j < clipped_rect.width(); ++j) {
                 dst[j] = color.value();
             }
-            c += increment;
             dst += dst_skip;
         }
     }
@@ -247,15 +240,16 @@ void Painter::draw_rect(const Rect& a_rect, Color color, bool rough)
     int min_y = clipped_rect.top();
     int max_y = clipped_rect.bottom();
 
+    // Rough rects leave out the corner pixels.
+    int start_x = rough ? max(rect.left() + 1, clipped_rect.left()) : clipped_rect.left();
+    int end_x = rough ? min(rect.right() - 1, clipped_rect.right()) : clipped_rect.right();
+    int width = max(end_x - start_x + 1, 0);
+
     if (rect.top() >= clipped_rect.top() && rect.top() <= clipped_rect.bottom()) {
-        int start_x = rough ? max(rect.x() + 1, clipped_rect.x()) : clipped_rect.x();
-        int width = rough ? min(rect.width() - 2, clipped_rect.width()) : clipped_rect.width();
         fast_u32_fill(m_target->scanline(rect.top()) + start_x, color.value(), width);
         ++min_y;
     }
     if (rect.bottom() >= clipped_rect.top() && rect.bottom() <= clipped_rect.bottom()) {
-        int start_x = rough ? max(rect.x() + 1, clipped_rect.x()) : clipped_rect.x();
-        int width = rough ? min(rect.width() - 2, clipped_rect.width()) : clipped_rect.width();
         fast_u32_fill(m_target->scanline(rect.bottom()) + start_x, color.value(), width);
         --max_y;
     }
@@ -341,22 +335,33 @@ void Painter::blit_scaled(const Rect& dst_rect_raw, const Gfx::Bitmap& source, c
     RGBA32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
     const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
 
+    // Step through the source in 16.16 fixed point, resolving the columns once for all rows.
+    i64 column_step = hscale * 65536;
+    i64 row_step = vscale * 65536;
     int x_start = first_column + src_rect.left();
-    for (int row = first_row; row <= last_row; ++row) {
-        int sr = (row + src_rect.top()) * vscale;
-        if (sr >= source.size().height() || sr < 0) {
-            dst += dst_skip;
+    int first_valid_column = clipped_rect.width();
+    int last_valid_column = -1;
+    Vector<int, 256> columns;
+    columns.resize(clipped_rect.width());
+    for (int i = 0; i < clipped_rect.width(); ++i) {
+        i64 sx = ((i64)(x_start + i) * column_step) >> 16;
+        if (sx < 0 || sx >= source.size().width())
+            continue;
+        columns[i] = sx;
+        first_valid_column = min(first_valid_column, i);
+        last_valid_column = i;
+    }
+    if (last_valid_column < 0)
+        return;
+
+    for (int row = first_row; row <= last_row; ++row, dst += dst_skip) {
+        i64 sr = ((i64)(row + src_rect.top()) * row_step) >> 16;
+        if (sr >= source.size().height() || sr < 0)
             continue;
-        }
         const RGBA32* sl = source.scanline(sr);
-        for (int x = x_start; x < clipped_rect.width() + x_start; ++x) {
-            int sx = x * hscale;
-            if (sx < source.size().width() && sx >= 0)
-                dst[x - x_start] = sl[sx];
-        }
-        dst += dst_skip;
+        for (int i = first_valid_column; i <= last_valid_column; ++i)
+            dst[i] = sl[columns[i]];
     }
-    return;
 }
 
 void Painter::blit_with_opacity(const Point& position, const Gfx::Bitmap& source, const Rect& src_rect, float opacity)
@@ -386,12 +391,7 @@ void Painter::blit_with_opacity(const Point& position, const Gfx::Bitmap& source
     const unsigned src_skip = source.pitch() / sizeof(RGBA32);
 
     for (int row = first_row; row <= last_row; ++row) {
-        for (int x = 0; x <= (last_column - first_column); ++x) {
-            Color src_color_with_alpha = Color::from_rgb(src[x]);
-            src_color_with_alpha.set_alpha(alpha);
-            Color dst_color = Color::from_rgb(dst[x]);
-            dst[x] = dst_color.blend(src_color_with_alpha).value();
-        }
+        blend_scanline_with_opacity(dst, src, last_column - first_column + 1, alpha);
         dst += dst_skip;
         src += src_skip;
     }
@@ -525,15 +525,7 @@ void Painter::blit_with_alpha(const Point& position, const Gfx::Bitmap& source,
     const size_t src_skip = source.pitch() / sizeof(RGBA32);
 
     for (int row = first_row; row <= last_row; ++row) {
-        for (int x = 0; x <= (last_column - first_column); ++x) {
-            u8 alpha = Color::from_rgba(src[x]).alpha();
-            if (alpha == 0xff)
-                dst[x] = src[x];
-            else if (!alpha)
-                continue;
-            else
-                dst[x] = Color::from_rgba(dst[x]).blend(Color::from_rgba(src[x])).value();
-        }
+        blend_scanline(dst, src, last_column - first_column + 1);
         dst += dst_skip;
         src += src_skip;
     }
@@ -583,58 +575,151 @@ void Painter::blit(const Point& position, const Gfx::Bitmap& source, const Rect&
     ASSERT_NOT_REACHED();
 }
 
-template<bool has_alpha_channel, typename GetPixel>
-ALWAYS_INLINE static void do_draw_integer_scaled_bitmap(Gfx::Bitmap& target, const Rect& dst_rect, const Gfx::Bitmap& source, int hfactor, int vfactor, GetPixel get_pixel)
-{
-    for (int y = source.rect().top(); y <= source.rect().bottom(); ++y) {
-        int dst_y = dst_rect.y() + y * vfactor;
-        for (int x = source.rect().left(); x <= source.rect().right(); ++x) {
-            auto src_pixel = get_pixel(source, x, y);
-            for (int yo = 0; yo < vfactor; ++yo) {
-                auto* scanline = (Color*)target.scanline(dst_y + yo);
-                int dst_x = dst_rect.x() + x * hfactor;
-                for (int xo = 0; xo < hfactor; ++xo) {
-                    if constexpr (has_alpha_channel)
-                        scanline[dst_x + xo] = scanline[dst_x + xo].blend(src_pixel);
-                    else
-                        scanline[dst_x + xo] = src_pixel;
-                }
-            }
-        }
-    }
+// Source positions for scaled drawing are stepped in 16.16 fixed point and sampled at pixel centers.
+// The tables are only built for the part of the destination that survives clipping.
+static void compute_nearest_samples(Vector<int, 256>& samples, int first, int count, int src_size, int dst_size)
+{
+    u32 step = ((u32)src_size << 16) / dst_size;
+    u32 position = first * step + step / 2;
+    samples.resize(count);
+    for (int i = 0; i < count; ++i, position += step)
+        samples[i] = min((int)(position >> 16), src_size - 1);
 }
 
-template<bool has_alpha_channel, typename GetPixel>
-ALWAYS_INLINE static void do_draw_scaled_bitmap(Gfx::Bitmap& target, const Rect& dst_rect, const Rect& clipped_rect, const Gfx::Bitmap& source, const Rect& src_rect, int hscale, int vscale, GetPixel get_pixel)
+struct BilinearSample {
+    int index;
+    int next;
+    u32 weight;
+};
+
+static void compute_bilinear_samples(Vector<BilinearSample, 256>& samples, int first, int count, int src_size, int dst_size)
 {
-    if (dst_rect == clipped_rect && !(dst_rect.width() % src_rect.width()) && !(dst_rect.height() % src_rect.height())) {
-        int hfactor = dst_rect.width() / src_rect.width();
-        int vfactor = dst_rect.height() / src_rect.height();
-        if (hfactor == 2 && vfactor == 2)
-            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, source, 2, 2, get_pixel);
-        if (hfactor == 3 && vfactor == 3)
-            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, source, 3, 3, get_pixel);
-        if (hfactor == 4 && vfactor == 4)
-            return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, source, 4, 4, get_pixel);
-        return do_draw_integer_scaled_bitmap<has_alpha_channel>(target, dst_rect, source, hfactor, vfactor, get_pixel);
+    u32 step = ((u32)src_size << 16) / dst_size;
+    // Pixel centers sit half a pixel in, so the first few destination pixels sample left of the first source pixel.
+    i64 position = (i64)first * step + step / 2 - 0x8000;
+    samples.resize(count);
+    for (int i = 0; i < count; ++i, position += step) {
+        auto clamped_position = (u32)max<i64>(position, 0);
+        int index = min((int)(clamped_position >> 16), src_size - 1);
+        bool at_edge = index == src_size - 1;
+        samples[i] = { index, at_edge ? 0 : 1, at_edge ? 0 : (clamped_position >> 8) & 0xff };
     }
+}
 
-    for (int y = clipped_rect.top(); y <= clipped_rect.bottom(); ++y) {
-        auto* scanline = (Color*)target.scanline(y);
-        for (int x = clipped_rect.left(); x <= clipped_rect.right(); ++x) {
-            auto scaled_x = ((x - dst_rect.x()) * hscale) >> 16;
-            auto scaled_y = ((y - dst_rect.y()) * vscale) >> 16;
-            auto src_pixel = get_pixel(source, scaled_x, scaled_y);
+// Returns row `y` of `src_rect` as 32-bit pixels, converting it into `buffer` for other formats.
+static const RGBA32* scaled_source_row(const Gfx::Bitmap& source, const Rect& src_rect, int y, Vector<RGBA32, 256>& buffer)
+{
+    int source_y = src_rect.top() + y;
+    if (source.format() == BitmapFormat::RGB32 || source.format() == BitmapFormat::RGBA32)
+        return source.scanline(source_y) + src_rect.left();
+    buffer.resize(src_rect.width());
+    for (int x = 0; x < src_rect.width(); ++x)
+        buffer[x] = source.get_pixel(src_rect.left() + x, source_y).value();
+    return buffer.data();
+}
+
+static void draw_nearest_scaled_bitmap(Gfx::Bitmap& target, const Rect& dst_rect, const Rect& clipped_rect, const Gfx::Bitmap& source, const Rect& src_rect)
+{
+    Vector<int, 256> columns;
+    Vector<int, 256> rows;
+    compute_nearest_samples(columns, clipped_rect.left() - dst_rect.left(), clipped_rect.width(), src_rect.width(), dst_rect.width());
+    compute_nearest_samples(rows, clipped_rect.top() - dst_rect.top(), clipped_rect.height(), src_rect.height(), dst_rect.height());
+
+    bool has_alpha_channel = source.has_alpha_channel();
+    RGBA32 opaque_bits = source.format() == BitmapFormat::RGB32 ? 0xff000000 : 0;
+    size_t width = clipped_rect.width();
+    Vector<RGBA32, 256> converted_row;
+    Vector<RGBA32, 256> scaled_row;
+    scaled_row.resize(width);
+
+    const RGBA32* previous_dst = nullptr;
+    for (int i = 0; i < clipped_rect.height(); ++i) {
+        RGBA32* dst = target.scanline(clipped_rect.top() + i) + clipped_rect.left();
+        bool same_row_as_before = i && rows[i] == rows[i - 1];
+        if (!has_alpha_channel) {
+            // When scaling up, most rows are copies of the one above.
+            if (same_row_as_before) {
+                fast_u32_copy(dst, previous_dst, width);
+            } else {
+                const RGBA32* src = scaled_source_row(source, src_rect, rows[i], converted_row);
+                for (size_t x = 0; x < width; ++x)
+                    dst[x] = src[columns[x]] | opaque_bits;
+            }
+            previous_dst = dst;
+            continue;
+        }
+        if (!same_row_as_before) {
+            const RGBA32* src = scaled_source_row(source, src_rect, rows[i], converted_row);
+            for (size_t x = 0; x < width; ++x)
+                scaled_row[x] = src[columns[x]];
+        }
+        blend_scanline(dst, scaled_row.data(), width);
+    }
+}
 
-            if constexpr (has_alpha_channel) {
-                scanline[x] = scanline[x].blend(src_pixel);
-            } else
-                scanline[x] = src_pixel;
+static void draw_bilinear_scaled_bitmap(Gfx::Bitmap& target, const Rect& dst_rect, const Rect& clipped_rect, const Gfx::Bitmap& source, const Rect& src_rect)
+{
+    Vector<BilinearSample, 256> columns;
+    Vector<BilinearSample, 256> rows;
+    compute_bilinear_samples(columns, clipped_rect.left() - dst_rect.left(), clipped_rect.width(), src_rect.width(), dst_rect.width());
+    compute_bilinear_samples(rows, clipped_rect.top() - dst_rect.top(), clipped_rect.height(), src_rect.height(), dst_rect.height());
+
+    bool has_alpha_channel = source.has_alpha_channel();
+    // Premultiplied rows can go straight onto an opaque target. Anything else gets them back as straight alpha.
+    bool target_is_opaque = !target.has_alpha_channel();
+    RGBA32 opaque_bits = source.format() == BitmapFormat::RGB32 ? 0xff000000 : 0;
+    size_t width = clipped_rect.width();
+    // The vertical pass only has to cover the source columns this part of the destination samples from.
+    int first_column = columns.first().index;
+    int column_count = columns.last().index + columns.last().next - first_column + 1;
+
+    Vector<RGBA32, 256> top_buffer;
+    Vector<RGBA32, 256> bottom_buffer;
+    Vector<RGBA32, 256> vertical_row;
+    Vector<RGBA32, 256> scaled_row;
+    vertical_row.resize(src_rect.width());
+    scaled_row.resize(width);
+
+    for (int i = 0; i < clipped_rect.height(); ++i) {
+        RGBA32* dst = target.scanline(clipped_rect.top() + i) + clipped_rect.left();
+        auto& row = rows[i];
+        bool same_row_as_before = i && row.index == rows[i - 1].index && row.weight == rows[i - 1].weight;
+        if (!same_row_as_before) {
+            const RGBA32* top = scaled_source_row(source, src_rect, row.index, top_buffer);
+            const RGBA32* bottom = scaled_source_row(source, src_rect, row.index + row.next, bottom_buffer);
+            if (has_alpha_channel) {
+                // Filter premultiplied pixels, so that transparent ones don't drag their (usually black) color into the edges.
+                top_buffer.resize(src_rect.width());
+                premultiply_scanline(top_buffer.data() + first_column, top + first_column, column_count);
+                top = top_buffer.data();
+                if (row.weight) {
+                    bottom_buffer.resize(src_rect.width());
+                    premultiply_scanline(bottom_buffer.data() + first_column, bottom + first_column, column_count);
+                    bottom = bottom_buffer.data();
+                }
+            }
+            lerp_scanlines(vertical_row.data() + first_column, top + first_column, bottom + first_column, column_count, row.weight);
+            RGBA32* out = has_alpha_channel ? scaled_row.data() : dst;
+            for (size_t x = 0; x < width; ++x) {
+                auto& column = columns[x];
+                out[x] = lerp_pixels(vertical_row[column.index], vertical_row[column.index + column.next], column.weight) | opaque_bits;
+            }
+            if (!has_alpha_channel)
+                continue;
+            if (!target_is_opaque)
+                unpremultiply_scanline(scaled_row.data(), width);
+        } else if (!has_alpha_channel) {
+            fast_u32_copy(dst, dst - target.pitch() / sizeof(RGBA32), width);
+            continue;
         }
+        if (target_is_opaque)
+            blend_premultiplied_scanline(dst, scaled_row.data(), width);
+        else
+            blend_scanline(dst, scaled_row.data(), width);
     }
 }
 
-void Painter::draw_scaled_bitmap(const Rect& a_dst_rect, const Gfx::Bitmap& source, const Rect& src_rect)
+void Painter::draw_scaled_bitmap(const Rect& a_dst_rect, const Gfx::Bitmap& source, const Rect& src_rect, ScalingMode scaling_mode)
 {
     auto dst_rect = a_dst_rect;
     if (dst_rect.size() == src_rect.size())
@@ -644,53 +729,61 @@ void Painter::draw_scaled_bitmap(const Rect& a_dst_rect, const Gfx::Bitmap& sour
     ASSERT(source.rect().contains(safe_src_rect));
     dst_rect.move_by(state().translation);
     auto clipped_rect = dst_rect.intersected(clip_rect());
-    if (clipped_rect.is_empty())
+    if (clipped_rect.is_empty() || safe_src_rect.is_empty())
         return;
 
-    int hscale = (src_rect.width() << 16) / dst_rect.width();
-    int vscale = (src_rect.height() << 16) / dst_rect.height();
+    if (scaling_mode == ScalingMode::Bilinear)
+        draw_bilinear_scaled_bitmap(*m_target, dst_rect, clipped_rect, source, safe_src_rect);
+    else
+        draw_nearest_scaled_bitmap(*m_target, dst_rect, clipped_rect, source, safe_src_rect);
+}
 
-    if (source.has_alpha_channel()) {
-        switch (source.format()) {
-        case BitmapFormat::RGB32:
-            do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::RGB32>);
-            break;
-        case BitmapFormat::RGBA32:
-            do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::RGBA32>);
-            break;
-        case BitmapFormat::Indexed8:
-            do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::Indexed8>);
-            break;
-        default:
-            do_draw_scaled_bitmap<true>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::Invalid>);
-            break;
-        }
+[[gnu::flatten]] void Painter::draw_glyph(const Point& point, char ch, Color color)
+{
+    draw_glyph(point, ch, font(), color);
+}
+
+ALWAYS_INLINE static void fill_span(RGBA32* dst, RGBA32 color, int width)
+{
+    // Most glyph spans are only a few pixels wide, where a plain loop beats rep stos.
+    if (width < 8) {
+        for (int i = 0; i < width; ++i)
+            dst[i] = color;
     } else {
-        switch (source.format()) {
-        case BitmapFormat::RGB32:
-            do_draw_scaled_bitmap<false>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::RGB32>);
-            break;
-        case BitmapFormat::RGBA32:
-            do_draw_scaled_bitmap<false>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::RGBA32>);
-            break;
-        case BitmapFormat::Indexed8:
-            do_draw_scaled_bitmap<false>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::Indexed8>);
-            break;
-        default:
-            do_draw_scaled_bitmap<false>(*m_target, dst_rect, clipped_rect, source, src_rect, hscale, vscale, get_pixel<BitmapFormat::Invalid>);
-            break;
-        }
+        fast_u32_fill(dst, color, width);
     }
 }
 
-[[gnu::flatten]] void Painter::draw_glyph(const Point& point, char ch, Color color)
+// Fills rows [first_row, last_row] of a glyph placed at glyph_x. The scanline is the target row of first_row.
+static void fill_glyph(RGBA32* scanline, size_t dst_skip, const GlyphAtlas& atlas, u8 glyph, int first_row, int last_row, int glyph_x, int glyph_width, int clip_left, int clip_right, RGBA32 color)
 {
-    draw_glyph(point, ch, font(), color);
+    size_t span_count;
+    bool needs_clipping = glyph_x < clip_left || glyph_x + glyph_width - 1 > clip_right;
+    for (int row = first_row; row <= last_row; ++row) {
+        auto* spans = atlas.spans(glyph, row, span_count);
+        if (!needs_clipping) {
+            for (size_t i = 0; i < span_count; ++i)
+                fill_span(scanline + glyph_x + spans[i].x, color, spans[i].width);
+        } else {
+            for (size_t i = 0; i < span_count; ++i) {
+                int left = max(glyph_x + spans[i].x, clip_left);
+                int right = min(glyph_x + spans[i].x + spans[i].width - 1, clip_right);
+                if (left <= right)
+                    fill_span(scanline + left, color, right - left + 1);
+            }
+        }
+        scanline += dst_skip;
+    }
 }
 
 [[gnu::flatten]] void Painter::draw_glyph(const Point& point, char ch, const Font& font, Color color)
 {
-    draw_bitmap(point, font.glyph_bitmap(ch), color);
+    auto dst_rect = Rect(point, { font.glyph_width(ch), font.glyph_height() }).translated(translation());
+    auto clipped_rect = dst_rect.intersected(clip_rect());
+    if (clipped_rect.is_empty())
+        return;
+    fill_glyph(m_target->scanline(clipped_rect.top()), m_target->pitch() / sizeof(RGBA32), font.glyph_atlas(), ch,
+        clipped_rect.top() - dst_rect.top(), clipped_rect.bottom() - dst_rect.top(), dst_rect.x(), dst_rect.width(), clipped_rect.left(), clipped_rect.right(), color.value());
 }
 
 void Painter::draw_emoji(const Point& point, const Gfx::Bitmap& emoji, const Font& font)
@@ -781,17 +874,48 @@ void Painter::draw_text_line(const Rect& a_rect, const Utf8View& text, const Fon
         ASSERT_NOT_REACHED();
     }
 
-    auto point = rect.location();
-    int space_width = font.glyph_width(' ') + font.glyph_spacing();
+    draw_text_run(rect.location(), final_text, font, color);
+}
 
-    for (u32 codepoint : final_text) {
-        if (codepoint == ' ') {
-            point.move_by(space_width, 0);
+void Painter::draw_text_run(const Point& point, const Utf8View& run, const Font& font, Color color)
+{
+    auto origin = point.translated(translation());
+    auto clip = clip_rect();
+    int top = max(origin.y(), clip.top());
+    int bottom = min(origin.y() + font.glyph_height() - 1, clip.bottom());
+    if (top > bottom || origin.x() > clip.right())
+        return;
+
+    // Lay out the run first so the fill loop below only deals with visible atlas glyphs.
+    struct PlacedGlyph {
+        int x;
+        u8 width;
+        u8 glyph;
+    };
+    Vector<PlacedGlyph, 128> glyphs;
+    auto& atlas = font.glyph_atlas();
+    int x = origin.x();
+    for (u32 codepoint : run) {
+        if (x > clip.right())
+            break;
+        if (codepoint >= 256) {
+            draw_glyph_or_emoji({ x - translation().x(), point.y() }, codepoint, font, color);
+            x += font.glyph_or_emoji_width(codepoint) + font.glyph_spacing();
             continue;
         }
-        draw_glyph_or_emoji(point, codepoint, font, color);
-        point.move_by(font.glyph_or_emoji_width(codepoint) + font.glyph_spacing(), 0);
+        int advance = font.glyph_width(codepoint);
+        if (codepoint != ' ' && x + advance > clip.left() && !atlas.is_empty(codepoint))
+            glyphs.append({ x, (u8)advance, (u8)codepoint });
+        x += advance + font.glyph_spacing();
     }
+
+    if (glyphs.is_empty())
+        return;
+
+    RGBA32* scanline = m_target->scanline(top);
+    const size_t dst_skip = m_target->pitch() / sizeof(RGBA32);
+    for (auto& glyph : glyphs)
+        fill_glyph(scanline, dst_skip, atlas, glyph.glyph, top - origin.y(), bottom - origin.y(), glyph.x, glyph.width, clip.left(), clip.right(), color.value());
 }
 
 void Painter::draw_text(const Rect& rect, const StringView& text, TextAlignment alignment, Color color, TextElision elision)
@@ -887,6 +1011,9 @@ void Painter::draw_pixel(const Point& position, Color color, int thickness)
 void Painter::draw_line(const Point& p1, const Point& p2, Color color, int thickness, bool dotted)
 {
     auto clip_rect = this->clip_rect();
+    // Thick points are clipped by fill_rect(), but points just outside the clip rect still reach into it.
+    if (thickness > 1)
+        clip_rect.inflate(thickness * 2, thickness * 2);
 
     auto point1 = p1;
     point1.move_by(state().translation);
@@ -908,6 +1035,8 @@ void Painter::draw_line(const Point& p1, const Point& p2, Color color, int thick
         int min_y = max(point1.y(), clip_rect.top());
         int max_y = min(point2.y(), clip_rect.bottom());
         if (dotted) {
+            // Keep the dots in phase with the start of the line when it's clipped.
+            min_y += (min_y - point1.y()) & 1;
             for (int y = min_y; y <= max_y; y += 2)
                 draw_pixel({ x, y }, color, thickness);
         } else {
@@ -931,6 +1060,7 @@ void Painter::draw_line(const Point& p1, const Point& p2, Color color, int thick
         int min_x = max(point1.x(), clip_rect.left());
         int max_x = min(point2.x(), clip_rect.right());
         if (dotted) {
+            min_x += (min_x - point1.x()) & 1;
             for (int x = min_x; x <= max_x; x += 2)
                 draw_pixel({ x, y }, color, thickness);
         } else {
@@ -40,6 +40,8 @@
 namespace Gfx {
 
 class Painter {
+    friend class TiledPainter;
+
 public:
     explicit Painter(Gfx::Bitmap&);
     ~Painter();
@@ -54,7 +56,11 @@ public:
     void draw_ellipse_intersecting(const Rect&, Color, int thickness = 1);
     void set_pixel(const Point&, Color);
     void draw_line(const Point&, const Point&, Color, int thickness = 1, bool dotted = false);
-    void draw_scaled_bitmap(const Rect& dst_rect, const Gfx::Bitmap&, const Rect& src_rect);
+    enum class ScalingMode {
+        NearestNeighbor,
+        Bilinear,
+    };
+    void draw_scaled_bitmap(const Rect& dst_rect, const Gfx::Bitmap&, const Rect& src_rect, ScalingMode = ScalingMode::NearestNeighbor);
     void blit(const Point&, const Gfx::Bitmap&, const Rect& src_rect, float opacity = 1.0f);
     void blit_dimmed(const Point&, const Gfx::Bitmap&, const Rect& src_rect);
     void blit_brightened(const Point&, const Gfx::Bitmap&, const Rect& src_rect);
@@ -68,6 +74,8 @@ public:
     void draw_glyph(const Point&, char, const Font&, Color);
     void draw_emoji(const Point&, const Gfx::Bitmap&, const Font&);
     void draw_glyph_or_emoji(const Point&, u32 codepoint, const Font&, Color);
+    // Draws a single line of text starting at the given top-left point, without alignment or elision.
+    void draw_text_run(const Point&, const Utf8View&, const Font&, Color);
 
     const Font& font() const { return *state().font; }
     void set_font(const Font& font) { state().font = &font; }
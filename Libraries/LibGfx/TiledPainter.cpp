@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/DisplayList.h>
+#include <LibGfx/Font.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/TiledPainter.h>
+#include <LibThread/ThreadPool.h>
+
+namespace Gfx {
+
+TiledPainter::TiledPainter(Painter& painter)
+    : m_painter(painter)
+{
+}
+
+void TiledPainter::paint(const DisplayList& display_list)
+{
+    auto clip_rect = m_painter.clip_rect();
+    if (display_list.is_empty() || clip_rect.is_empty())
+        return;
+
+    auto& pool = LibThread::ThreadPool::the();
+    int tile_width = max(m_tile_size.width(), 1);
+    int tile_height = max(m_tile_size.height(), 1);
+    if (pool.worker_count() == 0 || (clip_rect.width() <= tile_width && clip_rect.height() <= tile_height)) {
+        display_list.paint(m_painter);
+        return;
+    }
+
+    Vector<Rect> tiles;
+    for (int y = clip_rect.top(); y <= clip_rect.bottom(); y += tile_height) {
+        for (int x = clip_rect.left(); x <= clip_rect.right(); x += tile_width)
+            tiles.append(Rect(x, y, tile_width, tile_height).intersected(clip_rect));
+    }
+
+    auto& target = *m_painter.target();
+    ASSERT(target.format() == BitmapFormat::RGB32 || target.format() == BitmapFormat::RGBA32);
+
+    // Every Painter is constructed with the default font, which is loaded on first use.
+    Font::default_font();
+
+    auto state = m_painter.state();
+    auto clip_origin = m_painter.m_clip_origin;
+    pool.run(tiles.size(), [&](size_t index) {
+        // A Painter holds a reference to its target and reference counts aren't atomic,
+        // so each tile paints through its own bitmap wrapping the same pixels.
+        auto tile_target = Bitmap::create_wrapper(target.format(), target.size(), target.pitch(), target.scanline(0));
+        Painter painter(*tile_target);
+        painter.m_clip_origin = clip_origin;
+        painter.state() = state;
+        painter.state().clip_rect = tiles[index];
+        display_list.paint(painter, tiles[index].translated(-state.translation));
+    });
+}
+
+}
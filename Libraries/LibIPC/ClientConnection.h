@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/SharedBuffer.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/IODevice.h>
@@ -35,8 +36,10 @@
 #include <LibCore/Object.h>
 #include <LibIPC/Endpoint.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedRing.h>
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -108,24 +111,12 @@ public:
 
         auto buffer = message.encode();
 
-        int nwritten = write(m_socket->fd(), buffer.data(), buffer.size());
-        if (nwritten < 0) {
-            switch (errno) {
-            case EPIPE:
-                dbg() << *this << "::post_message: Disconnected from peer";
-                shutdown();
-                return;
-            case EAGAIN:
-                dbg() << *this << "::post_message: Client buffer overflowed.";
-                did_misbehave();
-                return;
-            default:
-                perror("Connection::post_message write");
-                ASSERT_NOT_REACHED();
-            }
+        if (m_outgoing_ring.has_value()) {
+            post_message_to_ring(buffer);
+            return;
         }
 
-        ASSERT(static_cast<size_t>(nwritten) == buffer.size());
+        write_to_socket(buffer.data(), buffer.size());
     }
 
     void drain_messages_from_client()
@@ -148,9 +139,26 @@ public:
             bytes.append(buffer, nread);
         }
 
+        if (m_incoming_ring.has_value()) {
+            // Once the client has moved to shared rings, the socket only carries wakeups and messages too big for a ring.
+            if (!m_incoming_overflow.receive(bytes.data(), bytes.size())) {
+                did_misbehave("garbage on the socket");
+                return;
+            }
+            drain_messages_from_ring();
+            return;
+        }
+
         size_t decoded_bytes = 0;
         for (size_t index = 0; index < bytes.size(); index += decoded_bytes) {
             auto remaining_bytes = ByteBuffer::wrap(bytes.data() + index, bytes.size() - index);
+            if (remaining_bytes.size() >= sizeof(SharedRingRequest) && *reinterpret_cast<const u32*>(remaining_bytes.data()) == SharedRingRequest::static_magic) {
+                SharedRingRequest request;
+                memcpy(&request, remaining_bytes.data(), sizeof(request));
+                accept_shared_rings(request);
+                decoded_bytes = sizeof(request);
+                continue;
+            }
             auto message = Endpoint::decode_message(remaining_bytes, decoded_bytes);
             if (!message) {
                 dbg() << "drain_messages_from_client: Endpoint didn't recognize message";
@@ -163,6 +171,39 @@ public:
         }
     }
 
+    void drain_messages_from_ring()
+    {
+        for (;;) {
+            auto result = m_incoming_ring.value().read(m_ring_message);
+            if (result == SharedRing::ReadResult::Corrupt) {
+                did_misbehave("corrupted shared ring");
+                return;
+            }
+            if (result == SharedRing::ReadResult::Empty) {
+                if (m_incoming_ring.value().prepare_to_sleep())
+                    return;
+                continue;
+            }
+            if (m_incoming_ring.value().producer_needs_wakeup())
+                send_wakeup();
+            if (m_ring_message.is_empty() && !take_overflowed_message()) {
+                did_misbehave("message missing from the socket");
+                return;
+            }
+
+            size_t decoded_bytes = 0;
+            auto bytes = ByteBuffer::wrap(m_ring_message.data(), m_ring_message.size());
+            auto message = Endpoint::decode_message(bytes, decoded_bytes);
+            if (!message) {
+                dbg() << "drain_messages_from_ring: Endpoint didn't recognize message";
+                did_misbehave();
+                return;
+            }
+            if (auto response = m_endpoint.handle(*message))
+                post_message(*response);
+        }
+    }
+
     void did_misbehave()
     {
         dbg() << *this << " (id=" << m_client_id << ", pid=" << m_client_pid << ") misbehaved, disconnecting.";
@@ -200,10 +241,119 @@ protected:
     }
 
 private:
+    bool write_to_socket(const u8* data, size_t size)
+    {
+        int nwritten = write(m_socket->fd(), data, size);
+        if (nwritten < 0) {
+            switch (errno) {
+            case EPIPE:
+                dbg() << *this << "::post_message: Disconnected from peer";
+                shutdown();
+                return false;
+            case EAGAIN:
+                dbg() << *this << "::post_message: Client buffer overflowed.";
+                did_misbehave();
+                return false;
+            default:
+                perror("Connection::post_message write");
+                ASSERT_NOT_REACHED();
+            }
+        }
+
+        ASSERT(static_cast<size_t>(nwritten) == size);
+        return true;
+    }
+
+    void accept_shared_rings(const SharedRingRequest& request)
+    {
+        SharedRingResponse response;
+        if (!m_ring_buffer && SharedRing::is_valid_capacity(request.capacity)) {
+            size_t region_size = SharedRing::region_size(request.capacity);
+            auto buffer = SharedBuffer::create_from_shbuf_id(request.shbuf_id);
+            if (buffer && static_cast<size_t>(buffer->size()) >= 2 * region_size) {
+                auto* base = reinterpret_cast<u8*>(buffer->data());
+                m_incoming_ring = SharedRing::attach(base, request.capacity);
+                m_outgoing_ring = SharedRing::attach(base + region_size, request.capacity);
+                if (m_incoming_ring.has_value() && m_outgoing_ring.has_value()) {
+                    m_ring_buffer = move(buffer);
+                    response.accepted = true;
+                } else {
+                    m_incoming_ring = {};
+                    m_outgoing_ring = {};
+                }
+            }
+        }
+
+        // This is the last thing we send through the socket if the rings were accepted.
+        int nwritten = write(m_socket->fd(), &response, sizeof(response));
+        if (nwritten != sizeof(response)) {
+            did_misbehave("couldn't answer shared ring request");
+            return;
+        }
+        if (!response.accepted)
+            dbg() << *this << ": Rejected shared ring request from client " << m_client_id;
+    }
+
+    void post_message_to_ring(const MessageBuffer& buffer)
+    {
+        auto result = m_outgoing_ring.value().post(buffer.data(), buffer.size());
+        if (result == SharedRing::PostResult::TooBig) {
+            // Send it through the socket instead, and put an empty message in the ring to hold its place.
+            auto bytes = SharedRingOverflow::encode(buffer.data(), buffer.size());
+            if (!write_to_socket(bytes.data(), bytes.size()))
+                return;
+            result = m_outgoing_ring.value().post(buffer.data(), 0);
+        }
+
+        switch (result) {
+        case SharedRing::PostResult::Posted:
+            if (m_outgoing_ring.value().consumer_needs_wakeup())
+                send_wakeup();
+            return;
+        case SharedRing::PostResult::Full:
+            dbg() << *this << "::post_message: Client ring overflowed.";
+            did_misbehave();
+            return;
+        case SharedRing::PostResult::TooBig:
+            ASSERT_NOT_REACHED();
+        case SharedRing::PostResult::Corrupt:
+            did_misbehave("corrupted shared ring");
+            return;
+        }
+    }
+
+    bool take_overflowed_message()
+    {
+        // The client writes the message to the socket before it puts the empty one in the ring.
+        while (!m_incoming_overflow.take_message(m_ring_message)) {
+            u8 buffer[4096];
+            ssize_t nread = recv(m_socket->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (nread <= 0 || !m_incoming_overflow.receive(buffer, nread))
+                return false;
+        }
+        return true;
+    }
+
+    void send_wakeup()
+    {
+        u8 wakeup = 0;
+        // EAGAIN is fine, it means the client has plenty of wakeups waiting for it already.
+        if (write(m_socket->fd(), &wakeup, sizeof(wakeup)) < 0 && errno == EPIPE) {
+            dbg() << *this << "::send_wakeup: Disconnected from peer";
+            shutdown();
+        }
+    }
+
     Endpoint& m_endpoint;
     RefPtr<Core::LocalSocket> m_socket;
     int m_client_id { -1 };
     int m_client_pid { -1 };
+
+    RefPtr<SharedBuffer> m_ring_buffer;
+    Optional<SharedRing> m_incoming_ring;
+    Optional<SharedRing> m_outgoing_ring;
+    Vector<u8> m_ring_message;
+    SharedRingOverflow m_incoming_overflow;
 };
 
 }
@@ -112,4 +112,23 @@ bool Decoder::decode(String& value)
     return !m_stream.handle_read_failure();
 }
 
+bool Decoder::decode(ByteBuffer& value)
+{
+    i32 size = 0;
+    m_stream >> size;
+    if (m_stream.handle_read_failure())
+        return false;
+    if (size < 0) {
+        value = {};
+        return true;
+    }
+    value = ByteBuffer::create_uninitialized(static_cast<size_t>(size));
+    for (size_t i = 0; i < static_cast<size_t>(size); ++i) {
+        m_stream >> value[i];
+        if (m_stream.handle_read_failure())
+            return false;
+    }
+    return true;
+}
+
 }
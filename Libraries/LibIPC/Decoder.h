@@ -55,6 +55,7 @@ public:
     bool decode(i64&);
     bool decode(float&);
     bool decode(String&);
+    bool decode(ByteBuffer&);
 
     template<typename T>
     bool decode(T& value)
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Forward.h>
 #include <LibIPC/Message.h>
 
 namespace IPC {
@@ -50,6 +51,7 @@ public:
     Encoder& operator<<(const char*);
     Encoder& operator<<(const StringView&);
     Encoder& operator<<(const String&);
+    Encoder& operator<<(const ByteBuffer&);
 
 private:
     MessageBuffer& m_buffer;
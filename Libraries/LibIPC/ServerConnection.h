@@ -28,13 +28,16 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/SharedBuffer.h>
 #include <LibCore/Event.h>
 #include <LibCore/LocalSocket.h>
 #include <LibCore/Notifier.h>
 #include <LibCore/SyscallUtils.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/SharedRing.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -97,15 +100,7 @@ public:
             }
         }
         for (;;) {
-            fd_set rfds;
-            FD_ZERO(&rfds);
-            FD_SET(m_connection->fd(), &rfds);
-            int rc = Core::safe_syscall(select, m_connection->fd() + 1, &rfds, nullptr, nullptr, nullptr);
-            if (rc < 0) {
-                perror("select");
-            }
-            ASSERT(rc > 0);
-            ASSERT(FD_ISSET(m_connection->fd(), &rfds));
+            wait_until_readable();
             if (!drain_messages_from_server())
                 return nullptr;
             for (size_t i = 0; i < m_unprocessed_messages.size(); ++i) {
@@ -118,9 +113,51 @@ public:
         }
     }
 
+    // Moves this connection off the socket and onto a pair of rings in a shared buffer, if the server agrees.
+    // Messages then go straight into the peer's address space, and the socket is only used to wake it up.
+    bool enable_shared_rings(size_t capacity = SharedRing::default_capacity)
+    {
+        ASSERT(!m_ring_buffer);
+        size_t region_size = SharedRing::region_size(capacity);
+        auto buffer = SharedBuffer::create_with_size(2 * region_size);
+        if (!buffer || !buffer->share_with(m_server_pid))
+            return false;
+        auto* base = reinterpret_cast<u8*>(buffer->data());
+        auto outgoing_ring = SharedRing::create(base, capacity);
+        auto incoming_ring = SharedRing::create(base + region_size, capacity);
+
+        SharedRingRequest request;
+        request.shbuf_id = buffer->shbuf_id();
+        request.capacity = capacity;
+        int nwritten = write(m_connection->fd(), &request, sizeof(request));
+        if (nwritten < 0) {
+            perror("write");
+            ASSERT_NOT_REACHED();
+        }
+        ASSERT(nwritten == sizeof(request));
+
+        // Anything the server sent before its answer still comes through the socket.
+        m_shared_ring_response = {};
+        while (!m_shared_ring_response.has_value()) {
+            wait_until_readable();
+            if (!drain_messages_from_server())
+                return false;
+        }
+        if (!m_shared_ring_response.value())
+            return false;
+
+        m_ring_buffer = move(buffer);
+        m_outgoing_ring = outgoing_ring;
+        m_incoming_ring = incoming_ring;
+        // The server may have put messages in the ring right after answering.
+        return drain_messages_from_server();
+    }
+
     bool post_message(const Message& message)
     {
         auto buffer = message.encode();
+        if (m_outgoing_ring.has_value())
+            return post_message_to_ring(buffer);
         int nwritten = write(m_connection->fd(), buffer.data(), buffer.size());
         if (nwritten < 0) {
             perror("write");
@@ -142,6 +179,80 @@ public:
     }
 
 private:
+    void wait_until_readable()
+    {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(m_connection->fd(), &rfds);
+        int rc = Core::safe_syscall(select, m_connection->fd() + 1, &rfds, nullptr, nullptr, nullptr);
+        if (rc < 0) {
+            perror("select");
+        }
+        ASSERT(rc > 0);
+        ASSERT(FD_ISSET(m_connection->fd(), &rfds));
+    }
+
+    bool post_message_to_ring(const MessageBuffer& buffer)
+    {
+        const u8* data = buffer.data();
+        size_t size = buffer.size();
+        for (;;) {
+            switch (m_outgoing_ring.value().post(data, size)) {
+            case SharedRing::PostResult::Posted:
+                if (m_outgoing_ring.value().consumer_needs_wakeup())
+                    send_wakeup();
+                return true;
+            case SharedRing::PostResult::Full:
+                // Block until the server makes room, just like a blocking write to the socket would.
+                // Keep reading our own ring meanwhile, or the server might give up on us.
+                if (m_outgoing_ring.value().prepare_to_wait_for_space(size)) {
+                    wait_until_readable();
+                    if (!drain_messages_from_server())
+                        return false;
+                }
+                break;
+            case SharedRing::PostResult::TooBig: {
+                // Send it through the socket instead, and put an empty message in the ring to hold its place.
+                auto bytes = SharedRingOverflow::encode(data, size);
+                int nwritten = write(m_connection->fd(), bytes.data(), bytes.size());
+                if (nwritten < 0) {
+                    perror("write");
+                    ASSERT_NOT_REACHED();
+                    return false;
+                }
+                ASSERT(static_cast<size_t>(nwritten) == bytes.size());
+                size = 0;
+                break;
+            }
+            case SharedRing::PostResult::Corrupt:
+                dbg() << "post_message: The shared ring is corrupt";
+                ASSERT_NOT_REACHED();
+                return false;
+            }
+        }
+    }
+
+    void send_wakeup()
+    {
+        u8 wakeup = 0;
+        if (write(m_connection->fd(), &wakeup, sizeof(wakeup)) < 0) {
+            perror("write");
+            ASSERT_NOT_REACHED();
+        }
+    }
+
+    void decode_message(const ByteBuffer& bytes, size_t& decoded_bytes)
+    {
+        if (auto message = LocalEndpoint::decode_message(bytes, decoded_bytes)) {
+            m_unprocessed_messages.append(move(message));
+        } else if (auto message = PeerEndpoint::decode_message(bytes, decoded_bytes)) {
+            m_unprocessed_messages.append(move(message));
+        } else {
+            ASSERT_NOT_REACHED();
+        }
+        ASSERT(decoded_bytes);
+    }
+
     bool drain_messages_from_server()
     {
         Vector<u8> bytes;
@@ -164,17 +275,42 @@ private:
             bytes.append(buffer, nread);
         }
 
-        size_t decoded_bytes = 0;
-        for (size_t index = 0; index < bytes.size(); index += decoded_bytes) {
-            auto remaining_bytes = ByteBuffer::wrap(bytes.data() + index, bytes.size() - index);
-            if (auto message = LocalEndpoint::decode_message(remaining_bytes, decoded_bytes)) {
-                m_unprocessed_messages.append(move(message));
-            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, decoded_bytes)) {
-                m_unprocessed_messages.append(move(message));
-            } else {
+        if (m_incoming_ring.has_value()) {
+            // The socket only carries wakeups and messages too big for the ring now, the rest are in the ring.
+            if (!m_incoming_overflow.receive(bytes.data(), bytes.size()))
                 ASSERT_NOT_REACHED();
+            for (;;) {
+                auto result = m_incoming_ring.value().read(m_ring_message);
+                ASSERT(result != SharedRing::ReadResult::Corrupt);
+                if (result == SharedRing::ReadResult::Empty) {
+                    if (m_incoming_ring.value().prepare_to_sleep())
+                        break;
+                    continue;
+                }
+                if (m_ring_message.is_empty())
+                    take_overflowed_message();
+                size_t decoded_bytes = 0;
+                decode_message(ByteBuffer::wrap(m_ring_message.data(), m_ring_message.size()), decoded_bytes);
+            }
+        } else {
+            size_t decoded_bytes = 0;
+            for (size_t index = 0; index < bytes.size(); index += decoded_bytes) {
+                auto remaining_bytes = ByteBuffer::wrap(bytes.data() + index, bytes.size() - index);
+                if (remaining_bytes.size() >= sizeof(SharedRingResponse) && *reinterpret_cast<const u32*>(remaining_bytes.data()) == SharedRingResponse::static_magic) {
+                    SharedRingResponse response;
+                    memcpy(&response, remaining_bytes.data(), sizeof(response));
+                    m_shared_ring_response = response.accepted;
+                    decoded_bytes = sizeof(response);
+                    // Whatever follows an accepting response belongs with the rings.
+                    if (response.accepted) {
+                        if (!m_incoming_overflow.receive(remaining_bytes.data() + sizeof(response), remaining_bytes.size() - sizeof(response)))
+                            ASSERT_NOT_REACHED();
+                        break;
+                    }
+                    continue;
+                }
+                decode_message(remaining_bytes, decoded_bytes);
             }
-            ASSERT(decoded_bytes);
         }
 
         if (!m_unprocessed_messages.is_empty()) {
@@ -185,6 +321,22 @@ private:
         return true;
     }
 
+    void take_overflowed_message()
+    {
+        // The server writes the message to the socket before it puts the empty one in the ring.
+        while (!m_incoming_overflow.take_message(m_ring_message)) {
+            wait_until_readable();
+            u8 buffer[4096];
+            ssize_t nread = recv(m_connection->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (nread <= 0) {
+                perror("recv");
+                exit(1);
+            }
+            if (!m_incoming_overflow.receive(buffer, nread))
+                ASSERT_NOT_REACHED();
+        }
+    }
+
     void handle_messages()
     {
         auto messages = move(m_unprocessed_messages);
@@ -200,6 +352,13 @@ private:
     Vector<OwnPtr<Message>> m_unprocessed_messages;
     int m_server_pid { -1 };
     int m_my_client_id { -1 };
+
+    RefPtr<SharedBuffer> m_ring_buffer;
+    Optional<SharedRing> m_incoming_ring;
+    Optional<SharedRing> m_outgoing_ring;
+    Optional<bool> m_shared_ring_response;
+    Vector<u8> m_ring_message;
+    SharedRingOverflow m_incoming_overflow;
 };
 
 }
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StdLibExtras.h>
+#include <LibIPC/SharedRing.h>
+#include <string.h>
+
+namespace IPC {
+
+static constexpr u32 shared_ring_magic = 0x1bc0ffee;
+
+size_t SharedRing::region_size(size_t capacity)
+{
+    return sizeof(Header) + capacity;
+}
+
+bool SharedRing::is_valid_capacity(size_t capacity)
+{
+    return capacity >= 4 * KB && capacity <= 1 * MB && !(capacity & (capacity - 1));
+}
+
+SharedRing::SharedRing(void* region, size_t capacity)
+    : m_header(reinterpret_cast<Header*>(region))
+    , m_data(reinterpret_cast<u8*>(region) + sizeof(Header))
+    , m_capacity(capacity)
+{
+}
+
+SharedRing SharedRing::create(void* region, size_t capacity)
+{
+    ASSERT(is_valid_capacity(capacity));
+    SharedRing ring(region, capacity);
+    auto* header = new (region) Header;
+    header->magic = shared_ring_magic;
+    header->capacity = capacity;
+    header->head = 0;
+    header->tail = 0;
+    // Nobody is listening yet, so the first message has to come with a wakeup.
+    header->consumer_is_sleeping = 1;
+    header->producer_is_waiting = 0;
+    return ring;
+}
+
+Optional<SharedRing> SharedRing::attach(void* region, size_t capacity)
+{
+    if (!is_valid_capacity(capacity))
+        return {};
+    SharedRing ring(region, capacity);
+    if (ring.m_header->magic != shared_ring_magic || ring.m_header->capacity != capacity)
+        return {};
+    ring.m_head = ring.m_header->head.load();
+    ring.m_tail = ring.m_header->tail.load();
+    if (ring.m_head - ring.m_tail > capacity)
+        return {};
+    return ring;
+}
+
+void SharedRing::copy_in(u32 position, const void* data, size_t size)
+{
+    size_t offset = position & (m_capacity - 1);
+    size_t first_chunk = min(size, m_capacity - offset);
+    memcpy(m_data + offset, data, first_chunk);
+    memcpy(m_data, reinterpret_cast<const u8*>(data) + first_chunk, size - first_chunk);
+}
+
+void SharedRing::copy_out(u32 position, void* data, size_t size) const
+{
+    size_t offset = position & (m_capacity - 1);
+    size_t first_chunk = min(size, m_capacity - offset);
+    memcpy(data, m_data + offset, first_chunk);
+    memcpy(reinterpret_cast<u8*>(data) + first_chunk, m_data, size - first_chunk);
+}
+
+SharedRing::PostResult SharedRing::post(const u8* data, size_t size)
+{
+    size_t needed = record_size(size);
+    if (needed > m_capacity)
+        return PostResult::TooBig;
+    u32 used = m_head - m_header->tail.load();
+    if (used > m_capacity)
+        return PostResult::Corrupt;
+    if (needed > m_capacity - used)
+        return PostResult::Full;
+
+    u32 length = size;
+    copy_in(m_head, &length, sizeof(length));
+    copy_in(m_head + sizeof(length), data, size);
+    m_head += needed;
+    m_header->head.store(m_head);
+    return PostResult::Posted;
+}
+
+bool SharedRing::consumer_needs_wakeup()
+{
+    return m_header->consumer_is_sleeping.exchange(0);
+}
+
+bool SharedRing::prepare_to_wait_for_space(size_t size)
+{
+    m_header->producer_is_waiting.store(1);
+    u32 used = m_head - m_header->tail.load();
+    return used > m_capacity || record_size(size) > m_capacity - used;
+}
+
+SharedRing::ReadResult SharedRing::read(Vector<u8>& message)
+{
+    u32 available = m_header->head.load() - m_tail;
+    if (!available)
+        return ReadResult::Empty;
+    if (available > m_capacity || available < sizeof(u32))
+        return ReadResult::Corrupt;
+
+    u32 length;
+    copy_out(m_tail, &length, sizeof(length));
+    if (length > m_capacity || record_size(length) > available)
+        return ReadResult::Corrupt;
+
+    // Copy the message out of shared memory before anybody looks at it, so the peer can't change it under our feet.
+    message.resize(length);
+    copy_out(m_tail + sizeof(length), message.data(), length);
+    m_tail += record_size(length);
+    m_header->tail.store(m_tail);
+    return ReadResult::Message;
+}
+
+bool SharedRing::producer_needs_wakeup()
+{
+    return m_header->producer_is_waiting.exchange(0);
+}
+
+bool SharedRing::prepare_to_sleep()
+{
+    m_header->consumer_is_sleeping.store(1);
+    return m_header->head.load() == m_tail;
+}
+
+Vector<u8> SharedRingOverflow::encode(const u8* data, size_t size)
+{
+    ASSERT(size <= max_message_size);
+    SharedRingOverflowHeader header;
+    header.size = size;
+    Vector<u8> bytes;
+    bytes.ensure_capacity(sizeof(header) + size);
+    bytes.append(reinterpret_cast<const u8*>(&header), sizeof(header));
+    bytes.append(data, size);
+    return bytes;
+}
+
+bool SharedRingOverflow::receive(const u8* data, size_t size)
+{
+    m_pending_bytes.append(data, size);
+
+    size_t offset = 0;
+    while (offset < m_pending_bytes.size()) {
+        // A zero byte is a wakeup, and a header never starts with one.
+        if (!m_pending_bytes[offset]) {
+            ++offset;
+            continue;
+        }
+        size_t remaining = m_pending_bytes.size() - offset;
+        SharedRingOverflowHeader header;
+        if (remaining < sizeof(header))
+            break;
+        memcpy(&header, m_pending_bytes.data() + offset, sizeof(header));
+        if (header.magic != SharedRingOverflowHeader::static_magic || header.size > max_message_size)
+            return false;
+        if (remaining - sizeof(header) < header.size)
+            break;
+        Vector<u8> message;
+        message.append(m_pending_bytes.data() + offset + sizeof(header), header.size);
+        m_messages.append(move(message));
+        offset += sizeof(header) + header.size;
+    }
+
+    if (offset) {
+        Vector<u8> rest;
+        rest.append(m_pending_bytes.data() + offset, m_pending_bytes.size() - offset);
+        m_pending_bytes = move(rest);
+    }
+    return true;
+}
+
+bool SharedRingOverflow::take_message(Vector<u8>& message)
+{
+    if (m_messages.is_empty())
+        return false;
+    message = m_messages.take_first();
+    return true;
+}
+
+}
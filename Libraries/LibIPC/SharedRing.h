@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace IPC {
+
+// Sent over the socket (instead of an endpoint message) to move a connection onto a pair of shared rings.
+// The client creates a shared buffer holding both rings and the server answers with a SharedRingResponse.
+struct SharedRingRequest {
+    static constexpr u32 static_magic = 0x52494e47; // "RING"
+    u32 magic { static_magic };
+    i32 shbuf_id { -1 };
+    u32 capacity { 0 };
+};
+
+struct SharedRingResponse {
+    static constexpr u32 static_magic = 0x5241434b; // "RACK"
+    u32 magic { static_magic };
+    u32 accepted { false };
+};
+
+// Precedes a message sent over the socket because it doesn't fit in the shared ring, see SharedRingOverflow.
+struct SharedRingOverflowHeader {
+    static constexpr u32 static_magic = 0x4f564552; // "OVER"
+    u32 magic { static_magic };
+    u32 size { 0 };
+};
+
+// A single-producer, single-consumer queue of length-prefixed messages in shared memory.
+// Once a connection uses a pair of these, its socket only carries one-byte wakeups for a peer
+// that has gone to sleep, so a burst of messages costs no syscalls at all.
+// The peer is not trusted: everything read back from shared memory is bounds-checked, and our own
+// position in the ring is kept privately.
+class SharedRing {
+public:
+    static constexpr size_t default_capacity = 64 * KB;
+
+    // Bytes of shared memory needed for a ring with the given capacity. Capacities must be powers of two.
+    static size_t region_size(size_t capacity);
+    static bool is_valid_capacity(size_t);
+
+    // Sets up a fresh ring in `region`.
+    static SharedRing create(void* region, size_t capacity);
+    // Attaches to a ring set up by the peer, if it looks sane.
+    static Optional<SharedRing> attach(void* region, size_t capacity);
+
+    enum class PostResult {
+        Posted,
+        Full,
+        TooBig,
+        Corrupt,
+    };
+    PostResult post(const u8* data, size_t size);
+    // After a post, tells whether the consumer went to sleep and needs a wakeup byte. Resets the flag.
+    bool consumer_needs_wakeup();
+    // Call before blocking for a wakeup from the consumer. Returns false if there's space after all.
+    bool prepare_to_wait_for_space(size_t size);
+
+    enum class ReadResult {
+        Message,
+        Empty,
+        Corrupt,
+    };
+    ReadResult read(Vector<u8>& message);
+    // After a read, tells whether the producer is blocked waiting for space. Resets the flag.
+    bool producer_needs_wakeup();
+    // Call before going back to sleep. Returns false if more messages arrived in the meantime.
+    bool prepare_to_sleep();
+
+private:
+    struct Header {
+        u32 magic;
+        u32 capacity;
+        Atomic<u32> head;
+        Atomic<u32> tail;
+        Atomic<u32> consumer_is_sleeping;
+        Atomic<u32> producer_is_waiting;
+    };
+
+    SharedRing(void* region, size_t capacity);
+
+    static size_t record_size(size_t message_size) { return sizeof(u32) + ((message_size + 3) & ~3); }
+    void copy_in(u32 position, const void*, size_t);
+    void copy_out(u32 position, void*, size_t) const;
+
+    Header* m_header { nullptr };
+    u8* m_data { nullptr };
+    u32 m_capacity { 0 };
+    u32 m_head { 0 };
+    u32 m_tail { 0 };
+};
+
+// Messages too big for a ring still go through the socket, after a SharedRingOverflowHeader,
+// and an empty message in the ring holds their place in line. This picks them out from between the wakeups.
+class SharedRingOverflow {
+public:
+    static constexpr size_t max_message_size = 16 * MB;
+
+    // What to write to the socket for a message that doesn't fit in the ring.
+    static Vector<u8> encode(const u8* data, size_t size);
+
+    // Takes bytes received from the socket. Returns false if the peer sent something that makes no sense.
+    bool receive(const u8* data, size_t size);
+    // Moves the oldest message that has come through the socket in full into `message`.
+    bool take_message(Vector<u8>& message);
+
+private:
+    Vector<u8> m_pending_bytes;
+    Vector<Vector<u8>> m_messages;
+};
+
+}
@@ -47,9 +47,9 @@ bool Client::is_supported_protocol(const String& protocol)
     return send_sync<Messages::ProtocolServer::IsSupportedProtocol>(protocol)->supported();
 }
 
-RefPtr<Download> Client::start_download(const String& url)
+RefPtr<Download> Client::start_download(const String& url, bool stream_data)
 {
-    i32 download_id = send_sync<Messages::ProtocolServer::StartDownload>(url)->download_id();
+    i32 download_id = send_sync<Messages::ProtocolServer::StartDownload>(url, stream_data)->download_id();
     if (download_id < 0)
         return nullptr;
     auto download = Download::create_from_id({}, *this, download_id);
@@ -81,4 +81,11 @@ void Client::handle(const Messages::ProtocolClient::DownloadProgress& message)
     }
 }
 
+void Client::handle(const Messages::ProtocolClient::DownloadData& message)
+{
+    if (auto download = const_cast<Download*>(m_downloads.get(message.download_id()).value_or(nullptr))) {
+        download->did_receive_data({}, message.data());
+    }
+}
+
 }
@@ -44,13 +44,15 @@ public:
     virtual void handshake() override;
 
     bool is_supported_protocol(const String&);
-    RefPtr<Download> start_download(const String& url);
+    // With stream_data set, the download's on_data is called with each piece of the payload as it arrives.
+    RefPtr<Download> start_download(const String& url, bool stream_data = false);
 
     bool stop_download(Badge<Download>, Download&);
 
 private:
     virtual void handle(const Messages::ProtocolClient::DownloadProgress&) override;
     virtual void handle(const Messages::ProtocolClient::DownloadFinished&) override;
+    virtual void handle(const Messages::ProtocolClient::DownloadData&) override;
 
     HashMap<i32, RefPtr<Download>> m_downloads;
 };
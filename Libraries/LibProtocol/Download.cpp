@@ -61,4 +61,10 @@ void Download::did_progress(Badge<Client>, u32 total_size, u32 downloaded_size)
         on_progress(total_size, downloaded_size);
 }
 
+void Download::did_receive_data(Badge<Client>, const ByteBuffer& data)
+{
+    if (on_data)
+        on_data(data);
+}
+
 }
@@ -48,9 +48,11 @@ public:
 
     Function<void(bool success, const ByteBuffer& payload, RefPtr<SharedBuffer> payload_storage)> on_finish;
     Function<void(u32 total_size, u32 downloaded_size)> on_progress;
+    Function<void(const ByteBuffer&)> on_data;
 
     void did_finish(Badge<Client>, bool success, u32 total_size, i32 shbuf_id);
     void did_progress(Badge<Client>, u32 total_size, u32 downloaded_size);
+    void did_receive_data(Badge<Client>, const ByteBuffer&);
 
 private:
     explicit Download(Client&, i32 download_id);
@@ -28,6 +28,7 @@
 #include <AK/Atomic.h>
 #include <AK/StdLibExtras.h>
 #include <Kernel/Syscall.h>
+#include <bits/pthread_integration.h>
 #include <limits.h>
 #include <pthread.h>
 #include <serenity.h>
@@ -42,6 +43,11 @@
 
 namespace {
 using PthreadAttrImpl = Syscall::SC_create_thread_params;
+
+struct ThreadStart {
+    void* (*start_routine)(void*);
+    void* argument;
+};
 } // end anonymous namespace
 
 constexpr size_t required_stack_alignment = 4 * MB;
@@ -61,6 +67,17 @@ static void exit_thread(void* code)
     ASSERT_NOT_REACHED();
 }
 
+// Every thread starts out here, so that returning from the start routine goes through pthread_exit() like calling it does.
+static void* start_thread(void* argument)
+{
+    auto* thread_start = reinterpret_cast<ThreadStart*>(argument);
+    auto* start_routine = thread_start->start_routine;
+    void* argument_to_start_routine = thread_start->argument;
+    delete thread_start;
+    pthread_exit(start_routine(argument_to_start_routine));
+    return nullptr;
+}
+
 int pthread_self()
 {
     return gettid();
@@ -96,15 +113,19 @@ int pthread_create(pthread_t* thread, pthread_attr_t* attributes, void* (*start_
         used_attributes->m_stack_location);
 #endif
 
-    int rc = create_thread(start_routine, argument_to_start_routine, used_attributes);
-    if (rc < 0)
+    auto* thread_start = new ThreadStart { start_routine, argument_to_start_routine };
+    int rc = create_thread(start_thread, thread_start, used_attributes);
+    if (rc < 0) {
+        delete thread_start;
         return rc;
+    }
     *thread = rc;
     return 0;
 }
 
 void pthread_exit(void* value_ptr)
 {
+    __malloc_thread_exit();
     exit_thread(value_ptr);
 }
 
@@ -139,31 +160,52 @@ int pthread_mutex_destroy(pthread_mutex_t*)
     return 0;
 }
 
+// The mutex lock word is 0 when unlocked, 1 when locked, and 2 when locked with (possible) waiters
+// sleeping on it with FUTEX_WAIT. Unlocking only enters the kernel if someone may be waiting.
+static constexpr u32 mutex_unlocked = 0;
+static constexpr u32 mutex_locked = 1;
+static constexpr u32 mutex_locked_with_waiters = 2;
+
+// How many times to retry a contended mutex before going to sleep. Critical sections are usually
+// short, so the holder often releases the lock while we spin, and we avoid two syscalls.
+static constexpr int mutex_spin_count = 100;
+
+static bool try_lock_mutex_while_spinning(Atomic<u32>& atomic)
+{
+    for (int i = 0; i < mutex_spin_count; ++i) {
+        u32 expected = mutex_unlocked;
+        if (atomic.load(AK::memory_order_relaxed) == mutex_unlocked
+            && atomic.compare_exchange_strong(expected, mutex_locked, AK::memory_order_acq_rel))
+            return true;
+        asm volatile("pause");
+    }
+    return false;
+}
+
 int pthread_mutex_lock(pthread_mutex_t* mutex)
 {
     auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
     pthread_t this_thread = pthread_self();
-    for (;;) {
-        u32 expected = false;
-        if (!atomic.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
-                mutex->level++;
-                return 0;
-            }
-            sched_yield();
-            continue;
-        }
-        mutex->owner = this_thread;
-        mutex->level = 0;
+    if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+        mutex->level++;
         return 0;
     }
+    u32 expected = mutex_unlocked;
+    if (!atomic.compare_exchange_strong(expected, mutex_locked, AK::memory_order_acq_rel)
+        && !try_lock_mutex_while_spinning(atomic)) {
+        while (atomic.exchange(mutex_locked_with_waiters, AK::memory_order_acquire) != mutex_unlocked)
+            futex(reinterpret_cast<i32*>(&mutex->lock), FUTEX_WAIT, mutex_locked_with_waiters, nullptr);
+    }
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
 }
 
 int pthread_mutex_trylock(pthread_mutex_t* mutex)
 {
     auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
-    u32 expected = false;
-    if (!atomic.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
+    u32 expected = mutex_unlocked;
+    if (!atomic.compare_exchange_strong(expected, mutex_locked, AK::memory_order_acq_rel)) {
         if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == pthread_self()) {
             mutex->level++;
             return 0;
@@ -182,7 +224,9 @@ int pthread_mutex_unlock(pthread_mutex_t* mutex)
         return 0;
     }
     mutex->owner = 0;
-    mutex->lock = 0;
+    auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
+    if (atomic.exchange(mutex_unlocked, AK::memory_order_release) == mutex_locked_with_waiters)
+        futex(reinterpret_cast<i32*>(&mutex->lock), FUTEX_WAKE, 1, nullptr);
     return 0;
 }
 
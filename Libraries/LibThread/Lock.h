@@ -31,10 +31,13 @@
 #include <AK/Assertions.h>
 #include <AK/Types.h>
 #include <AK/Atomic.h>
+#include <serenity.h>
 #include <unistd.h>
 
 namespace LibThread {
 
+// A recursive lock. The uncontended paths are a single atomic operation and never enter the kernel:
+// gettid() is cached in TLS, and we only touch the futex when someone is (or may be) sleeping on it.
 class Lock {
 public:
     Lock() {}
@@ -44,9 +47,12 @@ public:
     void unlock();
 
 private:
-    AK::Atomic<bool> m_lock { false };
+    void lock_slow();
+
+    // 0 = unlocked, 1 = locked, 2 = locked and another thread may be waiting in FUTEX_WAIT.
+    AK::Atomic<u32> m_state { 0 };
+    AK::Atomic<int> m_holder { -1 };
     u32 m_level { 0 };
-    int m_holder { -1 };
 };
 
 class Locker {
@@ -67,39 +73,38 @@ private:
 [[gnu::always_inline]] inline void Lock::lock()
 {
     int tid = gettid();
-    for (;;) {
-        bool expected = false;
-        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            if (m_holder == -1 || m_holder == tid) {
-                m_holder = tid;
-                ++m_level;
-                m_lock.store(false, AK::memory_order_release);
-                return;
-            }
-            m_lock.store(false, AK::memory_order_release);
-        }
-        donate(m_holder);
+    if (m_holder.load(AK::memory_order_relaxed) == tid) {
+        ++m_level;
+        return;
     }
+    u32 expected = 0;
+    if (!m_state.compare_exchange_strong(expected, 1, AK::memory_order_acq_rel))
+        lock_slow();
+    m_holder.store(tid, AK::memory_order_relaxed);
+    m_level = 1;
 }
 
-inline void Lock::unlock()
+inline void Lock::lock_slow()
 {
-    for (;;) {
-        bool expected = false;
-        if (m_lock.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            ASSERT(m_holder == gettid());
-            ASSERT(m_level);
-            --m_level;
-            if (m_level) {
-                m_lock.store(false, AK::memory_order_release);
-                return;
-            }
-            m_holder = -1;
-            m_lock.store(false, AK::memory_order_release);
+    for (int i = 0; i < 100; ++i) {
+        u32 expected = 0;
+        if (m_state.load(AK::memory_order_relaxed) == 0 && m_state.compare_exchange_strong(expected, 1, AK::memory_order_acq_rel))
             return;
-        }
-        donate(m_holder);
+        asm volatile("pause");
     }
+    while (m_state.exchange(2, AK::memory_order_acquire) != 0)
+        futex(reinterpret_cast<int32_t*>(&m_state), FUTEX_WAIT, 2, nullptr);
+}
+
+inline void Lock::unlock()
+{
+    ASSERT(m_holder.load(AK::memory_order_relaxed) == gettid());
+    ASSERT(m_level);
+    if (--m_level)
+        return;
+    m_holder.store(-1, AK::memory_order_relaxed);
+    if (m_state.exchange(0, AK::memory_order_release) == 2)
+        futex(reinterpret_cast<int32_t*>(&m_state), FUTEX_WAKE, 1, nullptr);
 }
 
 #define LOCKER(lock) LibThread::Locker locker(lock)
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Atomic.h>
+#include <LibThread/ThreadPool.h>
+#include <stdio.h>
+
+namespace LibThread {
+
+struct ThreadPool::Batch {
+    Batch(const Function<void(size_t)>& job, size_t job_count)
+        : job(job)
+        , job_count(job_count)
+    {
+    }
+
+    const Function<void(size_t)>& job;
+    size_t job_count { 0 };
+    AK::Atomic<size_t> next_job { 0 };
+    // Guarded by m_mutex. The batch lives on the caller's stack, so run() can't return while a worker is inside.
+    int workers_inside { 0 };
+};
+
+static size_t processor_count()
+{
+    FILE* fp = fopen("/proc/cpuinfo", "r");
+    if (!fp)
+        return 1;
+    unsigned count = 0;
+    if (fscanf(fp, "processors: %u", &count) != 1)
+        count = 1;
+    fclose(fp);
+    return max(count, 1u);
+}
+
+ThreadPool& ThreadPool::the()
+{
+    static ThreadPool* s_the;
+    if (!s_the)
+        s_the = new ThreadPool(processor_count() - 1);
+    return *s_the;
+}
+
+ThreadPool::ThreadPool(size_t worker_count)
+{
+    pthread_mutex_init(&m_run_mutex, nullptr);
+    pthread_mutex_init(&m_mutex, nullptr);
+    pthread_cond_init(&m_work_available, nullptr);
+    pthread_cond_init(&m_batch_finished, nullptr);
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto worker = Thread::construct([this] { return worker_main(); }, "Pool worker");
+        worker->start();
+        m_workers.append(move(worker));
+    }
+}
+
+void ThreadPool::run_jobs(Batch& batch)
+{
+    for (;;) {
+        size_t index = batch.next_job.fetch_add(1);
+        if (index >= batch.job_count)
+            return;
+        batch.job(index);
+    }
+}
+
+int ThreadPool::worker_main()
+{
+    u32 seen_generation = 0;
+    for (;;) {
+        pthread_mutex_lock(&m_mutex);
+        while (!m_batch || m_generation == seen_generation)
+            pthread_cond_wait(&m_work_available, &m_mutex);
+        seen_generation = m_generation;
+        auto& batch = *m_batch;
+        ++batch.workers_inside;
+        pthread_mutex_unlock(&m_mutex);
+
+        run_jobs(batch);
+
+        pthread_mutex_lock(&m_mutex);
+        if (--batch.workers_inside == 0)
+            pthread_cond_signal(&m_batch_finished);
+        pthread_mutex_unlock(&m_mutex);
+    }
+}
+
+void ThreadPool::run(size_t job_count, const Function<void(size_t)>& job)
+{
+    if (m_workers.is_empty() || job_count <= 1) {
+        for (size_t i = 0; i < job_count; ++i)
+            job(i);
+        return;
+    }
+
+    pthread_mutex_lock(&m_run_mutex);
+    Batch batch(job, job_count);
+
+    pthread_mutex_lock(&m_mutex);
+    m_batch = &batch;
+    ++m_generation;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_mutex);
+
+    run_jobs(batch);
+
+    // Every job has been claimed by now; wait for the workers still running theirs.
+    // Workers that wake up after m_batch is cleared go straight back to sleep.
+    pthread_mutex_lock(&m_mutex);
+    while (batch.workers_inside)
+        pthread_cond_wait(&m_batch_finished, &m_mutex);
+    m_batch = nullptr;
+    pthread_mutex_unlock(&m_mutex);
+
+    pthread_mutex_unlock(&m_run_mutex);
+}
+
+}
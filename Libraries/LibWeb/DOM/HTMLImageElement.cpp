@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibCore/Timer.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
 #include <LibWeb/CSS/StyleResolver.h>
@@ -52,20 +53,91 @@ void HTMLImageElement::parse_attribute(const FlyString& name, const String& valu
 void HTMLImageElement::load_image(const String& src)
 {
     URL src_url = document().complete_url(src);
-    ResourceLoader::the().load(src_url, [this, weak_element = make_weak_ptr()](auto data) {
-        if (!weak_element) {
-            dbg() << "HTMLImageElement: Load completed after element destroyed.";
-            return;
-        }
-        if (data.is_null()) {
-            dbg() << "HTMLImageElement: Failed to load " << this->src();
-            return;
-        }
-
-        m_encoded_data = data;
-        m_image_decoder = Gfx::ImageDecoder::create(m_encoded_data.data(), m_encoded_data.size());
+    m_image_decoder = nullptr;
+    m_encoded_data.clear();
+    m_incremental_decoding_failed = false;
+    m_current_frame_index = 0;
+    m_loops_completed = 0;
+    if (m_animation_timer)
+        m_animation_timer->stop();
+    ResourceLoader::the().load_incrementally(
+        src_url,
+        [this, weak_element = make_weak_ptr()](auto& data) {
+            if (!weak_element)
+                return;
+            did_receive_image_data(data);
+        },
+        [this, weak_element = make_weak_ptr()](auto data) {
+            if (!weak_element) {
+                dbg() << "HTMLImageElement: Load completed after element destroyed.";
+                return;
+            }
+            if (data.is_null()) {
+                dbg() << "HTMLImageElement: Failed to load " << this->src();
+                return;
+            }
+
+            m_encoded_data = data;
+            // If the image was decoded while it arrived, we're done. Otherwise decode it from the whole data.
+            if (!m_image_decoder || !m_image_decoder->is_complete())
+                m_image_decoder = Gfx::ImageDecoder::create(m_encoded_data.data(), m_encoded_data.size());
+            if (m_image_decoder->is_animated() && m_image_decoder->frame_count() > 1)
+                start_animation();
+            document().update_layout();
+        });
+}
+
+void HTMLImageElement::start_animation()
+{
+    if (!m_animation_timer) {
+        m_animation_timer = Core::Timer::construct();
+        m_animation_timer->on_timeout = [this] { animate(); };
+    }
+    m_animation_timer->start(m_image_decoder->frame(m_current_frame_index).duration);
+}
+
+void HTMLImageElement::animate()
+{
+    if (!m_image_decoder || !layout_node())
+        return;
+
+    m_current_frame_index = (m_current_frame_index + 1) % m_image_decoder->frame_count();
+    auto current_frame = m_image_decoder->frame(m_current_frame_index);
+
+    if (current_frame.duration != m_animation_timer->interval())
+        m_animation_timer->restart(current_frame.duration);
+
+    if (m_current_frame_index == m_image_decoder->frame_count() - 1) {
+        ++m_loops_completed;
+        if (m_loops_completed == m_image_decoder->loop_count())
+            m_animation_timer->stop();
+    }
+
+    layout_node()->set_needs_display();
+}
+
+void HTMLImageElement::did_receive_image_data(const ByteBuffer& data)
+{
+    if (m_incremental_decoding_failed)
+        return;
+    if (!m_image_decoder)
+        m_image_decoder = Gfx::ImageDecoder::create_incremental();
+
+    bool had_size = !m_image_decoder->size().is_empty();
+    if (!m_image_decoder->append_data(data.data(), data.size())) {
+        // Leave it to the full decode once everything has arrived.
+        m_incremental_decoding_failed = true;
+        m_image_decoder = nullptr;
         document().update_layout();
-    });
+        return;
+    }
+
+    if (!had_size && !m_image_decoder->size().is_empty()) {
+        document().update_layout();
+        return;
+    }
+    if (layout_node())
+        layout_node()->set_needs_display();
 }
 
 int HTMLImageElement::preferred_width() const
@@ -107,6 +179,8 @@ const Gfx::Bitmap* HTMLImageElement::bitmap() const
 {
     if (!m_image_decoder)
         return nullptr;
+    if (m_image_decoder->is_animated())
+        return m_image_decoder->frame(m_current_frame_index).image;
     return m_image_decoder->bitmap();
 }
 
@@ -115,13 +189,20 @@ void HTMLImageElement::set_volatile(Badge<LayoutDocument>, bool v)
     if (!m_image_decoder)
         return;
     if (v) {
+        // Don't keep decoding frames for an image that isn't visible.
+        if (m_animation_timer)
+            m_animation_timer->stop();
         m_image_decoder->set_volatile();
         return;
     }
     bool has_image = m_image_decoder->set_nonvolatile();
-    if (has_image)
+    if (!has_image)
+        m_image_decoder = Gfx::ImageDecoder::create(m_encoded_data.data(), m_encoded_data.size());
+    if (!m_animation_timer || m_animation_timer->is_active())
         return;
-    m_image_decoder = Gfx::ImageDecoder::create(m_encoded_data.data(), m_encoded_data.size());
+    auto loop_count = m_image_decoder->loop_count();
+    if (loop_count == 0 || m_loops_completed < loop_count)
+        start_animation();
 }
 
 }
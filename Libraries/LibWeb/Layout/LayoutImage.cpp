@@ -77,7 +77,7 @@ void LayoutImage::render(RenderingContext& context)
             alt = node().src();
         context.painter().draw_text(enclosing_int_rect(rect()), alt, Gfx::TextAlignment::Center, style().color_or_fallback(CSS::PropertyID::Color, document(), Color::Black), Gfx::TextElision::Right);
     } else if (node().bitmap())
-        context.painter().draw_scaled_bitmap(enclosing_int_rect(rect()), *node().bitmap(), node().bitmap()->rect());
+        context.painter().draw_scaled_bitmap(enclosing_int_rect(rect()), *node().bitmap(), node().bitmap()->rect(), Gfx::Painter::ScalingMode::Bilinear);
     LayoutReplaced::render(context);
 }
 
@@ -66,6 +66,11 @@ void ResourceLoader::load_sync(const URL& url, Function<void(const ByteBuffer&)>
 }
 
 void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&)> success_callback, Function<void(const String&)> error_callback)
+{
+    load_incrementally(url, nullptr, move(success_callback), move(error_callback));
+}
+
+void ResourceLoader::load_incrementally(const URL& url, Function<void(const ByteBuffer&)> data_callback, Function<void(const ByteBuffer&)> success_callback, Function<void(const String&)> error_callback)
 {
     if (url.protocol() == "file") {
         auto f = Core::File::construct();
@@ -85,12 +90,15 @@ void ResourceLoader::load(const URL& url, Function<void(const ByteBuffer&)> succ
     }
 
     if (url.protocol() == "http") {
-        auto download = protocol_client().start_download(url.to_string());
+        bool stream_data = !!data_callback;
+        auto download = protocol_client().start_download(url.to_string(), stream_data);
         if (!download) {
             if (error_callback)
                 error_callback("Failed to initiate load");
             return;
         }
+        if (stream_data)
+            download->on_data = move(data_callback);
         download->on_finish = [this, success_callback = move(success_callback), error_callback = move(error_callback)](bool success, const ByteBuffer& payload, auto) {
             --m_pending_loads;
             if (on_load_counter_change)
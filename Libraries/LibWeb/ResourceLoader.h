@@ -42,6 +42,9 @@ public:
     static ResourceLoader& the();
 
     void load(const URL&, Function<void(const ByteBuffer&)> success_callback, Function<void(const String&)> error_callback = nullptr);
+    // Like load(), but data_callback also gets each piece of the resource while it is still arriving, when the protocol allows it.
+    // success_callback is called with the whole resource either way.
+    void load_incrementally(const URL&, Function<void(const ByteBuffer&)> data_callback, Function<void(const ByteBuffer&)> success_callback, Function<void(const String&)> error_callback = nullptr);
     void load_sync(const URL&, Function<void(const ByteBuffer&)> success_callback, Function<void(const String&)> error_callback = nullptr);
 
     Function<void()> on_load_counter_change;
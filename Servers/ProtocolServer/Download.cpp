@@ -85,3 +85,14 @@ void Download::did_progress(size_t total_size, size_t downloaded_size)
     m_downloaded_size = downloaded_size;
     m_client->did_progress_download({}, *this);
 }
+
+void Download::did_receive_data(const ByteBuffer& data)
+{
+    if (!m_should_stream_data)
+        return;
+    if (!m_client) {
+        dbg() << "Download::did_receive_data() after the client already disconnected.";
+        return;
+    }
+    m_client->did_receive_download_data({}, *this, data);
+}
@@ -46,6 +46,9 @@ public:
     size_t downloaded_size() const { return m_downloaded_size; }
     const ByteBuffer& payload() const { return m_payload; }
 
+    bool should_stream_data() const { return m_should_stream_data; }
+    void set_should_stream_data(bool should_stream_data) { m_should_stream_data = should_stream_data; }
+
     void stop();
 
 protected:
@@ -53,6 +56,7 @@ protected:
 
     void did_finish(bool success);
     void did_progress(size_t total_size, size_t downloaded_size);
+    void did_receive_data(const ByteBuffer&);
     void set_payload(const ByteBuffer&);
 
 private:
@@ -61,5 +65,6 @@ private:
     size_t m_total_size { 0 };
     size_t m_downloaded_size { 0 };
     ByteBuffer m_payload;
+    bool m_should_stream_data { false };
     WeakPtr<PSClientConnection> m_client;
 };
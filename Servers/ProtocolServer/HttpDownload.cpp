@@ -37,6 +37,9 @@ HttpDownload::HttpDownload(PSClientConnection& client, NonnullRefPtr<Core::HttpJ
             set_payload(m_job->response()->payload());
         did_finish(success);
     };
+    m_job->on_data_received = [this](auto& data) {
+        did_receive_data(data);
+    };
 }
 
 HttpDownload::~HttpDownload()
@@ -63,6 +63,9 @@ OwnPtr<Messages::ProtocolServer::StartDownloadResponse> PSClientConnection::hand
     if (!protocol)
         return make<Messages::ProtocolServer::StartDownloadResponse>(-1);
     auto download = protocol->start_download(*this, url);
+    if (!download)
+        return make<Messages::ProtocolServer::StartDownloadResponse>(-1);
+    download->set_should_stream_data(message.stream_data());
     return make<Messages::ProtocolServer::StartDownloadResponse>(download->id());
 }
 
@@ -94,6 +97,16 @@ void PSClientConnection::did_progress_download(Badge<Download>, Download& downlo
     post_message(Messages::ProtocolClient::DownloadProgress(download.id(), download.total_size(), download.downloaded_size()));
 }
 
+void PSClientConnection::did_receive_download_data(Badge<Download>, Download& download, const ByteBuffer& data)
+{
+    // Keep each message well below the socket buffer size, so the client never sees half of one.
+    static constexpr size_t max_chunk_size = 4 * KB;
+    for (size_t offset = 0; offset < data.size(); offset += max_chunk_size) {
+        size_t chunk_size = min(max_chunk_size, data.size() - offset);
+        post_message(Messages::ProtocolClient::DownloadData(download.id(), ByteBuffer::wrap(data.data() + offset, chunk_size)));
+    }
+}
+
 OwnPtr<Messages::ProtocolServer::GreetResponse> PSClientConnection::handle(const Messages::ProtocolServer::Greet&)
 {
     return make<Messages::ProtocolServer::GreetResponse>(client_id());
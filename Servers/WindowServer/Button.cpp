@@ -64,7 +64,7 @@ void Button::on_mouse_event(const MouseEvent& event)
     if (event.type() == Event::MouseDown && event.button() == MouseButton::Left) {
         m_pressed = true;
         wm.set_cursor_tracking_button(this);
-        wm.invalidate(screen_rect());
+        invalidate();
         return;
     }
 
@@ -79,7 +79,7 @@ void Button::on_mouse_event(const MouseEvent& event)
                 on_click(*this);
         }
         if (old_pressed != m_pressed)
-            wm.invalidate(screen_rect());
+            invalidate();
         return;
     }
 
@@ -88,7 +88,7 @@ void Button::on_mouse_event(const MouseEvent& event)
         m_hovered = rect().contains(event.position());
         wm.set_hovered_button(m_hovered ? this : nullptr);
         if (old_hovered != m_hovered)
-            wm.invalidate(screen_rect());
+            invalidate();
     }
 
     if (event.type() == Event::MouseMove && event.buttons() & (unsigned)MouseButton::Left) {
@@ -97,10 +97,16 @@ void Button::on_mouse_event(const MouseEvent& event)
         bool old_pressed = m_pressed;
         m_pressed = m_hovered;
         if (old_pressed != m_pressed)
-            wm.invalidate(screen_rect());
+            invalidate();
     }
 }
 
+void Button::invalidate()
+{
+    m_frame.set_title_bar_needs_render();
+    WindowManager::the().invalidate(screen_rect());
+}
+
 Gfx::Rect Button::screen_rect() const
 {
     return m_relative_rect.translated(m_frame.rect().location());
@@ -59,6 +59,8 @@ public:
     void set_bitmap(const Gfx::CharacterBitmap& bitmap) { m_bitmap = bitmap; }
 
 private:
+    void invalidate();
+
     WindowFrame& m_frame;
     Gfx::Rect m_relative_rect;
     NonnullRefPtr<Gfx::CharacterBitmap> m_bitmap;
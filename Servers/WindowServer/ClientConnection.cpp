@@ -757,6 +757,27 @@ void ClientConnection::handle(const Messages::WindowServer::DisableDisplayLink&)
     m_has_display_link = false;
 }
 
+OwnPtr<Messages::WindowServer::GetCompositorStatisticsResponse> ClientConnection::handle(const Messages::WindowServer::GetCompositorStatistics& message)
+{
+    auto& compositor = Compositor::the();
+    auto& statistics = compositor.statistics();
+    auto response = make<Messages::WindowServer::GetCompositorStatisticsResponse>(
+        statistics.frame_count,
+        statistics.compose_microseconds,
+        statistics.animation_microseconds,
+        statistics.flush_microseconds,
+        statistics.pixels_composed,
+        statistics.dirty_rect_count,
+        statistics.bytes_flushed,
+        compositor.frame_time_percentile(50),
+        compositor.frame_time_percentile(90),
+        compositor.frame_time_percentile(99),
+        compositor.frame_time_percentile(100));
+    if (message.reset())
+        compositor.reset_statistics();
+    return response;
+}
+
 void ClientConnection::notify_display_link(Badge<Compositor>)
 {
     if (!m_has_display_link)
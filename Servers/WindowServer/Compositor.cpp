@@ -32,10 +32,12 @@
 #include "Window.h"
 #include "WindowManager.h"
 #include <AK/Memory.h>
+#include <AK/QuickSort.h>
 #include <LibCore/Timer.h>
 #include <LibGfx/Font.h>
 #include <LibGfx/Painter.h>
 #include <LibThread/BackgroundAction.h>
+#include <time.h>
 
 // #define COMPOSITOR_DEBUG
 
@@ -111,11 +113,18 @@ void Compositor::init_bitmaps()
     invalidate();
 }
 
+static u64 monotonic_microseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 void Compositor::compose()
 {
     auto& wm = WindowManager::the();
     if (m_wallpaper_mode == WallpaperMode::Unchecked)
-        m_wallpaper_mode = mode_to_enum(wm.wm_config()->read_entry("Background", "Mode", "simple"));
+        load_background_config();
     auto& ws = Screen::the();
 
     auto dirty_rects = move(m_dirty_rects);
@@ -125,40 +134,67 @@ void Compositor::compose()
         return;
     }
 
+    u64 frame_start = monotonic_microseconds();
+
     dirty_rects.add(Gfx::Rect::intersection(m_last_geometry_label_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::Rect::intersection(m_last_cursor_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::Rect::intersection(m_last_dnd_rect, Screen::the().rect()));
     dirty_rects.add(Gfx::Rect::intersection(current_cursor_rect(), Screen::the().rect()));
 
-    auto any_dirty_rect_intersects_window = [&dirty_rects](const Window& window) {
-        auto window_frame_rect = window.frame().rect();
-        for (auto& dirty_rect : dirty_rects.rects()) {
-            if (dirty_rect.intersects(window_frame_rect))
-                return true;
-        }
-        return false;
+    // The theme's desktop color is looked up every frame so theme changes apply without any extra bookkeeping.
+    Color background_color = m_custom_background_color.value_or(wm.palette().desktop_background());
+
+    // Work out which part of the damage each window is responsible for, walking the stack from the front.
+    // Whatever an opaque window covers is taken out of the damage left for the windows behind it,
+    // so every pixel is composed once (plus whatever shows through translucent windows).
+    struct WindowDamage {
+        Window* window;
+        Gfx::DisjointRectSet rects;
+    };
+    Vector<WindowDamage, 32> window_damage;
+    auto uncovered_rects = dirty_rects.intersected(ws.rect());
+    auto collect_window_damage = [&](Window& window) -> IterationDecision {
+        if (uncovered_rects.is_empty())
+            return IterationDecision::Break;
+        auto frame_rect = window.frame().rect();
+        auto damage = uncovered_rects.intersected(frame_rect);
+        if (damage.is_empty())
+            return IterationDecision::Continue;
+        window_damage.append({ &window, move(damage) });
+        bool is_opaque = window.opacity() >= 1.0f && !window.has_alpha_channel();
+        if (is_opaque)
+            uncovered_rects = uncovered_rects.shattered(frame_rect);
+        return IterationDecision::Continue;
     };
 
-    Color background_color = wm.palette().desktop_background();
-    String background_color_entry = wm.wm_config()->read_entry("Background", "Color", "");
-    if (!background_color_entry.is_empty()) {
-        background_color = Color::from_string(background_color_entry).value_or(background_color);
-    }
+    if (auto* fullscreen_window = wm.active_fullscreen_window())
+        collect_window_damage(*fullscreen_window);
+    else
+        wm.for_each_visible_window_from_front_to_back(collect_window_damage);
+
+    // Paint the wallpaper wherever no opaque window covers the damage.
+    bool wallpaper_is_opaque = m_wallpaper && !m_wallpaper->has_alpha_channel();
+    Gfx::Point wallpaper_offset;
+    if (m_wallpaper && m_wallpaper_mode == WallpaperMode::Center)
+        wallpaper_offset = { ws.size().width() / 2 - m_wallpaper->size().width() / 2, ws.size().height() / 2 - m_wallpaper->size().height() / 2 };
+    auto wallpaper_covers_rect = [&](const Gfx::Rect& rect) {
+        if (!wallpaper_is_opaque)
+            return false;
+        if (m_wallpaper_mode == WallpaperMode::Tile || m_wallpaper_mode == WallpaperMode::Scaled)
+            return true;
+        return m_wallpaper->rect().translated(wallpaper_offset).contains(rect);
+    };
 
-    // Paint the wallpaper.
-    for (auto& dirty_rect : dirty_rects.rects()) {
-        if (wm.any_opaque_window_contains_rect(dirty_rect))
-            continue;
-        // FIXME: If the wallpaper is opaque, no need to fill with color!
-        m_back_painter->fill_rect(dirty_rect, background_color);
+    for (auto& dirty_rect : uncovered_rects.rects()) {
+        m_statistics.pixels_composed += dirty_rect.width() * dirty_rect.height();
+        if (!wallpaper_covers_rect(dirty_rect))
+            m_back_painter->fill_rect(dirty_rect, background_color);
         if (m_wallpaper) {
             if (m_wallpaper_mode == WallpaperMode::Simple) {
                 m_back_painter->blit(dirty_rect.location(), *m_wallpaper, dirty_rect);
             } else if (m_wallpaper_mode == WallpaperMode::Center) {
-                Gfx::Point offset { ws.size().width() / 2 - m_wallpaper->size().width() / 2,
-                    ws.size().height() / 2 - m_wallpaper->size().height() / 2 };
                 m_back_painter->blit_offset(dirty_rect.location(), *m_wallpaper,
-                    dirty_rect, offset);
+                    dirty_rect, wallpaper_offset);
             } else if (m_wallpaper_mode == WallpaperMode::Tile) {
                 m_back_painter->draw_tiled_bitmap(dirty_rect, *m_wallpaper);
             } else if (m_wallpaper_mode == WallpaperMode::Scaled) {
@@ -172,20 +208,16 @@ void Compositor::compose()
         }
     }
 
-    auto compose_window = [&](Window& window) -> IterationDecision {
-        if (!any_dirty_rect_intersects_window(window))
-            return IterationDecision::Continue;
-        Gfx::PainterStateSaver saver(*m_back_painter);
-        m_back_painter->add_clip_rect(window.frame().rect());
+    auto compose_window = [&](Window& window, const Gfx::DisjointRectSet& damage) {
         RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        for (auto& dirty_rect : dirty_rects.rects()) {
-            if (wm.any_opaque_window_above_this_one_contains_rect(window, dirty_rect))
-                continue;
+        for (auto& dirty_rect : damage.rects()) {
+            m_statistics.pixels_composed += dirty_rect.width() * dirty_rect.height();
             Gfx::PainterStateSaver saver(*m_back_painter);
             m_back_painter->add_clip_rect(dirty_rect);
             if (!backing_store)
                 m_back_painter->fill_rect(dirty_rect, wm.palette().window());
-            if (!window.is_fullscreen())
+            // Only redraw the frame when the damage reaches past the window contents into the decorations.
+            if (!window.is_fullscreen() && !window.rect().contains(dirty_rect))
                 window.frame().paint(*m_back_painter);
             if (!backing_store)
                 continue;
@@ -236,21 +268,18 @@ void Compositor::compose()
             for (auto background_rect : window.rect().shatter(backing_rect))
                 m_back_painter->fill_rect(background_rect, wm.palette().window());
         }
-        return IterationDecision::Continue;
     };
 
-    // Paint the window stack.
-    if (auto* fullscreen_window = wm.active_fullscreen_window()) {
-        compose_window(*fullscreen_window);
-    } else {
-        wm.for_each_visible_window_from_back_to_front([&](Window& window) {
-            return compose_window(window);
-        });
+    // Paint the window stack, back to front.
+    for (size_t i = window_damage.size(); i > 0; --i)
+        compose_window(*window_damage[i - 1].window, window_damage[i - 1].rects);
 
+    if (!wm.active_fullscreen_window())
         draw_geometry_label();
-    }
 
+    u64 compose_end = monotonic_microseconds();
     run_animations();
+    u64 animation_end = monotonic_microseconds();
 
     draw_cursor();
 
@@ -264,6 +293,32 @@ void Compositor::compose()
 
     for (auto& r : dirty_rects.rects())
         flush(r);
+
+    u64 frame_end = monotonic_microseconds();
+    m_statistics.frame_count++;
+    m_statistics.compose_microseconds += compose_end - frame_start;
+    m_statistics.animation_microseconds += animation_end - compose_end;
+    m_statistics.flush_microseconds += frame_end - animation_end;
+    m_statistics.dirty_rect_count += dirty_rects.size();
+    m_statistics.frame_microseconds.enqueue(frame_end - frame_start);
+}
+
+void Compositor::reset_statistics()
+{
+    m_statistics = {};
+}
+
+u32 Compositor::frame_time_percentile(int percent) const
+{
+    auto& frames = m_statistics.frame_microseconds;
+    if (frames.is_empty())
+        return 0;
+    Vector<u32, 1024> sorted;
+    for (size_t i = 0; i < frames.size(); ++i)
+        sorted.append(frames.at(i));
+    quick_sort(sorted);
+    size_t index = (sorted.size() - 1) * percent / 100;
+    return sorted[index];
 }
 
 void Compositor::flush(const Gfx::Rect& a_rect)
@@ -294,6 +349,7 @@ void Compositor::flush(const Gfx::Rect& a_rect)
         from_ptr = back_ptr;
     }
 
+    m_statistics.bytes_flushed += rect.width() * rect.height() * sizeof(Gfx::RGBA32);
     for (int y = 0; y < rect.height(); ++y) {
         fast_u32_copy(to_ptr, from_ptr, rect.width());
         from_ptr = (const Gfx::RGBA32*)((const u8*)from_ptr + pitch);
@@ -331,14 +387,23 @@ void Compositor::invalidate(const Gfx::Rect& a_rect)
     }
 }
 
+void Compositor::load_background_config()
+{
+    auto& wm = WindowManager::the();
+    m_wallpaper_mode = mode_to_enum(wm.wm_config()->read_entry("Background", "Mode", "simple"));
+    m_custom_background_color = Color::from_string(wm.wm_config()->read_entry("Background", "Color", ""));
+}
+
 bool Compositor::set_backgound_color(const String& background_color)
 {
     auto& wm = WindowManager::the();
     wm.wm_config()->write_entry("Background", "Color", background_color);
     bool ret_val = wm.wm_config()->sync();
 
-    if (ret_val)
+    if (ret_val) {
+        m_custom_background_color = Color::from_string(background_color);
         Compositor::invalidate();
+    }
 
     return ret_val;
 }
@@ -26,9 +26,12 @@
 
 #pragma once
 
+#include <AK/CircularQueue.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <LibCore/Object.h>
+#include <LibGfx/Color.h>
 #include <LibGfx/DisjointRectSet.h>
 #include <LibGfx/Forward.h>
 
@@ -44,6 +47,18 @@ enum class WallpaperMode {
     Unchecked
 };
 
+// Counters for everything composed since the last reset, so a slow frame can be pinned on the compositor or on clients.
+struct CompositorStatistics {
+    u32 frame_count { 0 };
+    u64 compose_microseconds { 0 };
+    u64 animation_microseconds { 0 };
+    u64 flush_microseconds { 0 };
+    u64 pixels_composed { 0 };
+    u64 dirty_rect_count { 0 };
+    u64 bytes_flushed { 0 };
+    CircularQueue<u32, 1024> frame_microseconds;
+};
+
 class Compositor final : public Core::Object {
     C_OBJECT(Compositor)
 public:
@@ -65,9 +80,15 @@ public:
     void invalidate_cursor();
     Gfx::Rect current_cursor_rect() const;
 
+    const CompositorStatistics& statistics() const { return m_statistics; }
+    void reset_statistics();
+    // Frame time (in microseconds) below which `percent` percent of the recent frames fell.
+    u32 frame_time_percentile(int percent) const;
+
 private:
     Compositor();
     void init_bitmaps();
+    void load_background_config();
     void flip_buffers();
     void flush(const Gfx::Rect&);
     void draw_cursor();
@@ -88,6 +109,7 @@ private:
     OwnPtr<Gfx::Painter> m_front_painter;
 
     Gfx::DisjointRectSet m_dirty_rects;
+    CompositorStatistics m_statistics;
 
     Gfx::Rect m_last_cursor_rect;
     Gfx::Rect m_last_dnd_rect;
@@ -95,6 +117,7 @@ private:
 
     String m_wallpaper_path;
     WallpaperMode m_wallpaper_mode { WallpaperMode::Unchecked };
+    Optional<Gfx::Color> m_custom_background_color;
     RefPtr<Gfx::Bitmap> m_wallpaper;
 };
 
@@ -93,6 +93,7 @@ void Window::set_title(const String& title)
     if (m_title == title)
         return;
     m_title = title;
+    frame().set_title_bar_needs_render();
     WindowManager::the().notify_title_changed(*this);
 }
 
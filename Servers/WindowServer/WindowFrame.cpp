@@ -148,6 +148,7 @@ void WindowFrame::did_set_maximized(Badge<Window>, bool maximized)
 {
     ASSERT(m_maximize_button);
     m_maximize_button->set_bitmap(maximized ? *s_unmaximize_button_bitmap : *s_maximize_button_bitmap);
+    set_title_bar_needs_render();
 }
 
 Gfx::Rect WindowFrame::title_bar_rect() const
@@ -193,13 +194,9 @@ WindowFrame::FrameColors WindowFrame::compute_frame_colors() const
     return { palette.inactive_window_title(), palette.inactive_window_border1(), palette.inactive_window_border2() };
 }
 
-void WindowFrame::paint_notification_frame(Gfx::Painter& painter)
+void WindowFrame::paint_notification_title_bar(Gfx::Painter& painter)
 {
     auto palette = WindowManager::the().palette();
-    Gfx::Rect outer_rect = { {}, rect().size() };
-
-    Gfx::StylePainter::paint_window_frame(painter, outer_rect, palette);
-
     auto titlebar_rect = title_bar_rect();
     painter.fill_rect_with_gradient(Gfx::Orientation::Vertical, titlebar_rect, palette.active_window_border1(), palette.active_window_border2());
 
@@ -212,28 +209,18 @@ void WindowFrame::paint_notification_frame(Gfx::Painter& painter)
     }
 }
 
-void WindowFrame::paint_normal_frame(Gfx::Painter& painter)
+void WindowFrame::paint_normal_title_bar(Gfx::Painter& painter, const FrameColors& colors)
 {
-    auto palette = WindowManager::the().palette();
     auto& window = m_window;
-    Gfx::Rect outer_rect = { {}, rect().size() };
-
-    Gfx::StylePainter::paint_window_frame(painter, outer_rect, palette);
-
-    if (!window.show_titlebar())
-        return;
-
     auto titlebar_rect = title_bar_rect();
     auto titlebar_icon_rect = title_bar_icon_rect();
     auto titlebar_inner_rect = title_bar_text_rect();
     auto titlebar_title_rect = titlebar_inner_rect;
     titlebar_title_rect.set_width(Gfx::Font::default_bold_font().width(window.title()));
 
-    auto [title_color, border_color, border_color2] = compute_frame_colors();
+    auto [title_color, border_color, border_color2] = colors;
 
     auto& wm = WindowManager::the();
-    painter.draw_line(titlebar_rect.bottom_left().translated(0, 1), titlebar_rect.bottom_right().translated(0, 1), palette.button());
-
     auto leftmost_button_rect = m_buttons.is_empty() ? Gfx::Rect() : m_buttons.last().relative_rect();
 
     painter.fill_rect_with_gradient(titlebar_rect, border_color, border_color2);
@@ -257,21 +244,58 @@ void WindowFrame::paint_normal_frame(Gfx::Painter& painter)
     painter.blit(titlebar_icon_rect.location(), window.icon(), window.icon().rect());
 }
 
-void WindowFrame::paint(Gfx::Painter& painter)
+void WindowFrame::render_title_bar_if_needed()
 {
-    Gfx::PainterStateSaver saver(painter);
-    painter.translate(rect().location());
+    auto titlebar_rect = title_bar_rect();
+    auto colors = compute_frame_colors();
+    // Title, icon, button and theme changes are flagged explicitly; size and active state are cheap to compare.
+    if (!m_title_bar_needs_render && m_title_bar_bitmap && m_title_bar_bitmap->size() == titlebar_rect.size() && m_rendered_frame_colors == colors)
+        return;
 
+    if (!m_title_bar_bitmap || m_title_bar_bitmap->size() != titlebar_rect.size())
+        m_title_bar_bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, titlebar_rect.size());
+    if (!m_title_bar_bitmap)
+        return;
+
+    Gfx::Painter painter(*m_title_bar_bitmap);
+    painter.translate(-titlebar_rect.location());
     if (m_window.type() == WindowType::Notification)
-        paint_notification_frame(painter);
-    else if (m_window.type() == WindowType::Normal)
-        paint_normal_frame(painter);
+        paint_notification_title_bar(painter);
     else
-        return;
+        paint_normal_title_bar(painter, colors);
 
     for (auto& button : m_buttons) {
         button.paint(painter);
     }
+
+    m_rendered_frame_colors = colors;
+    m_title_bar_needs_render = false;
+}
+
+void WindowFrame::paint(Gfx::Painter& painter)
+{
+    if (m_window.type() != WindowType::Notification && m_window.type() != WindowType::Normal)
+        return;
+
+    Gfx::PainterStateSaver saver(painter);
+    painter.translate(rect().location());
+
+    auto palette = WindowManager::the().palette();
+    Gfx::StylePainter::paint_window_frame(painter, { {}, rect().size() }, palette);
+
+    if (m_window.type() == WindowType::Normal && !m_window.show_titlebar())
+        return;
+
+    auto titlebar_rect = title_bar_rect();
+    if (titlebar_rect.is_empty())
+        return;
+    if (m_window.type() == WindowType::Normal)
+        painter.draw_line(titlebar_rect.bottom_left().translated(0, 1), titlebar_rect.bottom_right().translated(0, 1), palette.button());
+
+    render_title_bar_if_needed();
+    if (!m_title_bar_bitmap)
+        return;
+    painter.blit(titlebar_rect.location(), *m_title_bar_bitmap, m_title_bar_bitmap->rect());
 }
 
 static Gfx::Rect frame_rect_for_window(Window& window, const Gfx::Rect& rect)
@@ -311,6 +335,7 @@ Gfx::Rect WindowFrame::rect() const
 
 void WindowFrame::invalidate_title_bar()
 {
+    set_title_bar_needs_render();
     WindowManager::the().invalidate(title_bar_rect().translated(rect().location()));
 }
 
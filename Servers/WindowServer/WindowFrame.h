@@ -28,6 +28,8 @@
 
 #include <AK/Forward.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/RefPtr.h>
+#include <LibGfx/Color.h>
 #include <LibGfx/Forward.h>
 
 namespace WindowServer {
@@ -46,6 +48,8 @@ public:
     void on_mouse_event(const MouseEvent&);
     void notify_window_rect_changed(const Gfx::Rect& old_rect, const Gfx::Rect& new_rect);
     void invalidate_title_bar();
+    // The title bar is rendered into a cached bitmap; this forces the next paint to render it again.
+    void set_title_bar_needs_render() { m_title_bar_needs_render = true; }
 
     Gfx::Rect title_bar_rect() const;
     Gfx::Rect title_bar_icon_rect() const;
@@ -54,21 +58,32 @@ public:
     void did_set_maximized(Badge<Window>, bool);
 
 private:
-    void paint_notification_frame(Gfx::Painter&);
-    void paint_normal_frame(Gfx::Painter&);
-
     struct FrameColors {
         Color title_color;
         Color border_color;
         Color border_color2;
+
+        bool operator==(const FrameColors& other) const
+        {
+            return title_color == other.title_color && border_color == other.border_color && border_color2 == other.border_color2;
+        }
+        bool operator!=(const FrameColors& other) const { return !(*this == other); }
     };
 
+    void render_title_bar_if_needed();
+    void paint_notification_title_bar(Gfx::Painter&);
+    void paint_normal_title_bar(Gfx::Painter&, const FrameColors&);
+
     FrameColors compute_frame_colors() const;
 
     Window& m_window;
     NonnullOwnPtrVector<Button> m_buttons;
     Button* m_maximize_button { nullptr };
     Button* m_minimize_button { nullptr };
+
+    RefPtr<Gfx::Bitmap> m_title_bar_bitmap;
+    bool m_title_bar_needs_render { true };
+    FrameColors m_rendered_frame_colors;
 };
 
 }
@@ -1260,6 +1260,7 @@ bool WindowManager::update_theme(String theme_path, String theme_name)
     m_palette = Gfx::PaletteImpl::create_with_shared_buffer(*new_theme);
     HashTable<ClientConnection*> notified_clients;
     for_each_window([&](Window& window) {
+        window.frame().set_title_bar_needs_render();
         if (window.client()) {
             if (!notified_clients.contains(window.client())) {
                 window.client()->post_message(Messages::WindowClient::UpdateSystemTheme(Gfx::current_system_theme_buffer_id()));
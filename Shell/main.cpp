@@ -37,6 +37,7 @@
 #include <fcntl.h>
 #include <pwd.h>
 #include <signal.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -590,6 +591,7 @@ public:
         m_fds.clear();
     }
     void add(int fd) { m_fds.append(fd); }
+    const Vector<int, 32>& fds() const { return m_fds; }
 
 private:
     Vector<int, 32> m_fds;
@@ -885,33 +887,42 @@ static int run_command(const String& cmd)
             if (handle_builtin(argv.size() - 1, argv.data(), retval))
                 return retval;
 
-            pid_t child = fork();
-            if (!child) {
-                setpgid(0, 0);
-                tcsetpgrp(0, getpid());
-                tcsetattr(0, TCSANOW, &g.default_termios);
-                for (auto& rewiring : subcommand.rewirings) {
+            posix_spawn_file_actions_t file_actions;
+            posix_spawn_file_actions_init(&file_actions);
+            for (auto& rewiring : subcommand.rewirings) {
 #ifdef SH_DEBUG
-                    dbgprintf("in %s<%d>, dup2(%d, %d)\n", argv[0], getpid(), rewiring.rewire_fd, rewiring.fd);
+                dbgprintf("in %s, dup2(%d, %d)\n", argv[0], rewiring.rewire_fd, rewiring.fd);
 #endif
-                    int rc = dup2(rewiring.rewire_fd, rewiring.fd);
-                    if (rc < 0) {
-                        perror("dup2");
-                        return 1;
-                    }
-                }
-
-                fds.collect();
+                posix_spawn_file_actions_adddup2(&file_actions, rewiring.rewire_fd, rewiring.fd);
+            }
+            for (auto fd : fds.fds())
+                posix_spawn_file_actions_addclose(&file_actions, fd);
+
+            posix_spawnattr_t attr;
+            posix_spawnattr_init(&attr);
+            posix_spawnattr_setpgroup(&attr, 0);
+            // Hand the terminal to the child before it runs, so it can't try to read from it as a background process.
+            if (isatty(0)) {
+                posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_TCSETPGROUP);
+                posix_spawnattr_tcsetpgrp_np(&attr, 0);
+            } else {
+                posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+            }
 
-                int rc = execvp(argv[0], const_cast<char* const*>(argv.data()));
-                if (rc < 0) {
-                    if (errno == ENOENT)
-                        fprintf(stderr, "%s: Command not found.\n", argv[0]);
-                    else
-                        fprintf(stderr, "execvp(%s): %s\n", argv[0], strerror(errno));
-                    _exit(1);
-                }
-                ASSERT_NOT_REACHED();
+            tcsetattr(0, TCSANOW, &g.default_termios);
+
+            pid_t child = 0;
+            int rc = posix_spawnp(&child, argv[0], &file_actions, &attr, const_cast<char* const*>(argv.data()), environ);
+            posix_spawnattr_destroy(&attr);
+            posix_spawn_file_actions_destroy(&file_actions);
+            if (rc != 0) {
+                if (rc == ENOENT)
+                    fprintf(stderr, "%s: Command not found.\n", argv[0]);
+                else
+                    fprintf(stderr, "posix_spawn(%s): %s\n", argv[0], strerror(rc));
+                if (i == 0)
+                    return_value = 1;
+                continue;
             }
             children.append({ argv[0], child });
         }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Syscall.h>
+#include <LibCore/ElapsedTimer.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: clock_benchmark [-h] [-n reads] [-r]\n");
+    exit(rc);
+}
+
+static u64 to_nanoseconds(const timespec& ts)
+{
+    return (u64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int syscall_clock_gettime(clockid_t clock_id, timespec* ts)
+{
+    return syscall(SC_clock_gettime, clock_id, ts);
+}
+
+int main(int argc, char** argv)
+{
+    int reads = 1000000;
+    clockid_t clock_id = CLOCK_MONOTONIC;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:r")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            reads = atoi(optarg);
+            break;
+        case 'r':
+            clock_id = CLOCK_REALTIME;
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (reads <= 0)
+        exit_with_usage(1);
+
+    printf("Reading %s %d times\n", clock_id == CLOCK_REALTIME ? "CLOCK_REALTIME" : "CLOCK_MONOTONIC", reads);
+
+    Core::ElapsedTimer timer;
+    auto run = [&](const char* label, int (*read_clock)(clockid_t, timespec*)) {
+        // Besides the cost of a read, look at the smallest step the clock takes and whether it ever goes backwards.
+        u64 smallest_step = 0;
+        int backwards_steps = 0;
+        timespec ts;
+        read_clock(clock_id, &ts);
+        u64 previous = to_nanoseconds(ts);
+        timer.start();
+        for (int i = 0; i < reads; ++i) {
+            if (read_clock(clock_id, &ts) < 0) {
+                perror(label);
+                exit(1);
+            }
+            u64 now = to_nanoseconds(ts);
+            if (now < previous)
+                ++backwards_steps;
+            else if (now > previous && (!smallest_step || now - previous < smallest_step))
+                smallest_step = now - previous;
+            previous = now;
+        }
+        auto elapsed_ms = timer.elapsed();
+        u64 ns_per_read = elapsed_ms * 1000000ull / reads;
+        printf("%s: %d reads in %d ms (%llu ns/read), smallest step %llu ns, %d backwards\n", label, reads, elapsed_ms, ns_per_read, smallest_step, backwards_steps);
+    };
+
+    run("libc", clock_gettime);
+    run("syscall", syscall_clock_gettime);
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/Timer.h>
+#include <LibGUI/Application.h>
+#include <LibGUI/Desktop.h>
+#include <LibGUI/Painter.h>
+#include <LibGUI/Widget.h>
+#include <LibGUI/Window.h>
+#include <LibGUI/WindowServerConnection.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: compositor_benchmark [-h] [-t] [-n windows] [-s steps]\n");
+    exit(rc);
+}
+
+class SolidWidget final : public GUI::Widget {
+    C_OBJECT(SolidWidget)
+public:
+    virtual ~SolidWidget() override {}
+
+private:
+    explicit SolidWidget(Color color)
+        : m_color(color)
+    {
+    }
+
+    virtual void paint_event(GUI::PaintEvent& event) override
+    {
+        GUI::Painter painter(*this);
+        painter.fill_rect(event.rect(), m_color);
+    }
+
+    Color m_color;
+};
+
+int main(int argc, char** argv)
+{
+    int window_count = 8;
+    int steps = 300;
+    bool translucent = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "htn:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 't':
+            translucent = true;
+            break;
+        case 'n':
+            window_count = atoi(optarg);
+            break;
+        case 's':
+            steps = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (window_count <= 0 || steps <= 0)
+        exit_with_usage(1);
+
+    GUI::Application app(argc, argv);
+
+    auto desktop_rect = GUI::Desktop::the().rect();
+    Vector<RefPtr<GUI::Window>> windows;
+    for (int i = 0; i < window_count; ++i) {
+        auto window = GUI::Window::construct();
+        window->set_title(String::format("Compositor benchmark %d", i));
+        window->set_rect(40 + i * 24, 40 + i * 24, 320, 200);
+        if (translucent && (i % 2))
+            window->set_opacity(0.75f);
+        window->set_main_widget<SolidWidget>(Color((i * 67) & 0xff, (i * 131) & 0xff, (i * 29 + 96) & 0xff));
+        window->show();
+        windows.append(move(window));
+    }
+
+    auto& connection = GUI::WindowServerConnection::the();
+    int step = 0;
+    Core::ElapsedTimer elapsed_timer;
+
+    // Every step moves each window along its own diagonal, and every few steps it grows or shrinks too,
+    // so each frame has a mix of exposed wallpaper, overlapping windows and fresh backing stores.
+    auto timer = Core::Timer::construct(1000 / 60, [&] {
+        if (step == 0) {
+            connection.send_sync<Messages::WindowServer::GetCompositorStatistics>(true);
+            elapsed_timer.start();
+        }
+        if (step == steps) {
+            auto elapsed_ms = max(elapsed_timer.elapsed(), 1);
+            auto statistics = connection.send_sync<Messages::WindowServer::GetCompositorStatistics>(false);
+            u32 frames = max(statistics->frame_count(), 1u);
+            printf("%d windows, %d steps in %d ms, %u frames (%u fps)\n", window_count, steps, elapsed_ms, statistics->frame_count(), statistics->frame_count() * 1000 / elapsed_ms);
+            printf("frame time: p50 %u us, p90 %u us, p99 %u us, max %u us\n",
+                statistics->frame_microseconds_p50(), statistics->frame_microseconds_p90(), statistics->frame_microseconds_p99(), statistics->frame_microseconds_max());
+            printf("per frame: compose %llu us, animations %llu us, flush %llu us\n",
+                statistics->compose_microseconds() / frames, statistics->animation_microseconds() / frames, statistics->flush_microseconds() / frames);
+            printf("per frame: %llu pixels composed, %llu dirty rects, %llu bytes flushed\n",
+                statistics->pixels_composed() / frames, statistics->dirty_rect_count() / frames, statistics->bytes_flushed() / frames);
+            app.quit();
+            return;
+        }
+        for (size_t i = 0; i < windows.size(); ++i) {
+            auto rect = windows[i]->rect();
+            int dx = (i % 2) ? -4 : 4;
+            int dy = (i % 3) ? 3 : -3;
+            rect.move_by(dx, dy);
+            if (step % 8 == 0) {
+                int delta = (step / 8) % 2 ? -16 : 16;
+                rect.set_width(rect.width() + delta);
+                rect.set_height(rect.height() + delta);
+            }
+            // Start over from the initial position once a window wanders off the desktop.
+            if (!desktop_rect.contains(rect))
+                rect.set_location({ 40 + (int)i * 24, 40 + (int)i * 24 });
+            windows[i]->set_rect(rect);
+        }
+        ++step;
+    });
+
+    return app.exec();
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <dlfcn.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+struct Library {
+    String path;
+    Vector<String> symbols;
+};
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: dl_benchmark [-h] [-l loads] [-n lookups] [-s symbol1,symbol2,...] [library...]\n");
+    exit(rc);
+}
+
+static u64 now_microseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// dlopen() loads a library only once per process, so every timed load happens in a fresh child.
+static bool time_load(const String& library, u64& elapsed_us)
+{
+    int fds[2];
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        return false;
+    }
+
+    pid_t child_pid = fork();
+    if (child_pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (!child_pid) {
+        close(fds[0]);
+        u64 start = now_microseconds();
+        void* handle = dlopen(library.characters(), RTLD_LAZY | RTLD_GLOBAL);
+        u64 elapsed = now_microseconds() - start;
+        if (!handle) {
+            fprintf(stderr, "dlopen(%s): %s\n", library.characters(), dlerror());
+            _exit(1);
+        }
+        write(fds[1], &elapsed, sizeof(elapsed));
+        _exit(0);
+    }
+
+    close(fds[1]);
+    bool ok = read(fds[0], &elapsed_us, sizeof(elapsed_us)) == sizeof(elapsed_us);
+    close(fds[0]);
+    waitpid(child_pid, nullptr, 0);
+    return ok;
+}
+
+static void benchmark_loads(const Library& library, int loads)
+{
+    u64 total_us = 0;
+    u64 fastest_us = 0;
+    for (int i = 0; i < loads; ++i) {
+        u64 elapsed_us;
+        if (!time_load(library.path, elapsed_us))
+            return;
+        total_us += elapsed_us;
+        if (!i || elapsed_us < fastest_us)
+            fastest_us = elapsed_us;
+    }
+    printf("%s: loaded and relocated %d times, %llu us average, %llu us fastest\n", library.path.characters(), loads, total_us / loads, fastest_us);
+}
+
+static void benchmark_lookups(const Library& library, int lookups)
+{
+    void* handle = dlopen(library.path.characters(), RTLD_LAZY | RTLD_GLOBAL);
+    if (!handle) {
+        fprintf(stderr, "dlopen(%s): %s\n", library.path.characters(), dlerror());
+        return;
+    }
+
+    // Misses have to walk a whole hash chain (or stop at the GNU bloom filter),
+    // so measure them separately from lookups that find their symbol.
+    Vector<String> missing_symbols;
+    for (auto& symbol : library.symbols)
+        missing_symbols.append(String::format("%s_missing", symbol.characters()));
+
+    auto run = [&](const char* label, const Vector<String>& names, bool expect_found) {
+        int found = 0;
+        u64 start = now_microseconds();
+        for (int i = 0; i < lookups; ++i) {
+            if (dlsym(handle, names[i % names.size()].characters()))
+                ++found;
+        }
+        u64 elapsed_us = now_microseconds() - start;
+        if (found != (expect_found ? lookups : 0))
+            printf("%s: %s: %d of %d lookups found a symbol\n", library.path.characters(), label, found, lookups);
+        printf("%s: %s: %d lookups in %llu us (%llu ns/lookup)\n", library.path.characters(), label, lookups, elapsed_us, elapsed_us * 1000 / lookups);
+    };
+
+    run("hit", library.symbols, true);
+    run("miss", missing_symbols, false);
+}
+
+int main(int argc, char** argv)
+{
+    int loads = 20;
+    int lookups = 100000;
+    Vector<String> symbols;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hl:n:s:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'l':
+            loads = atoi(optarg);
+            break;
+        case 'n':
+            lookups = atoi(optarg);
+            break;
+        case 's':
+            symbols = String(optarg).split(',');
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (loads <= 0 || lookups <= 0)
+        exit_with_usage(1);
+
+    Vector<Library> libraries;
+    for (int i = optind; i < argc; ++i)
+        libraries.append({ argv[i], symbols });
+
+    if (libraries.is_empty()) {
+        libraries.append({ "/usr/lib/libm.so", { "sin", "sqrt", "pow", "fmod" } });
+        libraries.append({ "/usr/lib/libDynamicLib.so", { "global_lib_function", "other_lib_function", "global_lib_variable" } });
+        if (!symbols.is_empty()) {
+            for (auto& library : libraries)
+                library.symbols = symbols;
+        }
+    }
+
+    for (auto& library : libraries)
+        benchmark_loads(library, loads);
+
+    for (auto& library : libraries) {
+        if (library.symbols.is_empty()) {
+            printf("%s: no symbols to look up, pass some with -s\n", library.path.characters());
+            continue;
+        }
+        benchmark_lookups(library, lookups);
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Function.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGfx/AlphaBlending.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: gfx_benchmark [-h] [-n iterations] [-w width] [-H height] [-o operation]\n");
+    exit(rc);
+}
+
+struct Operation {
+    const char* name;
+    Function<void()> run;
+};
+
+int main(int argc, char** argv)
+{
+    int iterations = 50;
+    int width = 512;
+    int height = 512;
+    const char* only_operation = nullptr;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:w:H:o:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'w':
+            width = atoi(optarg);
+            break;
+        case 'H':
+            height = atoi(optarg);
+            break;
+        case 'o':
+            only_operation = optarg;
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (iterations <= 0 || width <= 0 || height <= 0)
+        exit_with_usage(1);
+
+    Gfx::Size size { width, height };
+    auto target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, size);
+    auto opaque_source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, size);
+    auto translucent_source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, size);
+    auto premultiplied_source = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, size);
+
+    // Something like a window shadow or an anti-aliased icon: a mix of opaque, clear and translucent pixels.
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            u8 alpha = (x * 255 / width + y) & 0xff;
+            Gfx::Color color(x & 0xff, y & 0xff, (x ^ y) & 0xff, alpha);
+            opaque_source->set_pixel(x, y, color.with_alpha(0xff));
+            translucent_source->set_pixel(x, y, color);
+            premultiplied_source->set_pixel(x, y, Gfx::Color(color.red() * alpha / 255, color.green() * alpha / 255, color.blue() * alpha / 255, alpha));
+        }
+    }
+
+    Gfx::Painter painter(*target);
+    Vector<Operation> operations;
+    operations.append({ "fill_rect_alpha", [&] { painter.fill_rect(target->rect(), Gfx::Color(40, 80, 160, 100)); } });
+    operations.append({ "blit_with_alpha", [&] { painter.blit({}, *translucent_source, translucent_source->rect()); } });
+    operations.append({ "blit_with_opacity", [&] { painter.blit({}, *opaque_source, opaque_source->rect(), 0.6f); } });
+    operations.append({ "blend_premultiplied", [&] {
+                           for (int y = 0; y < height; ++y)
+                               Gfx::blend_premultiplied_scanline(target->scanline(y), premultiplied_source->scanline(y), width);
+                       } });
+    // Scaling a quarter-sized region up to the whole target, like a zoomed image or a thumbnail in reverse.
+    Gfx::Rect quarter_rect { 0, 0, max(width / 2, 1), max(height / 2, 1) };
+    operations.append({ "scaled_nearest", [&] { painter.draw_scaled_bitmap(target->rect(), *opaque_source, quarter_rect); } });
+    operations.append({ "scaled_bilinear", [&] { painter.draw_scaled_bitmap(target->rect(), *opaque_source, quarter_rect, Gfx::Painter::ScalingMode::Bilinear); } });
+    operations.append({ "scaled_bilinear_alpha", [&] { painter.draw_scaled_bitmap(target->rect(), *translucent_source, quarter_rect, Gfx::Painter::ScalingMode::Bilinear); } });
+
+    bool simd_available = Gfx::alpha_blending_uses_simd();
+    printf("%dx%d, %d iterations, SSE2 %s\n", width, height, iterations, simd_available ? "available" : "not available");
+
+    Core::ElapsedTimer timer;
+    for (auto& operation : operations) {
+        if (only_operation && strcmp(only_operation, operation.name))
+            continue;
+        for (bool use_simd : { false, true }) {
+            if (use_simd && !simd_available)
+                continue;
+            Gfx::set_alpha_blending_uses_simd(use_simd);
+            target->fill(Gfx::Color::White);
+            timer.start();
+            for (int i = 0; i < iterations; ++i)
+                operation.run();
+            auto elapsed_ms = max(timer.elapsed(), 1);
+            u64 pixels = (u64)width * height * iterations;
+            printf("%-22s %-6s %6d ms  %6llu MP/s\n", operation.name, use_simd ? "sse2" : "scalar", elapsed_ms, pixels / 1000 / elapsed_ms);
+        }
+    }
+
+    Gfx::set_alpha_blending_uses_simd(simd_available);
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibCore/File.h>
+#include <LibCore/Gzip.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: inflate_benchmark [-h] [-n iterations] [-c chunk size] <file.gz>\n");
+    exit(rc);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 10;
+    int chunk_size = 4096;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:c:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'c':
+            chunk_size = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (optind >= argc || iterations <= 0 || chunk_size <= 0)
+        exit_with_usage(1);
+
+    auto file = Core::File::open(argv[optind], Core::IODevice::ReadOnly);
+    if (!file) {
+        fprintf(stderr, "Unable to open %s\n", argv[optind]);
+        return 1;
+    }
+    auto compressed = file->read_all();
+    if (!Core::Gzip::is_compressed(compressed)) {
+        fprintf(stderr, "%s is not a gzip file\n", argv[optind]);
+        return 1;
+    }
+
+    // Whole-buffer decoding into one ByteBuffer, the way Gzip::decompress() is used for files.
+    Core::ElapsedTimer timer;
+    size_t decompressed_size = 0;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        auto decompressed = Core::Gzip::decompress(compressed);
+        if (!decompressed.has_value()) {
+            fprintf(stderr, "Decompression failed\n");
+            return 1;
+        }
+        decompressed_size = decompressed.value().size();
+    }
+    auto whole_ms = max(timer.elapsed(), 1);
+
+    // Chunked decoding with output handed straight to a callback, the way HttpJob sees a response body.
+    u64 streamed_size = 0;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        Core::GzipDecompressor decompressor;
+        decompressor.set_on_output([&](const u8*, size_t size) { streamed_size += size; });
+        for (size_t offset = 0; offset < compressed.size(); offset += chunk_size) {
+            size_t size = min((size_t)chunk_size, compressed.size() - offset);
+            if (decompressor.write(compressed.data() + offset, size) == Core::GzipDecompressor::Status::Error)
+                break;
+        }
+        if (decompressor.status() != Core::GzipDecompressor::Status::Finished) {
+            fprintf(stderr, "Streaming decompression failed\n");
+            return 1;
+        }
+    }
+    auto streamed_ms = max(timer.elapsed(), 1);
+
+    u64 total_size = (u64)decompressed_size * iterations;
+    printf("%zu bytes compressed, %zu bytes decompressed, %d iterations\n", compressed.size(), decompressed_size, iterations);
+    printf("%-22s %6d ms  %6llu KiB/s\n", "whole buffer", whole_ms, total_size * 1000 / 1024 / whole_ms);
+    printf("%-22s %6d ms  %6llu KiB/s\n", String::format("%d byte chunks", chunk_size).characters(), streamed_ms, streamed_size * 1000 / 1024 / streamed_ms);
+    return 0;
+}
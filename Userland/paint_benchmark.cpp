@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/String.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/DisplayList.h>
+#include <LibGfx/Font.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/TiledPainter.h>
+#include <LibThread/ThreadPool.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: paint_benchmark [-h] [-n iterations] [-w width] [-H height] [-x tile width] [-y tile height]\n");
+    exit(rc);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 20;
+    int width = 1024;
+    int height = 768;
+    int tile_width = 256;
+    int tile_height = 64;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:w:H:x:y:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'w':
+            width = atoi(optarg);
+            break;
+        case 'H':
+            height = atoi(optarg);
+            break;
+        case 'x':
+            tile_width = atoi(optarg);
+            break;
+        case 'y':
+            tile_height = atoi(optarg);
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (iterations <= 0 || width <= 0 || height <= 0 || tile_width <= 0 || tile_height <= 0)
+        exit_with_usage(1);
+
+    // A small wallpaper-like image, scaled up to fill the screen.
+    auto wallpaper = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { 320, 240 });
+    for (int y = 0; y < wallpaper->height(); ++y) {
+        for (int x = 0; x < wallpaper->width(); ++x)
+            wallpaper->set_pixel(x, y, Gfx::Color(x & 0xff, y & 0xff, (x ^ y) & 0xff));
+    }
+    auto icon = Gfx::Bitmap::create(Gfx::BitmapFormat::RGBA32, { 32, 32 });
+    for (int y = 0; y < icon->height(); ++y) {
+        for (int x = 0; x < icon->width(); ++x)
+            icon->set_pixel(x, y, Gfx::Color(255, x * 8, y * 8, (x + y) * 4));
+    }
+
+    // Something like a desktop repaint: wallpaper, a few windows with title bars, text and icons.
+    Gfx::DisplayList display_list;
+    display_list.draw_scaled_bitmap({ 0, 0, width, height }, *wallpaper, wallpaper->rect(), Gfx::Painter::ScalingMode::Bilinear);
+    auto& font = Gfx::Font::default_font();
+    for (int i = 0; i < 4; ++i) {
+        Gfx::Rect window_rect { 40 + i * width / 6, 30 + i * height / 8, width / 2, height / 2 };
+        display_list.fill_rect_with_gradient(Orientation::Horizontal, { window_rect.x(), window_rect.y(), window_rect.width(), 18 }, Gfx::Color(40, 60, 150), Gfx::Color(120, 150, 220));
+        display_list.fill_rect({ window_rect.x(), window_rect.y() + 18, window_rect.width(), window_rect.height() - 18 }, Gfx::Color(0xd4, 0xd0, 0xc8));
+        display_list.draw_rect(window_rect, Gfx::Color::Black);
+        display_list.draw_text({ window_rect.x() + 4, window_rect.y(), window_rect.width() - 8, 18 }, String::format("Window %d", i), font, Gfx::TextAlignment::CenterLeft, Gfx::Color::White);
+        for (int line = 0; line < 20; ++line)
+            display_list.draw_text({ window_rect.x() + 8, window_rect.y() + 24 + line * 14, window_rect.width() - 16, 14 }, "The quick brown fox jumps over the lazy dog. 0123456789", font, Gfx::TextAlignment::CenterLeft, Gfx::Color::Black, Gfx::TextElision::Right);
+        for (int j = 0; j < 8; ++j)
+            display_list.blit({ window_rect.x() + 8 + j * 40, window_rect.bottom() - 40 }, *icon, icon->rect());
+    }
+
+    auto single_target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { width, height });
+    auto tiled_target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { width, height });
+
+    printf("%dx%d, %zu operations, %d iterations, %zu pool workers, %dx%d tiles\n", width, height, display_list.size(), iterations, LibThread::ThreadPool::the().worker_count(), tile_width, tile_height);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        Gfx::Painter painter(*single_target);
+        display_list.paint(painter);
+    }
+    auto single_ms = max(timer.elapsed(), 1);
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        Gfx::Painter painter(*tiled_target);
+        Gfx::TiledPainter tiled_painter(painter);
+        tiled_painter.set_tile_size({ tile_width, tile_height });
+        tiled_painter.paint(display_list);
+    }
+    auto tiled_ms = max(timer.elapsed(), 1);
+
+    bool identical = !memcmp(single_target->scanline(0), tiled_target->scanline(0), single_target->pitch() * height);
+    printf("%-14s %6d ms  %6.1f frames/s\n", "single thread", single_ms, iterations * 1000.0 / single_ms);
+    printf("%-14s %6d ms  %6.1f frames/s\n", "tiled", tiled_ms, iterations * 1000.0 / tiled_ms);
+    printf("output %s\n", identical ? "identical" : "DIFFERS");
+    return identical ? 0 : 1;
+}
@@ -24,11 +24,92 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/File.h>
 #include <serenity.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static volatile bool g_interrupted;
+
+static bool drain_profile(JsonArray& events, JsonArray& processes, u32& lost_samples)
+{
+    // Every read hands out a bounded batch of samples, so keep reading until none are pending.
+    for (;;) {
+        auto file = Core::File::construct("/proc/profile");
+        if (!file->open(Core::IODevice::ReadOnly)) {
+            fprintf(stderr, "Failed to open /proc/profile: %s\n", file->error_string());
+            return false;
+        }
+        auto json = JsonValue::from_string(file->read_all());
+        if (!json.is_object())
+            return false;
+        auto& object = json.as_object();
+        processes = object.get("processes").as_array();
+        // The kernel keeps counting lost samples until profiling starts over.
+        lost_samples = object.get("lost_samples").to_u32();
+        object.get("events").as_array().for_each([&](auto& event) {
+            events.append(event);
+        });
+        if (!object.get("pending_samples").to_u32())
+            return true;
+    }
+}
+
+static int stream_profile(pid_t pid, pid_t child_pid, const char* output_path)
+{
+    JsonArray events;
+    JsonArray processes;
+    u32 lost_samples = 0;
+
+    signal(SIGINT, [](int) { g_interrupted = true; });
+
+    for (;;) {
+        sleep(1);
+        if (!drain_profile(events, processes, lost_samples))
+            return 1;
+        if (g_interrupted)
+            break;
+        if (child_pid && waitpid(child_pid, nullptr, WNOHANG) == child_pid)
+            break;
+    }
+
+    if (profiling_disable(pid) < 0)
+        perror("profiling_disable");
+    drain_profile(events, processes, lost_samples);
+
+    String executable;
+    processes.for_each([&](auto& value) {
+        auto& process = value.as_object();
+        if (executable.is_null() && process.get("pid").to_i32() == pid)
+            executable = process.get("executable").to_string();
+    });
+
+    JsonObject profile;
+    profile.set("pid", pid);
+    profile.set("executable", executable);
+    profile.set("lost_samples", lost_samples);
+    profile.set("processes", move(processes));
+    profile.set("events", move(events));
+
+    auto output = Core::File::construct(output_path);
+    if (!output->open(Core::IODevice::WriteOnly)) {
+        fprintf(stderr, "Failed to open %s: %s\n", output_path, output->error_string());
+        return 1;
+    }
+    output->write(profile.to_string());
+
+    if (lost_samples)
+        fprintf(stderr, "Warning: the kernel dropped %u samples.\n", lost_samples);
+    return 0;
+}
 
 int main(int argc, char** argv)
 {
@@ -36,29 +117,41 @@ int main(int argc, char** argv)
 
     const char* pid_argument = nullptr;
     const char* cmd_argument = nullptr;
+    const char* output_path = nullptr;
+    bool all_processes = false;
     bool enable = false;
     bool disable = false;
 
     args_parser.add_option(pid_argument, "Target PID", nullptr, 'p', "PID");
+    args_parser.add_option(all_processes, "Profile all processes", nullptr, 'a');
     args_parser.add_option(enable, "Enable", nullptr, 'e');
     args_parser.add_option(disable, "Disable", nullptr, 'd');
     args_parser.add_option(cmd_argument, "Command", nullptr, 'c', "command");
+    args_parser.add_option(output_path, "Stream samples to file until the command exits or ^C", nullptr, 'o', "file");
 
     args_parser.parse(argc, argv);
 
-    if (!pid_argument && !cmd_argument) {
+    if (!pid_argument && !cmd_argument && !all_processes) {
         args_parser.print_usage(stdout, argv[0]);
         return 0;
     }
 
-    if (pid_argument) {
+    if (pid_argument || all_processes) {
+        pid_t pid = all_processes ? -1 : atoi(pid_argument);
+
+        if (output_path) {
+            if (profiling_enable(pid) < 0) {
+                perror("profiling_enable");
+                return 1;
+            }
+            return stream_profile(pid, 0, output_path);
+        }
+
         if (!(enable ^ disable)) {
-            fprintf(stderr, "-p <PID> requires -e xor -d.\n");
+            fprintf(stderr, "-p <PID> and -a require -e xor -d.\n");
             return 1;
         }
 
-        pid_t pid = atoi(pid_argument);
-
         if (enable) {
             if (profiling_enable(pid) < 0) {
                 perror("profiling_enable");
@@ -83,6 +176,22 @@ int main(int argc, char** argv)
 
     cmd_argv.append(nullptr);
 
+    if (output_path) {
+        pid_t child_pid = fork();
+        if (child_pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (child_pid == 0) {
+            profiling_enable(getpid());
+            if (execvp(cmd_argv[0], const_cast<char**>(cmd_argv.data())) < 0) {
+                perror("execv");
+                _exit(1);
+            }
+        }
+        return stream_profile(child_pid, child_pid, output_path);
+    }
+
     dbg() << "Enabling profiling for PID " << getpid();
     profiling_enable(getpid());
     if (execvp(cmd_argv[0], const_cast<char**>(cmd_argv.data())) < 0) {
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Assertions.h>
+#include <AK/String.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define EXPECT(condition)                                                            \
+    do {                                                                             \
+        if (!(condition))                                                            \
+            fprintf(stderr, __FILE__ ":%d: Expected " #condition "\n", __LINE__); \
+    } while (0)
+
+static int wait_for(pid_t pid)
+{
+    int wstatus = 0;
+    int rc;
+    do {
+        rc = waitpid(pid, &wstatus, 0);
+    } while (rc < 0 && errno == EINTR);
+    ASSERT(rc == pid);
+    return wstatus;
+}
+
+static String read_file(const char* path)
+{
+    char buffer[256];
+    int fd = open(path, O_RDONLY);
+    ASSERT(fd >= 0);
+    int nread = read(fd, buffer, sizeof(buffer));
+    ASSERT(nread >= 0);
+    close(fd);
+    return String(buffer, nread);
+}
+
+void test_spawn_exit_status()
+{
+    const char* argv[] = { "/bin/true", nullptr };
+    pid_t pid = 0;
+    int rc = posix_spawn(&pid, argv[0], nullptr, nullptr, const_cast<char* const*>(argv), environ);
+    EXPECT(rc == 0);
+    EXPECT(pid > 0);
+    int wstatus = wait_for(pid);
+    EXPECT(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0);
+}
+
+void test_spawnp_not_found()
+{
+    const char* argv[] = { "this-program-does-not-exist", nullptr };
+    pid_t pid = 0;
+    int rc = posix_spawnp(&pid, argv[0], nullptr, nullptr, const_cast<char* const*>(argv), environ);
+    EXPECT(rc == ENOENT);
+    // Nothing should have been started on the way.
+    EXPECT(waitpid(-1, nullptr, WNOHANG) < 0 && errno == ECHILD);
+}
+
+void test_spawnp_runs_file_actions_once()
+{
+    // With /bin second in PATH, an exclusive create fails if the file actions run for the first entry too.
+    const char* path = "/tmp/posix_spawn_once";
+    unlink(path);
+    const char* old_path = getenv("PATH");
+    String saved_path = old_path ? old_path : "";
+    setenv("PATH", "/this/does/not/exist:/bin", 1);
+
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    posix_spawn_file_actions_addopen(&file_actions, STDOUT_FILENO, path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    const char* argv[] = { "echo", "once", nullptr };
+    pid_t pid = 0;
+    int rc = posix_spawnp(&pid, argv[0], &file_actions, nullptr, const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&file_actions);
+    setenv("PATH", saved_path.characters(), 1);
+
+    EXPECT(rc == 0);
+    if (rc == 0) {
+        int wstatus = wait_for(pid);
+        EXPECT(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0);
+        EXPECT(read_file(path) == "once\n");
+    }
+    unlink(path);
+}
+
+void test_dup2_onto_open_descriptor()
+{
+    const char* path = "/tmp/posix_spawn_dup2";
+    unlink(path);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT(fd >= 0);
+
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    posix_spawn_file_actions_adddup2(&file_actions, fd, STDOUT_FILENO);
+    const char* argv[] = { "/bin/echo", "dup2", nullptr };
+    pid_t pid = 0;
+    int rc = posix_spawn(&pid, argv[0], &file_actions, nullptr, const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&file_actions);
+    close(fd);
+
+    EXPECT(rc == 0);
+    if (rc == 0) {
+        wait_for(pid);
+        EXPECT(read_file(path) == "dup2\n");
+    }
+    unlink(path);
+}
+
+void test_signal_mask()
+{
+    // A SIGTERM sent right away must wait until the child unblocks it, which it never does.
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    const char* argv[] = { "/bin/sleep", "1", nullptr };
+    pid_t pid = 0;
+    int rc = posix_spawn(&pid, argv[0], nullptr, &attr, const_cast<char* const*>(argv), environ);
+    posix_spawnattr_destroy(&attr);
+
+    EXPECT(rc == 0);
+    if (rc == 0) {
+        kill(pid, SIGTERM);
+        int wstatus = wait_for(pid);
+        EXPECT(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0);
+    }
+}
+
+void test_tcsetpgroup_needs_tty()
+{
+    int pipefds[2];
+    ASSERT(pipe(pipefds) == 0);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_TCSETPGROUP);
+    posix_spawnattr_tcsetpgrp_np(&attr, pipefds[0]);
+    const char* argv[] = { "/bin/true", nullptr };
+    pid_t pid = 0;
+    int rc = posix_spawn(&pid, argv[0], nullptr, &attr, const_cast<char* const*>(argv), environ);
+    posix_spawnattr_destroy(&attr);
+    EXPECT(rc == ENOTTY);
+    close(pipefds[0]);
+    close(pipefds[1]);
+}
+
+int main(int, char**)
+{
+    test_spawn_exit_status();
+    test_spawnp_not_found();
+    test_spawnp_runs_file_actions_once();
+    test_dup2_onto_open_descriptor();
+    test_signal_mask();
+    test_tcsetpgroup_needs_tty();
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2020, Andreas Kling <kling@serenityos.org>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Function.h>
+#include <AK/String.h>
+#include <AK/StringBuilder.h>
+#include <AK/Utf8View.h>
+#include <AK/Vector.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Font.h>
+#include <LibGfx/Painter.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void exit_with_usage(int rc)
+{
+    fprintf(stderr, "Usage: text_benchmark [-h] [-n iterations] [-c columns] [-r rows] [-f font]\n");
+    exit(rc);
+}
+
+struct Operation {
+    const char* name;
+    Function<void()> run;
+};
+
+int main(int argc, char** argv)
+{
+    int iterations = 100;
+    int columns = 80;
+    int rows = 25;
+    const char* font_path = nullptr;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hn:c:r:f:")) != -1) {
+        switch (opt) {
+        case 'h':
+            exit_with_usage(0);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'c':
+            columns = atoi(optarg);
+            break;
+        case 'r':
+            rows = atoi(optarg);
+            break;
+        case 'f':
+            font_path = optarg;
+            break;
+        default:
+            exit_with_usage(1);
+        }
+    }
+
+    if (iterations <= 0 || columns <= 0 || rows <= 0)
+        exit_with_usage(1);
+
+    RefPtr<Gfx::Font> font;
+    if (font_path) {
+        font = Gfx::Font::load_from_file(font_path);
+        if (!font) {
+            fprintf(stderr, "Unable to load font %s\n", font_path);
+            return 1;
+        }
+    } else {
+        font = Gfx::Font::default_fixed_width_font();
+    }
+
+    // Something like a screen of shell output: words of printable ASCII separated by spaces.
+    Vector<String> lines;
+    unsigned seed = 1;
+    for (int row = 0; row < rows; ++row) {
+        StringBuilder builder;
+        for (int column = 0; column < columns; ++column) {
+            seed = seed * 1103515245 + 12345;
+            unsigned value = (seed >> 16) % 100;
+            builder.append(value < 15 ? ' ' : (char)('!' + value % 94));
+        }
+        lines.append(builder.to_string());
+    }
+
+    int cell_width = font->glyph_width('x');
+    int line_height = font->glyph_height() + 2;
+    auto target = Gfx::Bitmap::create(Gfx::BitmapFormat::RGB32, { columns * (cell_width + font->glyph_spacing()), rows * line_height });
+    Gfx::Painter painter(*target);
+    Gfx::Color color(0xc0, 0xc0, 0xc0);
+
+    Vector<Operation> operations;
+    // One bit test per glyph pixel, the way glyphs were drawn before they had an atlas.
+    operations.append({ "glyph_bitmap", [&] {
+                           for (int row = 0; row < rows; ++row) {
+                               for (int column = 0; column < columns; ++column) {
+                                   char ch = lines[row][column];
+                                   if (ch != ' ')
+                                       painter.draw_bitmap({ column * cell_width, row * line_height }, font->glyph_bitmap(ch), color);
+                               }
+                           }
+                       } });
+    // One glyph per cell, the way TerminalWidget paints.
+    operations.append({ "draw_glyph", [&] {
+                           for (int row = 0; row < rows; ++row) {
+                               for (int column = 0; column < columns; ++column) {
+                                   char ch = lines[row][column];
+                                   if (ch != ' ')
+                                       painter.draw_glyph({ column * cell_width, row * line_height }, ch, *font, color);
+                               }
+                           }
+                       } });
+    // One run per line, the way draw_text() paints.
+    operations.append({ "draw_text_run", [&] {
+                           for (int row = 0; row < rows; ++row)
+                               painter.draw_text_run({ 0, row * line_height }, Utf8View(lines[row]), *font, color);
+                       } });
+
+    printf("%s, %dx%d cells, %d iterations\n", font->name().characters(), columns, rows, iterations);
+
+    // Build the atlas up front so it isn't counted against the first operation that uses it.
+    font->glyph_atlas();
+
+    Core::ElapsedTimer timer;
+    for (auto& operation : operations) {
+        target->fill(Gfx::Color::Black);
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+            operation.run();
+        auto elapsed_ms = max(timer.elapsed(), 1);
+        u64 glyphs = (u64)columns * rows * iterations;
+        printf("%-16s %6d ms  %8llu glyphs/ms\n", operation.name, elapsed_ms, glyphs / elapsed_ms);
+    }
+    return 0;
+}